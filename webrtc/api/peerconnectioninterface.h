@@ -934,6 +934,23 @@ class PeerConnectionFactoryInterface : public rtc::RefCountInterface {
 
     // Sets crypto related options, e.g. enabled cipher suites.
     rtc::CryptoOptions crypto_options;
+
+    // Number of certificates with the default key type that are generated
+    // in the background ahead of time, so that PeerConnections created without
+    // a certificate don't have to wait for key generation. Only applies to
+    // PeerConnections created with the default certificate generator.
+    int certificate_pool_size = 0;
+
+    // Number of threads running the DTLS handshakes of the PeerConnections,
+    // so that the public key operations of many concurrent handshakes don't
+    // delay the network thread. If 0, the handshakes run on the network
+    // thread. Only applies to PeerConnections created afterwards.
+    int dtls_handshake_threads = 0;
+
+    // If set to true, DTLS sessions are cached, so that later connections
+    // between the same certificates resume them with an abbreviated
+    // handshake. Only applies to PeerConnections created afterwards.
+    bool enable_dtls_session_resumption = false;
   };
 
   virtual void SetOptions(const Options& options) = 0;
@@ -953,6 +970,18 @@ class PeerConnectionFactoryInterface : public rtc::RefCountInterface {
       std::unique_ptr<rtc::RTCCertificateGeneratorInterface> cert_generator,
       PeerConnectionObserver* observer) = 0;
 
+  // Creates a factory whose PeerConnections run on |signaling_thread|, and
+  // which shares the worker and network threads, the media engine, the default
+  // network manager and the certificate pool of this factory. Shards with
+  // different signaling threads can create PeerConnections concurrently, so
+  // that joining many calls at once isn't serialized on one signaling thread.
+  // A shard starts with the options of this factory; its SetOptions doesn't
+  // change what it shares. Returns null if sharding isn't supported.
+  virtual rtc::scoped_refptr<PeerConnectionFactoryInterface> CreateShard(
+      rtc::Thread* signaling_thread) {
+    return nullptr;
+  }
+
   virtual rtc::scoped_refptr<MediaStreamInterface>
       CreateLocalMediaStream(const std::string& label) = 0;
 
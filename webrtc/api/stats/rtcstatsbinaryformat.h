@@ -0,0 +1,159 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_API_STATS_RTCSTATSBINARYFORMAT_H_
+#define WEBRTC_API_STATS_RTCSTATSBINARYFORMAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "webrtc/api/stats/rtcstats.h"
+#include "webrtc/api/stats/rtcstatsreport.h"
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ref_ptr.h"
+
+namespace webrtc {
+
+// A compact binary encoding of a stream of |RTCStatsReport|s, for shipping
+// stats of many calls to a server. Unlike |RTCStatsReport::ToString|, stats
+// types and member names are not repeated in every report: the first time a
+// type is written to a stream, its schema, the names and value types of its
+// members, is written and assigned a number, and its stats are written with
+// that number and the indices of their members in the schema.
+//
+// The stream is a sequence of records, each starting with a tag byte:
+//   kReportTag: flags (kDeltaFlag), timestamp_us (zigzag varint).
+//   kSchemaTag: type number (varint), type (string), number of members
+//               (varint), then for each member its |Type| (byte) and name
+//               (string).
+//   kStatsTag: type number (varint), id (string), timestamp_us relative to
+//              the report (zigzag varint), number of members written
+//              (varint), then for each member (index << 1 | is_defined)
+//              (varint) and, if defined, its value.
+//   kRemovedTag: id (string) of stats which are not in the report.
+//   kEndTag: ends the report.
+// Strings and sequences are prefixed by their size (varint), integers are
+// varints (zigzag for signed types), doubles are 8 bytes, little-endian.
+//
+// In a delta report only the stats members which changed since the previous
+// report are written, stats that didn't change at all are left out and stats
+// that are gone are listed with kRemovedTag.
+class RTCStatsBinaryWriter {
+ public:
+  enum Mode {
+    kFull,
+    kDelta,
+  };
+
+  RTCStatsBinaryWriter();
+  ~RTCStatsBinaryWriter();
+
+  // Writes |report| to |buffer|, as a delta of the previously written report
+  // if |mode| is kDelta and there is one. Returns the number of bytes written,
+  // or 0 if the report doesn't fit in |buffer_size| bytes; the writer is then
+  // left unchanged, and the report can be written again to a larger buffer.
+  // Once the stats types of the stream have been seen, writing doesn't
+  // allocate memory.
+  size_t Write(const rtc::scoped_refptr<const RTCStatsReport>& report,
+               Mode mode,
+               uint8_t* buffer,
+               size_t buffer_size);
+
+ private:
+  // The schema registry entry of a stats type.
+  struct Schema {
+    const char* type;
+    uint32_t number;
+    // The offsets of the members within a stats object of the type. Members
+    // are found with these rather than with |RTCStats::Members|, which
+    // allocates a vector.
+    std::vector<ptrdiff_t> member_offsets;
+    bool written;
+  };
+
+  class Buffer;
+
+  Schema* GetSchema(const RTCStats& stats);
+  void WriteStats(const RTCStats& stats,
+                  const Schema& schema,
+                  const RTCStats* previous_stats,
+                  int64_t timestamp_us,
+                  int64_t previous_timestamp_us,
+                  Buffer* out);
+
+  std::vector<Schema> schemas_;
+  // The numbers of the schemas first written by the current |Write| call,
+  // which are marked as not written again if it fails.
+  std::vector<uint32_t> written_schemas_;
+  rtc::scoped_refptr<const RTCStatsReport> previous_report_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RTCStatsBinaryWriter);
+};
+
+// Reads the reports written by an |RTCStatsBinaryWriter|, in the order they
+// were written. The reader keeps the stats of the last report read, which
+// delta reports are applied to.
+class RTCStatsBinaryReader {
+ public:
+  struct Member {
+    std::string name;
+    RTCStatsMemberInterface::Type type;
+    bool is_defined;
+    // The value as formatted by |RTCStatsMemberInterface::ValueToString|.
+    std::string value;
+  };
+  struct Stats {
+    Stats();
+    Stats(const Stats& other);
+    ~Stats();
+
+    std::string type;
+    std::string id;
+    int64_t timestamp_us;
+    // In the order of |RTCStats::Members|.
+    std::vector<Member> members;
+  };
+
+  RTCStatsBinaryReader();
+  ~RTCStatsBinaryReader();
+
+  // Reads the report at the start of |data|. Returns the number of bytes
+  // read, or 0 if |data| doesn't start with a well-formed report, after which
+  // the reader must not be used anymore.
+  size_t Read(const uint8_t* data, size_t size);
+
+  int64_t timestamp_us() const { return timestamp_us_; }
+  // The stats of the last report read, by id.
+  const std::map<std::string, Stats>& stats() const { return stats_; }
+
+ private:
+  struct Schema {
+    Schema();
+    Schema(const Schema& other);
+    ~Schema();
+
+    std::string type;
+    std::vector<Member> members;
+  };
+
+  std::map<uint32_t, Schema> schemas_;
+  int64_t timestamp_us_;
+  std::map<std::string, Stats> stats_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RTCStatsBinaryReader);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_API_STATS_RTCSTATSBINARYFORMAT_H_
@@ -10,61 +10,184 @@
 
 #include "webrtc/base/copyonwritebuffer.h"
 
+#include <vector>
+
+#include "webrtc/base/atomicops.h"
+#include "webrtc/base/basictypes.h"
+#include "webrtc/base/criticalsection.h"
+
 namespace rtc {
 
+namespace {
+
+// Storage of up to kMaxPooledCapacity bytes comes from one of the size classes
+// kMinPooledCapacity, 2 * kMinPooledCapacity, ..., kMaxPooledCapacity.
+const size_t kMinPooledCapacity = 128;
+const size_t kMaxPooledCapacity = 2048;
+const size_t kNumSizeClasses = 5;
+// The number of free buffers kept per size class, which bounds the memory
+// held by the pool to 32 * (128 + 256 + ... + 2048) bytes.
+const size_t kMaxFreeBuffers = 32;
+
+class PooledBuffer;
+
+// Free storage of packet-sized buffers, shared by all threads.
+class BufferPool {
+ public:
+  static BufferPool* Instance() {
+    RTC_DEFINE_STATIC_LOCAL(BufferPool, instance, ());
+    return &instance;
+  }
+
+  // Returns storage of at least |capacity| <= kMaxPooledCapacity bytes.
+  RefCountedObject<Buffer>* Get(size_t capacity);
+  // Takes back |buffer| when it is no longer referenced. Returns false if the
+  // pool is full, in which case |buffer| should be deleted.
+  bool Put(PooledBuffer* buffer);
+
+  CopyOnWriteBuffer::PoolStats stats() {
+    CritScope cs(&crit_);
+    return stats_;
+  }
+
+ private:
+  static size_t SizeClass(size_t capacity) {
+    size_t size_class = 0;
+    for (size_t c = kMinPooledCapacity; c < capacity; c *= 2) {
+      ++size_class;
+    }
+    return size_class;
+  }
+
+  CriticalSection crit_;
+  std::vector<PooledBuffer*> free_buffers_[kNumSizeClasses];
+  CopyOnWriteBuffer::PoolStats stats_;
+};
+
+// Storage which goes back to the pool instead of being deleted.
+class PooledBuffer : public RefCountedObject<Buffer> {
+ public:
+  explicit PooledBuffer(size_t capacity)
+      : RefCountedObject<Buffer>(capacity) {}
+
+  int Release() const override {
+    int count = AtomicOps::Decrement(&ref_count_);
+    if (!count) {
+      PooledBuffer* buffer = const_cast<PooledBuffer*>(this);
+      if (!BufferPool::Instance()->Put(buffer)) {
+        delete buffer;
+      }
+    }
+    return count;
+  }
+};
+
+RefCountedObject<Buffer>* BufferPool::Get(size_t capacity) {
+  RTC_DCHECK_LE(capacity, kMaxPooledCapacity);
+  const size_t size_class = SizeClass(capacity);
+  {
+    CritScope cs(&crit_);
+    std::vector<PooledBuffer*>& free_buffers = free_buffers_[size_class];
+    if (!free_buffers.empty()) {
+      PooledBuffer* buffer = free_buffers.back();
+      free_buffers.pop_back();
+      ++stats_.hits;
+      return buffer;
+    }
+    ++stats_.misses;
+  }
+  return new PooledBuffer(kMinPooledCapacity << size_class);
+}
+
+bool BufferPool::Put(PooledBuffer* buffer) {
+  std::vector<PooledBuffer*>& free_buffers =
+      free_buffers_[SizeClass(buffer->capacity())];
+  CritScope cs(&crit_);
+  if (free_buffers.size() >= kMaxFreeBuffers) {
+    return false;
+  }
+  free_buffers.push_back(buffer);
+  return true;
+}
+
+}  // namespace
+
 CopyOnWriteBuffer::CopyOnWriteBuffer() {
   RTC_DCHECK(IsConsistent());
 }
 
 CopyOnWriteBuffer::CopyOnWriteBuffer(const CopyOnWriteBuffer& buf)
-    : buffer_(buf.buffer_) {
+    : buffer_(buf.buffer_),
+      offset_(buf.offset_),
+      size_(buf.size_),
+      capacity_(buf.capacity_) {
 }
 
 CopyOnWriteBuffer::CopyOnWriteBuffer(CopyOnWriteBuffer&& buf)
-    : buffer_(std::move(buf.buffer_)) {
+    : buffer_(std::move(buf.buffer_)),
+      offset_(buf.offset_),
+      size_(buf.size_),
+      capacity_(buf.capacity_) {
+  buf.offset_ = 0;
+  buf.size_ = 0;
+  buf.capacity_ = 0;
 }
 
 CopyOnWriteBuffer::CopyOnWriteBuffer(size_t size)
-    : buffer_(size > 0 ? new RefCountedObject<Buffer>(size) : nullptr) {
-  RTC_DCHECK(IsConsistent());
+    : CopyOnWriteBuffer(size, size) {
 }
 
-CopyOnWriteBuffer::CopyOnWriteBuffer(size_t size, size_t capacity)
-    : buffer_(size > 0 || capacity > 0
-          ? new RefCountedObject<Buffer>(size, capacity)
-          : nullptr) {
+CopyOnWriteBuffer::CopyOnWriteBuffer(size_t size, size_t capacity) {
+  if (size > 0 || capacity > 0) {
+    Allocate(std::max(size, capacity));
+    size_ = size;
+  }
   RTC_DCHECK(IsConsistent());
 }
 
 CopyOnWriteBuffer::~CopyOnWriteBuffer() = default;
 
 bool CopyOnWriteBuffer::operator==(const CopyOnWriteBuffer& buf) const {
-  // Must either use the same buffer internally or have the same contents.
+  // Must either use the same data or have the same contents.
   RTC_DCHECK(IsConsistent());
   RTC_DCHECK(buf.IsConsistent());
-  return buffer_.get() == buf.buffer_.get() ||
-      (buffer_.get() && buf.buffer_.get() &&
-      *buffer_.get() == *buf.buffer_.get());
+  return size_ == buf.size_ &&
+      (size_ == 0 || cdata() == buf.cdata() ||
+      std::memcmp(cdata(), buf.cdata(), size_) == 0);
+}
+
+CopyOnWriteBuffer CopyOnWriteBuffer::Slice(size_t offset,
+                                           size_t length) const {
+  RTC_DCHECK(IsConsistent());
+  RTC_DCHECK_LE(offset, size_);
+  RTC_DCHECK_LE(length, size_ - offset);
+  CopyOnWriteBuffer slice;
+  if (offset < capacity_) {
+    slice = *this;
+    slice.offset_ += offset;
+    slice.size_ = length;
+    slice.capacity_ -= offset;
+  }
+  RTC_DCHECK(slice.IsConsistent());
+  return slice;
 }
 
 void CopyOnWriteBuffer::SetSize(size_t size) {
   RTC_DCHECK(IsConsistent());
   if (!buffer_) {
     if (size > 0) {
-      buffer_ = new RefCountedObject<Buffer>(size);
+      Allocate(size);
+      size_ = size;
     }
     RTC_DCHECK(IsConsistent());
     return;
   }
 
-  // Clone data if referenced.
-  if (!buffer_->HasOneRef()) {
-    buffer_ = new RefCountedObject<Buffer>(
-        buffer_->data(),
-        std::min(buffer_->size(), size),
-        std::max(buffer_->capacity(), size));
+  // Truncating doesn't change the shared data.
+  if (size > size_) {
+    UnshareAndEnsureCapacity(size, true);
   }
-  buffer_->SetSize(size);
+  size_ = size;
   RTC_DCHECK(IsConsistent());
 }
 
@@ -72,16 +195,15 @@ void CopyOnWriteBuffer::EnsureCapacity(size_t capacity) {
   RTC_DCHECK(IsConsistent());
   if (!buffer_) {
     if (capacity > 0) {
-      buffer_ = new RefCountedObject<Buffer>(0, capacity);
+      Allocate(capacity);
     }
     RTC_DCHECK(IsConsistent());
     return;
-  } else if (capacity <= buffer_->capacity()) {
+  } else if (capacity <= capacity_) {
     return;
   }
 
-  CloneDataIfReferenced(std::max(buffer_->capacity(), capacity));
-  buffer_->EnsureCapacity(capacity);
+  UnshareAndEnsureCapacity(capacity, false);
   RTC_DCHECK(IsConsistent());
 }
 
@@ -89,24 +211,52 @@ void CopyOnWriteBuffer::Clear() {
   if (!buffer_)
     return;
 
-  if (buffer_->HasOneRef()) {
-    buffer_->Clear();
-  } else {
-    buffer_ = new RefCountedObject<Buffer>(0, buffer_->capacity());
+  if (!buffer_->HasOneRef()) {
+    const size_t capacity = capacity_;
+    Allocate(capacity);
   }
+  size_ = 0;
   RTC_DCHECK(IsConsistent());
 }
 
-void CopyOnWriteBuffer::CloneDataIfReferenced(size_t new_capacity) {
-  if (buffer_->HasOneRef()) {
+CopyOnWriteBuffer::PoolStats CopyOnWriteBuffer::GetPoolStats() {
+  return BufferPool::Instance()->stats();
+}
+
+void CopyOnWriteBuffer::Allocate(size_t capacity) {
+  RTC_DCHECK_GT(capacity, 0u);
+  if (capacity <= kMaxPooledCapacity) {
+    buffer_ = BufferPool::Instance()->Get(capacity);
+  } else {
+    buffer_ = new RefCountedObject<Buffer>(capacity);
+  }
+  offset_ = 0;
+  capacity_ = capacity;
+}
+
+void CopyOnWriteBuffer::UnshareAndEnsureCapacity(size_t capacity,
+                                                 bool extra_headroom) {
+  const bool shared = !buffer_->HasOneRef();
+  if (!shared && capacity <= capacity_) {
     return;
   }
 
-  buffer_ = new RefCountedObject<Buffer>(buffer_->data(), buffer_->size(),
-      new_capacity);
+  size_t new_capacity = std::max(capacity_, capacity);
+  if (!shared && extra_headroom) {
+    // Grows like rtc::Buffer.
+    new_capacity = std::max(capacity, capacity_ + capacity_ / 2);
+  }
+  if (!shared && offset_ + new_capacity <= buffer_->capacity()) {
+    // The storage has room to grow in place.
+    capacity_ = new_capacity;
+    return;
+  }
+
+  scoped_refptr<RefCountedObject<Buffer>> old_buffer = std::move(buffer_);
+  const size_t old_offset = offset_;
+  Allocate(new_capacity);
+  std::memcpy(buffer_->data(), old_buffer->data() + old_offset, size_);
   RTC_DCHECK(IsConsistent());
 }
 
-
-
 }  // namespace rtc
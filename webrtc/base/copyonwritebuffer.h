@@ -80,8 +80,8 @@ class CopyOnWriteBuffer {
     if (!buffer_) {
       return nullptr;
     }
-    CloneDataIfReferenced(buffer_->capacity());
-    return buffer_->data<T>();
+    UnshareAndEnsureCapacity(capacity_, false);
+    return buffer_->data<T>() + offset_;
   }
 
   // Get const pointer to the data. This will not create a copy of the
@@ -94,17 +94,17 @@ class CopyOnWriteBuffer {
     if (!buffer_) {
       return nullptr;
     }
-    return buffer_->data<T>();
+    return buffer_->data<T>() + offset_;
   }
 
   size_t size() const {
     RTC_DCHECK(IsConsistent());
-    return buffer_ ? buffer_->size() : 0;
+    return size_;
   }
 
   size_t capacity() const {
     RTC_DCHECK(IsConsistent());
-    return buffer_ ? buffer_->capacity() : 0;
+    return capacity_;
   }
 
   CopyOnWriteBuffer& operator=(const CopyOnWriteBuffer& buf) {
@@ -112,6 +112,9 @@ class CopyOnWriteBuffer {
     RTC_DCHECK(buf.IsConsistent());
     if (&buf != this) {
       buffer_ = buf.buffer_;
+      offset_ = buf.offset_;
+      size_ = buf.size_;
+      capacity_ = buf.capacity_;
     }
     return *this;
   }
@@ -120,6 +123,12 @@ class CopyOnWriteBuffer {
     RTC_DCHECK(IsConsistent());
     RTC_DCHECK(buf.IsConsistent());
     buffer_ = std::move(buf.buffer_);
+    offset_ = buf.offset_;
+    size_ = buf.size_;
+    capacity_ = buf.capacity_;
+    buf.offset_ = 0;
+    buf.size_ = 0;
+    buf.capacity_ = 0;
     return *this;
   }
 
@@ -147,12 +156,18 @@ class CopyOnWriteBuffer {
   void SetData(const T* data, size_t size) {
     RTC_DCHECK(IsConsistent());
     if (!buffer_) {
-      buffer_ = size > 0 ? new RefCountedObject<Buffer>(data, size) : nullptr;
-    } else if (!buffer_->HasOneRef()) {
-      buffer_ = new RefCountedObject<Buffer>(data, size, buffer_->capacity());
+      if (size > 0) {
+        Allocate(size);
+      }
     } else {
-      buffer_->SetData(data, size);
+      // The old contents aren't kept, so they are not copied.
+      size_ = 0;
+      UnshareAndEnsureCapacity(size, true);
     }
+    if (size > 0) {
+      std::memcpy(buffer_->data() + offset_, data, size);
+    }
+    size_ = size;
     RTC_DCHECK(IsConsistent());
   }
 
@@ -165,11 +180,7 @@ class CopyOnWriteBuffer {
   }
 
   void SetData(const CopyOnWriteBuffer& buf) {
-    RTC_DCHECK(IsConsistent());
-    RTC_DCHECK(buf.IsConsistent());
-    if (&buf != this) {
-      buffer_ = buf.buffer_;
-    }
+    *this = buf;
   }
 
   // Append data to the buffer. Accepts the same types as the constructors.
@@ -178,15 +189,16 @@ class CopyOnWriteBuffer {
                 internal::BufferCompat<uint8_t, T>::value>::type* = nullptr>
   void AppendData(const T* data, size_t size) {
     RTC_DCHECK(IsConsistent());
-    if (!buffer_) {
-      buffer_ = new RefCountedObject<Buffer>(data, size);
-      RTC_DCHECK(IsConsistent());
+    if (size == 0) {
       return;
     }
-
-    CloneDataIfReferenced(std::max(buffer_->capacity(),
-        buffer_->size() + size));
-    buffer_->AppendData(data, size);
+    if (!buffer_) {
+      Allocate(size);
+    } else {
+      UnshareAndEnsureCapacity(size_ + size, true);
+    }
+    std::memcpy(buffer_->data() + offset_ + size_, data, size);
+    size_ += size;
     RTC_DCHECK(IsConsistent());
   }
 
@@ -202,6 +214,10 @@ class CopyOnWriteBuffer {
     AppendData(buf.data(), buf.size());
   }
 
+  // Returns a buffer of |length| bytes starting at |offset| in this one. The
+  // data is shared until either buffer is written to.
+  CopyOnWriteBuffer Slice(size_t offset, size_t length) const;
+
   // Sets the size of the buffer. If the new size is smaller than the old, the
   // buffer contents will be kept but truncated; if the new size is greater,
   // the existing contents will be kept and the new space will be
@@ -220,20 +236,48 @@ class CopyOnWriteBuffer {
   // Swaps two buffers.
   friend void swap(CopyOnWriteBuffer& a, CopyOnWriteBuffer& b) {
     std::swap(a.buffer_, b.buffer_);
+    std::swap(a.offset_, b.offset_);
+    std::swap(a.size_, b.size_);
+    std::swap(a.capacity_, b.capacity_);
   }
 
+  // Counters of the pool which the storage of packet-sized buffers is taken
+  // from. Storage of up to 2048 bytes is rounded up to a power of two, and
+  // reused once no buffer refers to it.
+  struct PoolStats {
+    // Allocations which reused free storage.
+    int hits = 0;
+    // Allocations for which the pool had no free storage.
+    int misses = 0;
+  };
+  static PoolStats GetPoolStats();
+
  private:
-  // Create a copy of the underlying data if it is referenced from other Buffer
-  // objects.
-  void CloneDataIfReferenced(size_t new_capacity);
+  // Allocates unshared storage of at least |capacity| > 0 bytes.
+  void Allocate(size_t capacity);
+
+  // Create a copy of the underlying data if it is referenced from other
+  // CopyOnWriteBuffer objects, or if its capacity is less than |capacity|.
+  // With |extra_headroom|, growing the capacity leaves room for more.
+  void UnshareAndEnsureCapacity(size_t capacity, bool extra_headroom);
 
   // Pre- and postcondition of all methods.
   bool IsConsistent() const {
-    return (!buffer_ || buffer_->capacity() > 0);
+    if (!buffer_) {
+      return offset_ == 0 && size_ == 0 && capacity_ == 0;
+    }
+    return capacity_ > 0 && size_ <= capacity_ &&
+           offset_ + capacity_ <= buffer_->capacity();
   }
 
-  // buffer_ is either null, or points to an rtc::Buffer with capacity > 0.
+  // buffer_ is either null, or points to an rtc::Buffer of which this buffer
+  // uses the |capacity_| > 0 bytes at |offset_|. The storage may be shared
+  // with other CopyOnWriteBuffers, and may be larger than |capacity_| if it
+  // comes from the pool.
   scoped_refptr<RefCountedObject<Buffer>> buffer_;
+  size_t offset_ = 0;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
 };
 
 }  // namespace rtc
@@ -316,4 +316,103 @@ TEST(CopyOnWriteBufferTest, TestBacketWrite) {
   EXPECT_EQ(0, memcmp(buf2.cdata(), kTestData, 3));
 }
 
+TEST(CopyOnWriteBufferTest, SliceSharesData) {
+  CopyOnWriteBuffer buf(kTestData, 10, 16);
+  CopyOnWriteBuffer slice = buf.Slice(3, 5);
+
+  EXPECT_EQ(5u, slice.size());
+  EXPECT_EQ(13u, slice.capacity());
+  EXPECT_EQ(buf.cdata() + 3, slice.cdata());
+  EXPECT_EQ(CopyOnWriteBuffer(kTestData + 3, 5), slice);
+
+  // A slice of a slice is still shared.
+  CopyOnWriteBuffer inner = slice.Slice(1, 2);
+  EXPECT_EQ(buf.cdata() + 4, inner.cdata());
+  EXPECT_EQ(CopyOnWriteBuffer(kTestData + 4, 2), inner);
+
+  // Empty slices are empty buffers.
+  EXPECT_EQ(0u, buf.Slice(10, 0).size());
+  EXPECT_EQ(0u, buf.Slice(0, 0).size());
+}
+
+TEST(CopyOnWriteBufferTest, WritingToSliceDoesntChangeOriginal) {
+  CopyOnWriteBuffer buf(kTestData, 10, 16);
+  const uint8_t* const original_allocation = buf.cdata();
+  CopyOnWriteBuffer slice = buf.Slice(3, 5);
+
+  slice[0] = 0xff;
+
+  EXPECT_EQ(original_allocation, buf.cdata());
+  EXPECT_EQ(CopyOnWriteBuffer(kTestData, 10), buf);
+  EXPECT_EQ(5u, slice.size());
+  EXPECT_EQ(13u, slice.capacity());
+  EXPECT_EQ(0xff, slice.cdata()[0]);
+  EXPECT_EQ(0, memcmp(slice.cdata() + 1, kTestData + 4, 4));
+}
+
+TEST(CopyOnWriteBufferTest, AppendDataToSliceDoesntChangeOriginal) {
+  CopyOnWriteBuffer buf(kTestData, 10, 16);
+  CopyOnWriteBuffer slice = buf.Slice(3, 2);
+
+  slice.AppendData("ab", 2);
+
+  EXPECT_EQ(CopyOnWriteBuffer(kTestData, 10), buf);
+  const uint8_t exp[] = {0x3, 0x4, 'a', 'b'};
+  EXPECT_EQ(CopyOnWriteBuffer(exp), slice);
+}
+
+TEST(CopyOnWriteBufferTest, UnsharedSliceIsWrittenInPlace) {
+  CopyOnWriteBuffer buf(kTestData, 10, 16);
+  const uint8_t* const original_allocation = buf.cdata();
+  buf = buf.Slice(2, 8);
+
+  buf[0] = 0xff;
+  buf.AppendData(kTestData, 6);
+
+  EXPECT_EQ(original_allocation + 2, buf.cdata());
+  EXPECT_EQ(14u, buf.size());
+  EXPECT_EQ(14u, buf.capacity());
+}
+
+TEST(CopyOnWriteBufferTest, SetSizeTruncatesWithoutCopying) {
+  CopyOnWriteBuffer buf1(kTestData, 10, 16);
+  CopyOnWriteBuffer buf2(buf1);
+
+  buf2.SetSize(4);
+
+  EXPECT_EQ(4u, buf2.size());
+  EXPECT_EQ(16u, buf2.capacity());
+  EXPECT_EQ(buf1.cdata(), buf2.cdata());
+  EXPECT_EQ(10u, buf1.size());
+}
+
+TEST(CopyOnWriteBufferTest, ReusesPacketSizedStorage) {
+  // The pool is shared with everything else in the process, so only check
+  // that exactly one request went through it.
+  CopyOnWriteBuffer::PoolStats stats = CopyOnWriteBuffer::GetPoolStats();
+  CopyOnWriteBuffer buf(kTestData, 10, 1500);
+  CopyOnWriteBuffer::PoolStats next_stats = CopyOnWriteBuffer::GetPoolStats();
+
+  // The requested capacity is kept, even though the storage is larger.
+  EXPECT_EQ(1500u, buf.capacity());
+  EXPECT_EQ(stats.hits + stats.misses + 1,
+            next_stats.hits + next_stats.misses);
+
+  // Growing within the storage doesn't reallocate.
+  const uint8_t* const original_allocation = buf.cdata();
+  buf.EnsureCapacity(2000);
+  EXPECT_EQ(2000u, buf.capacity());
+  EXPECT_EQ(original_allocation, buf.cdata());
+}
+
+TEST(CopyOnWriteBufferTest, DoesntPoolLargeStorage) {
+  CopyOnWriteBuffer::PoolStats stats = CopyOnWriteBuffer::GetPoolStats();
+  CopyOnWriteBuffer buf(4096);
+  CopyOnWriteBuffer::PoolStats next_stats = CopyOnWriteBuffer::GetPoolStats();
+
+  EXPECT_EQ(4096u, buf.capacity());
+  EXPECT_EQ(stats.hits, next_stats.hits);
+  EXPECT_EQ(stats.misses, next_stats.misses);
+}
+
 }  // namespace rtc
@@ -278,6 +278,82 @@ static long stream_ctrl(BIO* b, int cmd, long num, void* ptr) {
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// OpenSSLSessionCache
+/////////////////////////////////////////////////////////////////////////////
+
+OpenSSLSessionCache::OpenSSLSessionCache(size_t max_sessions)
+    : max_sessions_(max_sessions) {
+  RTC_CHECK(RAND_bytes(ticket_keys_, sizeof(ticket_keys_)) > 0);
+}
+
+OpenSSLSessionCache::~OpenSSLSessionCache() {
+  Clear();
+}
+
+size_t OpenSSLSessionCache::size() const {
+  CritScope cs(&crit_);
+  return sessions_.size();
+}
+
+void OpenSSLSessionCache::Clear() {
+  CritScope cs(&crit_);
+  for (const auto& entry : sessions_)
+    SSL_SESSION_free(entry.second);
+  sessions_.clear();
+  peers_.clear();
+}
+
+bool OpenSSLSessionCache::ConfigureContext(SSL_CTX* ctx) const {
+  // The keys are only read, but OpenSSL doesn't take them as const.
+  return SSL_CTX_set_tlsext_ticket_keys(
+             ctx, const_cast<unsigned char*>(ticket_keys_),
+             sizeof(ticket_keys_)) == 1;
+}
+
+SSL_SESSION* OpenSSLSessionCache::Lookup(const std::string& peer_id) {
+  CritScope cs(&crit_);
+  auto it = sessions_.find(peer_id);
+  if (it == sessions_.end())
+    return nullptr;
+  // SSL_set_session takes its own reference, so the caller releases this one.
+  SSL_SESSION* session = it->second;
+#if defined(OPENSSL_IS_BORINGSSL)
+  SSL_SESSION_up_ref(session);
+#else
+  CRYPTO_add(&session->references, 1, CRYPTO_LOCK_SSL_SESSION);
+#endif
+  return session;
+}
+
+void OpenSSLSessionCache::Store(const std::string& peer_id,
+                                SSL_SESSION* session) {
+  CritScope cs(&crit_);
+  RemoveLocked(peer_id);
+  if (max_sessions_ == 0) {
+    SSL_SESSION_free(session);
+    return;
+  }
+  while (sessions_.size() >= max_sessions_)
+    RemoveLocked(peers_.front());
+  sessions_[peer_id] = session;
+  peers_.push_back(peer_id);
+}
+
+void OpenSSLSessionCache::Remove(const std::string& peer_id) {
+  CritScope cs(&crit_);
+  RemoveLocked(peer_id);
+}
+
+void OpenSSLSessionCache::RemoveLocked(const std::string& peer_id) {
+  auto it = sessions_.find(peer_id);
+  if (it == sessions_.end())
+    return;
+  SSL_SESSION_free(it->second);
+  sessions_.erase(it);
+  peers_.erase(std::find(peers_.begin(), peers_.end(), peer_id));
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // OpenSSLStreamAdapter
 /////////////////////////////////////////////////////////////////////////////
@@ -491,6 +567,17 @@ bool OpenSSLStreamAdapter::GetDtlsSrtpCryptoSuite(int* crypto_suite) {
   return true;
 }
 
+void OpenSSLStreamAdapter::SetSessionCache(SSLSessionCache* cache,
+                                           const std::string& peer_id) {
+  RTC_DCHECK(state_ == SSL_NONE);
+  session_cache_ = static_cast<OpenSSLSessionCache*>(cache);
+  session_peer_id_ = peer_id;
+}
+
+bool OpenSSLStreamAdapter::IsSessionResumed() const {
+  return session_resumed_;
+}
+
 bool OpenSSLStreamAdapter::IsTlsConnected() {
   return state_ == SSL_CONNECTED;
 }
@@ -805,6 +892,15 @@ int OpenSSLStreamAdapter::BeginSSL() {
 
   SSL_set_app_data(ssl_, this);
 
+  if (session_cache_ && role_ == SSL_CLIENT && !session_peer_id_.empty()) {
+    SSL_SESSION* session = session_cache_->Lookup(session_peer_id_);
+    if (session) {
+      LOG(LS_INFO) << "Offering cached SSL session.";
+      SSL_set_session(ssl_, session);
+      SSL_SESSION_free(session);
+    }
+  }
+
   SSL_set_bio(ssl_, bio, bio);  // the SSL object owns the bio now.
   if (ssl_mode_ == SSL_MODE_DTLS) {
 #ifdef OPENSSL_IS_BORINGSSL
@@ -848,6 +944,8 @@ int OpenSSLStreamAdapter::ContinueSSL() {
   switch (ssl_error = SSL_get_error(ssl_, code)) {
     case SSL_ERROR_NONE:
       LOG(LS_VERBOSE) << " -- success";
+      if (!OnHandshakeDone())
+        return -1;
       // By this point, OpenSSL should have given us a certificate, or errored
       // out if one was missing.
       RTC_DCHECK(peer_certificate_ || !client_auth_enabled());
@@ -1090,6 +1188,27 @@ SSL_CTX* OpenSSLStreamAdapter::SetupSSLContext() {
     }
   }
 
+  if (session_cache_) {
+    // A server only resumes sessions it issued with the same certificate,
+    // which its digest identifies. The session ID context is also required
+    // to resume sessions when the peer's certificate is verified.
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    size_t digest_length = 0;
+    if (identity_ &&
+        !OpenSSLCertificate::ComputeDigest(identity_->certificate().x509(),
+                                           DIGEST_SHA_256, digest,
+                                           sizeof(digest), &digest_length)) {
+      SSL_CTX_free(ctx);
+      return NULL;
+    }
+    if (!session_cache_->ConfigureContext(ctx) ||
+        !SSL_CTX_set_session_id_context(
+            ctx, digest, static_cast<unsigned int>(digest_length))) {
+      SSL_CTX_free(ctx);
+      return NULL;
+    }
+  }
+
   return ctx;
 }
 
@@ -1121,6 +1240,35 @@ bool OpenSSLStreamAdapter::VerifyPeerCertificate() {
   return true;
 }
 
+bool OpenSSLStreamAdapter::OnHandshakeDone() {
+  if (!session_cache_)
+    return true;
+
+  session_resumed_ = SSL_session_reused(ssl_) != 0;
+  if (session_resumed_) {
+    // The peer didn't send its certificate, so SSLVerifyCallback wasn't
+    // called; the certificate is the one of the resumed session.
+    LOG(LS_INFO) << "Resumed cached SSL session.";
+    X509* cert = SSL_get_peer_certificate(ssl_);
+    if (cert) {
+      peer_certificate_.reset(new OpenSSLCertificate(cert));
+      X509_free(cert);
+    }
+    if (has_peer_certificate_digest() && !VerifyPeerCertificate()) {
+      if (!session_peer_id_.empty())
+        session_cache_->Remove(session_peer_id_);
+      return false;
+    }
+  }
+
+  if (role_ == SSL_CLIENT && !session_peer_id_.empty()) {
+    SSL_SESSION* session = SSL_get1_session(ssl_);
+    if (session)
+      session_cache_->Store(session_peer_id_, session);
+  }
+  return true;
+}
+
 int OpenSSLStreamAdapter::SSLVerifyCallback(int ok, X509_STORE_CTX* store) {
   // Get our SSL structure from the store
   SSL* ssl = reinterpret_cast<SSL*>(
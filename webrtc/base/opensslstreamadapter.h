@@ -11,16 +11,21 @@
 #ifndef WEBRTC_BASE_OPENSSLSTREAMADAPTER_H__
 #define WEBRTC_BASE_OPENSSLSTREAMADAPTER_H__
 
+#include <deque>
+#include <map>
 #include <string>
 #include <memory>
 #include <vector>
 
 #include "webrtc/base/buffer.h"
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/criticalsection.h"
 #include "webrtc/base/sslstreamadapter.h"
 #include "webrtc/base/opensslidentity.h"
 
 typedef struct ssl_st SSL;
 typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_session_st SSL_SESSION;
 typedef struct ssl_cipher_st SSL_CIPHER;
 typedef struct x509_store_ctx_st X509_STORE_CTX;
 
@@ -54,6 +59,44 @@ class OpenSSLIdentity;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Session tickets are encrypted with keys generated when the cache is created,
+// so any server using the same cache accepts the tickets of the others.
+// Clients keep one session per peer, holding a reference to its SSL_SESSION.
+class OpenSSLSessionCache : public SSLSessionCache {
+ public:
+  explicit OpenSSLSessionCache(size_t max_sessions);
+  ~OpenSSLSessionCache() override;
+
+  size_t size() const override;
+  void Clear() override;
+
+  // Makes |ctx| issue and accept session tickets encrypted with our keys.
+  bool ConfigureContext(SSL_CTX* ctx) const;
+
+  // Returns a new reference to the session of |peer_id|, or null.
+  SSL_SESSION* Lookup(const std::string& peer_id);
+  // Stores |session| for |peer_id|, taking ownership of the reference.
+  void Store(const std::string& peer_id, SSL_SESSION* session);
+  void Remove(const std::string& peer_id);
+
+ private:
+  void RemoveLocked(const std::string& peer_id)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  const size_t max_sessions_;
+  // Name, HMAC secret and AES key of the tickets, as expected by
+  // SSL_CTX_set_tlsext_ticket_keys.
+  unsigned char ticket_keys_[48];
+
+  CriticalSection crit_;
+  std::map<std::string, SSL_SESSION*> sessions_ GUARDED_BY(crit_);
+  // Peers in the order their sessions were stored, oldest first.
+  std::deque<std::string> peers_ GUARDED_BY(crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(OpenSSLSessionCache);
+};
+
+
 class OpenSSLStreamAdapter : public SSLStreamAdapter {
  public:
   explicit OpenSSLStreamAdapter(StreamInterface* stream);
@@ -108,6 +151,10 @@ class OpenSSLStreamAdapter : public SSLStreamAdapter {
   bool SetDtlsSrtpCryptoSuites(const std::vector<int>& crypto_suites) override;
   bool GetDtlsSrtpCryptoSuite(int* crypto_suite) override;
 
+  void SetSessionCache(SSLSessionCache* cache,
+                       const std::string& peer_id) override;
+  bool IsSessionResumed() const override;
+
   bool IsTlsConnected() override;
 
   // Capabilities interfaces.
@@ -169,6 +216,10 @@ class OpenSSLStreamAdapter : public SSLStreamAdapter {
   SSL_CTX* SetupSSLContext();
   // Verify the peer certificate matches the signaled digest.
   bool VerifyPeerCertificate();
+  // Called once the handshake succeeded to take the peer certificate from a
+  // resumed session and to cache a new one. Returns false if the resumed
+  // session belongs to another peer.
+  bool OnHandshakeDone();
   // SSL certification verification error handler, called back from
   // the openssl library. Returns an int interpreted as a boolean in
   // the C style: zero means verification failure, non-zero means
@@ -214,6 +265,11 @@ class OpenSSLStreamAdapter : public SSLStreamAdapter {
   // Max. allowed protocol version
   SSLProtocolVersion ssl_max_version_;
 
+  // Sessions to resume, if any, and the peer they are cached for.
+  OpenSSLSessionCache* session_cache_ = nullptr;
+  std::string session_peer_id_;
+  bool session_resumed_ = false;
+
   // A 50-ms initial timeout ensures rapid setup on fast connections, but may
   // be too aggressive for low bandwidth links.
   int dtls_handshake_timeout_ms_ = 50;
@@ -15,6 +15,7 @@
 
 #include "webrtc/base/checks.h"
 #include "webrtc/base/sslidentity.h"
+#include "webrtc/base/timeutils.h"
 
 namespace rtc {
 
@@ -25,6 +26,10 @@ const char kIdentityName[] = "WebRTC";
 
 uint64_t kYearInSeconds = 365 * 24 * 60 * 60;
 
+// Pooled certificates that expire sooner than this are discarded rather than
+// handed out.
+const uint64_t kMinPooledLifetimeMs = 24 * 60 * 60 * 1000;
+
 enum {
   MSG_GENERATE,
   MSG_GENERATE_DONE,
@@ -54,6 +59,11 @@ class RTCCertificateGenerationTask : public RefCountInterface,
   }
   ~RTCCertificateGenerationTask() override {}
 
+  // Skips |MSG_GENERATE|, for when the certificate was taken from a pool.
+  void set_certificate(const scoped_refptr<RTCCertificate>& certificate) {
+    certificate_ = certificate;
+  }
+
   // Handles |MSG_GENERATE| and its follow-up |MSG_GENERATE_DONE|.
   void OnMessage(Message* msg) override {
     switch (msg->message_id) {
@@ -98,8 +108,136 @@ class RTCCertificateGenerationTask : public RefCountInterface,
   scoped_refptr<RTCCertificate> certificate_;
 };
 
+bool KeyParamsEqual(const KeyParams& a, const KeyParams& b) {
+  if (a.type() != b.type())
+    return false;
+  if (a.type() == KT_RSA) {
+    return a.rsa_params().mod_size == b.rsa_params().mod_size &&
+           a.rsa_params().pub_exp == b.rsa_params().pub_exp;
+  }
+  return a.ec_curve() == b.ec_curve();
+}
+
 }  // namespace
 
+RTCCertificatePool::RTCCertificatePool(Thread* worker_thread)
+    : worker_thread_(worker_thread) {
+  RTC_DCHECK(worker_thread_);
+}
+
+RTCCertificatePool::~RTCCertificatePool() {}
+
+void RTCCertificatePool::SetPoolSize(const KeyParams& key_params,
+                                     size_t size) {
+  RTC_DCHECK(key_params.IsValid());
+  CritScope cs(&crit_);
+  Pool* pool = FindPool(key_params, true);
+  pool->target_size = size;
+  RefillPool(pool - pools_.data());
+}
+
+scoped_refptr<RTCCertificate> RTCCertificatePool::Take(
+    const KeyParams& key_params) {
+  uint64_t now_ms = TimeUTCMicros() / kNumMicrosecsPerMillisec;
+  CritScope cs(&crit_);
+  Pool* pool = FindPool(key_params, false);
+  if (!pool) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  scoped_refptr<RTCCertificate> certificate;
+  while (!certificate && !pool->certificates.empty()) {
+    certificate = pool->certificates.front();
+    pool->certificates.pop_front();
+    if (certificate->HasExpired(now_ms + kMinPooledLifetimeMs))
+      certificate = nullptr;
+  }
+  if (certificate) {
+    ++stats_.hits;
+  } else {
+    ++stats_.misses;
+  }
+  RefillPool(pool - pools_.data());
+  return certificate;
+}
+
+size_t RTCCertificatePool::size(const KeyParams& key_params) const {
+  CritScope cs(&crit_);
+  const Pool* pool = FindPool(key_params);
+  return pool ? pool->certificates.size() : 0;
+}
+
+RTCCertificatePool::Stats RTCCertificatePool::GetStats() const {
+  CritScope cs(&crit_);
+  return stats_;
+}
+
+RTCCertificatePool::Pool* RTCCertificatePool::FindPool(
+    const KeyParams& key_params,
+    bool create) {
+  for (Pool& pool : pools_) {
+    if (KeyParamsEqual(pool.key_params, key_params))
+      return &pool;
+  }
+  if (!create)
+    return nullptr;
+  pools_.push_back(Pool(key_params));
+  return &pools_.back();
+}
+
+const RTCCertificatePool::Pool* RTCCertificatePool::FindPool(
+    const KeyParams& key_params) const {
+  for (const Pool& pool : pools_) {
+    if (KeyParamsEqual(pool.key_params, key_params))
+      return &pool;
+  }
+  return nullptr;
+}
+
+void RTCCertificatePool::RefillPool(size_t index) {
+  Pool& pool = pools_[index];
+  while (pool.certificates.size() + pool.pending < pool.target_size) {
+    ++pool.pending;
+    // The message data references |this|, keeping the pool alive until the
+    // generation has completed.
+    worker_thread_->Post(RTC_FROM_HERE, this, static_cast<uint32_t>(index),
+                         new ScopedRefMessageData<RTCCertificatePool>(this));
+  }
+}
+
+void RTCCertificatePool::OnMessage(Message* msg) {
+  RTC_DCHECK(worker_thread_->IsCurrent());
+  size_t index = msg->message_id;
+  KeyParams key_params;
+  {
+    CritScope cs(&crit_);
+    key_params = pools_[index].key_params;
+  }
+  int64_t start_us = TimeMicros();
+  scoped_refptr<RTCCertificate> certificate =
+      RTCCertificateGenerator::GenerateCertificate(key_params,
+                                                   Optional<uint64_t>());
+  int64_t elapsed_us = TimeMicros() - start_us;
+  {
+    CritScope cs(&crit_);
+    Pool& pool = pools_[index];
+    --pool.pending;
+    if (certificate) {
+      ++stats_.generated;
+      stats_.total_generation_time_us += elapsed_us;
+      stats_.max_generation_time_us =
+          std::max(stats_.max_generation_time_us, elapsed_us);
+      if (pool.certificates.size() < pool.target_size)
+        pool.certificates.push_back(certificate);
+    } else {
+      // Don't retry, generation would most likely keep failing.
+      ++stats_.failed;
+    }
+  }
+  // May delete |this|, do not touch member variables after this line.
+  delete msg->pdata;
+}
+
 // static
 scoped_refptr<RTCCertificate>
 RTCCertificateGenerator::GenerateCertificate(
@@ -132,8 +270,15 @@ RTCCertificateGenerator::GenerateCertificate(
 
 RTCCertificateGenerator::RTCCertificateGenerator(
     Thread* signaling_thread, Thread* worker_thread)
+    : RTCCertificateGenerator(signaling_thread, worker_thread, nullptr) {}
+
+RTCCertificateGenerator::RTCCertificateGenerator(
+    Thread* signaling_thread,
+    Thread* worker_thread,
+    const scoped_refptr<RTCCertificatePool>& pool)
     : signaling_thread_(signaling_thread),
-      worker_thread_(worker_thread) {
+      worker_thread_(worker_thread),
+      pool_(pool) {
   RTC_DCHECK(signaling_thread_);
   RTC_DCHECK(worker_thread_);
 }
@@ -153,6 +298,16 @@ void RTCCertificateGenerator::GenerateCertificateAsync(
           new RefCountedObject<RTCCertificateGenerationTask>(
               signaling_thread_, worker_thread_, key_params, expires_ms,
               callback));
+  scoped_refptr<RTCCertificate> pooled_certificate;
+  if (pool_ && !expires_ms)
+    pooled_certificate = pool_->Take(key_params);
+  if (pooled_certificate) {
+    // The callback is still invoked asynchronously, as callers expect.
+    msg_data->data()->set_certificate(pooled_certificate);
+    signaling_thread_->Post(RTC_FROM_HERE, msg_data->data().get(),
+                            MSG_GENERATE_DONE, msg_data);
+    return;
+  }
   worker_thread_->Post(RTC_FROM_HERE, msg_data->data().get(), MSG_GENERATE,
                        msg_data);
 }
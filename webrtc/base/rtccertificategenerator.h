@@ -11,6 +11,10 @@
 #ifndef WEBRTC_BASE_RTCCERTIFICATEGENERATOR_H_
 #define WEBRTC_BASE_RTCCERTIFICATEGENERATOR_H_
 
+#include <deque>
+#include <vector>
+
+#include "webrtc/base/criticalsection.h"
 #include "webrtc/base/optional.h"
 #include "webrtc/base/refcount.h"
 #include "webrtc/base/rtccertificate.h"
@@ -48,10 +52,83 @@ class RTCCertificateGeneratorInterface {
       const scoped_refptr<RTCCertificateGeneratorCallback>& callback) = 0;
 };
 
+// Keeps a number of pre-generated certificates per |KeyParams| so that they
+// can be handed out without waiting for key generation, which can take
+// hundreds of milliseconds for RSA keys. Certificates are generated on the
+// worker thread and the pool is refilled as certificates are taken from it.
+// Pooled certificates have the default expiration time. The methods are
+// thread safe. The worker thread must outlive the pool.
+class RTCCertificatePool : public RefCountInterface, public MessageHandler {
+ public:
+  struct Stats {
+    // Number of |Take| calls that returned a pooled certificate.
+    int hits = 0;
+    // Number of |Take| calls that found the pool empty.
+    int misses = 0;
+    // Number of certificates generated and failed generations.
+    int generated = 0;
+    int failed = 0;
+    // Time spent generating the pooled certificates.
+    int64_t total_generation_time_us = 0;
+    int64_t max_generation_time_us = 0;
+  };
+
+  explicit RTCCertificatePool(Thread* worker_thread);
+
+  // Sets how many certificates with |key_params| are kept ready. Generation of
+  // the missing ones starts right away. Setting a size of 0 stops refilling,
+  // but certificates already in the pool can still be taken.
+  void SetPoolSize(const KeyParams& key_params, size_t size);
+
+  // Returns a pooled certificate for |key_params| and triggers a refill, or
+  // returns null if none is available.
+  scoped_refptr<RTCCertificate> Take(const KeyParams& key_params);
+
+  // The number of certificates with |key_params| currently in the pool.
+  size_t size(const KeyParams& key_params) const;
+
+  Stats GetStats() const;
+
+ protected:
+  ~RTCCertificatePool() override;
+
+ private:
+  struct Pool {
+    explicit Pool(const KeyParams& key_params) : key_params(key_params) {}
+
+    KeyParams key_params;
+    size_t target_size = 0;
+    // Number of generation tasks posted to the worker thread.
+    size_t pending = 0;
+    std::deque<scoped_refptr<RTCCertificate>> certificates;
+  };
+
+  // Returns null if there is no pool for |key_params| and |create| is false.
+  Pool* FindPool(const KeyParams& key_params, bool create)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  const Pool* FindPool(const KeyParams& key_params) const
+      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Posts a generation task for each certificate missing from the pool at
+  // |index|.
+  void RefillPool(size_t index) EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Generates a certificate for the pool whose index is the message id.
+  void OnMessage(Message* msg) override;
+
+  Thread* const worker_thread_;
+  rtc::CriticalSection crit_;
+  // Pools are never removed, so that the index of a pool can identify it in
+  // messages posted to the worker thread.
+  std::vector<Pool> pools_ GUARDED_BY(crit_);
+  Stats stats_ GUARDED_BY(crit_);
+};
+
 // Standard implementation of |RTCCertificateGeneratorInterface|.
 // The static function |GenerateCertificate| generates a certificate on the
 // current thread. The |RTCCertificateGenerator| instance generates certificates
-// asynchronously on the worker thread with |GenerateCertificateAsync|.
+// asynchronously on the worker thread with |GenerateCertificateAsync|, or
+// takes them from a |RTCCertificatePool| if one is given and has a matching
+// certificate.
 class RTCCertificateGenerator : public RTCCertificateGeneratorInterface {
  public:
   // Generates a certificate on the current thread. Returns null on failure.
@@ -64,6 +141,10 @@ class RTCCertificateGenerator : public RTCCertificateGeneratorInterface {
       const Optional<uint64_t>& expires_ms);
 
   RTCCertificateGenerator(Thread* signaling_thread, Thread* worker_thread);
+  // Requests without |expires_ms| are served from |pool| when possible.
+  RTCCertificateGenerator(Thread* signaling_thread,
+                          Thread* worker_thread,
+                          const scoped_refptr<RTCCertificatePool>& pool);
   ~RTCCertificateGenerator() override {}
 
   // |RTCCertificateGeneratorInterface| overrides.
@@ -79,6 +160,7 @@ class RTCCertificateGenerator : public RTCCertificateGeneratorInterface {
  private:
   Thread* const signaling_thread_;
   Thread* const worker_thread_;
+  const scoped_refptr<RTCCertificatePool> pool_;
 };
 
 }  // namespace rtc
@@ -149,4 +149,61 @@ TEST_F(RTCCertificateGeneratorTest, GenerateWithInvalidParamsShouldFail) {
   EXPECT_FALSE(fixture_->certificate());
 }
 
+TEST_F(RTCCertificateGeneratorTest, PoolIsRefilledWhenTaken) {
+  std::unique_ptr<Thread> pool_thread(new Thread());
+  ASSERT_TRUE(pool_thread->Start());
+  scoped_refptr<RTCCertificatePool> pool(
+      new RefCountedObject<RTCCertificatePool>(pool_thread.get()));
+
+  // Nothing is pooled until a size is set.
+  EXPECT_FALSE(pool->Take(KeyParams::ECDSA()));
+  EXPECT_EQ(1, pool->GetStats().misses);
+
+  pool->SetPoolSize(KeyParams::ECDSA(), 2);
+  EXPECT_EQ_WAIT(2u, pool->size(KeyParams::ECDSA()), kGenerationTimeoutMs);
+  EXPECT_EQ(0u, pool->size(KeyParams::RSA()));
+  EXPECT_FALSE(pool->Take(KeyParams::RSA()));
+
+  scoped_refptr<RTCCertificate> first = pool->Take(KeyParams::ECDSA());
+  scoped_refptr<RTCCertificate> second = pool->Take(KeyParams::ECDSA());
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_NE(first, second);
+  EXPECT_EQ_WAIT(2u, pool->size(KeyParams::ECDSA()), kGenerationTimeoutMs);
+
+  RTCCertificatePool::Stats stats = pool->GetStats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_EQ(4, stats.generated);
+  EXPECT_EQ(0, stats.failed);
+  EXPECT_GT(stats.total_generation_time_us, 0);
+  EXPECT_GE(stats.total_generation_time_us, stats.max_generation_time_us);
+}
+
+TEST_F(RTCCertificateGeneratorTest, GenerateAsyncFromPool) {
+  std::unique_ptr<Thread> pool_thread(new Thread());
+  ASSERT_TRUE(pool_thread->Start());
+  scoped_refptr<RTCCertificatePool> pool(
+      new RefCountedObject<RTCCertificatePool>(pool_thread.get()));
+  pool->SetPoolSize(KeyParams::ECDSA(), 1);
+  ASSERT_EQ_WAIT(1u, pool->size(KeyParams::ECDSA()), kGenerationTimeoutMs);
+  RTCCertificateGenerator generator(Thread::Current(), pool_thread.get(), pool);
+
+  generator.GenerateCertificateAsync(KeyParams::ECDSA(), Optional<uint64_t>(),
+                                     fixture_);
+  // The pooled certificate is still delivered asynchronously.
+  EXPECT_FALSE(fixture_->GenerateAsyncCompleted());
+  EXPECT_TRUE_WAIT(fixture_->GenerateAsyncCompleted(), kGenerationTimeoutMs);
+  EXPECT_TRUE(fixture_->certificate());
+  EXPECT_EQ(1, pool->GetStats().hits);
+
+  // Requests with an expiration time are not served from the pool.
+  generator.GenerateCertificateAsync(KeyParams::ECDSA(),
+                                     Optional<uint64_t>(60000), fixture_);
+  EXPECT_TRUE_WAIT(fixture_->GenerateAsyncCompleted(), kGenerationTimeoutMs);
+  EXPECT_TRUE(fixture_->certificate());
+  EXPECT_EQ(1, pool->GetStats().hits);
+  EXPECT_EQ(0, pool->GetStats().misses);
+}
+
 }  // namespace rtc
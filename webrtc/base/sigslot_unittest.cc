@@ -10,7 +10,11 @@
 
 #include "webrtc/base/sigslot.h"
 
+#include <memory>
+
 #include "webrtc/base/gunit.h"
+#include "webrtc/base/logging.h"
+#include "webrtc/base/timeutils.h"
 
 // This function, when passed a has_slots or signalx, will break the build if
 // its threading requirement is not single threaded
@@ -248,3 +252,201 @@ TEST(DestructionOrder, SlotFirst) {
   (*signal)();
   delete signal;
 }
+
+// Slot which counts its calls and can change the connections of the signal
+// it is called from.
+class SigslotEmitReceiver : public sigslot::has_slots<> {
+ public:
+  SigslotEmitReceiver()
+      : signal_(nullptr),
+        disconnect_(nullptr),
+        connect_(nullptr),
+        signal_count_(0) {}
+
+  void Connect(sigslot::signal0<>* signal) {
+    signal_ = signal;
+    signal->connect(this, &SigslotEmitReceiver::OnSignal);
+  }
+  // On the next emit, disconnects |receiver| from the signal.
+  void DisconnectOnEmit(SigslotEmitReceiver* receiver) {
+    disconnect_ = receiver;
+  }
+  // On the next emit, connects |receiver| to the signal.
+  void ConnectOnEmit(SigslotEmitReceiver* receiver) { connect_ = receiver; }
+
+  void OnSignal() {
+    ++signal_count_;
+    if (disconnect_) {
+      signal_->disconnect(disconnect_);
+      disconnect_ = nullptr;
+    }
+    if (connect_) {
+      connect_->Connect(signal_);
+      connect_ = nullptr;
+    }
+  }
+  int signal_count() const { return signal_count_; }
+
+ private:
+  sigslot::signal0<>* signal_;
+  SigslotEmitReceiver* disconnect_;
+  SigslotEmitReceiver* connect_;
+  int signal_count_;
+};
+
+TEST(SigslotEmitTest, DisconnectSelfDuringEmit) {
+  sigslot::signal0<> signal;
+  SigslotEmitReceiver first, second;
+  first.Connect(&signal);
+  second.Connect(&signal);
+  first.DisconnectOnEmit(&first);
+  signal();
+  EXPECT_EQ(1, first.signal_count());
+  EXPECT_EQ(1, second.signal_count());
+  signal();
+  EXPECT_EQ(1, first.signal_count());
+  EXPECT_EQ(2, second.signal_count());
+}
+
+TEST(SigslotEmitTest, DisconnectOtherDuringEmit) {
+  sigslot::signal0<> signal;
+  SigslotEmitReceiver first, second, third;
+  first.Connect(&signal);
+  second.Connect(&signal);
+  third.Connect(&signal);
+  // A slot disconnected before its turn is not called.
+  first.DisconnectOnEmit(&second);
+  signal();
+  EXPECT_EQ(1, first.signal_count());
+  EXPECT_EQ(0, second.signal_count());
+  EXPECT_EQ(1, third.signal_count());
+  signal();
+  EXPECT_EQ(2, first.signal_count());
+  EXPECT_EQ(0, second.signal_count());
+  EXPECT_EQ(2, third.signal_count());
+}
+
+TEST(SigslotEmitTest, ConnectDuringEmit) {
+  sigslot::signal0<> signal;
+  SigslotEmitReceiver first, second;
+  first.Connect(&signal);
+  first.ConnectOnEmit(&second);
+  // A slot connected during an emit is called from the next one.
+  signal();
+  EXPECT_EQ(1, first.signal_count());
+  EXPECT_EQ(0, second.signal_count());
+  signal();
+  EXPECT_EQ(2, first.signal_count());
+  EXPECT_EQ(1, second.signal_count());
+}
+
+TEST(SigslotEmitTest, ConnectDuringEmitWithManySlots) {
+  sigslot::signal0<> signal;
+  SigslotEmitReceiver first, second, third;
+  first.Connect(&signal);
+  second.Connect(&signal);
+  // Connecting the third slot moves the connections out of the signal.
+  first.ConnectOnEmit(&third);
+  signal();
+  EXPECT_EQ(1, first.signal_count());
+  EXPECT_EQ(1, second.signal_count());
+  EXPECT_EQ(0, third.signal_count());
+  signal();
+  EXPECT_EQ(2, first.signal_count());
+  EXPECT_EQ(2, second.signal_count());
+  EXPECT_EQ(1, third.signal_count());
+}
+
+TEST(SigslotEmitTest, DestroySlotAfterDisconnectDuringEmit) {
+  sigslot::signal0<> signal;
+  SigslotEmitReceiver first;
+  std::unique_ptr<SigslotEmitReceiver> second(new SigslotEmitReceiver());
+  first.Connect(&signal);
+  second->Connect(&signal);
+  first.DisconnectOnEmit(second.get());
+  signal();
+  second.reset();
+  signal();
+  EXPECT_EQ(2, first.signal_count());
+}
+
+TEST(SigslotEmitTest, SameSlotConnectedTwice) {
+  sigslot::signal0<> signal;
+  SigslotEmitReceiver receiver;
+  receiver.Connect(&signal);
+  receiver.Connect(&signal);
+  signal();
+  EXPECT_EQ(2, receiver.signal_count());
+  // Each disconnect removes one connection.
+  signal.disconnect(&receiver);
+  signal();
+  EXPECT_EQ(3, receiver.signal_count());
+  signal.disconnect(&receiver);
+  signal();
+  EXPECT_EQ(3, receiver.signal_count());
+}
+
+TEST(SigslotEmitTest, CopiedSlotIsConnected) {
+  sigslot::signal0<> signal;
+  SigslotEmitReceiver receiver;
+  receiver.Connect(&signal);
+  {
+    SigslotEmitReceiver copy(receiver);
+    signal();
+    EXPECT_EQ(1, receiver.signal_count());
+    EXPECT_EQ(1, copy.signal_count());
+  }
+  // Destroying the copy disconnects it.
+  signal();
+  EXPECT_EQ(2, receiver.signal_count());
+}
+
+TEST(SigslotEmitTest, ManySlots) {
+  sigslot::signal0<> signal;
+  const int kNumReceivers = 20;
+  SigslotEmitReceiver receivers[kNumReceivers];
+  for (SigslotEmitReceiver& receiver : receivers) {
+    receiver.Connect(&signal);
+  }
+  for (int i = 0; i < kNumReceivers; i += 2) {
+    signal.disconnect(&receivers[i]);
+  }
+  signal();
+  for (int i = 0; i < kNumReceivers; ++i) {
+    EXPECT_EQ(i % 2, receivers[i].signal_count());
+  }
+}
+
+class SigslotPacketReceiver : public sigslot::has_slots<> {
+ public:
+  SigslotPacketReceiver() : bytes_(0) {}
+  void OnPacket(const char* data, size_t size, int64_t time_us) {
+    bytes_ += size;
+  }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  size_t bytes_;
+};
+
+// Measures the cost of emitting a signal with the signature of
+// SignalReadPacket to 1 to 4 slots.
+TEST(SigslotEmitTest, Perf) {
+  const int kNumEmits = 1000000;
+  const char kData[] = "packet";
+  for (int num_slots = 1; num_slots <= 4; ++num_slots) {
+    sigslot::signal3<const char*, size_t, int64_t> signal;
+    SigslotPacketReceiver receivers[4];
+    for (int i = 0; i < num_slots; ++i) {
+      signal.connect(&receivers[i], &SigslotPacketReceiver::OnPacket);
+    }
+    int64_t start = rtc::TimeNanos();
+    for (int i = 0; i < kNumEmits; ++i) {
+      signal(kData, sizeof(kData), i);
+    }
+    int64_t elapsed = rtc::TimeNanos() - start;
+    EXPECT_EQ(kNumEmits * sizeof(kData), receivers[0].bytes());
+    LOG(LS_INFO) << "Average emit time with " << num_slots << " slots: "
+                 << elapsed / kNumEmits << " ns";
+  }
+}
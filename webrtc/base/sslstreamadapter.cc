@@ -95,6 +95,10 @@ CryptoOptions CryptoOptions::NoGcm() {
   return options;
 }
 
+SSLSessionCache* SSLSessionCache::Create(size_t max_sessions) {
+  return new OpenSSLSessionCache(max_sessions);
+}
+
 SSLStreamAdapter* SSLStreamAdapter::Create(StreamInterface* stream) {
   return new OpenSSLStreamAdapter(stream);
 }
@@ -128,6 +132,13 @@ bool SSLStreamAdapter::GetDtlsSrtpCryptoSuite(int* crypto_suite) {
   return false;
 }
 
+void SSLStreamAdapter::SetSessionCache(SSLSessionCache* cache,
+                                       const std::string& peer_id) {}
+
+bool SSLStreamAdapter::IsSessionResumed() const {
+  return false;
+}
+
 bool SSLStreamAdapter::IsBoringSsl() {
   return OpenSSLStreamAdapter::IsBoringSsl();
 }
@@ -119,6 +119,27 @@ enum { SSE_MSG_TRUNC = 0xff0001 };
 // Used to send back UMA histogram value. Logged when Dtls handshake fails.
 enum class SSLHandshakeError { UNKNOWN, INCOMPATIBLE_CIPHERSUITE, MAX_VALUE };
 
+// Caches SSL sessions so that later connections with the same peer can be
+// resumed with an abbreviated handshake, which skips the certificate exchange
+// and the public key operations. As a server, the cache holds the keys that
+// encrypt the session tickets given to clients; as a client, it holds the
+// sessions established with each peer. A cache can be shared by any number of
+// SSLStreamAdapters on any threads.
+class SSLSessionCache {
+ public:
+  // Creates a cache holding the sessions of at most |max_sessions| peers, the
+  // oldest being evicted first. Caller is responsible for freeing the returned
+  // object.
+  static SSLSessionCache* Create(size_t max_sessions);
+
+  virtual ~SSLSessionCache() {}
+
+  // Returns the number of peers with a cached session.
+  virtual size_t size() const = 0;
+  // Forgets all cached sessions.
+  virtual void Clear() = 0;
+};
+
 class SSLStreamAdapter : public StreamAdapterInterface {
  public:
   // Instantiate an SSLStreamAdapter wrapping the given stream,
@@ -228,6 +249,17 @@ class SSLStreamAdapter : public StreamAdapterInterface {
   virtual bool SetDtlsSrtpCryptoSuites(const std::vector<int>& crypto_suites);
   virtual bool GetDtlsSrtpCryptoSuite(int* crypto_suite);
 
+  // Lets the handshake resume a session found in |cache|, and stores the new
+  // session there otherwise. |peer_id| identifies the peer whose sessions are
+  // looked up and stored when acting as a client; no session is stored for an
+  // empty |peer_id|. A resumed session is still verified against the peer
+  // certificate digest. |cache| must outlive this object. Must be called
+  // before StartSSL().
+  virtual void SetSessionCache(SSLSessionCache* cache,
+                               const std::string& peer_id);
+  // Returns true if the handshake resumed a cached session.
+  virtual bool IsSessionResumed() const;
+
   // Returns true if a TLS connection has been established.
   // The only difference between this and "GetState() == SE_OPEN" is that if
   // the peer certificate digest hasn't been verified, the state will still be
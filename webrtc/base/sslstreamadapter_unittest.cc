@@ -361,6 +361,34 @@ class SSLStreamAdapterTestBase : public testing::Test,
     identities_set_ = true;
   }
 
+  void SetSessionCaches(rtc::SSLSessionCache* client_cache,
+                        rtc::SSLSessionCache* server_cache) {
+    client_ssl_->SetSessionCache(client_cache, "server");
+    server_ssl_->SetSessionCache(server_cache, "client");
+  }
+
+  // Replaces the adapters with new ones using the same identities, as for a
+  // new connection between the same peers.
+  void RecreateAdapters() {
+    rtc::SSLIdentity* client_identity = client_identity_->GetReference();
+    rtc::SSLIdentity* server_identity = server_identity_->GetReference();
+    client_ssl_.reset();
+    server_ssl_.reset();
+    CreateStreams();
+
+    client_ssl_.reset(rtc::SSLStreamAdapter::Create(client_stream_));
+    server_ssl_.reset(rtc::SSLStreamAdapter::Create(server_stream_));
+
+    client_ssl_->SignalEvent.connect(this, &SSLStreamAdapterTestBase::OnEvent);
+    server_ssl_->SignalEvent.connect(this, &SSLStreamAdapterTestBase::OnEvent);
+
+    client_identity_ = client_identity;
+    server_identity_ = server_identity;
+    client_ssl_->SetIdentity(client_identity_);
+    server_ssl_->SetIdentity(server_identity_);
+    identities_set_ = false;
+  }
+
   void SetupProtocolVersions(rtc::SSLProtocolVersion server_version,
                              rtc::SSLProtocolVersion client_version) {
     server_ssl_->SetMaxProtocolVersion(server_version);
@@ -742,6 +770,9 @@ class SSLStreamAdapterTestDTLS
   }
 
   void CreateStreams() override {
+    // Drop what previous adapters may have left, such as a close alert.
+    client_buffer_.Clear();
+    server_buffer_.Clear();
     client_stream_ =
         new SSLDummyStreamDTLS(this, "c2s", &client_buffer_, &server_buffer_);
     server_stream_ =
@@ -1006,6 +1037,47 @@ TEST_P(SSLStreamAdapterTestDTLS, TestDTLSTransferWithDamage) {
   TestTransfer(100);
 };
 
+// Test that a second connection between the same peers resumes the session
+// of the first one, and still learns the peer's certificate.
+TEST_P(SSLStreamAdapterTestDTLS, TestDTLSSessionResumption) {
+  std::unique_ptr<rtc::SSLSessionCache> client_cache(
+      rtc::SSLSessionCache::Create(10));
+  std::unique_ptr<rtc::SSLSessionCache> server_cache(
+      rtc::SSLSessionCache::Create(10));
+  SetSessionCaches(client_cache.get(), server_cache.get());
+  TestHandshake();
+  EXPECT_FALSE(client_ssl_->IsSessionResumed());
+  EXPECT_FALSE(server_ssl_->IsSessionResumed());
+  EXPECT_EQ(1u, client_cache->size());
+
+  RecreateAdapters();
+  SetSessionCaches(client_cache.get(), server_cache.get());
+  TestHandshake();
+  EXPECT_TRUE(client_ssl_->IsSessionResumed());
+  EXPECT_TRUE(server_ssl_->IsSessionResumed());
+  EXPECT_TRUE(client_ssl_->GetPeerCertificate());
+  EXPECT_TRUE(server_ssl_->GetPeerCertificate());
+  TestTransfer(100);
+}
+
+// Test that a cached session isn't resumed with a peer whose certificate
+// doesn't match the digest, and is forgotten.
+TEST_P(SSLStreamAdapterTestDTLS, TestDTLSSessionResumptionWithBogusDigest) {
+  std::unique_ptr<rtc::SSLSessionCache> client_cache(
+      rtc::SSLSessionCache::Create(10));
+  std::unique_ptr<rtc::SSLSessionCache> server_cache(
+      rtc::SSLSessionCache::Create(10));
+  SetSessionCaches(client_cache.get(), server_cache.get());
+  TestHandshake();
+  EXPECT_EQ(1u, client_cache->size());
+
+  RecreateAdapters();
+  SetSessionCaches(client_cache.get(), server_cache.get());
+  SetPeerIdentitiesByDigest(false, true);
+  TestHandshake(false);
+  EXPECT_EQ(0u, client_cache->size());
+}
+
 TEST_P(SSLStreamAdapterTestDTLS, TestDTLSDelayedIdentity) {
   TestHandshakeWithDelayedIdentity(true);
 };
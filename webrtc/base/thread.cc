@@ -20,6 +20,7 @@
 #include <time.h>
 #endif
 
+#include "webrtc/base/atomicops.h"
 #include "webrtc/base/checks.h"
 #include "webrtc/base/logging.h"
 #include "webrtc/base/nullsocketserver.h"
@@ -35,6 +36,12 @@
 
 namespace rtc {
 
+namespace {
+
+volatile int g_blocking_send_count = 0;
+
+}  // namespace
+
 ThreadManager* ThreadManager::Instance() {
   RTC_DEFINE_STATIC_LOCAL(ThreadManager, thread_manager, ());
   return &thread_manager;
@@ -371,6 +378,8 @@ void Thread::Send(const Location& posted_from,
   }
 
   AssertBlockingIsAllowedOnCurrentThread();
+  int blocking_send_count = AtomicOps::Increment(&g_blocking_send_count);
+  TRACE_COUNTER1("webrtc", "Thread::BlockingSends", blocking_send_count);
 
   AutoThread thread;
   Thread *current_thread = Thread::Current();
@@ -455,6 +464,10 @@ bool Thread::PopSendMessageFromThread(const Thread* source, _SendMessage* msg) {
   return false;
 }
 
+int Thread::GetBlockingSendCount() {
+  return AtomicOps::AcquireLoad(&g_blocking_send_count);
+}
+
 void Thread::InvokeInternal(const Location& posted_from,
                             MessageHandler* handler) {
   TRACE_EVENT2("webrtc", "Thread::Invoke", "src_file_and_line",
@@ -156,6 +156,12 @@ class LOCKABLE Thread : public MessageQueue {
                     uint32_t id = 0,
                     MessageData* pdata = NULL);
 
+  // Returns the number of Send()s, and so Invoke()s, which have blocked a
+  // thread on another thread in this process so far. Each is also reported as
+  // the "Thread::BlockingSends" trace counter, to find the synchronous thread
+  // hops that remain on hot paths.
+  static int GetBlockingSendCount();
+
   // Convenience method to invoke a functor on another thread.  Caller must
   // provide the |ReturnT| template argument, which cannot (easily) be deduced.
   // Uses Send() internally, which blocks the current thread until execution
@@ -287,6 +287,18 @@ TEST(ThreadTest, Invoke) {
   thread.Invoke<void>(RTC_FROM_HERE, &LocalFuncs::Func2);
 }
 
+TEST(ThreadTest, CountsBlockingSends) {
+  AutoThread current_thread;
+  Thread thread;
+  thread.Start();
+  int count = Thread::GetBlockingSendCount();
+  thread.Invoke<int>(RTC_FROM_HERE, FunctorA());
+  EXPECT_EQ(count + 1, Thread::GetBlockingSendCount());
+  // Invoking the current thread doesn't block.
+  Thread::Current()->Invoke<int>(RTC_FROM_HERE, FunctorA());
+  EXPECT_EQ(count + 1, Thread::GetBlockingSendCount());
+}
+
 // Verifies that two threads calling Invoke on each other at the same time does
 // not deadlock.
 TEST(ThreadTest, TwoThreadsInvokeNoDeadlock) {
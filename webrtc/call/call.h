@@ -27,6 +27,7 @@
 namespace webrtc {
 
 class AudioProcessing;
+class DecodeScheduler;
 class RtcEventLog;
 
 const char* Version();
@@ -86,6 +87,11 @@ class Call {
     // RtcEventLog to use for this call. Required.
     // Use webrtc::RtcEventLog::CreateNull() for a null implementation.
     RtcEventLog* event_log = nullptr;
+
+    // Optional pool of decode threads shared by the video receive streams of
+    // this call, and possibly of other calls. If null, each video receive
+    // stream decodes on its own thread. Must outlive the call.
+    DecodeScheduler* decode_scheduler = nullptr;
   };
 
   struct Stats {
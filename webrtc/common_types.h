@@ -535,6 +535,13 @@ struct VideoCodecVP8 {
   bool frameDroppingOn;
   int keyFrameInterval;
   TemporalLayersFactory* tl_factory;
+  // Number of threads used to encode the highest resolution stream, capped by
+  // the number of cores given to InitEncode(). 0 means that the encoder picks
+  // a value based on resolution and number of cores.
+  int numberOfThreads;
+  // Log2 of the number of DCT token partitions (0-3). Partitions can be
+  // processed in parallel by the encoder and the decoder.
+  int tokenPartitions;
 };
 
 // VP9 specific.
@@ -574,6 +581,15 @@ struct VideoCodecH264 {
   const uint8_t* ppsData;
   size_t ppsLen;
   H264::Profile profile;
+  // Number of encoder threads, capped by the number of cores given to
+  // InitEncode(). 0 means that the encoder picks a value based on resolution
+  // and number of cores.
+  int numberOfThreads;
+  // Number of slices per frame in non-interleaved packetization mode, which
+  // is what allows encoder threads to work in parallel. 0 means one slice per
+  // encoder thread. Ignored in single NAL unit mode, where slices are size
+  // limited instead.
+  int numberOfSlices;
 };
 
 // Video codec types
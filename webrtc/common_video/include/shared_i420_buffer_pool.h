@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_COMMON_VIDEO_INCLUDE_SHARED_I420_BUFFER_POOL_H_
+#define WEBRTC_COMMON_VIDEO_INCLUDE_SHARED_I420_BUFFER_POOL_H_
+
+#include <stdint.h>
+
+#include "webrtc/api/video/i420_buffer.h"
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ref_ptr.h"
+
+namespace webrtc {
+
+// Thread-safe I420 frame allocator that can be shared by any number of
+// decoders, scalers and capturers. Unlike I420BufferPool, the pool does not
+// hold on to buffers that are in use: a buffer goes back to the pool when its
+// last reference is released, on whatever thread that happens.
+//
+// Free buffers are kept in size classes, one per resolution, each with a
+// bounded lock-free free list, so CreateBuffer() and buffer release do not
+// take any locks in the steady state. A lock is only taken when a resolution
+// without a size class is requested and a size class has to be assigned or
+// evicted.
+//
+// The amount of memory held by free buffers is capped. Buffers released while
+// the pool is at its cap are freed immediately.
+class SharedI420BufferPool {
+ public:
+  struct Config {
+    Config() {}
+    // Max number of bytes held by free buffers in the pool.
+    size_t max_free_bytes = 64 * 1024 * 1024;
+    // If true, newly allocated buffers are zero-initialized. Recycled buffers
+    // are not cleared, see I420BufferPool for why FFmpeg needs this.
+    bool zero_initialize = true;
+  };
+
+  struct Stats {
+    // Number of CreateBuffer() calls served from a free list.
+    uint64_t hits = 0;
+    // Number of CreateBuffer() calls that allocated a new buffer.
+    uint64_t misses = 0;
+    // Number of released buffers that were freed instead of pooled, because
+    // the pool was at its memory cap or the size class was full or evicted.
+    uint64_t discards = 0;
+    // Bytes currently held by free buffers.
+    size_t free_bytes = 0;
+  };
+
+  // Process-wide pool with the default configuration. Never destroyed.
+  static SharedI420BufferPool* Default();
+
+  SharedI420BufferPool();
+  explicit SharedI420BufferPool(const Config& config);
+  // Frees all free buffers. Buffers still in use stay valid and are freed
+  // when released.
+  ~SharedI420BufferPool();
+
+  // Returns a buffer of the given size, recycled if possible. Can be called
+  // on any thread.
+  rtc::scoped_refptr<I420Buffer> CreateBuffer(int width, int height);
+
+  // Changes the memory cap, freeing buffers if the pool is above it.
+  void SetMaxFreeBytes(size_t max_free_bytes);
+
+  // Frees all free buffers.
+  void Trim();
+
+  Stats GetStats() const;
+
+ private:
+  class Core;
+  class PooledBuffer;
+
+  const rtc::scoped_refptr<Core> core_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(SharedI420BufferPool);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_COMMON_VIDEO_INCLUDE_SHARED_I420_BUFFER_POOL_H_
@@ -0,0 +1,359 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_video/include/shared_i420_buffer_pool.h"
+
+#include <atomic>
+#include <utility>
+
+#include "webrtc/base/checks.h"
+#include "webrtc/base/criticalsection.h"
+#include "webrtc/base/refcount.h"
+
+namespace webrtc {
+
+namespace {
+
+// Number of size classes, i.e. distinct resolutions that can be pooled at the
+// same time.
+const size_t kNumSizeClasses = 16;
+// Max number of free buffers per size class. Must be a power of two.
+const size_t kFreeListCapacity = 32;
+static_assert((kFreeListCapacity & (kFreeListCapacity - 1)) == 0,
+              "kFreeListCapacity must be a power of two");
+
+uint64_t SizeClassKey(int width, int height) {
+  return (static_cast<uint64_t>(width) << 32) | static_cast<uint32_t>(height);
+}
+
+size_t BufferBytes(int width, int height) {
+  return static_cast<size_t>(width) * height +
+         2 * static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+}
+
+}  // namespace
+
+// An I420Buffer that returns itself to its pool instead of being deleted when
+// the last reference is released.
+class SharedI420BufferPool::PooledBuffer : public I420Buffer {
+ public:
+  PooledBuffer(int width, int height) : I420Buffer(width, height) {}
+
+  int AddRef() const override {
+    return ref_count_.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+  int Release() const override;
+
+  // Reference to the pool while the buffer is in use. Null while the buffer
+  // is on a free list, to avoid a reference cycle.
+  rtc::scoped_refptr<Core> core_;
+
+ private:
+  friend class SharedI420BufferPool::Core;
+  ~PooledBuffer() override {}
+
+  mutable std::atomic<int> ref_count_{0};
+};
+
+// Shared between the pool and all buffers in use, so that buffers can outlive
+// the SharedI420BufferPool object.
+class SharedI420BufferPool::Core : public rtc::RefCountInterface {
+ public:
+  explicit Core(const Config& config);
+  ~Core() override;
+
+  rtc::scoped_refptr<I420Buffer> CreateBuffer(rtc::scoped_refptr<Core> self,
+                                              int width,
+                                              int height);
+  void Return(PooledBuffer* buffer);
+  void SetMaxFreeBytes(size_t max_free_bytes);
+  void Trim();
+  Stats GetStats() const;
+
+ private:
+  // Bounded multi-producer multi-consumer queue, based on Dmitry Vyukov's
+  // design. Each cell carries a sequence number that tells producers and
+  // consumers whether the cell is ready for them, which avoids the ABA
+  // problem of a linked free list.
+  class FreeList {
+   public:
+    FreeList();
+    bool Push(PooledBuffer* buffer);
+    PooledBuffer* Pop();
+
+   private:
+    struct Cell {
+      std::atomic<size_t> sequence;
+      PooledBuffer* buffer;
+    };
+    Cell cells_[kFreeListCapacity];
+    std::atomic<size_t> enqueue_pos_;
+    std::atomic<size_t> dequeue_pos_;
+  };
+
+  struct SizeClass {
+    // SizeClassKey() of the resolution served, or 0 if unassigned.
+    std::atomic<uint64_t> key{0};
+    // Value of |use_counter_| when the size class was last used.
+    std::atomic<uint64_t> last_use{0};
+    FreeList free_list;
+  };
+
+  SizeClass* FindSizeClass(uint64_t key);
+  SizeClass* AssignSizeClass(uint64_t key);
+  // Frees all buffers on the free list of |size_class|.
+  void Drain(SizeClass* size_class);
+  void Discard(PooledBuffer* buffer);
+
+  const bool zero_initialize_;
+  std::atomic<size_t> max_free_bytes_;
+  std::atomic<size_t> free_bytes_{0};
+  std::atomic<uint64_t> use_counter_{0};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> discards_{0};
+
+  SizeClass size_classes_[kNumSizeClasses];
+  // Serializes assignment and eviction of size classes.
+  rtc::CriticalSection assign_crit_;
+};
+
+int SharedI420BufferPool::PooledBuffer::Release() const {
+  int count = ref_count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  if (!count) {
+    PooledBuffer* self = const_cast<PooledBuffer*>(this);
+    // Move the pool reference out before the buffer is published on a free
+    // list, where another thread may pick it up right away. |core| keeps the
+    // pool alive until Return() is done.
+    rtc::scoped_refptr<Core> core = std::move(self->core_);
+    core->Return(self);
+  }
+  return count;
+}
+
+SharedI420BufferPool::Core::FreeList::FreeList()
+    : enqueue_pos_(0), dequeue_pos_(0) {
+  for (size_t i = 0; i < kFreeListCapacity; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+    cells_[i].buffer = nullptr;
+  }
+}
+
+bool SharedI420BufferPool::Core::FreeList::Push(PooledBuffer* buffer) {
+  Cell* cell;
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &cells_[pos & (kFreeListCapacity - 1)];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(sequence) -
+                    static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;  // Full.
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->buffer = buffer;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+SharedI420BufferPool::PooledBuffer*
+SharedI420BufferPool::Core::FreeList::Pop() {
+  Cell* cell;
+  size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &cells_[pos & (kFreeListCapacity - 1)];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(sequence) -
+                    static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return nullptr;  // Empty.
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  PooledBuffer* buffer = cell->buffer;
+  cell->sequence.store(pos + kFreeListCapacity, std::memory_order_release);
+  return buffer;
+}
+
+SharedI420BufferPool::Core::Core(const Config& config)
+    : zero_initialize_(config.zero_initialize),
+      max_free_bytes_(config.max_free_bytes) {}
+
+SharedI420BufferPool::Core::~Core() {
+  // Only reached when no buffers are in use.
+  Trim();
+}
+
+SharedI420BufferPool::Core::SizeClass*
+SharedI420BufferPool::Core::FindSizeClass(uint64_t key) {
+  for (SizeClass& size_class : size_classes_) {
+    if (size_class.key.load(std::memory_order_acquire) == key)
+      return &size_class;
+  }
+  return nullptr;
+}
+
+SharedI420BufferPool::Core::SizeClass*
+SharedI420BufferPool::Core::AssignSizeClass(uint64_t key) {
+  rtc::CritScope lock(&assign_crit_);
+  // Another thread may have assigned it while we were waiting for the lock.
+  SizeClass* size_class = FindSizeClass(key);
+  if (size_class)
+    return size_class;
+  // Prefer an unassigned size class, otherwise evict the least recently used.
+  SizeClass* victim = &size_classes_[0];
+  for (SizeClass& candidate : size_classes_) {
+    if (candidate.key.load(std::memory_order_relaxed) == 0) {
+      victim = &candidate;
+      break;
+    }
+    if (candidate.last_use.load(std::memory_order_relaxed) <
+        victim->last_use.load(std::memory_order_relaxed)) {
+      victim = &candidate;
+    }
+  }
+  victim->key.store(key, std::memory_order_release);
+  // Buffers of the old resolution can still be pushed by threads that looked
+  // up the size class before the key changed. CreateBuffer() checks the size
+  // of every buffer it pops, so such stragglers are discarded there.
+  Drain(victim);
+  return victim;
+}
+
+void SharedI420BufferPool::Core::Drain(SizeClass* size_class) {
+  while (PooledBuffer* buffer = size_class->free_list.Pop()) {
+    free_bytes_.fetch_sub(BufferBytes(buffer->width(), buffer->height()),
+                          std::memory_order_relaxed);
+    delete buffer;
+  }
+}
+
+void SharedI420BufferPool::Core::Discard(PooledBuffer* buffer) {
+  discards_.fetch_add(1, std::memory_order_relaxed);
+  delete buffer;
+}
+
+rtc::scoped_refptr<I420Buffer> SharedI420BufferPool::Core::CreateBuffer(
+    rtc::scoped_refptr<Core> self,
+    int width,
+    int height) {
+  RTC_DCHECK_GT(width, 0);
+  RTC_DCHECK_GT(height, 0);
+  const uint64_t key = SizeClassKey(width, height);
+  const uint64_t use = use_counter_.fetch_add(1, std::memory_order_relaxed);
+  SizeClass* size_class = FindSizeClass(key);
+  if (!size_class)
+    size_class = AssignSizeClass(key);
+  size_class->last_use.store(use, std::memory_order_relaxed);
+
+  while (PooledBuffer* buffer = size_class->free_list.Pop()) {
+    free_bytes_.fetch_sub(BufferBytes(buffer->width(), buffer->height()),
+                          std::memory_order_relaxed);
+    if (buffer->width() != width || buffer->height() != height) {
+      Discard(buffer);
+      continue;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    buffer->core_ = std::move(self);
+    return buffer;
+  }
+
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  PooledBuffer* buffer = new PooledBuffer(width, height);
+  if (zero_initialize_)
+    buffer->InitializeData();
+  buffer->core_ = std::move(self);
+  return buffer;
+}
+
+void SharedI420BufferPool::Core::Return(PooledBuffer* buffer) {
+  const size_t bytes = BufferBytes(buffer->width(), buffer->height());
+  SizeClass* size_class =
+      FindSizeClass(SizeClassKey(buffer->width(), buffer->height()));
+  if (!size_class) {
+    Discard(buffer);
+    return;
+  }
+  size_t free_bytes =
+      free_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  if (free_bytes > max_free_bytes_.load(std::memory_order_relaxed) ||
+      !size_class->free_list.Push(buffer)) {
+    free_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    Discard(buffer);
+  }
+}
+
+void SharedI420BufferPool::Core::SetMaxFreeBytes(size_t max_free_bytes) {
+  max_free_bytes_.store(max_free_bytes, std::memory_order_relaxed);
+  if (free_bytes_.load(std::memory_order_relaxed) > max_free_bytes)
+    Trim();
+}
+
+void SharedI420BufferPool::Core::Trim() {
+  for (SizeClass& size_class : size_classes_)
+    Drain(&size_class);
+}
+
+SharedI420BufferPool::Stats SharedI420BufferPool::Core::GetStats() const {
+  Stats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.discards = discards_.load(std::memory_order_relaxed);
+  stats.free_bytes = free_bytes_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+SharedI420BufferPool* SharedI420BufferPool::Default() {
+  static SharedI420BufferPool* const pool = new SharedI420BufferPool();
+  return pool;
+}
+
+SharedI420BufferPool::SharedI420BufferPool()
+    : SharedI420BufferPool(Config()) {}
+
+SharedI420BufferPool::SharedI420BufferPool(const Config& config)
+    : core_(new rtc::RefCountedObject<Core>(config)) {}
+
+SharedI420BufferPool::~SharedI420BufferPool() {
+  // Buffers in use keep |core_| alive. Free the ones that are not.
+  core_->Trim();
+}
+
+rtc::scoped_refptr<I420Buffer> SharedI420BufferPool::CreateBuffer(int width,
+                                                                  int height) {
+  return core_->CreateBuffer(core_, width, height);
+}
+
+void SharedI420BufferPool::SetMaxFreeBytes(size_t max_free_bytes) {
+  core_->SetMaxFreeBytes(max_free_bytes);
+}
+
+void SharedI420BufferPool::Trim() {
+  core_->Trim();
+}
+
+SharedI420BufferPool::Stats SharedI420BufferPool::GetStats() const {
+  return core_->GetStats();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,176 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include "webrtc/base/platform_thread.h"
+#include "webrtc/common_video/include/shared_i420_buffer_pool.h"
+#include "webrtc/test/gtest.h"
+
+namespace webrtc {
+
+TEST(SharedI420BufferPoolTest, ReusesReleasedBuffer) {
+  SharedI420BufferPool pool;
+  rtc::scoped_refptr<I420Buffer> buffer = pool.CreateBuffer(16, 16);
+  const uint8_t* y_ptr = buffer->DataY();
+  buffer = nullptr;
+  EXPECT_EQ(16 * 16 + 2 * 8 * 8, static_cast<int>(pool.GetStats().free_bytes));
+
+  buffer = pool.CreateBuffer(16, 16);
+  EXPECT_EQ(y_ptr, buffer->DataY());
+  EXPECT_EQ(16, buffer->width());
+  EXPECT_EQ(16, buffer->height());
+  SharedI420BufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(0u, stats.free_bytes);
+}
+
+TEST(SharedI420BufferPoolTest, DoesNotReuseBufferOfOtherSize) {
+  SharedI420BufferPool pool;
+  rtc::scoped_refptr<I420Buffer> buffer = pool.CreateBuffer(16, 16);
+  buffer = nullptr;
+  buffer = pool.CreateBuffer(32, 16);
+  EXPECT_EQ(32, buffer->width());
+  EXPECT_EQ(16, buffer->height());
+  EXPECT_EQ(0u, pool.GetStats().hits);
+  EXPECT_EQ(2u, pool.GetStats().misses);
+}
+
+TEST(SharedI420BufferPoolTest, KeepsSeveralResolutions) {
+  SharedI420BufferPool pool;
+  pool.CreateBuffer(16, 16);
+  pool.CreateBuffer(32, 32);
+  pool.CreateBuffer(64, 64);
+  pool.CreateBuffer(16, 16);
+  pool.CreateBuffer(32, 32);
+  pool.CreateBuffer(64, 64);
+  EXPECT_EQ(3u, pool.GetStats().hits);
+  EXPECT_EQ(3u, pool.GetStats().misses);
+}
+
+TEST(SharedI420BufferPoolTest, DoesNotHandOutBuffersInUse) {
+  SharedI420BufferPool pool;
+  rtc::scoped_refptr<I420Buffer> buffer1 = pool.CreateBuffer(16, 16);
+  rtc::scoped_refptr<I420Buffer> buffer2 = pool.CreateBuffer(16, 16);
+  EXPECT_NE(buffer1->DataY(), buffer2->DataY());
+  EXPECT_EQ(2u, pool.GetStats().misses);
+}
+
+TEST(SharedI420BufferPoolTest, BufferValidAfterPoolDestruction) {
+  rtc::scoped_refptr<I420Buffer> buffer;
+  {
+    SharedI420BufferPool pool;
+    buffer = pool.CreateBuffer(16, 16);
+  }
+  EXPECT_EQ(16, buffer->width());
+  EXPECT_EQ(16, buffer->height());
+  // Try to trigger use-after-free errors by writing to y-plane.
+  memset(buffer->MutableDataY(), 0xA5, 16 * buffer->StrideY());
+}
+
+TEST(SharedI420BufferPoolTest, DiscardsBuffersAboveMemoryCap) {
+  SharedI420BufferPool::Config config;
+  config.max_free_bytes = 16 * 16 + 2 * 8 * 8;
+  SharedI420BufferPool pool(config);
+  rtc::scoped_refptr<I420Buffer> buffer1 = pool.CreateBuffer(16, 16);
+  rtc::scoped_refptr<I420Buffer> buffer2 = pool.CreateBuffer(16, 16);
+  buffer1 = nullptr;
+  buffer2 = nullptr;
+  SharedI420BufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(config.max_free_bytes, stats.free_bytes);
+  EXPECT_EQ(1u, stats.discards);
+
+  pool.SetMaxFreeBytes(0);
+  EXPECT_EQ(0u, pool.GetStats().free_bytes);
+}
+
+TEST(SharedI420BufferPoolTest, TrimFreesAllFreeBuffers) {
+  SharedI420BufferPool pool;
+  pool.CreateBuffer(16, 16);
+  pool.CreateBuffer(32, 32);
+  EXPECT_GT(pool.GetStats().free_bytes, 0u);
+  pool.Trim();
+  EXPECT_EQ(0u, pool.GetStats().free_bytes);
+}
+
+TEST(SharedI420BufferPoolTest, ZeroInitializesNewBuffers) {
+  SharedI420BufferPool pool;
+  rtc::scoped_refptr<I420Buffer> buffer = pool.CreateBuffer(16, 16);
+  for (int i = 0; i < 16 * buffer->StrideY(); ++i)
+    EXPECT_EQ(0, buffer->DataY()[i]);
+}
+
+namespace {
+
+const int kNumIterations = 2000;
+
+// Creates buffers of a few resolutions and hands every other one over to be
+// released by the next thread, so that buffers are returned on other threads
+// than the one that created them.
+struct StressTestState {
+  SharedI420BufferPool* pool;
+  int thread_index;
+  std::vector<rtc::scoped_refptr<I420Buffer>>* handoff;
+  rtc::CriticalSection* handoff_crit;
+};
+
+bool RunStressTest(void* obj) {
+  StressTestState* state = static_cast<StressTestState*>(obj);
+  for (int i = 0; i < kNumIterations; ++i) {
+    int size = 16 << ((i + state->thread_index) % 3);
+    rtc::scoped_refptr<I420Buffer> buffer =
+        state->pool->CreateBuffer(size, size);
+    EXPECT_EQ(size, buffer->width());
+    EXPECT_EQ(size, buffer->height());
+    // Catch buffers handed out twice: another user would overwrite this.
+    memset(buffer->MutableDataY(), state->thread_index, size);
+    EXPECT_EQ(state->thread_index, buffer->DataY()[size - 1]);
+    if (i % 2) {
+      rtc::CritScope lock(state->handoff_crit);
+      state->handoff->push_back(buffer);
+    } else {
+      rtc::CritScope lock(state->handoff_crit);
+      state->handoff->clear();
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(SharedI420BufferPoolTest, CanBeUsedFromMultipleThreads) {
+  const int kNumThreads = 4;
+  SharedI420BufferPool pool;
+  rtc::CriticalSection handoff_crit;
+  std::vector<rtc::scoped_refptr<I420Buffer>> handoff;
+  std::vector<StressTestState> states(kNumThreads);
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    states[i] = {&pool, i + 1, &handoff, &handoff_crit};
+    threads.emplace_back(
+        new rtc::PlatformThread(&RunStressTest, &states[i], "PoolStress"));
+  }
+  for (auto& thread : threads)
+    thread->Start();
+  for (auto& thread : threads)
+    thread->Stop();
+  handoff.clear();
+
+  SharedI420BufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(static_cast<uint64_t>(kNumThreads * kNumIterations),
+            stats.hits + stats.misses);
+  EXPECT_GT(stats.hits, stats.misses);
+}
+
+}  // namespace webrtc
@@ -20,7 +20,9 @@
 #include "webrtc/base/thread_checker.h"
 #include "webrtc/base/timeutils.h"
 #include "webrtc/call/call.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_compact_encoding.h"
 #include "webrtc/logging/rtc_event_log/rtc_event_log_helper_thread.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_packet_ring.h"
 #include "webrtc/modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "webrtc/modules/rtp_rtcp/source/byte_io.h"
 #include "webrtc/modules/rtp_rtcp/source/rtcp_packet/app.h"
@@ -51,7 +53,7 @@ namespace webrtc {
 
 class RtcEventLogImpl final : public RtcEventLog {
  public:
-  RtcEventLogImpl();
+  explicit RtcEventLogImpl(EncodingType encoding);
   ~RtcEventLogImpl() override;
 
   bool StartLogging(const std::string& file_name,
@@ -82,6 +84,16 @@ class RtcEventLogImpl final : public RtcEventLog {
 
  private:
   void StoreEvent(std::unique_ptr<rtclog::Event>* event);
+  // Adds a packet to the ring of the calling thread. Returns false if the
+  // packet doesn't fit in a PacketRecord or if the thread can't get a ring,
+  // in which case it is logged as an rtclog::Event instead.
+  bool StorePacket(PacketRecord::Type type,
+                   int64_t timestamp_us,
+                   PacketDirection direction,
+                   MediaType media_type,
+                   const uint8_t* data,
+                   size_t length,
+                   size_t packet_length);
 
   // Message queue for passing control messages to the logging thread.
   SwapQueue<RtcEventLogHelperThread::ControlMessage> message_queue_;
@@ -89,6 +101,9 @@ class RtcEventLogImpl final : public RtcEventLog {
   // Message queue for passing events to the logging thread.
   SwapQueue<std::unique_ptr<rtclog::Event> > event_queue_;
 
+  // Per-thread queues for passing RTP and RTCP packets to the logging thread.
+  PacketRingSet packet_rings_;
+
   RtcEventLogHelperThread helper_thread_;
   rtc::ThreadChecker thread_checker_;
 
@@ -133,14 +148,21 @@ rtclog::MediaType ConvertMediaType(MediaType media_type) {
 // sent packets because they also contain received packets.
 static const int kEventsPerSecond = 1000;
 static const int kControlMessagesPerSecond = 10;
+// The packet rings hold about one second of the packets sent or received by
+// one thread, or 128 kB each.
+static const size_t kPacketsPerThreadPerSecond = 1000;
 }  // namespace
 
 // RtcEventLogImpl member functions.
-RtcEventLogImpl::RtcEventLogImpl()
+RtcEventLogImpl::RtcEventLogImpl(EncodingType encoding)
     // Allocate buffers for roughly one second of history.
     : message_queue_(kControlMessagesPerSecond),
       event_queue_(kEventsPerSecond),
-      helper_thread_(&message_queue_, &event_queue_),
+      packet_rings_(kPacketsPerThreadPerSecond),
+      helper_thread_(&message_queue_,
+                     &event_queue_,
+                     &packet_rings_,
+                     encoding),
       thread_checker_() {
   thread_checker_.DetachFromThread();
 }
@@ -354,8 +376,13 @@ void RtcEventLogImpl::LogRtpHeader(PacketDirection direction,
     header_length += (x_len + 1) * 4;
   }
 
+  int64_t timestamp_us = rtc::TimeMicros();
+  if (StorePacket(PacketRecord::kRtp, timestamp_us, direction, media_type,
+                  header, header_length, packet_length)) {
+    return;
+  }
   std::unique_ptr<rtclog::Event> rtp_event(new rtclog::Event());
-  rtp_event->set_timestamp_us(rtc::TimeMicros());
+  rtp_event->set_timestamp_us(timestamp_us);
   rtp_event->set_type(rtclog::Event::RTP_EVENT);
   rtp_event->mutable_rtp_packet()->set_incoming(direction == kIncomingPacket);
   rtp_event->mutable_rtp_packet()->set_type(ConvertMediaType(media_type));
@@ -368,12 +395,7 @@ void RtcEventLogImpl::LogRtcpPacket(PacketDirection direction,
                                     MediaType media_type,
                                     const uint8_t* packet,
                                     size_t length) {
-  std::unique_ptr<rtclog::Event> rtcp_event(new rtclog::Event());
-  rtcp_event->set_timestamp_us(rtc::TimeMicros());
-  rtcp_event->set_type(rtclog::Event::RTCP_EVENT);
-  rtcp_event->mutable_rtcp_packet()->set_incoming(direction == kIncomingPacket);
-  rtcp_event->mutable_rtcp_packet()->set_type(ConvertMediaType(media_type));
-
+  int64_t timestamp_us = rtc::TimeMicros();
   rtcp::CommonHeader header;
   const uint8_t* block_begin = packet;
   const uint8_t* packet_end = packet + length;
@@ -410,6 +432,15 @@ void RtcEventLogImpl::LogRtcpPacket(PacketDirection direction,
 
     block_begin += block_size;
   }
+  if (StorePacket(PacketRecord::kRtcp, timestamp_us, direction, media_type,
+                  buffer, buffer_length, 0)) {
+    return;
+  }
+  std::unique_ptr<rtclog::Event> rtcp_event(new rtclog::Event());
+  rtcp_event->set_timestamp_us(timestamp_us);
+  rtcp_event->set_type(rtclog::Event::RTCP_EVENT);
+  rtcp_event->mutable_rtcp_packet()->set_incoming(direction == kIncomingPacket);
+  rtcp_event->mutable_rtcp_packet()->set_type(ConvertMediaType(media_type));
   rtcp_event->mutable_rtcp_packet()->set_packet_data(buffer, buffer_length);
   StoreEvent(&rtcp_event);
 }
@@ -466,6 +497,35 @@ void RtcEventLogImpl::StoreEvent(std::unique_ptr<rtclog::Event>* event) {
   helper_thread_.SignalNewEvent();
 }
 
+bool RtcEventLogImpl::StorePacket(PacketRecord::Type type,
+                                  int64_t timestamp_us,
+                                  PacketDirection direction,
+                                  MediaType media_type,
+                                  const uint8_t* data,
+                                  size_t length,
+                                  size_t packet_length) {
+  if (length > PacketRecord::kMaxDataLength)
+    return false;
+  PacketRing* ring = packet_rings_.GetRingForCurrentThread();
+  if (!ring)
+    return false;
+  PacketRecord* record = ring->BeginWrite();
+  if (!record) {
+    LOG(LS_ERROR) << "WebRTC event log queue full. Dropping event.";
+    return true;
+  }
+  record->timestamp_us = timestamp_us;
+  record->packet_length = static_cast<uint32_t>(packet_length);
+  record->data_length = static_cast<uint16_t>(length);
+  record->type = type;
+  record->incoming = direction == kIncomingPacket;
+  record->media_type = ConvertMediaType(media_type);
+  memcpy(record->data, data, length);
+  ring->EndWrite();
+  helper_thread_.SignalNewPacket();
+  return true;
+}
+
 bool RtcEventLog::ParseRtcEventLog(const std::string& file_name,
                                    rtclog::EventStream* result) {
   char tmp_buffer[1024];
@@ -479,6 +539,17 @@ bool RtcEventLog::ParseRtcEventLog(const std::string& file_name,
     dump_buffer.append(tmp_buffer, bytes_read);
   }
   dump_file->CloseFile();
+  if (IsCompactRtcEventLog(dump_buffer.data(), dump_buffer.size())) {
+    std::vector<rtclog::Event> events;
+    if (!DecodeCompactRtcEventLog(dump_buffer.data(), dump_buffer.size(),
+                                  &events)) {
+      return false;
+    }
+    result->Clear();
+    for (rtclog::Event& event : events)
+      result->add_stream()->Swap(&event);
+    return true;
+  }
   return result->ParseFromString(dump_buffer);
 }
 
@@ -495,8 +566,12 @@ bool RtcEventLogNullImpl::StartLogging(rtc::PlatformFile platform_file,
 
 // RtcEventLog member functions.
 std::unique_ptr<RtcEventLog> RtcEventLog::Create() {
+  return Create(EncodingType::kLegacy);
+}
+
+std::unique_ptr<RtcEventLog> RtcEventLog::Create(EncodingType encoding) {
 #ifdef ENABLE_RTC_EVENT_LOG
-  return std::unique_ptr<RtcEventLog>(new RtcEventLogImpl());
+  return std::unique_ptr<RtcEventLog>(new RtcEventLogImpl(encoding));
 #else
   return std::unique_ptr<RtcEventLog>(new RtcEventLogNullImpl());
 #endif  // ENABLE_RTC_EVENT_LOG
@@ -38,10 +38,22 @@ enum PacketDirection { kIncomingPacket = 0, kOutgoingPacket };
 
 class RtcEventLog {
  public:
+  // The encodings in which a log can be written.
+  enum class EncodingType {
+    // Each event is stored as a serialized rtclog::EventStream protobuf.
+    kLegacy,
+    // RTP and RTCP packets are stored in delta encoded batches, see
+    // rtc_event_log_compact_encoding.h. Much smaller, but the log can only be
+    // read by ParsedRtcEventLog and ParseRtcEventLog.
+    kCompact
+  };
+
   virtual ~RtcEventLog() {}
 
   // Factory method to create an RtcEventLog object.
   static std::unique_ptr<RtcEventLog> Create();
+  // Same as above, but writes the log in the given encoding.
+  static std::unique_ptr<RtcEventLog> Create(EncodingType encoding);
   // TODO(nisse): webrtc::Clock is deprecated. Delete this method and
   // above forward declaration of Clock when
   // webrtc/system_wrappers/include/clock.h is deleted.
@@ -119,8 +131,9 @@ class RtcEventLog {
   virtual void LogAudioNetworkAdaptation(
       const AudioNetworkAdaptor::EncoderRuntimeConfig& config) = 0;
 
-  // Reads an RtcEventLog file and returns true when reading was successful.
-  // The result is stored in the given EventStream object.
+  // Reads an RtcEventLog file, in either encoding, and returns true when
+  // reading was successful. The result is stored in the given EventStream
+  // object.
   // The order of the events in the EventStream is implementation defined.
   // The current implementation writes a LOG_START event, then the old
   // configurations, then the remaining events in timestamp order and finally
@@ -18,6 +18,7 @@
 #include "webrtc/call/call.h"
 #include "webrtc/logging/rtc_event_log/rtc_event_log.h"
 #include "webrtc/logging/rtc_event_log/rtc_event_log_parser.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_reader.h"
 #include "webrtc/modules/rtp_rtcp/source/byte_io.h"
 #include "webrtc/test/rtp_file_writer.h"
 
@@ -89,11 +90,15 @@ int main(int argc, char* argv[]) {
     RTC_CHECK(ParseSsrc(FLAGS_ssrc, &ssrc_filter))
         << "Flag verification has failed.";
 
-  webrtc::ParsedRtcEventLog parsed_stream;
-  if (!parsed_stream.ParseFile(input_file)) {
-    std::cerr << "Error while parsing input file: " << input_file << std::endl;
+  // The log is read a part at a time so that logs of any size can be
+  // converted in bounded memory.
+  const size_t kEventsPerRead = 10000;
+  webrtc::RtcEventLogReader reader;
+  if (!reader.Open(input_file)) {
+    std::cerr << "Error while opening input file: " << input_file << std::endl;
     return -1;
   }
+  webrtc::ParsedRtcEventLog parsed_stream;
 
   std::unique_ptr<webrtc::test::RtpFileWriter> rtp_writer(
       webrtc::test::RtpFileWriter::Create(
@@ -105,80 +110,90 @@ int main(int argc, char* argv[]) {
     return -1;
   }
 
-  std::cout << "Found " << parsed_stream.GetNumberOfEvents()
-            << " events in the input file." << std::endl;
+  size_t event_counter = 0;
   int rtp_counter = 0, rtcp_counter = 0;
   bool header_only = false;
-  for (size_t i = 0; i < parsed_stream.GetNumberOfEvents(); i++) {
-    // The parsed_stream will assert if the protobuf event is missing
-    // some required fields and we attempt to access them. We could consider
-    // a softer failure option, but it does not seem useful to generate
-    // RTP dumps based on broken event logs.
-    if (!FLAGS_nortp &&
-        parsed_stream.GetEventType(i) == webrtc::ParsedRtcEventLog::RTP_EVENT) {
-      webrtc::test::RtpPacket packet;
-      webrtc::PacketDirection direction;
-      webrtc::MediaType media_type;
-      parsed_stream.GetRtpHeader(i, &direction, &media_type, packet.data,
-                                 &packet.length, &packet.original_length);
-      if (packet.original_length > packet.length)
-        header_only = true;
-      packet.time_ms = parsed_stream.GetTimestamp(i) / 1000;
-
-      // TODO(terelius): Maybe add a flag to dump outgoing traffic instead?
-      if (direction == webrtc::kOutgoingPacket)
-        continue;
-      if (FLAGS_noaudio && media_type == webrtc::MediaType::AUDIO)
-        continue;
-      if (FLAGS_novideo && media_type == webrtc::MediaType::VIDEO)
-        continue;
-      if (FLAGS_nodata && media_type == webrtc::MediaType::DATA)
-        continue;
-      if (!FLAGS_ssrc.empty()) {
-        const uint32_t packet_ssrc =
-            webrtc::ByteReader<uint32_t>::ReadBigEndian(
-                reinterpret_cast<const uint8_t*>(packet.data + 8));
-        if (packet_ssrc != ssrc_filter)
+  while (reader.ReadEvents(kEventsPerRead, &parsed_stream) > 0) {
+    event_counter += parsed_stream.GetNumberOfEvents();
+    for (size_t i = 0; i < parsed_stream.GetNumberOfEvents(); i++) {
+      // The parsed_stream will assert if the protobuf event is missing
+      // some required fields and we attempt to access them. We could consider
+      // a softer failure option, but it does not seem useful to generate
+      // RTP dumps based on broken event logs.
+      if (!FLAGS_nortp &&
+          parsed_stream.GetEventType(i) ==
+              webrtc::ParsedRtcEventLog::RTP_EVENT) {
+        webrtc::test::RtpPacket packet;
+        webrtc::PacketDirection direction;
+        webrtc::MediaType media_type;
+        parsed_stream.GetRtpHeader(i, &direction, &media_type, packet.data,
+                                   &packet.length, &packet.original_length);
+        if (packet.original_length > packet.length)
+          header_only = true;
+        packet.time_ms = parsed_stream.GetTimestamp(i) / 1000;
+
+        // TODO(terelius): Maybe add a flag to dump outgoing traffic instead?
+        if (direction == webrtc::kOutgoingPacket)
+          continue;
+        if (FLAGS_noaudio && media_type == webrtc::MediaType::AUDIO)
           continue;
+        if (FLAGS_novideo && media_type == webrtc::MediaType::VIDEO)
+          continue;
+        if (FLAGS_nodata && media_type == webrtc::MediaType::DATA)
+          continue;
+        if (!FLAGS_ssrc.empty()) {
+          const uint32_t packet_ssrc =
+              webrtc::ByteReader<uint32_t>::ReadBigEndian(
+                  reinterpret_cast<const uint8_t*>(packet.data + 8));
+          if (packet_ssrc != ssrc_filter)
+            continue;
+        }
+
+        rtp_writer->WritePacket(&packet);
+        rtp_counter++;
       }
-
-      rtp_writer->WritePacket(&packet);
-      rtp_counter++;
-    }
-    if (!FLAGS_nortcp &&
-        parsed_stream.GetEventType(i) ==
-            webrtc::ParsedRtcEventLog::RTCP_EVENT) {
-      webrtc::test::RtpPacket packet;
-      webrtc::PacketDirection direction;
-      webrtc::MediaType media_type;
-      parsed_stream.GetRtcpPacket(i, &direction, &media_type, packet.data,
-                                  &packet.length);
-      // For RTCP packets the original_length should be set to 0 in the
-      // RTPdump format.
-      packet.original_length = 0;
-      packet.time_ms = parsed_stream.GetTimestamp(i) / 1000;
-
-      // TODO(terelius): Maybe add a flag to dump outgoing traffic instead?
-      if (direction == webrtc::kOutgoingPacket)
-        continue;
-      if (FLAGS_noaudio && media_type == webrtc::MediaType::AUDIO)
-        continue;
-      if (FLAGS_novideo && media_type == webrtc::MediaType::VIDEO)
-        continue;
-      if (FLAGS_nodata && media_type == webrtc::MediaType::DATA)
-        continue;
-      if (!FLAGS_ssrc.empty()) {
-        const uint32_t packet_ssrc =
-            webrtc::ByteReader<uint32_t>::ReadBigEndian(
-                reinterpret_cast<const uint8_t*>(packet.data + 4));
-        if (packet_ssrc != ssrc_filter)
+      if (!FLAGS_nortcp &&
+          parsed_stream.GetEventType(i) ==
+              webrtc::ParsedRtcEventLog::RTCP_EVENT) {
+        webrtc::test::RtpPacket packet;
+        webrtc::PacketDirection direction;
+        webrtc::MediaType media_type;
+        parsed_stream.GetRtcpPacket(i, &direction, &media_type, packet.data,
+                                    &packet.length);
+        // For RTCP packets the original_length should be set to 0 in the
+        // RTPdump format.
+        packet.original_length = 0;
+        packet.time_ms = parsed_stream.GetTimestamp(i) / 1000;
+
+        // TODO(terelius): Maybe add a flag to dump outgoing traffic instead?
+        if (direction == webrtc::kOutgoingPacket)
           continue;
+        if (FLAGS_noaudio && media_type == webrtc::MediaType::AUDIO)
+          continue;
+        if (FLAGS_novideo && media_type == webrtc::MediaType::VIDEO)
+          continue;
+        if (FLAGS_nodata && media_type == webrtc::MediaType::DATA)
+          continue;
+        if (!FLAGS_ssrc.empty()) {
+          const uint32_t packet_ssrc =
+              webrtc::ByteReader<uint32_t>::ReadBigEndian(
+                  reinterpret_cast<const uint8_t*>(packet.data + 4));
+          if (packet_ssrc != ssrc_filter)
+            continue;
+        }
+
+        rtp_writer->WritePacket(&packet);
+        rtcp_counter++;
       }
-
-      rtp_writer->WritePacket(&packet);
-      rtcp_counter++;
     }
   }
+  if (reader.error()) {
+    std::cerr << "Error while parsing input file: " << input_file << std::endl;
+    return -1;
+  }
+
+  std::cout << "Found " << event_counter << " events in the input file."
+            << std::endl;
   std::cout << "Wrote " << rtp_counter << (header_only ? " header-only" : "")
             << " RTP packets and " << rtcp_counter << " RTCP packets to the "
             << "output file." << std::endl;
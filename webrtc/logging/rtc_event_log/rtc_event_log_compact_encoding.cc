@@ -0,0 +1,519 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/logging/rtc_event_log/rtc_event_log_compact_encoding.h"
+
+#include <string.h>
+
+#include <utility>
+
+#include "webrtc/base/checks.h"
+#include "webrtc/modules/rtp_rtcp/source/byte_io.h"
+
+namespace webrtc {
+
+namespace {
+
+const char kMagic[] = "RtcEventLog";
+const size_t kMagicSize = sizeof(kMagic) - 1;
+
+enum BlockType { kEventBlock = 1, kPacketBatchBlock = 2 };
+
+// Bits of the stream descriptor.
+const uint8_t kRtcpStream = 0x01;
+const uint8_t kIncomingStream = 0x02;
+const int kMediaTypeShift = 2;
+const uint8_t kMediaTypeMask = 0x03;
+
+const size_t kRtpFixedHeaderSize = 12;
+// The first two bytes of the RTP header are stored with the bytes following
+// the fixed header, while the sequence number, RTP timestamp and SSRC are
+// stored separately.
+const size_t kRtpSeparateFieldsSize = 10;
+const size_t kMaxVarintSize = 10;
+// A batch is appended once it holds this many packets, to keep blocks small.
+const size_t kMaxPacketsPerBatch = 1000;
+// Upper bound on the size of a batch's block header and packet count.
+const size_t kMaxBatchOverhead = 4 * kMaxVarintSize;
+
+void AppendVarint(uint64_t value, std::string* output) {
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>(0x80 | (value & 0x7F)));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+
+// Zigzag encodes |value| so that values of small magnitude use few bytes.
+void AppendSignedVarint(int64_t value, std::string* output) {
+  AppendVarint((static_cast<uint64_t>(value) << 1) ^
+                   static_cast<uint64_t>(value >> 63),
+               output);
+}
+
+size_t VarintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+bool IsBatchedEvent(const rtclog::Event& event) {
+  if (event.type() == rtclog::Event::RTCP_EVENT)
+    return event.has_rtcp_packet();
+  return event.type() == rtclog::Event::RTP_EVENT && event.has_rtp_packet() &&
+         event.rtp_packet().header().size() >= kRtpFixedHeaderSize;
+}
+
+uint8_t StreamDescriptor(bool rtcp, bool incoming, rtclog::MediaType type) {
+  return (rtcp ? kRtcpStream : 0) | (incoming ? kIncomingStream : 0) |
+         static_cast<uint8_t>((type & kMediaTypeMask) << kMediaTypeShift);
+}
+
+// Reads the values written by the functions above, failing instead of
+// reading past the end of the data.
+class BlockReader {
+ public:
+  BlockReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  bool empty() const { return pos_ == size_; }
+  size_t remaining() const { return size_ - pos_; }
+
+  bool ReadVarint(uint64_t* value) {
+    *value = 0;
+    for (size_t i = 0; i < kMaxVarintSize && pos_ < size_; ++i) {
+      uint8_t byte = data_[pos_++];
+      *value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+      if ((byte & 0x80) == 0)
+        return true;
+    }
+    return false;
+  }
+
+  bool ReadSignedVarint(int64_t* value) {
+    uint64_t zigzag;
+    if (!ReadVarint(&zigzag))
+      return false;
+    *value =
+        static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    return true;
+  }
+
+  bool ReadBytes(size_t size, const uint8_t** bytes) {
+    if (size > remaining())
+      return false;
+    *bytes = data_ + pos_;
+    pos_ += size;
+    return true;
+  }
+
+ private:
+  const uint8_t* const data_;
+  const size_t size_;
+  size_t pos_ = 0;
+};
+
+struct DecodedStream {
+  uint8_t descriptor = 0;
+  uint32_t ssrc = 0;
+  uint16_t sequence_number = 0;
+  uint32_t rtp_timestamp = 0;
+  int64_t packet_length = 0;
+  std::string header_tail;
+};
+
+bool DecodePacketBatch(BlockReader* reader,
+                       std::vector<rtclog::Event>* events) {
+  uint64_t num_streams;
+  if (!reader->ReadVarint(&num_streams) || num_streams > reader->remaining())
+    return false;
+  std::vector<DecodedStream> streams(num_streams);
+  for (DecodedStream& stream : streams) {
+    const uint8_t* bytes;
+    if (!reader->ReadBytes(1, &bytes))
+      return false;
+    stream.descriptor = bytes[0];
+    if (stream.descriptor & kRtcpStream)
+      continue;
+    if (!reader->ReadBytes(4, &bytes))
+      return false;
+    stream.ssrc = ByteReader<uint32_t>::ReadBigEndian(bytes);
+  }
+
+  // Each packet takes at least two bytes, its stream index and timestamp.
+  uint64_t num_packets;
+  if (!reader->ReadVarint(&num_packets) ||
+      num_packets > reader->remaining() / 2) {
+    return false;
+  }
+  std::vector<size_t> stream_indices(num_packets);
+  for (size_t& index : stream_indices) {
+    uint64_t value;
+    if (!reader->ReadVarint(&value) || value >= num_streams)
+      return false;
+    index = value;
+  }
+
+  const size_t first = events->size();
+  events->resize(first + num_packets);
+  int64_t timestamp_us = 0;
+  for (size_t i = 0; i < num_packets; ++i) {
+    int64_t delta;
+    if (!reader->ReadSignedVarint(&delta))
+      return false;
+    timestamp_us += delta;
+    rtclog::Event& event = (*events)[first + i];
+    const DecodedStream& stream = streams[stream_indices[i]];
+    bool rtcp = (stream.descriptor & kRtcpStream) != 0;
+    bool incoming = (stream.descriptor & kIncomingStream) != 0;
+    rtclog::MediaType type = static_cast<rtclog::MediaType>(
+        (stream.descriptor >> kMediaTypeShift) & kMediaTypeMask);
+    event.set_timestamp_us(timestamp_us);
+    if (rtcp) {
+      event.set_type(rtclog::Event::RTCP_EVENT);
+      event.mutable_rtcp_packet()->set_incoming(incoming);
+      event.mutable_rtcp_packet()->set_type(type);
+    } else {
+      event.set_type(rtclog::Event::RTP_EVENT);
+      event.mutable_rtp_packet()->set_incoming(incoming);
+      event.mutable_rtp_packet()->set_type(type);
+    }
+  }
+
+  // The RTP columns, in the order they were written.
+  std::vector<uint16_t> sequence_numbers(num_packets);
+  for (size_t i = 0; i < num_packets; ++i) {
+    DecodedStream& stream = streams[stream_indices[i]];
+    if (stream.descriptor & kRtcpStream)
+      continue;
+    int64_t delta;
+    if (!reader->ReadSignedVarint(&delta))
+      return false;
+    stream.sequence_number += static_cast<uint16_t>(delta);
+    sequence_numbers[i] = stream.sequence_number;
+  }
+  std::vector<uint32_t> rtp_timestamps(num_packets);
+  for (size_t i = 0; i < num_packets; ++i) {
+    DecodedStream& stream = streams[stream_indices[i]];
+    if (stream.descriptor & kRtcpStream)
+      continue;
+    int64_t delta;
+    if (!reader->ReadSignedVarint(&delta))
+      return false;
+    stream.rtp_timestamp += static_cast<uint32_t>(delta);
+    rtp_timestamps[i] = stream.rtp_timestamp;
+  }
+  std::vector<uint32_t> packet_lengths(num_packets);
+  for (size_t i = 0; i < num_packets; ++i) {
+    DecodedStream& stream = streams[stream_indices[i]];
+    if (stream.descriptor & kRtcpStream)
+      continue;
+    int64_t delta;
+    if (!reader->ReadSignedVarint(&delta))
+      return false;
+    stream.packet_length += delta;
+    packet_lengths[i] = static_cast<uint32_t>(stream.packet_length);
+  }
+  uint8_t header[kRtpFixedHeaderSize];
+  for (size_t i = 0; i < num_packets; ++i) {
+    DecodedStream& stream = streams[stream_indices[i]];
+    if (stream.descriptor & kRtcpStream)
+      continue;
+    uint64_t header_length;
+    if (!reader->ReadVarint(&header_length) ||
+        header_length < kRtpFixedHeaderSize ||
+        header_length > reader->remaining() * 8 + kRtpFixedHeaderSize) {
+      return false;
+    }
+    size_t tail_size = header_length - kRtpSeparateFieldsSize;
+    const uint8_t* mask;
+    if (!reader->ReadBytes((tail_size + 7) / 8, &mask))
+      return false;
+    stream.header_tail.resize(tail_size, 0);
+    for (size_t j = 0; j < tail_size; ++j) {
+      if ((mask[j / 8] & (1 << (j % 8))) == 0)
+        continue;
+      const uint8_t* byte;
+      if (!reader->ReadBytes(1, &byte))
+        return false;
+      stream.header_tail[j] = static_cast<char>(*byte);
+    }
+
+    rtclog::RtpPacket* packet = (*events)[first + i].mutable_rtp_packet();
+    memcpy(header, stream.header_tail.data(), 2);
+    ByteWriter<uint16_t>::WriteBigEndian(header + 2, sequence_numbers[i]);
+    ByteWriter<uint32_t>::WriteBigEndian(header + 4, rtp_timestamps[i]);
+    ByteWriter<uint32_t>::WriteBigEndian(header + 8, stream.ssrc);
+    std::string* header_bytes = packet->mutable_header();
+    header_bytes->assign(reinterpret_cast<const char*>(header),
+                         kRtpFixedHeaderSize);
+    header_bytes->append(stream.header_tail, 2, std::string::npos);
+    packet->set_packet_length(packet_lengths[i]);
+  }
+
+  // The RTCP column.
+  for (size_t i = 0; i < num_packets; ++i) {
+    if ((streams[stream_indices[i]].descriptor & kRtcpStream) == 0)
+      continue;
+    uint64_t length;
+    const uint8_t* data;
+    if (!reader->ReadVarint(&length) || !reader->ReadBytes(length, &data))
+      return false;
+    (*events)[first + i].mutable_rtcp_packet()->set_packet_data(data, length);
+  }
+  return reader->empty();
+}
+
+}  // namespace
+
+struct RtcEventLogCompactEncoder::Stream {
+  uint8_t descriptor;
+  uint32_t ssrc;
+  uint16_t last_sequence_number;
+  uint32_t last_rtp_timestamp;
+  int64_t last_packet_length;
+  std::string last_header_tail;
+};
+
+RtcEventLogCompactEncoder::RtcEventLogCompactEncoder()
+    : num_packets_(0), last_timestamp_us_(0) {}
+
+RtcEventLogCompactEncoder::~RtcEventLogCompactEncoder() {}
+
+// static
+void RtcEventLogCompactEncoder::EncodeHeader(std::string* output) {
+  output->append(kMagic, kMagicSize);
+  AppendVarint(kCompactEncodingVersion, output);
+}
+
+void RtcEventLogCompactEncoder::Encode(const rtclog::Event& event,
+                                       std::string* output) {
+  if (!IsBatchedEvent(event)) {
+    // Keep the events in order.
+    Flush(output);
+    AppendVarint(kEventBlock, output);
+    AppendVarint(event.ByteSize(), output);
+    event.AppendToString(output);
+    return;
+  }
+
+  size_t index = FindOrAddStream(event);
+  AppendVarint(index, &stream_indices_);
+  AppendSignedVarint(event.timestamp_us() - last_timestamp_us_, &timestamps_);
+  last_timestamp_us_ = event.timestamp_us();
+  if (event.type() == rtclog::Event::RTP_EVENT) {
+    AddRtpPacket(event.rtp_packet(), &streams_[index]);
+  } else {
+    const std::string& data = event.rtcp_packet().packet_data();
+    AppendVarint(data.size(), &rtcp_packets_);
+    rtcp_packets_.append(data);
+  }
+  if (++num_packets_ >= kMaxPacketsPerBatch)
+    Flush(output);
+}
+
+void RtcEventLogCompactEncoder::Flush(std::string* output) {
+  if (num_packets_ == 0)
+    return;
+  size_t payload_size =
+      VarintSize(streams_.size()) + stream_table_.size() +
+      VarintSize(num_packets_) + stream_indices_.size() + timestamps_.size() +
+      sequence_numbers_.size() + rtp_timestamps_.size() +
+      packet_lengths_.size() + rtp_headers_.size() + rtcp_packets_.size();
+  AppendVarint(kPacketBatchBlock, output);
+  AppendVarint(payload_size, output);
+  AppendVarint(streams_.size(), output);
+  output->append(stream_table_);
+  AppendVarint(num_packets_, output);
+  output->append(stream_indices_);
+  output->append(timestamps_);
+  output->append(sequence_numbers_);
+  output->append(rtp_timestamps_);
+  output->append(packet_lengths_);
+  output->append(rtp_headers_);
+  output->append(rtcp_packets_);
+
+  // Clearing keeps the capacity, so that the next batches don't allocate.
+  streams_.clear();
+  num_packets_ = 0;
+  last_timestamp_us_ = 0;
+  stream_table_.clear();
+  stream_indices_.clear();
+  timestamps_.clear();
+  sequence_numbers_.clear();
+  rtp_timestamps_.clear();
+  packet_lengths_.clear();
+  rtp_headers_.clear();
+  rtcp_packets_.clear();
+}
+
+size_t RtcEventLogCompactEncoder::PendingSize() const {
+  if (num_packets_ == 0)
+    return 0;
+  return kMaxBatchOverhead + stream_table_.size() + stream_indices_.size() +
+         timestamps_.size() + sequence_numbers_.size() +
+         rtp_timestamps_.size() + packet_lengths_.size() +
+         rtp_headers_.size() + rtcp_packets_.size();
+}
+
+size_t RtcEventLogCompactEncoder::MaxEncodedSize(
+    const rtclog::Event& event) const {
+  if (!IsBatchedEvent(event))
+    return 2 * kMaxVarintSize + event.ByteSize();
+  // A new stream, the stream index and the timestamp.
+  size_t size = 5 + 2 * kMaxVarintSize;
+  if (num_packets_ == 0)
+    size += kMaxBatchOverhead;
+  if (event.type() == rtclog::Event::RTP_EVENT) {
+    size_t tail_size =
+        event.rtp_packet().header().size() - kRtpSeparateFieldsSize;
+    size += 4 * kMaxVarintSize + (tail_size + 7) / 8 + tail_size;
+  } else {
+    size += kMaxVarintSize + event.rtcp_packet().packet_data().size();
+  }
+  return size;
+}
+
+size_t RtcEventLogCompactEncoder::FindOrAddStream(const rtclog::Event& event) {
+  bool rtcp = event.type() == rtclog::Event::RTCP_EVENT;
+  uint8_t descriptor;
+  uint32_t ssrc = 0;
+  if (rtcp) {
+    descriptor = StreamDescriptor(true, event.rtcp_packet().incoming(),
+                                  event.rtcp_packet().type());
+  } else {
+    descriptor = StreamDescriptor(false, event.rtp_packet().incoming(),
+                                  event.rtp_packet().type());
+    const std::string& header = event.rtp_packet().header();
+    ssrc = ByteReader<uint32_t>::ReadBigEndian(
+        reinterpret_cast<const uint8_t*>(header.data()) + 8);
+  }
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    if (streams_[i].descriptor == descriptor && streams_[i].ssrc == ssrc)
+      return i;
+  }
+
+  Stream stream;
+  stream.descriptor = descriptor;
+  stream.ssrc = ssrc;
+  stream.last_sequence_number = 0;
+  stream.last_rtp_timestamp = 0;
+  stream.last_packet_length = 0;
+  streams_.push_back(std::move(stream));
+  stream_table_.push_back(static_cast<char>(descriptor));
+  if (!rtcp) {
+    uint8_t ssrc_bytes[4];
+    ByteWriter<uint32_t>::WriteBigEndian(ssrc_bytes, ssrc);
+    stream_table_.append(reinterpret_cast<const char*>(ssrc_bytes), 4);
+  }
+  return streams_.size() - 1;
+}
+
+void RtcEventLogCompactEncoder::AddRtpPacket(const rtclog::RtpPacket& packet,
+                                             Stream* stream) {
+  const std::string& header = packet.header();
+  const uint8_t* header_data = reinterpret_cast<const uint8_t*>(header.data());
+  uint16_t sequence_number =
+      ByteReader<uint16_t>::ReadBigEndian(header_data + 2);
+  uint32_t rtp_timestamp = ByteReader<uint32_t>::ReadBigEndian(header_data + 4);
+  AppendSignedVarint(static_cast<int16_t>(static_cast<uint16_t>(
+                         sequence_number - stream->last_sequence_number)),
+                     &sequence_numbers_);
+  AppendSignedVarint(static_cast<int32_t>(rtp_timestamp -
+                                          stream->last_rtp_timestamp),
+                     &rtp_timestamps_);
+  AppendSignedVarint(packet.packet_length() - stream->last_packet_length,
+                     &packet_lengths_);
+  stream->last_sequence_number = sequence_number;
+  stream->last_rtp_timestamp = rtp_timestamp;
+  stream->last_packet_length = packet.packet_length();
+
+  header_tail_.assign(header, 0, 2);
+  header_tail_.append(header, kRtpFixedHeaderSize, std::string::npos);
+  AppendVarint(header.size(), &rtp_headers_);
+  size_t mask_pos = rtp_headers_.size();
+  rtp_headers_.append((header_tail_.size() + 7) / 8, 0);
+  const std::string& last_tail = stream->last_header_tail;
+  for (size_t i = 0; i < header_tail_.size(); ++i) {
+    char last = i < last_tail.size() ? last_tail[i] : 0;
+    if (header_tail_[i] == last)
+      continue;
+    rtp_headers_[mask_pos + i / 8] |= static_cast<char>(1 << (i % 8));
+    rtp_headers_.push_back(header_tail_[i]);
+  }
+  stream->last_header_tail.swap(header_tail_);
+}
+
+bool IsCompactRtcEventLog(const char* data, size_t size) {
+  return size > 0 && data[0] == kMagic[0];
+}
+
+size_t DecodeCompactRtcEventLogHeader(const char* data, size_t size) {
+  if (size < kMagicSize || memcmp(data, kMagic, kMagicSize) != 0)
+    return 0;
+  BlockReader reader(reinterpret_cast<const uint8_t*>(data) + kMagicSize,
+                     size - kMagicSize);
+  uint64_t version;
+  if (!reader.ReadVarint(&version) || version != kCompactEncodingVersion)
+    return 0;
+  return size - reader.remaining();
+}
+
+size_t DecodeCompactRtcEventLogBlock(const char* data,
+                                     size_t size,
+                                     std::vector<rtclog::Event>* events) {
+  BlockReader reader(reinterpret_cast<const uint8_t*>(data), size);
+  uint64_t block_type;
+  uint64_t block_size;
+  const uint8_t* block;
+  if (!reader.ReadVarint(&block_type) || !reader.ReadVarint(&block_size) ||
+      !reader.ReadBytes(block_size, &block)) {
+    return 0;
+  }
+  switch (block_type) {
+    case kEventBlock: {
+      rtclog::Event event;
+      if (!event.ParseFromArray(block, static_cast<int>(block_size)))
+        return 0;
+      events->push_back(std::move(event));
+      break;
+    }
+    case kPacketBatchBlock: {
+      BlockReader block_reader(block, block_size);
+      if (!DecodePacketBatch(&block_reader, events))
+        return 0;
+      break;
+    }
+    default:
+      // Skip blocks added by later revisions of the encoding.
+      break;
+  }
+  return size - reader.remaining();
+}
+
+bool DecodeCompactRtcEventLog(const char* data,
+                              size_t size,
+                              std::vector<rtclog::Event>* events) {
+  size_t offset = DecodeCompactRtcEventLogHeader(data, size);
+  if (offset == 0)
+    return false;
+  while (offset < size) {
+    size_t block_size =
+        DecodeCompactRtcEventLogBlock(data + offset, size - offset, events);
+    if (block_size == 0)
+      return false;
+    offset += block_size;
+  }
+  return true;
+}
+
+}  // namespace webrtc
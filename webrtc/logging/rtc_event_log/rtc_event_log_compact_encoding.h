@@ -0,0 +1,130 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_COMPACT_ENCODING_H_
+#define WEBRTC_LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_COMPACT_ENCODING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/ignore_wundef.h"
+
+// Files generated at build-time by the protobuf compiler.
+RTC_PUSH_IGNORING_WUNDEF()
+#ifdef WEBRTC_ANDROID_PLATFORM_BUILD
+#include "external/webrtc/webrtc/logging/rtc_event_log/rtc_event_log.pb.h"
+#else
+#include "webrtc/logging/rtc_event_log/rtc_event_log.pb.h"
+#endif
+RTC_POP_IGNORING_WUNDEF()
+
+namespace webrtc {
+
+// The compact encoding of the RtcEventLog. A log starts with a header, which
+// holds a magic string and the version of the encoding, followed by blocks.
+// Each block is a varint block type, a varint payload length and the payload.
+//
+// RTP and RTCP events, which make up most of a log, are stored in packet
+// batch blocks. A batch starts with a table of the streams it refers to, an
+// RTP stream being identified by its direction, media type and SSRC and an
+// RTCP stream by its direction and media type. It then stores the events in
+// columns: the stream indices, the timestamps, then for the RTP packets the
+// sequence numbers, RTP timestamps, packet lengths and the remaining header
+// bytes, and finally the RTCP packets. Timestamps are deltas from the previous
+// event and the RTP fields are deltas from the previous packet of the same
+// stream, all varint encoded. The remaining header bytes (the first two bytes,
+// the CSRCs and the header extensions) are stored as a bitmask of the bytes
+// that differ from the previous header of the stream followed by those bytes.
+// Each batch can be decoded on its own.
+//
+// The other events are stored individually as serialized rtclog::Event
+// protobufs in event blocks. Blocks are written in the order in which the
+// events were logged.
+
+// The version written in the header.
+const int kCompactEncodingVersion = 2;
+
+class RtcEventLogCompactEncoder {
+ public:
+  RtcEventLogCompactEncoder();
+  ~RtcEventLogCompactEncoder();
+
+  // Appends the header that starts a log.
+  static void EncodeHeader(std::string* output);
+
+  // Appends |event| to |output|. RTP and RTCP events are added to the current
+  // batch instead, which is appended once it is full, when another type of
+  // event is encoded, or when Flush() is called.
+  void Encode(const rtclog::Event& event, std::string* output);
+
+  // Appends the current batch to |output|, if there is one.
+  void Flush(std::string* output);
+
+  // Upper bound on the number of bytes the current batch will take once
+  // appended.
+  size_t PendingSize() const;
+
+  // Upper bound on the number of bytes Encode(event) adds to the size of
+  // |output| plus PendingSize().
+  size_t MaxEncodedSize(const rtclog::Event& event) const;
+
+ private:
+  struct Stream;
+
+  size_t FindOrAddStream(const rtclog::Event& event);
+  void AddRtpPacket(const rtclog::RtpPacket& packet, Stream* stream);
+
+  std::vector<Stream> streams_;
+  size_t num_packets_;
+  int64_t last_timestamp_us_;
+  // The stream table and the columns of the current batch.
+  std::string stream_table_;
+  std::string stream_indices_;
+  std::string timestamps_;
+  std::string sequence_numbers_;
+  std::string rtp_timestamps_;
+  std::string packet_lengths_;
+  std::string rtp_headers_;
+  std::string rtcp_packets_;
+  // Scratch space for the remaining header bytes of an RTP packet.
+  std::string header_tail_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RtcEventLogCompactEncoder);
+};
+
+// Returns true if |data| looks like a log in the compact encoding. Logs in the
+// protobuf based encoding start with a field tag that differs from the first
+// byte of the header, so only the first byte is checked.
+bool IsCompactRtcEventLog(const char* data, size_t size);
+
+// Decodes the header at the start of a log in the compact encoding. Returns
+// the size of the header, or 0 if |data| doesn't start with the header of a
+// supported version.
+size_t DecodeCompactRtcEventLogHeader(const char* data, size_t size);
+
+// Decodes the block at the start of |data| and appends its events to
+// |events|. Returns the size of the block, or 0 if it is malformed.
+size_t DecodeCompactRtcEventLogBlock(const char* data,
+                                     size_t size,
+                                     std::vector<rtclog::Event>* events);
+
+// Decodes a log in the compact encoding and appends its events to |events|.
+// Returns false if the log is malformed or of an unsupported version.
+bool DecodeCompactRtcEventLog(const char* data,
+                              size_t size,
+                              std::vector<rtclog::Event>* events);
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_COMPACT_ENCODING_H_
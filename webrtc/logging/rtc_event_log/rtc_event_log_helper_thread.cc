@@ -12,8 +12,10 @@
 
 #include <algorithm>
 
+#include "webrtc/base/atomicops.h"
 #include "webrtc/base/checks.h"
 #include "webrtc/base/timeutils.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_compact_encoding.h"
 #include "webrtc/system_wrappers/include/logging.h"
 
 #ifdef ENABLE_RTC_EVENT_LOG
@@ -30,14 +32,38 @@ bool IsConfigEvent(const rtclog::Event& event) {
          event_type == rtclog::Event::AUDIO_RECEIVER_CONFIG_EVENT ||
          event_type == rtclog::Event::AUDIO_SENDER_CONFIG_EVENT;
 }
+
+void ConvertPacketRecord(const PacketRecord& record, rtclog::Event* event) {
+  event->Clear();
+  event->set_timestamp_us(record.timestamp_us);
+  rtclog::MediaType media_type =
+      static_cast<rtclog::MediaType>(record.media_type);
+  if (record.type == PacketRecord::kRtp) {
+    event->set_type(rtclog::Event::RTP_EVENT);
+    rtclog::RtpPacket* rtp_packet = event->mutable_rtp_packet();
+    rtp_packet->set_incoming(record.incoming);
+    rtp_packet->set_type(media_type);
+    rtp_packet->set_packet_length(record.packet_length);
+    rtp_packet->set_header(record.data, record.data_length);
+  } else {
+    event->set_type(rtclog::Event::RTCP_EVENT);
+    rtclog::RtcpPacket* rtcp_packet = event->mutable_rtcp_packet();
+    rtcp_packet->set_incoming(record.incoming);
+    rtcp_packet->set_type(media_type);
+    rtcp_packet->set_packet_data(record.data, record.data_length);
+  }
+}
 }  // namespace
 
 // RtcEventLogImpl member functions.
 RtcEventLogHelperThread::RtcEventLogHelperThread(
     SwapQueue<ControlMessage>* message_queue,
-    SwapQueue<std::unique_ptr<rtclog::Event>>* event_queue)
+    SwapQueue<std::unique_ptr<rtclog::Event>>* event_queue,
+    PacketRingSet* packet_rings,
+    RtcEventLog::EncodingType encoding)
     : message_queue_(message_queue),
       event_queue_(event_queue),
+      packet_rings_(packet_rings),
       history_(kEventsInHistory),
       config_history_(),
       file_(FileWrapper::Create()),
@@ -48,12 +74,18 @@ RtcEventLogHelperThread::RtcEventLogHelperThread(
       stop_time_(std::numeric_limits<int64_t>::max()),
       has_recent_event_(false),
       most_recent_event_(),
+      packet_event_ring_(nullptr),
+      hibernating_(0),
       output_string_(),
+      compact_encoder_(encoding == RtcEventLog::EncodingType::kCompact
+                           ? new RtcEventLogCompactEncoder()
+                           : nullptr),
       wake_periodically_(false, false),
       wake_from_hibernation_(false, false),
       file_finished_(false, false) {
   RTC_DCHECK(message_queue_);
   RTC_DCHECK(event_queue_);
+  RTC_DCHECK(packet_rings_);
   thread_.Start();
 }
 
@@ -85,7 +117,90 @@ void RtcEventLogHelperThread::SignalNewEvent() {
   wake_from_hibernation_.Set();
 }
 
+void RtcEventLogHelperThread::SignalNewPacket() {
+  // PacketRing::EndWrite() is a full barrier, so either this load sees
+  // |hibernating_| set or the output thread sees the new record before it
+  // hibernates.
+  if (rtc::AtomicOps::AcquireLoad(&hibernating_) &&
+      rtc::AtomicOps::CompareAndSwap(&hibernating_, 1, 0) == 1) {
+    wake_from_hibernation_.Set();
+  }
+}
+
+rtclog::Event* RtcEventLogHelperThread::PeekEvent() {
+  if (!has_recent_event_) {
+    has_recent_event_ = event_queue_->Remove(&most_recent_event_);
+  }
+  if (!packet_event_ring_) {
+    const PacketRecord* oldest_record = nullptr;
+    for (size_t i = 0; i < PacketRingSet::kMaxRings; ++i) {
+      PacketRing* ring = packet_rings_->ring(i);
+      if (!ring)
+        break;
+      const PacketRecord* record = ring->Front();
+      if (record && (!oldest_record ||
+                     record->timestamp_us < oldest_record->timestamp_us)) {
+        oldest_record = record;
+        packet_event_ring_ = ring;
+      }
+    }
+    if (oldest_record)
+      ConvertPacketRecord(*oldest_record, &packet_event_);
+  }
+  if (packet_event_ring_ &&
+      (!has_recent_event_ ||
+       packet_event_.timestamp_us() < most_recent_event_->timestamp_us())) {
+    return &packet_event_;
+  }
+  return has_recent_event_ ? most_recent_event_.get() : nullptr;
+}
+
+void RtcEventLogHelperThread::PopEvent(rtclog::Event* event) {
+  if (event == &packet_event_) {
+    packet_event_ring_->PopFront();
+    packet_event_ring_ = nullptr;
+  } else {
+    RTC_DCHECK(has_recent_event_);
+    has_recent_event_ = false;
+  }
+}
+
+std::unique_ptr<rtclog::Event> RtcEventLogHelperThread::TakeEvent(
+    rtclog::Event* event) {
+  std::unique_ptr<rtclog::Event> taken_event;
+  if (event == &packet_event_) {
+    taken_event.reset(new rtclog::Event());
+    taken_event->Swap(&packet_event_);
+  } else {
+    taken_event = std::move(most_recent_event_);
+  }
+  PopEvent(event);
+  return taken_event;
+}
+
+bool RtcEventLogHelperThread::HasPendingPackets() {
+  if (packet_event_ring_)
+    return true;
+  for (size_t i = 0; i < PacketRingSet::kMaxRings; ++i) {
+    PacketRing* ring = packet_rings_->ring(i);
+    if (!ring)
+      break;
+    if (ring->Front())
+      return true;
+  }
+  return false;
+}
+
 bool RtcEventLogHelperThread::AppendEventToString(rtclog::Event* event) {
+  if (compact_encoder_) {
+    size_t max_size = output_string_.size() + compact_encoder_->PendingSize() +
+                      compact_encoder_->MaxEncodedSize(*event);
+    if (written_bytes_ + static_cast<int64_t>(max_size) > max_size_bytes_)
+      return true;
+    compact_encoder_->Encode(*event, &output_string_);
+    return false;
+  }
+
   rtclog::EventStream event_stream;
   event_stream.add_stream();
   event_stream.mutable_stream(0)->Swap(event);
@@ -104,6 +219,11 @@ bool RtcEventLogHelperThread::AppendEventToString(rtclog::Event* event) {
   return stop;
 }
 
+void RtcEventLogHelperThread::FlushCompactEncoder() {
+  if (compact_encoder_)
+    compact_encoder_->Flush(&output_string_);
+}
+
 bool RtcEventLogHelperThread::LogToMemory() {
   RTC_DCHECK(!file_->is_open());
   bool message_received = false;
@@ -111,17 +231,14 @@ bool RtcEventLogHelperThread::LogToMemory() {
   // Process each event earlier than the current time and append it to the
   // appropriate history_.
   int64_t current_time = rtc::TimeMicros();
-  if (!has_recent_event_) {
-    has_recent_event_ = event_queue_->Remove(&most_recent_event_);
-  }
-  while (has_recent_event_ &&
-         most_recent_event_->timestamp_us() <= current_time) {
-    if (IsConfigEvent(*most_recent_event_)) {
-      config_history_.push_back(std::move(most_recent_event_));
+  rtclog::Event* event = PeekEvent();
+  while (event && event->timestamp_us() <= current_time) {
+    if (IsConfigEvent(*event)) {
+      config_history_.push_back(TakeEvent(event));
     } else {
-      history_.push_back(std::move(most_recent_event_));
+      history_.push_back(TakeEvent(event));
     }
-    has_recent_event_ = event_queue_->Remove(&most_recent_event_);
+    event = PeekEvent();
     message_received = true;
   }
   return message_received;
@@ -131,6 +248,8 @@ void RtcEventLogHelperThread::StartLogFile() {
   RTC_DCHECK(file_->is_open());
   bool stop = false;
   output_string_.clear();
+  if (compact_encoder_)
+    RtcEventLogCompactEncoder::EncodeHeader(&output_string_);
 
   // Create and serialize the LOG_START event.
   rtclog::Event start_event;
@@ -150,6 +269,7 @@ void RtcEventLogHelperThread::StartLogFile() {
       history_.pop_front();
     }
   }
+  FlushCompactEncoder();
 
   // Write to file.
   if (!file_->Write(output_string_.data(), output_string_.size())) {
@@ -180,21 +300,21 @@ bool RtcEventLogHelperThread::LogToFile() {
   // to the output_string_.
   int64_t current_time = rtc::TimeMicros();
   int64_t time_limit = std::min(current_time, stop_time_);
-  if (!has_recent_event_) {
-    has_recent_event_ = event_queue_->Remove(&most_recent_event_);
-  }
+  rtclog::Event* event = PeekEvent();
   bool stop = false;
-  while (!stop && has_recent_event_ &&
-         most_recent_event_->timestamp_us() <= time_limit) {
-    stop = AppendEventToString(most_recent_event_.get());
+  while (!stop && event && event->timestamp_us() <= time_limit) {
+    stop = AppendEventToString(event);
     if (!stop) {
-      if (IsConfigEvent(*most_recent_event_)) {
-        config_history_.push_back(std::move(most_recent_event_));
+      if (IsConfigEvent(*event)) {
+        config_history_.push_back(TakeEvent(event));
+      } else {
+        PopEvent(event);
       }
-      has_recent_event_ = event_queue_->Remove(&most_recent_event_);
+      event = PeekEvent();
     }
     message_received = true;
   }
+  FlushCompactEncoder();
 
   // Write string to file.
   if (!file_->Write(output_string_.data(), output_string_.size())) {
@@ -209,8 +329,7 @@ bool RtcEventLogHelperThread::LogToFile() {
   // want to stop logging if the remaining events are more recent than the
   // time limit, or in other words if we have terminated the loop despite
   // having more events in the queue.
-  if ((has_recent_event_ && most_recent_event_->timestamp_us() > stop_time_) ||
-      stop) {
+  if ((event && event->timestamp_us() > stop_time_) || stop) {
     RTC_DCHECK(file_->is_open());
     StopLogFile();
   }
@@ -229,6 +348,7 @@ void RtcEventLogHelperThread::StopLogFile() {
       std::min(stop_time_, rtc::TimeMicros()));
   end_event.set_type(rtclog::Event::LOG_END);
   AppendEventToString(&end_event);
+  FlushCompactEncoder();
 
   if (written_bytes_ + static_cast<int64_t>(output_string_.size()) <=
       max_size_bytes_) {
@@ -302,7 +422,15 @@ void RtcEventLogHelperThread::ProcessEvents() {
     if (message_received) {
       wake_periodically_.Wait(100);
     } else {
-      wake_from_hibernation_.Wait(rtc::Event::kForever);
+      // Threads logging packets only signal the thread while |hibernating_|
+      // is set, so the rings are checked once more after setting it.
+      rtc::AtomicOps::CompareAndSwap(&hibernating_, 0, 1);
+      if (HasPendingPackets()) {
+        wake_periodically_.Wait(100);
+      } else {
+        wake_from_hibernation_.Wait(rtc::Event::kForever);
+      }
+      rtc::AtomicOps::ReleaseStore(&hibernating_, 0);
     }
   }
 }
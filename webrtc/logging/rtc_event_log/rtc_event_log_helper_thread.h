@@ -23,6 +23,8 @@
 #include "webrtc/base/platform_thread.h"
 #include "webrtc/base/swap_queue.h"
 #include "webrtc/logging/rtc_event_log/ringbuffer.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_packet_ring.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log.h"
 #include "webrtc/system_wrappers/include/file_wrapper.h"
 
 #ifdef ENABLE_RTC_EVENT_LOG
@@ -40,6 +42,8 @@ RTC_POP_IGNORING_WUNDEF()
 
 namespace webrtc {
 
+class RtcEventLogCompactEncoder;
+
 class RtcEventLogHelperThread final {
  public:
   struct ControlMessage {
@@ -68,7 +72,9 @@ class RtcEventLogHelperThread final {
 
   RtcEventLogHelperThread(
       SwapQueue<ControlMessage>* message_queue,
-      SwapQueue<std::unique_ptr<rtclog::Event>>* event_queue);
+      SwapQueue<std::unique_ptr<rtclog::Event>>* event_queue,
+      PacketRingSet* packet_rings,
+      RtcEventLog::EncodingType encoding);
   ~RtcEventLogHelperThread();
 
   // This function MUST be called once a STOP_FILE message is added to the
@@ -80,10 +86,26 @@ class RtcEventLogHelperThread final {
   // This fuction MUST be called once an event is added to the event queue.
   void SignalNewEvent();
 
+  // This function MUST be called once a record is added to one of the packet
+  // rings. It only wakes the output thread if it is hibernating, since
+  // otherwise the output thread reads the rings on its own.
+  void SignalNewPacket();
+
  private:
   static bool ThreadOutputFunction(void* obj);
 
+  // Returns the oldest pending event, taken either from the event queue or
+  // from the packet rings, or null if there is none. The event remains
+  // pending until it is removed with PopEvent() or TakeEvent().
+  rtclog::Event* PeekEvent();
+  void PopEvent(rtclog::Event* event);
+  std::unique_ptr<rtclog::Event> TakeEvent(rtclog::Event* event);
+  bool HasPendingPackets();
+
   bool AppendEventToString(rtclog::Event* event);
+  // Appends the events batched by |compact_encoder_|, if any, to
+  // |output_string_|.
+  void FlushCompactEncoder();
   bool LogToMemory();
   void StartLogFile();
   bool LogToFile();
@@ -93,6 +115,7 @@ class RtcEventLogHelperThread final {
   // Message queues for passing events to the logging thread.
   SwapQueue<ControlMessage>* message_queue_;
   SwapQueue<std::unique_ptr<rtclog::Event>>* event_queue_;
+  PacketRingSet* packet_rings_;
 
   // History containing the most recent events (~ 10 s).
   RingBuffer<std::unique_ptr<rtclog::Event>> history_;
@@ -111,9 +134,21 @@ class RtcEventLogHelperThread final {
   bool has_recent_event_;
   std::unique_ptr<rtclog::Event> most_recent_event_;
 
+  // The event built from the front record of |packet_event_ring_|, which is
+  // the oldest record of all the rings. Null if it hasn't been built.
+  PacketRing* packet_event_ring_;
+  rtclog::Event packet_event_;
+
+  // Set while the output thread hibernates and packet records need to be
+  // signalled. Accessed with rtc::AtomicOps.
+  volatile int hibernating_;
+
   // Temporary space for serializing profobuf data.
   std::string output_string_;
 
+  // Encodes the events when writing the compact encoding, null otherwise.
+  std::unique_ptr<RtcEventLogCompactEncoder> compact_encoder_;
+
   rtc::Event wake_periodically_;
   rtc::Event wake_from_hibernation_;
   rtc::Event file_finished_;
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/logging/rtc_event_log/rtc_event_log_packet_ring.h"
+
+#include "webrtc/base/atomicops.h"
+#include "webrtc/base/checks.h"
+#include "webrtc/base/platform_thread.h"
+
+namespace webrtc {
+
+const size_t PacketRecord::kMaxDataLength;
+const size_t PacketRingSet::kMaxRings;
+
+PacketRing::PacketRing(rtc::PlatformThreadRef owner, size_t capacity)
+    : owner_(owner),
+      num_slots_(static_cast<int>(capacity) + 1),
+      records_(new PacketRecord[capacity + 1]),
+      write_index_(0),
+      read_index_(0) {
+  RTC_DCHECK_GT(capacity, 0u);
+}
+
+PacketRing::~PacketRing() {}
+
+PacketRecord* PacketRing::BeginWrite() {
+  if (Next(write_index_) == rtc::AtomicOps::AcquireLoad(&read_index_))
+    return nullptr;
+  return &records_[write_index_];
+}
+
+void PacketRing::EndWrite() {
+  // The compare-and-swap always succeeds since there is a single producer.
+  // It publishes the record, and as a full barrier it orders the store before
+  // any load the producer does next; see RtcEventLogHelperThread.
+  int index = write_index_;
+  rtc::AtomicOps::CompareAndSwap(&write_index_, index, Next(index));
+}
+
+const PacketRecord* PacketRing::Front() const {
+  if (rtc::AtomicOps::AcquireLoad(&write_index_) == read_index_)
+    return nullptr;
+  return &records_[read_index_];
+}
+
+void PacketRing::PopFront() {
+  RTC_DCHECK(Front());
+  rtc::AtomicOps::ReleaseStore(&read_index_, Next(read_index_));
+}
+
+PacketRingSet::PacketRingSet(size_t ring_capacity)
+    : ring_capacity_(ring_capacity) {
+  for (size_t i = 0; i < kMaxRings; ++i)
+    rings_[i] = nullptr;
+}
+
+PacketRingSet::~PacketRingSet() {
+  for (size_t i = 0; i < kMaxRings; ++i)
+    delete rings_[i];
+}
+
+PacketRing* PacketRingSet::GetRingForCurrentThread() {
+  const rtc::PlatformThreadRef current_thread = rtc::CurrentThreadRef();
+  std::unique_ptr<PacketRing> new_ring;
+  for (size_t i = 0; i < kMaxRings; ++i) {
+    PacketRing* ring = rtc::AtomicOps::AcquireLoadPtr(&rings_[i]);
+    if (!ring) {
+      if (!new_ring)
+        new_ring.reset(new PacketRing(current_thread, ring_capacity_));
+      ring = rtc::AtomicOps::CompareAndSwapPtr(
+          &rings_[i], static_cast<PacketRing*>(nullptr), new_ring.get());
+      if (!ring)
+        return new_ring.release();
+      // Another thread created ring |i| first.
+    }
+    if (rtc::IsThreadRefEqual(ring->owner(), current_thread))
+      return ring;
+  }
+  return nullptr;
+}
+
+PacketRing* PacketRingSet::ring(size_t index) {
+  RTC_DCHECK_LT(index, kMaxRings);
+  return rtc::AtomicOps::AcquireLoadPtr(&rings_[index]);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_PACKET_RING_H_
+#define WEBRTC_LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_PACKET_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/platform_thread_types.h"
+
+namespace webrtc {
+
+// An RTP header or RTCP packet, as logged by the thread which sends or
+// receives it. Records have a fixed size so that logging a packet doesn't
+// allocate; the rtclog::Event is built from the record by the logging thread.
+struct PacketRecord {
+  enum Type : uint8_t { kRtp, kRtcp };
+  static const size_t kMaxDataLength = 108;
+
+  int64_t timestamp_us;
+  // Length of the whole RTP packet, unused for RTCP.
+  uint32_t packet_length;
+  uint16_t data_length;
+  Type type;
+  bool incoming;
+  // The rtclog::MediaType of the packet.
+  uint8_t media_type;
+  // The RTP header or the RTCP packet.
+  uint8_t data[kMaxDataLength];
+};
+
+// A fixed-capacity queue of PacketRecords with one producer thread, the owner
+// of the ring, and one consumer thread. Neither side locks or allocates.
+class PacketRing {
+ public:
+  PacketRing(rtc::PlatformThreadRef owner, size_t capacity);
+  ~PacketRing();
+
+  rtc::PlatformThreadRef owner() const { return owner_; }
+
+  // Producer side. Returns the record to fill in, or null if the ring is
+  // full. The record is added to the ring by EndWrite(), which is also a full
+  // memory barrier.
+  PacketRecord* BeginWrite();
+  void EndWrite();
+
+  // Consumer side. Returns the oldest record, or null if the ring is empty.
+  const PacketRecord* Front() const;
+  void PopFront();
+
+ private:
+  int Next(int index) const { return index + 1 == num_slots_ ? 0 : index + 1; }
+
+  const rtc::PlatformThreadRef owner_;
+  // One slot is always kept empty to tell a full ring from an empty one.
+  const int num_slots_;
+  std::unique_ptr<PacketRecord[]> records_;
+  // Only written by the producer.
+  volatile int write_index_;
+  // Only written by the consumer.
+  volatile int read_index_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(PacketRing);
+};
+
+// The PacketRings of the threads logging packets to an RtcEventLog. A thread
+// gets a ring the first time it logs a packet and keeps it for the lifetime
+// of the set, so the number of logging threads is bounded by kMaxRings.
+class PacketRingSet {
+ public:
+  static const size_t kMaxRings = 16;
+
+  explicit PacketRingSet(size_t ring_capacity);
+  ~PacketRingSet();
+
+  // Returns the ring of the calling thread, creating it on first use. Returns
+  // null if all the rings belong to other threads.
+  PacketRing* GetRingForCurrentThread();
+
+  // Returns ring number |index|, or null if it hasn't been created yet. Rings
+  // are created in order, so the first null ring ends the set.
+  PacketRing* ring(size_t index);
+
+ private:
+  const size_t ring_capacity_;
+  PacketRing* volatile rings_[kMaxRings];
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(PacketRingSet);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_PACKET_RING_H_
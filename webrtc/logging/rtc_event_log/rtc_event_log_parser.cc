@@ -16,12 +16,14 @@
 #include <algorithm>
 #include <fstream>
 #include <istream>
+#include <iterator>
 #include <utility>
 
 #include "webrtc/base/checks.h"
 #include "webrtc/base/logging.h"
 #include "webrtc/call/call.h"
 #include "webrtc/logging/rtc_event_log/rtc_event_log.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_compact_encoding.h"
 #include "webrtc/modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "webrtc/system_wrappers/include/file_wrapper.h"
 
@@ -149,6 +151,17 @@ bool ParsedRtcEventLog::ParseStream(std::istream& stream) {
 
   RTC_DCHECK(stream.good());
 
+  char first_byte = static_cast<char>(stream.peek());
+  if (!stream.eof() && IsCompactRtcEventLog(&first_byte, 1)) {
+    std::string log((std::istreambuf_iterator<char>(stream)),
+                    std::istreambuf_iterator<char>());
+    if (!DecodeCompactRtcEventLog(log.data(), log.size(), &events_)) {
+      LOG(LS_WARNING) << "Failed to decode compact event log.";
+      return false;
+    }
+    return true;
+  }
+
   while (1) {
     // Check whether we have reached end of file.
     stream.peek();
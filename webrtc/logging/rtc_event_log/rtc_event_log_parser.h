@@ -32,6 +32,7 @@ namespace webrtc {
 enum class MediaType;
 
 class ParsedRtcEventLog {
+  friend class RtcEventLogReader;
   friend class RtcEventLogTestHelper;
 
  public:
@@ -51,7 +52,8 @@ class ParsedRtcEventLog {
     AUDIO_NETWORK_ADAPTATION_EVENT = 16
   };
 
-  // Reads an RtcEventLog file and returns true if parsing was successful.
+  // Reads an RtcEventLog file, in either the protobuf based or the compact
+  // encoding, and returns true if parsing was successful.
   bool ParseFile(const std::string& file_name);
 
   // Reads an RtcEventLog from a string and returns true if successful.
@@ -0,0 +1,454 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/logging/rtc_event_log/rtc_event_log_reader.h"
+
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "webrtc/base/bytebuffer.h"
+#include "webrtc/base/checks.h"
+#include "webrtc/base/logging.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_compact_encoding.h"
+#include "webrtc/system_wrappers/include/file_wrapper.h"
+
+namespace webrtc {
+
+namespace {
+
+const char kIndexMagic[] = "RtcEventLogIndex";
+const size_t kIndexMagicSize = sizeof(kIndexMagic) - 1;
+const uint64_t kIndexVersion = 1;
+
+// Same limit as ParsedRtcEventLog.
+const uint64_t kMaxEventSize = (1u << 16) - 1;
+
+// Small enough to map in a 32-bit address space.
+const size_t kDefaultWindowSize = 32 * 1024 * 1024;
+
+// Enough for the magic string and version of a compact log.
+const uint64_t kMaxFileHeaderSize = 64;
+
+// A record is a varint tag or block type, a varint length and the payload.
+const uint64_t kMaxRecordHeaderSize = 2 * 10;
+
+bool ReadVarint(const char* data,
+                uint64_t size,
+                uint64_t* offset,
+                uint64_t* value) {
+  *value = 0;
+  for (size_t i = 0; i < 10 && *offset < size; ++i) {
+    uint8_t byte = static_cast<uint8_t>(data[(*offset)++]);
+    *value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+    if ((byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Mappings must start at a multiple of this.
+uint64_t AllocationGranularity() {
+#if defined(WEBRTC_WIN)
+  SYSTEM_INFO system_info;
+  ::GetSystemInfo(&system_info);
+  return system_info.dwAllocationGranularity;
+#else
+  return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+}  // namespace
+
+size_t RtcEventLogIndex::FindEntry(int64_t timestamp_us) const {
+  return std::lower_bound(entries.begin(), entries.end(), timestamp_us,
+                          [](const Entry& entry, int64_t timestamp_us) {
+                            return entry.max_timestamp_us < timestamp_us;
+                          }) -
+         entries.begin();
+}
+
+bool RtcEventLogIndex::Write(const std::string& file_name) const {
+  rtc::ByteBufferWriter buffer;
+  buffer.WriteBytes(kIndexMagic, kIndexMagicSize);
+  buffer.WriteUVarint(kIndexVersion);
+  buffer.WriteUVarint(file_size);
+  buffer.WriteUVarint(entries.size());
+  // Entries are delta coded against the previous one.
+  Entry previous = {0, 0, 0, 0, 0};
+  for (const Entry& entry : entries) {
+    buffer.WriteUVarint(entry.offset - previous.offset);
+    buffer.WriteUVarint(entry.num_events);
+    buffer.WriteUVarint(
+        ZigZagEncode(entry.first_timestamp_us - previous.max_timestamp_us));
+    buffer.WriteUVarint(entry.max_timestamp_us - previous.max_timestamp_us);
+    buffer.WriteUVarint(entry.event_types);
+    previous = entry;
+  }
+
+  std::unique_ptr<FileWrapper> file(FileWrapper::Create());
+  if (!file->OpenFile(file_name.c_str(), false))
+    return false;
+  bool success = file->Write(buffer.Data(), buffer.Length());
+  file->CloseFile();
+  return success;
+}
+
+bool RtcEventLogIndex::Read(const std::string& file_name) {
+  std::unique_ptr<FileWrapper> file(FileWrapper::Create());
+  if (!file->OpenFile(file_name.c_str(), true))
+    return false;
+  std::string contents;
+  char buffer[4096];
+  int bytes_read;
+  while ((bytes_read = file->Read(buffer, sizeof(buffer))) > 0)
+    contents.append(buffer, bytes_read);
+  file->CloseFile();
+
+  if (contents.size() < kIndexMagicSize ||
+      contents.compare(0, kIndexMagicSize, kIndexMagic) != 0) {
+    return false;
+  }
+  rtc::ByteBufferReader reader(contents.data() + kIndexMagicSize,
+                               contents.size() - kIndexMagicSize);
+  uint64_t version;
+  uint64_t indexed_file_size;
+  uint64_t num_entries;
+  if (!reader.ReadUVarint(&version) || version != kIndexVersion ||
+      !reader.ReadUVarint(&indexed_file_size) ||
+      indexed_file_size != file_size || !reader.ReadUVarint(&num_entries) ||
+      num_entries > reader.Length()) {
+    return false;
+  }
+  std::vector<Entry> read_entries(num_entries);
+  Entry previous = {0, 0, 0, 0, 0};
+  for (Entry& entry : read_entries) {
+    uint64_t offset_delta;
+    uint64_t first_timestamp_delta;
+    uint64_t max_timestamp_delta;
+    uint64_t event_types;
+    if (!reader.ReadUVarint(&offset_delta) ||
+        !reader.ReadUVarint(&entry.num_events) ||
+        !reader.ReadUVarint(&first_timestamp_delta) ||
+        !reader.ReadUVarint(&max_timestamp_delta) ||
+        !reader.ReadUVarint(&event_types)) {
+      return false;
+    }
+    entry.offset = previous.offset + offset_delta;
+    entry.first_timestamp_us =
+        previous.max_timestamp_us + ZigZagDecode(first_timestamp_delta);
+    entry.max_timestamp_us = previous.max_timestamp_us + max_timestamp_delta;
+    entry.event_types = static_cast<uint32_t>(event_types);
+    if (entry.offset > file_size)
+      return false;
+    previous = entry;
+  }
+  entries.swap(read_entries);
+  return true;
+}
+
+RtcEventLogReader::RtcEventLogReader()
+    : RtcEventLogReader(kDefaultWindowSize) {}
+
+RtcEventLogReader::RtcEventLogReader(size_t window_size)
+    : window_size_(window_size),
+      window_(nullptr),
+      window_offset_(0),
+      window_length_(0),
+      size_(0),
+      start_(0),
+      compact_(false),
+      error_(false),
+      offset_(0),
+      next_event_(0),
+      record_offset_(0),
+#if defined(WEBRTC_WIN)
+      file_handle_(INVALID_HANDLE_VALUE),
+      mapping_handle_(nullptr) {
+#else
+      fd_(-1) {
+#endif
+}
+
+RtcEventLogReader::~RtcEventLogReader() {
+  Close();
+}
+
+bool RtcEventLogReader::Open(const std::string& file_name) {
+  Close();
+#if defined(WEBRTC_WIN)
+  file_handle_ = ::CreateFileA(file_name.c_str(), GENERIC_READ,
+                               FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  LARGE_INTEGER file_size;
+  if (file_handle_ == INVALID_HANDLE_VALUE ||
+      !::GetFileSizeEx(file_handle_, &file_size)) {
+    LOG(LS_WARNING) << "Could not open file for reading.";
+    Close();
+    return false;
+  }
+  size_ = file_size.QuadPart;
+  // Empty files can't be mapped.
+  if (size_ > 0) {
+    mapping_handle_ = ::CreateFileMapping(file_handle_, nullptr,
+                                          PAGE_READONLY, 0, 0, nullptr);
+  }
+#else
+  fd_ = open(file_name.c_str(), O_RDONLY);
+  struct stat file_stat;
+  if (fd_ < 0 || fstat(fd_, &file_stat) != 0) {
+    LOG(LS_WARNING) << "Could not open file for reading.";
+    Close();
+    return false;
+  }
+  size_ = file_stat.st_size;
+#endif
+  const uint64_t header_size = std::min(kMaxFileHeaderSize, size_);
+  const char* header = size_ > 0 ? Map(0, header_size) : nullptr;
+  if (size_ > 0 && !header) {
+    LOG(LS_WARNING) << "Could not map file.";
+    Close();
+    return false;
+  }
+
+  compact_ = IsCompactRtcEventLog(header, header_size);
+  if (compact_) {
+    start_ = DecodeCompactRtcEventLogHeader(header, header_size);
+    if (start_ == 0) {
+      LOG(LS_WARNING) << "Unsupported compact event log.";
+      Close();
+      return false;
+    }
+  }
+  offset_ = start_;
+  record_offset_ = start_;
+  return true;
+}
+
+void RtcEventLogReader::Close() {
+  Unmap();
+#if defined(WEBRTC_WIN)
+  if (mapping_handle_)
+    ::CloseHandle(mapping_handle_);
+  if (file_handle_ != INVALID_HANDLE_VALUE)
+    ::CloseHandle(file_handle_);
+  mapping_handle_ = nullptr;
+  file_handle_ = INVALID_HANDLE_VALUE;
+#else
+  if (fd_ >= 0)
+    close(fd_);
+  fd_ = -1;
+#endif
+  size_ = 0;
+  start_ = 0;
+  compact_ = false;
+  error_ = false;
+  offset_ = 0;
+  events_.clear();
+  next_event_ = 0;
+  record_offset_ = 0;
+}
+
+bool RtcEventLogReader::ReadEvent(rtclog::Event* event) {
+  while (next_event_ == events_.size()) {
+    if (error_ || offset_ == size_ || !ReadRecord())
+      return false;
+  }
+  event->Swap(&events_[next_event_++]);
+  return true;
+}
+
+size_t RtcEventLogReader::ReadEvents(size_t max_events,
+                                     ParsedRtcEventLog* parsed_log) {
+  std::vector<rtclog::Event>& events = parsed_log->events_;
+  events.resize(max_events);
+  size_t num_events = 0;
+  while (num_events < max_events && ReadEvent(&events[num_events]))
+    ++num_events;
+  events.resize(num_events);
+  return num_events;
+}
+
+uint64_t RtcEventLogReader::position() const {
+  return next_event_ < events_.size() ? record_offset_ : offset_;
+}
+
+bool RtcEventLogReader::Seek(uint64_t offset) {
+  if (offset < start_ || offset > size_)
+    return false;
+  offset_ = offset;
+  record_offset_ = offset;
+  events_.clear();
+  next_event_ = 0;
+  error_ = false;
+  return true;
+}
+
+bool RtcEventLogReader::BuildIndex(size_t events_per_entry,
+                                   RtcEventLogIndex* index) {
+  RTC_DCHECK_GT(events_per_entry, 0u);
+  index->file_size = size_;
+  index->entries.clear();
+  Seek(start_);
+  int64_t max_timestamp_us = std::numeric_limits<int64_t>::min();
+  rtclog::Event event;
+  while (ReadEvent(&event)) {
+    // Entries start at record boundaries, so that they can be sought to.
+    bool first_event_of_record = next_event_ == 1;
+    if (index->entries.empty() ||
+        (first_event_of_record &&
+         index->entries.back().num_events >= events_per_entry)) {
+      RtcEventLogIndex::Entry entry;
+      entry.offset = record_offset_;
+      entry.num_events = 0;
+      entry.first_timestamp_us = event.timestamp_us();
+      entry.max_timestamp_us = max_timestamp_us;
+      entry.event_types = 0;
+      index->entries.push_back(entry);
+    }
+    RtcEventLogIndex::Entry& entry = index->entries.back();
+    ++entry.num_events;
+    max_timestamp_us = std::max(max_timestamp_us, event.timestamp_us());
+    entry.max_timestamp_us = max_timestamp_us;
+    if (event.type() < 32)
+      entry.event_types |= 1u << event.type();
+  }
+  bool success = !error_;
+  Seek(start_);
+  return success;
+}
+
+bool RtcEventLogReader::ReadRecord() {
+  RTC_DCHECK_LT(offset_, size_);
+  events_.clear();
+  next_event_ = 0;
+  record_offset_ = offset_;
+  // Both encodings store records as a varint tag, or block type, and a
+  // varint payload length followed by the payload; see
+  // ParsedRtcEventLog::ParseStream() for the protobuf based encoding.
+  const uint64_t kExpectedTag = (1 << 3) | 2;
+  uint64_t header_size = std::min(kMaxRecordHeaderSize, size_ - offset_);
+  const char* header = Map(offset_, header_size);
+  uint64_t payload_offset = 0;
+  uint64_t tag;
+  uint64_t payload_length;
+  if (!header ||
+      !ReadVarint(header, header_size, &payload_offset, &tag) ||
+      !ReadVarint(header, header_size, &payload_offset, &payload_length) ||
+      payload_length > size_ - offset_ - payload_offset ||
+      (!compact_ &&
+       (tag != kExpectedTag || payload_length > kMaxEventSize))) {
+    LOG(LS_WARNING) << "Malformed event log record.";
+    error_ = true;
+    return false;
+  }
+  uint64_t record_size = payload_offset + payload_length;
+  const char* record = Map(offset_, record_size);
+  if (!record) {
+    LOG(LS_WARNING) << "Could not map event log record.";
+    error_ = true;
+    return false;
+  }
+  if (compact_) {
+    if (DecodeCompactRtcEventLogBlock(record, static_cast<size_t>(record_size),
+                                      &events_) != record_size) {
+      LOG(LS_WARNING) << "Failed to decode compact event log block.";
+      events_.clear();
+      error_ = true;
+      return false;
+    }
+  } else {
+    events_.resize(1);
+    if (!events_[0].ParseFromArray(record + payload_offset,
+                                   static_cast<int>(payload_length))) {
+      LOG(LS_WARNING) << "Failed to parse protobuf message.";
+      events_.clear();
+      error_ = true;
+      return false;
+    }
+  }
+  offset_ += record_size;
+  return true;
+}
+
+const char* RtcEventLogReader::Map(uint64_t offset, uint64_t length) {
+  RTC_DCHECK_LE(offset, size_);
+  RTC_DCHECK_LE(length, size_ - offset);
+  if (window_ && offset >= window_offset_ &&
+      offset + length <= window_offset_ + window_length_) {
+    return window_ + (offset - window_offset_);
+  }
+  Unmap();
+  // The window starts at the multiple of the allocation granularity below
+  // |offset|, and is extended past |window_size_| if the requested bytes don't
+  // fit, which fails if they don't fit in the address space either.
+  const uint64_t window_offset = offset - offset % AllocationGranularity();
+  const uint64_t window_length =
+      std::min(std::max<uint64_t>(offset + length - window_offset,
+                                  window_size_),
+               size_ - window_offset);
+  if (window_length > std::numeric_limits<size_t>::max())
+    return nullptr;
+#if defined(WEBRTC_WIN)
+  void* window = ::MapViewOfFile(mapping_handle_, FILE_MAP_READ,
+                                 static_cast<DWORD>(window_offset >> 32),
+                                 static_cast<DWORD>(window_offset),
+                                 static_cast<SIZE_T>(window_length));
+  if (!window)
+    return nullptr;
+#else
+  if (window_offset >
+      static_cast<uint64_t>(std::numeric_limits<off_t>::max())) {
+    return nullptr;
+  }
+  void* window = mmap(nullptr, static_cast<size_t>(window_length), PROT_READ,
+                      MAP_SHARED, fd_, static_cast<off_t>(window_offset));
+  if (window == MAP_FAILED)
+    return nullptr;
+  madvise(window, static_cast<size_t>(window_length), MADV_SEQUENTIAL);
+#endif
+  window_ = static_cast<const char*>(window);
+  window_offset_ = window_offset;
+  window_length_ = static_cast<size_t>(window_length);
+  return window_ + (offset - window_offset_);
+}
+
+void RtcEventLogReader::Unmap() {
+  if (window_) {
+#if defined(WEBRTC_WIN)
+    ::UnmapViewOfFile(window_);
+#else
+    munmap(const_cast<char*>(window_), window_length_);
+#endif
+  }
+  window_ = nullptr;
+  window_offset_ = 0;
+  window_length_ = 0;
+}
+
+}  // namespace webrtc
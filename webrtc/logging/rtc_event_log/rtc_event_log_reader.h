@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_READER_H_
+#define WEBRTC_LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_parser.h"
+
+namespace webrtc {
+
+// An index of an RtcEventLog file, built by RtcEventLogReader::BuildIndex().
+// It splits the log into runs of events which can be read independently of
+// each other, which lets tools seek by time, skip runs without the event
+// types they are interested in, and read several runs in parallel.
+struct RtcEventLogIndex {
+  struct Entry {
+    // Offset of the first event of the run in the file.
+    uint64_t offset;
+    uint64_t num_events;
+    int64_t first_timestamp_us;
+    // The largest timestamp of the events up to the end of the run. Unlike
+    // the timestamps of the events, these never decrease from one entry to
+    // the next.
+    int64_t max_timestamp_us;
+    // Bit (1 << type) is set if the run holds events of rtclog::Event type
+    // |type|; see EventTypeBit().
+    uint32_t event_types;
+  };
+
+  static uint32_t EventTypeBit(ParsedRtcEventLog::EventType type) {
+    return 1u << type;
+  }
+
+  // Returns the first entry whose run may hold events at or after
+  // |timestamp_us|, or entries.size() if there is none.
+  size_t FindEntry(int64_t timestamp_us) const;
+
+  // Writes the index to a side file, or reads it back. Read() fails if the
+  // file isn't an index of a log of |file_size| bytes.
+  bool Write(const std::string& file_name) const;
+  bool Read(const std::string& file_name);
+
+  // Size of the indexed log file.
+  uint64_t file_size = 0;
+  std::vector<Entry> entries;
+};
+
+// Reads an RtcEventLog file, in either encoding, event by event. Unlike
+// ParsedRtcEventLog, which holds all the events of a log in memory, the
+// reader maps a window of the file which slides as the log is read, and only
+// decodes the events as they are read, so logs of any size can be processed
+// in bounded memory and address space.
+class RtcEventLogReader {
+ public:
+  RtcEventLogReader();
+  // Maps |window_size| bytes of the file at a time, or more when a record
+  // doesn't fit.
+  explicit RtcEventLogReader(size_t window_size);
+  ~RtcEventLogReader();
+
+  // Opens |file_name| and moves to its first event. Returns false if the file
+  // can't be opened or isn't an RtcEventLog.
+  bool Open(const std::string& file_name);
+  void Close();
+
+  // Reads the next event into |event|. Returns false at the end of the log or
+  // if the log is malformed, which error() tells apart.
+  bool ReadEvent(rtclog::Event* event);
+
+  // Replaces the events of |parsed_log| with the next |max_events| events of
+  // the log, or fewer at its end, so that the accessors of ParsedRtcEventLog
+  // can be used one part of the log at a time. Returns the number of events
+  // read.
+  size_t ReadEvents(size_t max_events, ParsedRtcEventLog* parsed_log);
+
+  bool error() const { return error_; }
+  uint64_t file_size() const { return size_; }
+
+  // Returns the offset from which the next event is read. Events are stored
+  // in records, which in the compact encoding hold batches of events; when a
+  // record has only been partially read, its offset is returned.
+  uint64_t position() const;
+
+  // Moves to |offset|, which must be the start of a record, such as the
+  // offset of an index entry or one returned by position() when all the
+  // events of the previous record have been read. Returns false if |offset|
+  // is past the end of the file.
+  bool Seek(uint64_t offset);
+
+  // Builds |index| by reading the whole log, with entries of at least
+  // |events_per_entry| events (the last one can have fewer). Moves back to
+  // the start of the log afterwards. Returns false if the log is malformed.
+  bool BuildIndex(size_t events_per_entry, RtcEventLogIndex* index);
+
+ private:
+  // Decodes the record at |offset_| into |events_|.
+  bool ReadRecord();
+  // Returns the bytes [offset, offset + length) of the file, moving the window
+  // if they aren't all in it, or null if they can't be mapped.
+  const char* Map(uint64_t offset, uint64_t length);
+  void Unmap();
+
+  const size_t window_size_;
+  // The mapped part of the file, [window_offset_, window_offset_ +
+  // window_length_).
+  const char* window_;
+  uint64_t window_offset_;
+  size_t window_length_;
+  uint64_t size_;
+  // Offset of the first record, after the header of a compact log.
+  uint64_t start_;
+  bool compact_;
+  bool error_;
+  // Offset of the next record to decode.
+  uint64_t offset_;
+  // The events of the last record decoded, from |record_offset_|, of which
+  // the first |next_event_| have been read.
+  std::vector<rtclog::Event> events_;
+  size_t next_event_;
+  uint64_t record_offset_;
+#if defined(WEBRTC_WIN)
+  void* file_handle_;
+  void* mapping_handle_;
+#else
+  int fd_;
+#endif
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RtcEventLogReader);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_READER_H_
@@ -0,0 +1,259 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "webrtc/logging/rtc_event_log/rtc_event_log_compact_encoding.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_parser.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_reader.h"
+#include "webrtc/test/gtest.h"
+#include "webrtc/test/testsupport/fileutils.h"
+
+namespace webrtc {
+
+namespace {
+
+const size_t kNumEvents = 5000;
+const int64_t kEventIntervalUs = 1000;
+
+// Every tenth event is an audio playout event, the others are RTP packets of
+// two streams.
+std::vector<rtclog::Event> GenerateEvents() {
+  std::vector<rtclog::Event> events(kNumEvents);
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    rtclog::Event& event = events[i];
+    event.set_timestamp_us(kEventIntervalUs * (i + 1));
+    if (i % 10 == 0) {
+      event.set_type(rtclog::Event::AUDIO_PLAYOUT_EVENT);
+      event.mutable_audio_playout_event()->set_local_ssrc(1234);
+      continue;
+    }
+    uint8_t header[12] = {0x80, 100};
+    header[2] = static_cast<uint8_t>(i >> 8);
+    header[3] = static_cast<uint8_t>(i);
+    header[11] = static_cast<uint8_t>(i % 2);
+    event.set_type(rtclog::Event::RTP_EVENT);
+    event.mutable_rtp_packet()->set_incoming(true);
+    event.mutable_rtp_packet()->set_type(rtclog::MediaType::VIDEO);
+    event.mutable_rtp_packet()->set_packet_length(1000);
+    event.mutable_rtp_packet()->set_header(header, sizeof(header));
+  }
+  return events;
+}
+
+std::string EncodeLog(const std::vector<rtclog::Event>& events, bool compact) {
+  std::string log;
+  if (compact) {
+    RtcEventLogCompactEncoder encoder;
+    RtcEventLogCompactEncoder::EncodeHeader(&log);
+    for (const rtclog::Event& event : events)
+      encoder.Encode(event, &log);
+    encoder.Flush(&log);
+  } else {
+    for (const rtclog::Event& event : events) {
+      rtclog::EventStream stream;
+      *stream.add_stream() = event;
+      stream.AppendToString(&log);
+    }
+  }
+  return log;
+}
+
+void WriteFile(const std::string& data, const std::string& file_name) {
+  FILE* file = fopen(file_name.c_str(), "wb");
+  ASSERT_TRUE(file);
+  ASSERT_EQ(data.size(), fwrite(data.data(), 1, data.size(), file));
+  fclose(file);
+}
+
+class RtcEventLogReaderTest : public ::testing::TestWithParam<bool> {
+ protected:
+  RtcEventLogReaderTest()
+      : events_(GenerateEvents()), log_(EncodeLog(events_, GetParam())) {
+    file_name_ = test::OutputPath() + "RtcEventLogReaderTest" +
+                 std::to_string(GetParam());
+    index_file_name_ = file_name_ + "Index";
+    WriteFile(log_, file_name_);
+  }
+  ~RtcEventLogReaderTest() override {
+    remove(file_name_.c_str());
+    remove(index_file_name_.c_str());
+  }
+
+  const std::vector<rtclog::Event> events_;
+  const std::string log_;
+  std::string file_name_;
+  std::string index_file_name_;
+};
+
+}  // namespace
+
+TEST_P(RtcEventLogReaderTest, ReadsAllEvents) {
+  RtcEventLogReader reader;
+  ASSERT_TRUE(reader.Open(file_name_));
+  rtclog::Event event;
+  for (const rtclog::Event& expected_event : events_) {
+    ASSERT_TRUE(reader.ReadEvent(&event));
+    EXPECT_EQ(expected_event.SerializeAsString(), event.SerializeAsString());
+  }
+  EXPECT_FALSE(reader.ReadEvent(&event));
+  EXPECT_FALSE(reader.error());
+  EXPECT_EQ(reader.file_size(), reader.position());
+}
+
+TEST_P(RtcEventLogReaderTest, ReadsAllEventsWithSmallWindow) {
+  // The records straddle the windows, and are bigger than them.
+  RtcEventLogReader reader(1);
+  ASSERT_TRUE(reader.Open(file_name_));
+  const uint64_t start = reader.position();
+  rtclog::Event event;
+  for (const rtclog::Event& expected_event : events_) {
+    ASSERT_TRUE(reader.ReadEvent(&event));
+    EXPECT_EQ(expected_event.SerializeAsString(), event.SerializeAsString());
+  }
+  EXPECT_FALSE(reader.ReadEvent(&event));
+  EXPECT_FALSE(reader.error());
+
+  // Moves the window back.
+  ASSERT_TRUE(reader.Seek(start));
+  ASSERT_TRUE(reader.ReadEvent(&event));
+  EXPECT_EQ(events_[0].SerializeAsString(), event.SerializeAsString());
+}
+
+TEST_P(RtcEventLogReaderTest, ReadsEventsIntoParsedLog) {
+  const size_t kEventsPerRead = 300;
+  RtcEventLogReader reader;
+  ASSERT_TRUE(reader.Open(file_name_));
+  ParsedRtcEventLog parsed_log;
+  size_t num_events = 0;
+  while (reader.ReadEvents(kEventsPerRead, &parsed_log) > 0) {
+    ASSERT_LE(parsed_log.GetNumberOfEvents(), kEventsPerRead);
+    for (size_t i = 0; i < parsed_log.GetNumberOfEvents(); ++i) {
+      EXPECT_EQ(events_[num_events].timestamp_us(), parsed_log.GetTimestamp(i));
+      ++num_events;
+    }
+  }
+  EXPECT_EQ(kNumEvents, num_events);
+  EXPECT_FALSE(reader.error());
+}
+
+TEST_P(RtcEventLogReaderTest, SeeksWithIndex) {
+  const size_t kEventsPerEntry = 500;
+  RtcEventLogReader reader;
+  ASSERT_TRUE(reader.Open(file_name_));
+  RtcEventLogIndex index;
+  ASSERT_TRUE(reader.BuildIndex(kEventsPerEntry, &index));
+  EXPECT_EQ(reader.file_size(), index.file_size);
+  ASSERT_GE(index.entries.size(), kNumEvents / (2 * kEventsPerEntry));
+  uint64_t num_events = 0;
+  for (const RtcEventLogIndex::Entry& entry : index.entries) {
+    EXPECT_TRUE(entry.event_types & RtcEventLogIndex::EventTypeBit(
+                                        ParsedRtcEventLog::RTP_EVENT));
+    EXPECT_TRUE(entry.event_types &
+                RtcEventLogIndex::EventTypeBit(
+                    ParsedRtcEventLog::AUDIO_PLAYOUT_EVENT));
+    EXPECT_FALSE(entry.event_types & RtcEventLogIndex::EventTypeBit(
+                                         ParsedRtcEventLog::RTCP_EVENT));
+    EXPECT_EQ(events_[num_events].timestamp_us(), entry.first_timestamp_us);
+    num_events += entry.num_events;
+  }
+  EXPECT_EQ(kNumEvents, num_events);
+
+  // Seek to the entry holding the event logged at |timestamp_us| and read
+  // until that event.
+  const size_t kEventNumber = 3210;
+  const int64_t timestamp_us = events_[kEventNumber].timestamp_us();
+  size_t entry_number = index.FindEntry(timestamp_us);
+  ASSERT_LT(entry_number, index.entries.size());
+  const RtcEventLogIndex::Entry& entry = index.entries[entry_number];
+  EXPECT_LE(entry.first_timestamp_us, timestamp_us);
+  EXPECT_GE(entry.max_timestamp_us, timestamp_us);
+  ASSERT_TRUE(reader.Seek(entry.offset));
+  rtclog::Event event;
+  do {
+    ASSERT_TRUE(reader.ReadEvent(&event));
+  } while (event.timestamp_us() < timestamp_us);
+  EXPECT_EQ(events_[kEventNumber].SerializeAsString(),
+            event.SerializeAsString());
+  EXPECT_EQ(index.entries.size(),
+            index.FindEntry(events_.back().timestamp_us() + 1));
+
+  // The index can be stored next to the log.
+  ASSERT_TRUE(index.Write(index_file_name_));
+  RtcEventLogIndex read_index;
+  read_index.file_size = reader.file_size();
+  ASSERT_TRUE(read_index.Read(index_file_name_));
+  ASSERT_EQ(index.entries.size(), read_index.entries.size());
+  for (size_t i = 0; i < index.entries.size(); ++i) {
+    EXPECT_EQ(index.entries[i].offset, read_index.entries[i].offset);
+    EXPECT_EQ(index.entries[i].num_events, read_index.entries[i].num_events);
+    EXPECT_EQ(index.entries[i].first_timestamp_us,
+              read_index.entries[i].first_timestamp_us);
+    EXPECT_EQ(index.entries[i].max_timestamp_us,
+              read_index.entries[i].max_timestamp_us);
+    EXPECT_EQ(index.entries[i].event_types, read_index.entries[i].event_types);
+  }
+  // An index doesn't apply to a log of a different size.
+  read_index.file_size = reader.file_size() + 1;
+  EXPECT_FALSE(read_index.Read(index_file_name_));
+}
+
+// Reads the two halves of the log with separate readers, as tools analyzing a
+// log in parallel would, one event from each at a time.
+TEST_P(RtcEventLogReaderTest, ReadsIndexEntriesIndependently) {
+  RtcEventLogIndex index;
+  RtcEventLogReader readers[2];
+  ASSERT_TRUE(readers[0].Open(file_name_));
+  ASSERT_TRUE(readers[1].Open(file_name_));
+  ASSERT_TRUE(readers[0].BuildIndex(100, &index));
+  size_t middle = index.entries.size() / 2;
+  ASSERT_TRUE(readers[1].Seek(index.entries[middle].offset));
+
+  size_t first_event_of_middle = 0;
+  for (size_t i = 0; i < middle; ++i)
+    first_event_of_middle += index.entries[i].num_events;
+  size_t next_event[2] = {0, first_event_of_middle};
+  const size_t end[2] = {first_event_of_middle, kNumEvents};
+  rtclog::Event event;
+  while (next_event[0] < end[0] || next_event[1] < end[1]) {
+    for (size_t i = 0; i < 2; ++i) {
+      if (next_event[i] == end[i])
+        continue;
+      ASSERT_TRUE(readers[i].ReadEvent(&event));
+      EXPECT_EQ(events_[next_event[i]++].timestamp_us(),
+                event.timestamp_us());
+    }
+  }
+  EXPECT_EQ(index.entries[middle].offset, readers[0].position());
+}
+
+TEST_P(RtcEventLogReaderTest, StopsAtTruncatedEvent) {
+  std::string truncated_file_name = file_name_ + "Truncated";
+  WriteFile(log_.substr(0, log_.size() - 3), truncated_file_name);
+
+  RtcEventLogReader reader;
+  ASSERT_TRUE(reader.Open(truncated_file_name));
+  rtclog::Event event;
+  size_t num_events = 0;
+  while (reader.ReadEvent(&event))
+    ++num_events;
+  EXPECT_TRUE(reader.error());
+  EXPECT_LT(num_events, kNumEvents);
+  remove(truncated_file_name.c_str());
+
+  EXPECT_FALSE(reader.Open(file_name_ + "Missing"));
+}
+
+INSTANTIATE_TEST_CASE_P(Encodings, RtcEventLogReaderTest, ::testing::Bool());
+
+}  // namespace webrtc
@@ -14,21 +14,27 @@
 #include <utility>
 #include <vector>
 
+#include "webrtc/base/arraysize.h"
 #include "webrtc/base/buffer.h"
 #include "webrtc/base/checks.h"
 #include "webrtc/base/fakeclock.h"
+#include "webrtc/base/platform_thread.h"
 #include "webrtc/base/random.h"
+#include "webrtc/base/timeutils.h"
 #include "webrtc/call/call.h"
 #include "webrtc/logging/rtc_event_log/rtc_event_log.h"
 #include "webrtc/logging/rtc_event_log/rtc_event_log_parser.h"
 #include "webrtc/logging/rtc_event_log/rtc_event_log_unittest_helper.h"
+#include "webrtc/modules/rtp_rtcp/source/byte_io.h"
 #include "webrtc/modules/rtp_rtcp/source/rtcp_packet.h"
 #include "webrtc/modules/rtp_rtcp/source/rtcp_packet/sender_report.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_header_extension.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_header_extensions.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "webrtc/system_wrappers/include/sleep.h"
 #include "webrtc/test/gtest.h"
 #include "webrtc/test/testsupport/fileutils.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 // Files generated at build-time by the protobuf compiler.
 #ifdef WEBRTC_ANDROID_PLATFORM_BUILD
@@ -248,7 +254,8 @@ void LogSessionAndReadBack(size_t rtp_count,
                            size_t bwe_loss_count,
                            uint32_t extensions_bitvector,
                            uint32_t csrcs_count,
-                           unsigned int random_seed) {
+                           unsigned int random_seed,
+                           RtcEventLog::EncodingType encoding) {
   ASSERT_LE(rtcp_count, rtp_count);
   ASSERT_LE(playout_count, rtp_count);
   ASSERT_LE(bwe_loss_count, rtp_count);
@@ -304,7 +311,7 @@ void LogSessionAndReadBack(size_t rtp_count,
   {
     rtc::ScopedFakeClock fake_clock;
     fake_clock.SetTimeMicros(prng.Rand<uint32_t>());
-    std::unique_ptr<RtcEventLog> log_dumper(RtcEventLog::Create());
+    std::unique_ptr<RtcEventLog> log_dumper(RtcEventLog::Create(encoding));
     log_dumper->LogVideoReceiveStreamConfig(receiver_config);
     fake_clock.AdvanceTimeMicros(prng.Rand(1, 1000));
     log_dumper->LogVideoSendStreamConfig(sender_config);
@@ -410,10 +417,10 @@ void LogSessionAndReadBack(size_t rtp_count,
   remove(temp_filename.c_str());
 }
 
-TEST(RtcEventLogTest, LogSessionAndReadBack) {
+void LogSessionsAndReadBack(RtcEventLog::EncodingType encoding) {
   // Log 5 RTP, 2 RTCP, 0 playout events and 0 BWE events
   // with no header extensions or CSRCS.
-  LogSessionAndReadBack(5, 2, 0, 0, 0, 0, 321);
+  LogSessionAndReadBack(5, 2, 0, 0, 0, 0, 321, encoding);
 
   // Enable AbsSendTime and TransportSequenceNumbers.
   uint32_t extensions = 0;
@@ -424,10 +431,10 @@ TEST(RtcEventLogTest, LogSessionAndReadBack) {
       extensions |= 1u << i;
     }
   }
-  LogSessionAndReadBack(8, 2, 0, 0, extensions, 0, 3141592653u);
+  LogSessionAndReadBack(8, 2, 0, 0, extensions, 0, 3141592653u, encoding);
 
   extensions = (1u << kNumExtensions) - 1;  // Enable all header extensions.
-  LogSessionAndReadBack(9, 2, 3, 2, extensions, 2, 2718281828u);
+  LogSessionAndReadBack(9, 2, 3, 2, extensions, 2, 2718281828u, encoding);
 
   // Try all combinations of header extensions and up to 2 CSRCS.
   for (extensions = 0; extensions < (1u << kNumExtensions); extensions++) {
@@ -438,11 +445,246 @@ TEST(RtcEventLogTest, LogSessionAndReadBack) {
                             1 + csrcs_count,  // Number of BWE loss events.
                             extensions,       // Bit vector choosing extensions.
                             csrcs_count,      // Number of contributing sources.
-                            extensions * 3 + csrcs_count + 1);  // Random seed.
+                            extensions * 3 + csrcs_count + 1,  // Random seed.
+                            encoding);
     }
   }
 }
 
+TEST(RtcEventLogTest, LogSessionAndReadBack) {
+  LogSessionsAndReadBack(RtcEventLog::EncodingType::kLegacy);
+}
+
+TEST(RtcEventLogTest, LogSessionAndReadBackCompact) {
+  LogSessionsAndReadBack(RtcEventLog::EncodingType::kCompact);
+}
+
+// Logs the packets of an audio and a video stream, with consecutive sequence
+// numbers and header extensions, in both encodings and checks that the
+// compact log holds the same events in a fraction of the size.
+TEST(RtcEventLogTest, CompactLogIsSmaller) {
+  const size_t kNumFrames = 60;
+  const size_t kPacketsPerFrame = 8;
+  Random prng(1234);
+
+  RtpHeaderExtensionMap extensions;
+  extensions.Register(kRtpExtensionAudioLevel, 1);
+  extensions.Register(kRtpExtensionAbsoluteSendTime, 2);
+  extensions.Register(kRtpExtensionTransportSequenceNumber, 3);
+  RtpPacketToSend first_video_packet(&extensions, 1200);
+  first_video_packet.SetPayloadType(100);
+  first_video_packet.SetSsrc(0x12345678);
+  first_video_packet.SetSequenceNumber(prng.Rand<uint16_t>());
+  first_video_packet.SetTimestamp(prng.Rand<uint32_t>());
+  RtpPacketToSend first_audio_packet(&extensions, 200);
+  first_audio_packet.SetPayloadType(111);
+  first_audio_packet.SetSsrc(0x9abcdef0);
+  first_audio_packet.SetSequenceNumber(prng.Rand<uint16_t>());
+  first_audio_packet.SetTimestamp(prng.Rand<uint32_t>());
+  rtc::Buffer rtcp_packet = GenerateRtcpPacket(&prng);
+
+  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  const std::string temp_filename[] = {
+      test::OutputPath() + test_info->test_case_name() + test_info->name(),
+      test::OutputPath() + test_info->test_case_name() + test_info->name() +
+          "Compact"};
+  const RtcEventLog::EncodingType encodings[] = {
+      RtcEventLog::EncodingType::kLegacy, RtcEventLog::EncodingType::kCompact};
+  for (size_t i = 0; i < 2; ++i) {
+    // Log the same packets in both encodings.
+    RtpPacketToSend video_packet = first_video_packet;
+    RtpPacketToSend audio_packet = first_audio_packet;
+    Random packet_prng(5678);
+    uint16_t transport_sequence_number = 0;
+    rtc::ScopedFakeClock fake_clock;
+    fake_clock.SetTimeMicros(1000000);
+    std::unique_ptr<RtcEventLog> log_dumper(RtcEventLog::Create(encodings[i]));
+    log_dumper->StartLogging(temp_filename[i], 10000000);
+    for (size_t frame = 0; frame < kNumFrames; ++frame) {
+      for (size_t j = 0; j < kPacketsPerFrame; ++j) {
+        video_packet.SetSequenceNumber(video_packet.SequenceNumber() + 1);
+        video_packet.SetMarker(j == kPacketsPerFrame - 1);
+        video_packet.SetExtension<AbsoluteSendTime>(
+            AbsoluteSendTime::MsTo24Bits(rtc::TimeMillis()));
+        video_packet.SetExtension<TransportSequenceNumber>(
+            transport_sequence_number++);
+        log_dumper->LogRtpHeader(kOutgoingPacket, MediaType::VIDEO,
+                                 video_packet.data(),
+                                 1000 + packet_prng.Rand(0, 200));
+        fake_clock.AdvanceTimeMicros(packet_prng.Rand(100, 1000));
+      }
+      video_packet.SetTimestamp(video_packet.Timestamp() + 3000);
+      if (frame % 2 == 0) {
+        audio_packet.SetSequenceNumber(audio_packet.SequenceNumber() + 1);
+        audio_packet.SetTimestamp(audio_packet.Timestamp() + 960);
+        audio_packet.SetExtension<AudioLevel>(true, packet_prng.Rand(127));
+        audio_packet.SetExtension<AbsoluteSendTime>(
+            AbsoluteSendTime::MsTo24Bits(rtc::TimeMillis()));
+        audio_packet.SetExtension<TransportSequenceNumber>(
+            transport_sequence_number++);
+        log_dumper->LogRtpHeader(kOutgoingPacket, MediaType::AUDIO,
+                                 audio_packet.data(), audio_packet.size());
+      }
+      if (frame % 10 == 0) {
+        log_dumper->LogRtcpPacket(kIncomingPacket, MediaType::VIDEO,
+                                  rtcp_packet.data(), rtcp_packet.size());
+      }
+      fake_clock.AdvanceTimeMicros(packet_prng.Rand(10000, 20000));
+    }
+    log_dumper->StopLogging();
+  }
+
+  ParsedRtcEventLog parsed_logs[2];
+  ASSERT_TRUE(parsed_logs[0].ParseFile(temp_filename[0]));
+  ASSERT_TRUE(parsed_logs[1].ParseFile(temp_filename[1]));
+  ASSERT_EQ(parsed_logs[0].GetNumberOfEvents(),
+            parsed_logs[1].GetNumberOfEvents());
+  for (size_t i = 0; i < parsed_logs[0].GetNumberOfEvents(); ++i) {
+    ASSERT_EQ(parsed_logs[0].GetEventType(i), parsed_logs[1].GetEventType(i));
+    EXPECT_EQ(parsed_logs[0].GetTimestamp(i), parsed_logs[1].GetTimestamp(i));
+    if (parsed_logs[0].GetEventType(i) == ParsedRtcEventLog::RTP_EVENT) {
+      uint8_t headers[2][IP_PACKET_SIZE];
+      size_t header_lengths[2];
+      size_t total_lengths[2];
+      MediaType media_types[2];
+      for (size_t j = 0; j < 2; ++j) {
+        parsed_logs[j].GetRtpHeader(i, nullptr, &media_types[j], headers[j],
+                                    &header_lengths[j], &total_lengths[j]);
+      }
+      EXPECT_EQ(media_types[0], media_types[1]);
+      EXPECT_EQ(total_lengths[0], total_lengths[1]);
+      ASSERT_EQ(header_lengths[0], header_lengths[1]);
+      EXPECT_EQ(0, memcmp(headers[0], headers[1], header_lengths[0]));
+    }
+  }
+
+  size_t sizes[2];
+  for (size_t i = 0; i < 2; ++i) {
+    FILE* file = fopen(temp_filename[i].c_str(), "rb");
+    ASSERT_TRUE(file);
+    fseek(file, 0, SEEK_END);
+    sizes[i] = static_cast<size_t>(ftell(file));
+    fclose(file);
+    remove(temp_filename[i].c_str());
+  }
+  test::PrintResult("rtc_event_log_size", "", "legacy", sizes[0], "bytes",
+                    false);
+  test::PrintResult("rtc_event_log_size", "", "compact", sizes[1], "bytes",
+                    false);
+  EXPECT_LT(sizes[1] * 3, sizes[0]);
+}
+
+// Measures the time the calling thread spends logging an RTP and an RTCP
+// packet, with the null event log, with the event log keeping its history in
+// memory and with the event log writing to a file. The packets are logged in
+// bursts which fit in the event queues, with pauses in between to let the
+// logging thread catch up.
+TEST(RtcEventLogTest, LogPacketCost) {
+  const int kBursts = 5;
+  const int kPacketsPerBurst = 200;
+  Random prng(1234);
+
+  RtpHeaderExtensionMap extensions;
+  for (unsigned i = 0; i < kNumExtensions; i++)
+    extensions.Register(kExtensionTypes[i], i + 1);
+  RtpPacketToSend rtp_packet = GenerateRtpPacket(&extensions, 0, 1000, &prng);
+  rtc::Buffer rtcp_packet = GenerateRtcpPacket(&prng);
+
+  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  const std::string temp_filename =
+      test::OutputPath() + test_info->test_case_name() + test_info->name();
+
+  const char* kModes[] = {"null", "memory", "file"};
+  for (size_t mode = 0; mode < arraysize(kModes); ++mode) {
+    std::unique_ptr<RtcEventLog> log_dumper(
+        mode == 0 ? RtcEventLog::CreateNull() : RtcEventLog::Create());
+    if (mode == 2)
+      log_dumper->StartLogging(temp_filename, 0);
+    int64_t elapsed_ns = 0;
+    for (int burst = 0; burst < kBursts; ++burst) {
+      int64_t start_ns = rtc::TimeNanos();
+      for (int i = 0; i < kPacketsPerBurst; ++i) {
+        log_dumper->LogRtpHeader(kOutgoingPacket, MediaType::VIDEO,
+                                 rtp_packet.data(), rtp_packet.size());
+        log_dumper->LogRtcpPacket(kIncomingPacket, MediaType::VIDEO,
+                                  rtcp_packet.data(), rtcp_packet.size());
+      }
+      elapsed_ns += rtc::TimeNanos() - start_ns;
+      SleepMs(150);
+    }
+    if (mode == 2)
+      log_dumper->StopLogging();
+    test::PrintResult("rtc_event_log_packet", "", kModes[mode],
+                      elapsed_ns / (2 * kBursts * kPacketsPerBurst),
+                      "ns/packet", false);
+  }
+  remove(temp_filename.c_str());
+}
+
+// Logs RTP packets from more threads than there are packet rings and checks
+// that the packets of every thread are read back, in the order in which the
+// thread logged them.
+TEST(RtcEventLogTest, LogPacketsFromManyThreads) {
+  const size_t kNumThreads = 20;
+  const uint16_t kPacketsPerThread = 50;
+
+  struct LoggingThread {
+    static bool Run(void* obj) {
+      LoggingThread* thread = static_cast<LoggingThread*>(obj);
+      RtpPacketToSend rtp_packet(nullptr);
+      rtp_packet.SetSsrc(thread->ssrc);
+      rtp_packet.AllocatePayload(100);
+      for (uint16_t i = 0; i < kPacketsPerThread; ++i) {
+        rtp_packet.SetSequenceNumber(i);
+        thread->event_log->LogRtpHeader(kOutgoingPacket, MediaType::VIDEO,
+                                        rtp_packet.data(), rtp_packet.size());
+      }
+      return false;
+    }
+    RtcEventLog* event_log;
+    uint32_t ssrc;
+  };
+
+  auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  const std::string temp_filename =
+      test::OutputPath() + test_info->test_case_name() + test_info->name();
+
+  std::unique_ptr<RtcEventLog> log_dumper(RtcEventLog::Create());
+  log_dumper->StartLogging(temp_filename, 10000000);
+  LoggingThread logging_threads[kNumThreads];
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    logging_threads[i].event_log = log_dumper.get();
+    logging_threads[i].ssrc = i;
+    threads.emplace_back(new rtc::PlatformThread(
+        &LoggingThread::Run, &logging_threads[i], "RtcEventLogTest"));
+  }
+  for (auto& thread : threads)
+    thread->Start();
+  for (auto& thread : threads)
+    thread->Stop();
+  log_dumper->StopLogging();
+
+  ParsedRtcEventLog parsed_log;
+  ASSERT_TRUE(parsed_log.ParseFile(temp_filename));
+  ASSERT_EQ(2 + kNumThreads * kPacketsPerThread,
+            parsed_log.GetNumberOfEvents());
+  std::vector<uint16_t> next_sequence_number(kNumThreads, 0);
+  for (size_t i = 1; i + 1 < parsed_log.GetNumberOfEvents(); ++i) {
+    ASSERT_EQ(ParsedRtcEventLog::RTP_EVENT, parsed_log.GetEventType(i));
+    uint8_t header[IP_PACKET_SIZE];
+    parsed_log.GetRtpHeader(i, nullptr, nullptr, header, nullptr, nullptr);
+    uint32_t ssrc = ByteReader<uint32_t>::ReadBigEndian(header + 8);
+    ASSERT_LT(ssrc, kNumThreads);
+    EXPECT_EQ(next_sequence_number[ssrc]++,
+              ByteReader<uint16_t>::ReadBigEndian(header + 2));
+  }
+  for (uint16_t sequence_number : next_sequence_number)
+    EXPECT_EQ(kPacketsPerThread, sequence_number);
+
+  remove(temp_filename.c_str());
+}
+
 TEST(RtcEventLogTest, LogEventAndReadBack) {
   Random prng(987654321);
 
@@ -25,6 +25,8 @@ enum PreservedErrno {
 
 #include <memory>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include "usrsctplib/usrsctp.h"
 #include "webrtc/base/arraysize.h"
@@ -296,13 +298,10 @@ class SctpTransport::UsrSctpWrapper {
                     << "; set_df: " << std::hex << static_cast<int>(set_df);
 
     VerboseLogPacket(data, length, SCTP_DUMP_OUTBOUND);
-    // Note: We have to copy the data; the caller will delete it.
-    rtc::CopyOnWriteBuffer buf(reinterpret_cast<uint8_t*>(data), length);
-    // TODO(deadbeef): Why do we need an AsyncInvoke here? We're already on the
-    // right thread and don't need to unwind the stack.
-    transport->invoker_.AsyncInvoke<void>(
-        RTC_FROM_HERE, transport->network_thread_,
-        rtc::Bind(&SctpTransport::OnPacketFromSctpToNetwork, transport, buf));
+    // Note: We have to copy the data; the caller will delete it. The packet
+    // can't be sent from here even on the network thread, since usrsctp holds
+    // its locks, and the transport may deliver a response synchronously.
+    transport->QueueOutboundPacket(data, length);
     return 0;
   }
 
@@ -330,19 +329,14 @@ class SctpTransport::UsrSctpWrapper {
       LOG(LS_ERROR) << "Received an unknown PPID " << ppid
                     << " on an SCTP packet.  Dropping.";
     } else {
-      rtc::CopyOnWriteBuffer buffer;
-      ReceiveDataParams params;
-      buffer.SetData(reinterpret_cast<uint8_t*>(data), length);
-      params.sid = rcv.rcv_sid;
-      params.seq_num = rcv.rcv_ssn;
-      params.timestamp = rcv.rcv_tsn;
-      params.type = type;
-      // The ownership of the packet transfers to |invoker_|. Using
-      // CopyOnWriteBuffer is the most convenient way to do this.
-      transport->invoker_.AsyncInvoke<void>(
-          RTC_FROM_HERE, transport->network_thread_,
-          rtc::Bind(&SctpTransport::OnInboundPacketFromSctpToChannel, transport,
-                    buffer, params, flags));
+      SctpInboundPacket packet;
+      packet.buffer.SetData(reinterpret_cast<uint8_t*>(data), length);
+      packet.params.sid = rcv.rcv_sid;
+      packet.params.seq_num = rcv.rcv_ssn;
+      packet.params.timestamp = rcv.rcv_tsn;
+      packet.params.type = type;
+      packet.flags = flags;
+      transport->QueueInboundPacket(&packet);
     }
     free(data);
     return 1;
@@ -417,6 +411,13 @@ void SctpTransport::SetTransportChannel(rtc::PacketTransportInternal* channel) {
   }
 }
 
+void SctpTransport::SetBufferSizes(int send_buffer_size,
+                                   int receive_buffer_size) {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  send_buffer_size_ = send_buffer_size;
+  receive_buffer_size_ = receive_buffer_size;
+}
+
 bool SctpTransport::Start(int local_sctp_port, int remote_sctp_port) {
   RTC_DCHECK_RUN_ON(network_thread_);
   if (local_sctp_port == -1) {
@@ -654,10 +655,12 @@ bool SctpTransport::OpenSctpSocket() {
   // still have to do something reasonable here.  Look up what the buffer's
   // real size is and set our threshold to something reasonable.
   static const int kSendThreshold = usrsctp_sysctl_get_sctp_sendspace() / 2;
+  const int send_threshold =
+      send_buffer_size_ > 0 ? send_buffer_size_ / 2 : kSendThreshold;
 
   sock_ = usrsctp_socket(
       AF_CONN, SOCK_STREAM, IPPROTO_SCTP, &UsrSctpWrapper::OnSctpInboundPacket,
-      &UsrSctpWrapper::SendThresholdCallback, kSendThreshold, this);
+      &UsrSctpWrapper::SendThresholdCallback, send_threshold, this);
   if (!sock_) {
     LOG_ERRNO(LS_ERROR) << debug_name_ << "->OpenSctpSocket(): "
                         << "Failed to create SCTP socket.";
@@ -713,6 +716,23 @@ bool SctpTransport::ConfigureSctpSocket() {
     return false;
   }
 
+  // The receive buffer size also sets the window advertised in the INIT, so
+  // it has to be set before connecting.
+  if (send_buffer_size_ > 0 &&
+      usrsctp_setsockopt(sock_, SOL_SOCKET, SO_SNDBUF, &send_buffer_size_,
+                         sizeof(send_buffer_size_))) {
+    LOG_ERRNO(LS_ERROR) << debug_name_ << "->ConfigureSctpSocket(): "
+                        << "Failed to set SO_SNDBUF.";
+    return false;
+  }
+  if (receive_buffer_size_ > 0 &&
+      usrsctp_setsockopt(sock_, SOL_SOCKET, SO_RCVBUF, &receive_buffer_size_,
+                         sizeof(receive_buffer_size_))) {
+    LOG_ERRNO(LS_ERROR) << debug_name_ << "->ConfigureSctpSocket(): "
+                        << "Failed to set SO_RCVBUF.";
+    return false;
+  }
+
   // Nagle.
   uint32_t nodelay = 1;
   if (usrsctp_setsockopt(sock_, IPPROTO_SCTP, SCTP_NODELAY, &nodelay,
@@ -869,13 +889,83 @@ sockaddr_conn SctpTransport::GetSctpSockAddr(int port) {
   return sconn;
 }
 
-void SctpTransport::OnPacketFromSctpToNetwork(
-    const rtc::CopyOnWriteBuffer& buffer) {
+void SctpTransport::QueueOutboundPacket(const void* data, size_t length) {
+  bool first_in_batch;
+  {
+    rtc::CritScope cs(&queue_crit_);
+    first_in_batch = outbound_sizes_.empty();
+    outbound_data_.AppendData(static_cast<const uint8_t*>(data), length);
+    outbound_sizes_.push_back(length);
+  }
+  if (first_in_batch) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&SctpTransport::SendQueuedOutboundPackets, this));
+  }
+}
+
+void SctpTransport::QueueInboundPacket(SctpInboundPacket* packet) {
+  bool first_in_batch;
+  {
+    rtc::CritScope cs(&queue_crit_);
+    first_in_batch = inbound_packets_.empty();
+    inbound_packets_.push_back(std::move(*packet));
+  }
+  if (first_in_batch) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&SctpTransport::DeliverQueuedInboundPackets, this));
+  }
+}
+
+void SctpTransport::SendQueuedOutboundPackets() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  TRACE_EVENT0("webrtc", "SctpTransport::SendQueuedOutboundPackets");
+  {
+    rtc::CritScope cs(&queue_crit_);
+    swap(sending_data_, outbound_data_);
+    sending_sizes_.swap(outbound_sizes_);
+  }
+  // Packets queued while these are sent, e.g. by the peer's responses when
+  // the transport delivers them synchronously, start a new batch.
+  size_t offset = 0;
+  for (size_t size : sending_sizes_) {
+    OnPacketFromSctpToNetwork(sending_data_.data<char>() + offset, size);
+    offset += size;
+  }
+  sending_data_.Clear();
+  sending_sizes_.clear();
+}
+
+void SctpTransport::DeliverQueuedInboundPackets() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  // The packets are moved to a local vector, since a slot of
+  // SignalDataReceived may destroy the transport, e.g. when a data channel
+  // closes. The spare capacity still goes back and forth with the queue.
+  std::vector<SctpInboundPacket> packets;
+  packets.swap(delivering_packets_);
+  {
+    rtc::CritScope cs(&queue_crit_);
+    packets.swap(inbound_packets_);
+  }
+  rtc::WeakPtr<SctpTransport> weak_this = weak_factory_.GetWeakPtr();
+  for (const SctpInboundPacket& packet : packets) {
+    OnInboundPacketFromSctpToChannel(packet.buffer, packet.params,
+                                     packet.flags);
+    if (!weak_this)
+      return;
+  }
+  packets.clear();
+  delivering_packets_.swap(packets);
+}
+
+void SctpTransport::OnPacketFromSctpToNetwork(const char* data,
+                                              size_t length) {
   RTC_DCHECK_RUN_ON(network_thread_);
-  if (buffer.size() > (kSctpMtu)) {
+  if (length > (kSctpMtu)) {
     LOG(LS_ERROR) << debug_name_ << "->OnPacketFromSctpToNetwork(...): "
                   << "SCTP seems to have made a packet that is bigger "
-                  << "than its official MTU: " << buffer.size() << " vs max of "
+                  << "than its official MTU: " << length << " vs max of "
                   << kSctpMtu;
   }
   TRACE_EVENT0("webrtc", "SctpTransport::OnPacketFromSctpToNetwork");
@@ -887,8 +977,8 @@ void SctpTransport::OnPacketFromSctpToNetwork(
   }
 
   // Bon voyage.
-  transport_channel_->SendPacket(buffer.data<char>(), buffer.size(),
-                                 rtc::PacketOptions(), PF_NORMAL);
+  transport_channel_->SendPacket(data, length, rtc::PacketOptions(),
+                                 PF_NORMAL);
 }
 
 void SctpTransport::OnInboundPacketFromSctpToChannel(
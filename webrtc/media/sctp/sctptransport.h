@@ -19,10 +19,14 @@
 #include <vector>
 
 #include "webrtc/base/asyncinvoker.h"
+#include "webrtc/base/buffer.h"
 #include "webrtc/base/constructormagic.h"
 #include "webrtc/base/copyonwritebuffer.h"
+#include "webrtc/base/criticalsection.h"
 #include "webrtc/base/sigslot.h"
 #include "webrtc/base/thread.h"
+#include "webrtc/base/thread_annotations.h"
+#include "webrtc/base/weak_ptr.h"
 // For SendDataParams/ReceiveDataParams.
 #include "webrtc/media/base/mediachannel.h"
 #include "webrtc/media/sctp/sctptransportinternal.h"
@@ -36,7 +40,13 @@ struct socket;
 namespace cricket {
 
 // Holds data to be passed on to a channel.
-struct SctpInboundPacket;
+struct SctpInboundPacket {
+  rtc::CopyOnWriteBuffer buffer;
+  ReceiveDataParams params;
+  // Used by SCTP to distinguish notification packets from other types of
+  // packets.
+  int flags = 0;
+};
 
 // From channel calls, data flows like this:
 // [network thread (although it can in princple be another thread)]
@@ -44,20 +54,25 @@ struct SctpInboundPacket;
 //  2.  usrsctp_sendv(data)
 // [network thread returns; sctp thread then calls the following]
 //  3.  OnSctpOutboundPacket(wrapped_data)
-// [sctp thread returns having async invoked on the network thread]
-//  4.  SctpTransport::OnPacketFromSctpToNetwork(wrapped_data)
+// [sctp thread returns having queued the packet, and async invoked on the
+//  network thread if the queue was empty]
+//  4.  SctpTransport::SendQueuedOutboundPackets()
 //  5.  TransportChannel::SendPacket(wrapped_data)
 //  6.  ... across network ... a packet is sent back ...
 //  7.  SctpTransport::OnPacketReceived(wrapped_data)
 //  8.  usrsctp_conninput(wrapped_data)
 // [network thread returns; sctp thread then calls the following]
 //  9.  OnSctpInboundData(data)
-// [sctp thread returns having async invoked on the network thread]
+// [sctp thread returns having queued the data, and async invoked on the
+//  network thread if the queue was empty]
 //  10. SctpTransport::OnInboundPacketFromSctpToChannel(inboundpacket)
 //  11. SctpTransport::OnDataFromSctpToChannel(data)
 //  12. SctpTransport::SignalDataReceived(data)
 // [from the same thread, methods registered/connected to
 //  SctpTransport are called with the recieved data]
+// Packets are queued so that all the packets usrsctp produces at once, such
+// as the fragments of a large message or a burst of data chunks from one
+// received packet, are handled by a single task on the network thread.
 // TODO(zhihuang): Rename "channel" to "transport" on network-level.
 class SctpTransport : public SctpTransportInternal,
                       public sigslot::has_slots<> {
@@ -83,6 +98,13 @@ class SctpTransport : public SctpTransportInternal,
     debug_name_ = debug_name;
   }
 
+  // Sets the sizes of the SCTP socket's send and receive buffers, which
+  // bound how much data can be queued for sending and the window advertised
+  // to the peer. Larger buffers allow more throughput on paths with a high
+  // bandwidth-delay product. 0 keeps the usrsctp default. Only applies to
+  // sockets created afterwards, so should be called before Start().
+  void SetBufferSizes(int send_buffer_size, int receive_buffer_size);
+
   // Exposed to allow Post call from c-callbacks.
   // TODO(deadbeef): Remove this or at least make it return a const pointer.
   rtc::Thread* network_thread() const { return network_thread_; }
@@ -119,9 +141,17 @@ class SctpTransport : public SctpTransportInternal,
   void OnSendThresholdCallback();
   sockaddr_conn GetSctpSockAddr(int port);
 
-  // Called using |invoker_| to send packet on the network.
-  void OnPacketFromSctpToNetwork(const rtc::CopyOnWriteBuffer& buffer);
-  // Called using |invoker_| to decide what to do with the packet.
+  // Called by usrsctp callbacks, possibly on a usrsctp thread, to queue
+  // packets for the network thread. Only the first packet of a batch posts a
+  // task.
+  void QueueOutboundPacket(const void* data, size_t length);
+  void QueueInboundPacket(SctpInboundPacket* packet);
+  // Called using |invoker_| to send or deliver all the queued packets.
+  void SendQueuedOutboundPackets();
+  void DeliverQueuedInboundPackets();
+
+  void OnPacketFromSctpToNetwork(const char* data, size_t length);
+  // Decides what to do with the packet.
   // The |flags| parameter is used by SCTP to distinguish notification packets
   // from other types of packets.
   void OnInboundPacketFromSctpToChannel(const rtc::CopyOnWriteBuffer& buffer,
@@ -144,6 +174,8 @@ class SctpTransport : public SctpTransportInternal,
   bool was_ever_writable_ = false;
   int local_port_ = kSctpDefaultPort;
   int remote_port_ = kSctpDefaultPort;
+  int send_buffer_size_ = 0;
+  int receive_buffer_size_ = 0;
   struct socket* sock_ = nullptr;  // The socket created by usrsctp_socket(...).
 
   // Has Start been called? Don't create SCTP socket until it has.
@@ -165,11 +197,29 @@ class SctpTransport : public SctpTransportInternal,
   StreamSet queued_reset_streams_;
   StreamSet sent_reset_streams_;
 
+  // Guards the queues filled by usrsctp callbacks, which can run on usrsctp
+  // threads.
+  rtc::CriticalSection queue_crit_;
+  // Outbound packets are stored back to back in |outbound_data_|, with their
+  // sizes in |outbound_sizes_|. The queues are swapped with the |sending_|
+  // ones when they are sent, so their capacity is reused and queuing a
+  // packet doesn't allocate in the steady state.
+  rtc::Buffer outbound_data_ GUARDED_BY(queue_crit_);
+  std::vector<size_t> outbound_sizes_ GUARDED_BY(queue_crit_);
+  rtc::Buffer sending_data_;
+  std::vector<size_t> sending_sizes_;
+  std::vector<SctpInboundPacket> inbound_packets_ GUARDED_BY(queue_crit_);
+  std::vector<SctpInboundPacket> delivering_packets_;
+
   // A static human-readable name for debugging messages.
   const char* debug_name_ = "SctpTransport";
   // Hides usrsctp interactions from this header file.
   class UsrSctpWrapper;
 
+  // Lets DeliverQueuedInboundPackets() stop if a slot destroys the transport.
+  // Must be the last member, so that it is destroyed first.
+  rtc::WeakPtrFactory<SctpTransport> weak_factory_{this};
+
   RTC_DISALLOW_COPY_AND_ASSIGN(SctpTransport);
 };
 
@@ -180,12 +230,22 @@ class SctpTransportFactory : public SctpTransportInternalFactory {
 
   std::unique_ptr<SctpTransportInternal> CreateSctpTransport(
       rtc::PacketTransportInternal* channel) override {
-    return std::unique_ptr<SctpTransportInternal>(
-        new SctpTransport(network_thread_, channel));
+    SctpTransport* transport = new SctpTransport(network_thread_, channel);
+    transport->SetBufferSizes(send_buffer_size_, receive_buffer_size_);
+    return std::unique_ptr<SctpTransportInternal>(transport);
+  }
+
+  // Sets the buffer sizes of the transports created afterwards. See
+  // SctpTransport::SetBufferSizes.
+  void SetBufferSizes(int send_buffer_size, int receive_buffer_size) {
+    send_buffer_size_ = send_buffer_size;
+    receive_buffer_size_ = receive_buffer_size;
   }
 
  private:
   rtc::Thread* network_thread_;
+  int send_buffer_size_ = 0;
+  int receive_buffer_size_ = 0;
 };
 
 }  // namespace cricket
@@ -12,6 +12,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -23,8 +24,10 @@
 #include "webrtc/base/helpers.h"
 #include "webrtc/base/ssladapter.h"
 #include "webrtc/base/thread.h"
+#include "webrtc/base/timeutils.h"
 #include "webrtc/media/sctp/sctptransport.h"
 #include "webrtc/p2p/base/fakedtlstransport.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 namespace {
 static const int kDefaultTimeout = 10000;  // 10 seconds.
@@ -67,6 +70,20 @@ class SctpFakeDataReceiver : public sigslot::has_slots<> {
   ReceiveDataParams last_params_;
 };
 
+// Counts the received bytes, for throughput tests.
+class SctpByteCounter : public sigslot::has_slots<> {
+ public:
+  void OnDataReceived(const ReceiveDataParams& params,
+                      const rtc::CopyOnWriteBuffer& data) {
+    bytes_received_ += data.size();
+  }
+
+  size_t bytes_received() const { return bytes_received_; }
+
+ private:
+  size_t bytes_received_ = 0;
+};
+
 class SignalReadyToSendObserver : public sigslot::has_slots<> {
  public:
   SignalReadyToSendObserver() : signaled_(false) {}
@@ -560,4 +577,57 @@ TEST_F(SctpTransportTest, DISABLED_ReusesAStream) {
                    kDefaultTimeout);
 }
 
+// Measures the throughput of a data channel over a loopback DTLS transport,
+// with the default buffers and with larger ones. Sends as fast as the
+// transport accepts data.
+TEST_F(SctpTransportTest, SendDataThroughput) {
+  const size_t kMessageSize = 16 * 1024;
+  const size_t kTotalBytes = 32 * 1024 * 1024;
+  const int kLargeBufferSize = 1024 * 1024;
+  for (int buffer_size : {0, kLargeBufferSize}) {
+    FakeDtlsTransport fake_dtls1("fake dtls 1", 0);
+    FakeDtlsTransport fake_dtls2("fake dtls 2", 0);
+    SctpFakeDataReceiver recv1;
+    SctpByteCounter counter;
+    std::unique_ptr<SctpTransport> transport1(
+        CreateTransport(&fake_dtls1, &recv1));
+    std::unique_ptr<SctpTransport> transport2(
+        new SctpTransport(rtc::Thread::Current(), &fake_dtls2));
+    transport2->SignalDataReceived.connect(&counter,
+                                           &SctpByteCounter::OnDataReceived);
+    transport1->SetBufferSizes(buffer_size, buffer_size);
+    transport2->SetBufferSizes(buffer_size, buffer_size);
+    transport1->OpenStream(1);
+    transport2->OpenStream(1);
+    transport1->Start(kTransport1Port, kTransport2Port);
+    transport2->Start(kTransport2Port, kTransport1Port);
+    fake_dtls1.SetDestination(&fake_dtls2, false);
+    ASSERT_TRUE_WAIT(transport1->ReadyToSendData(), kDefaultTimeout);
+
+    SendDataParams params;
+    params.sid = 1;
+    params.type = DMT_BINARY;
+    rtc::CopyOnWriteBuffer payload(kMessageSize);
+    memset(payload.data(), 0x55, kMessageSize);
+    size_t bytes_sent = 0;
+    int64_t start_ms = rtc::TimeMillis();
+    while (counter.bytes_received() < kTotalBytes) {
+      ASSERT_LT(rtc::TimeMillis() - start_ms, kDefaultTimeout);
+      if (bytes_sent < kTotalBytes && transport1->ReadyToSendData() &&
+          transport1->SendData(params, payload)) {
+        bytes_sent += kMessageSize;
+        continue;
+      }
+      // Let the packets and the acknowledgments flow.
+      rtc::Thread::Current()->ProcessMessages(1);
+    }
+    int64_t elapsed_ms = std::max<int64_t>(rtc::TimeMillis() - start_ms, 1);
+
+    webrtc::test::PrintResult(
+        "sctp_send_data", "",
+        buffer_size ? "large_buffers" : "default_buffers",
+        kTotalBytes * 8 / 1000 / elapsed_ms, "Mbps", false);
+  }
+}
+
 }  // namespace cricket
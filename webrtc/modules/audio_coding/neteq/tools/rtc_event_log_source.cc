@@ -24,6 +24,10 @@
 namespace webrtc {
 namespace test {
 
+namespace {
+const size_t kEventsPerRead = 10000;
+}  // namespace
+
 RtcEventLogSource* RtcEventLogSource::Create(const std::string& file_name) {
   RtcEventLogSource* source = new RtcEventLogSource();
   RTC_CHECK(source->OpenFile(file_name));
@@ -39,20 +43,21 @@ bool RtcEventLogSource::RegisterRtpHeaderExtension(RTPExtensionType type,
 }
 
 std::unique_ptr<Packet> RtcEventLogSource::NextPacket() {
-  while (rtp_packet_index_ < parsed_stream_.GetNumberOfEvents()) {
-    if (parsed_stream_.GetEventType(rtp_packet_index_) ==
-        ParsedRtcEventLog::RTP_EVENT) {
+  Cursor& cursor = rtp_packet_cursor_;
+  while (cursor.HasEvent()) {
+    const ParsedRtcEventLog& events = cursor.events;
+    if (events.GetEventType(cursor.index) == ParsedRtcEventLog::RTP_EVENT) {
       PacketDirection direction;
       MediaType media_type;
       size_t header_length;
       size_t packet_length;
-      uint64_t timestamp_us = parsed_stream_.GetTimestamp(rtp_packet_index_);
-      parsed_stream_.GetRtpHeader(rtp_packet_index_, &direction, &media_type,
-                                  nullptr, &header_length, &packet_length);
+      uint64_t timestamp_us = events.GetTimestamp(cursor.index);
+      events.GetRtpHeader(cursor.index, &direction, &media_type, nullptr,
+                          &header_length, &packet_length);
       if (direction == kIncomingPacket && media_type == MediaType::AUDIO) {
         uint8_t* packet_header = new uint8_t[header_length];
-        parsed_stream_.GetRtpHeader(rtp_packet_index_, nullptr, nullptr,
-                                    packet_header, nullptr, nullptr);
+        events.GetRtpHeader(cursor.index, nullptr, nullptr, packet_header,
+                            nullptr, nullptr);
         std::unique_ptr<Packet> packet(new Packet(
             packet_header, header_length, packet_length,
             static_cast<double>(timestamp_us) / 1000, *parser_.get()));
@@ -60,42 +65,56 @@ std::unique_ptr<Packet> RtcEventLogSource::NextPacket() {
           // Check if the packet should not be filtered out.
           if (!filter_.test(packet->header().payloadType) &&
               !(use_ssrc_filter_ && packet->header().ssrc != ssrc_)) {
-            rtp_packet_index_++;
+            cursor.index++;
             return packet;
           }
         } else {
-          std::cout << "Warning: Packet with index " << rtp_packet_index_
+          std::cout << "Warning: Packet with index " << cursor.event_number()
                     << " has an invalid header and will be ignored."
                     << std::endl;
         }
       }
     }
-    rtp_packet_index_++;
+    cursor.index++;
   }
   return nullptr;
 }
 
 int64_t RtcEventLogSource::NextAudioOutputEventMs() {
-  while (audio_output_index_ < parsed_stream_.GetNumberOfEvents()) {
-    if (parsed_stream_.GetEventType(audio_output_index_) ==
+  Cursor& cursor = audio_output_cursor_;
+  while (cursor.HasEvent()) {
+    const ParsedRtcEventLog& events = cursor.events;
+    if (events.GetEventType(cursor.index) ==
         ParsedRtcEventLog::AUDIO_PLAYOUT_EVENT) {
-      uint64_t timestamp_us = parsed_stream_.GetTimestamp(audio_output_index_);
+      uint64_t timestamp_us = events.GetTimestamp(cursor.index);
       // We call GetAudioPlayout only to check that the protobuf event is
       // well-formed.
-      parsed_stream_.GetAudioPlayout(audio_output_index_, nullptr);
-      audio_output_index_++;
+      events.GetAudioPlayout(cursor.index, nullptr);
+      cursor.index++;
       return timestamp_us / 1000;
     }
-    audio_output_index_++;
+    cursor.index++;
   }
   return std::numeric_limits<int64_t>::max();
 }
 
+bool RtcEventLogSource::Cursor::HasEvent() {
+  if (index < events.GetNumberOfEvents())
+    return true;
+  first_event_number += events.GetNumberOfEvents();
+  index = 0;
+  if (reader.ReadEvents(kEventsPerRead, &events) > 0)
+    return true;
+  RTC_CHECK(!reader.error()) << "Malformed event log.";
+  return false;
+}
+
 RtcEventLogSource::RtcEventLogSource()
     : PacketSource(), parser_(RtpHeaderParser::Create()) {}
 
 bool RtcEventLogSource::OpenFile(const std::string& file_name) {
-  return parsed_stream_.ParseFile(file_name);
+  return rtp_packet_cursor_.reader.Open(file_name) &&
+         audio_output_cursor_.reader.Open(file_name);
 }
 
 }  // namespace test
@@ -16,6 +16,7 @@
 
 #include "webrtc/base/constructormagic.h"
 #include "webrtc/logging/rtc_event_log/rtc_event_log_parser.h"
+#include "webrtc/logging/rtc_event_log/rtc_event_log_reader.h"
 #include "webrtc/modules/audio_coding/neteq/tools/packet_source.h"
 #include "webrtc/modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 
@@ -48,12 +49,26 @@ class RtcEventLogSource : public PacketSource {
  private:
   RtcEventLogSource();
 
-  bool OpenFile(const std::string& file_name);
+  // A position in the log. The events are read a part at a time, so that
+  // logs of any size can be processed in bounded memory.
+  struct Cursor {
+    // Returns false if there are no more events, otherwise makes sure the
+    // current event, |index| in |events|, has been read.
+    bool HasEvent();
+    // The number of the current event in the log.
+    size_t event_number() const { return first_event_number + index; }
+
+    RtcEventLogReader reader;
+    ParsedRtcEventLog events;
+    size_t index = 0;
+    size_t first_event_number = 0;
+  };
 
-  size_t rtp_packet_index_ = 0;
-  size_t audio_output_index_ = 0;
+  bool OpenFile(const std::string& file_name);
 
-  ParsedRtcEventLog parsed_stream_;
+  // RTP packets and audio output events are read independently.
+  Cursor rtp_packet_cursor_;
+  Cursor audio_output_cursor_;
   std::unique_ptr<RtpHeaderParser> parser_;
 
   RTC_DISALLOW_COPY_AND_ASSIGN(RtcEventLogSource);
@@ -38,6 +38,8 @@ VideoCodecVP8 VideoEncoder::GetDefaultVp8Settings() {
   vp8_settings.automaticResizeOn = false;
   vp8_settings.frameDroppingOn = true;
   vp8_settings.keyFrameInterval = 3000;
+  vp8_settings.numberOfThreads = 0;
+  vp8_settings.tokenPartitions = 0;
 
   return vp8_settings;
 }
@@ -69,6 +71,8 @@ VideoCodecH264 VideoEncoder::GetDefaultH264Settings() {
   h264_settings.ppsData = nullptr;
   h264_settings.ppsLen = 0;
   h264_settings.profile = H264::kProfileConstrainedBaseline;
+  h264_settings.numberOfThreads = 0;
+  h264_settings.numberOfSlices = 0;
 
   return h264_settings;
 }
@@ -11,8 +11,11 @@
 
 #include "webrtc/modules/video_coding/codecs/h264/h264_decoder_impl.h"
 
+#include <stdio.h>
+
 #include <algorithm>
 #include <limits>
+#include <string>
 
 extern "C" {
 #include "third_party/ffmpeg/libavcodec/avcodec.h"
@@ -26,6 +29,7 @@ extern "C" {
 #include "webrtc/base/keep_ref_until_done.h"
 #include "webrtc/base/logging.h"
 #include "webrtc/common_video/include/video_frame_buffer.h"
+#include "webrtc/system_wrappers/include/field_trial.h"
 #include "webrtc/system_wrappers/include/metrics.h"
 
 namespace webrtc {
@@ -44,6 +48,42 @@ enum H264DecoderImplEvent {
   kH264DecoderEventMax = 16,
 };
 
+// Multi-threaded decoding is opt-in. The group name selects the number of
+// threads and the FFmpeg threading model, e.g. "Enabled-4-slice" or
+// "Enabled-4-frame". Slice threading adds no latency but only helps if the
+// encoder produces multiple slices per frame. Frame threading works on any
+// stream but delays the output by up to |thread_count| - 1 frames.
+const char kH264DecoderThreadingFieldTrial[] = "WebRTC-H264DecoderThreading";
+const int kMaxSliceThreads = 16;
+const int kMaxFrameThreads = 4;
+
+void GetThreadingSettings(int number_of_cores,
+                          int* thread_count,
+                          int* thread_type) {
+  *thread_count = 1;
+  *thread_type = FF_THREAD_SLICE;
+  const std::string group =
+      field_trial::FindFullName(kH264DecoderThreadingFieldTrial);
+  int threads = 0;
+  char type[6] = {0};
+  if (sscanf(group.c_str(), "Enabled-%d-%5s", &threads, type) != 2)
+    return;
+  const std::string type_str(type);
+  int max_threads;
+  if (type_str == "slice") {
+    max_threads = kMaxSliceThreads;
+  } else if (type_str == "frame") {
+    *thread_type = FF_THREAD_FRAME;
+    max_threads = kMaxFrameThreads;
+  } else {
+    LOG(LS_WARNING) << "Invalid " << kH264DecoderThreadingFieldTrial
+                    << " group: " << group;
+    return;
+  }
+  *thread_count =
+      std::max(1, std::min(threads, std::min(number_of_cores, max_threads)));
+}
+
 #if defined(WEBRTC_INITIALIZE_FFMPEG)
 
 rtc::CriticalSection ffmpeg_init_lock;
@@ -130,8 +170,10 @@ int H264DecoderImpl::AVGetBuffer2(
   // http://crbug.com/390941. Our pool is set up to zero-initialize new buffers.
   // TODO(nisse): Delete that feature from the video pool, instead add
   // an explicit call to InitializeData here.
+  // The pool is thread-safe, which is required with frame threading where
+  // this is called on FFmpeg's worker threads.
   rtc::scoped_refptr<I420Buffer> frame_buffer =
-      decoder->pool_.CreateBuffer(width, height);
+      decoder->pool_->CreateBuffer(width, height);
 
   int y_size = width * height;
   int uv_size = ((width + 1) / 2) * ((height + 1) / 2);
@@ -176,11 +218,11 @@ void H264DecoderImpl::AVFreeBuffer2(void* opaque, uint8_t* data) {
   delete video_frame;
 }
 
-H264DecoderImpl::H264DecoderImpl() : pool_(true),
-                                     decoded_image_callback_(nullptr),
-                                     has_reported_init_(false),
-                                     has_reported_error_(false) {
-}
+H264DecoderImpl::H264DecoderImpl()
+    : pool_(SharedI420BufferPool::Default()),
+      decoded_image_callback_(nullptr),
+      has_reported_init_(false),
+      has_reported_error_(false) {}
 
 H264DecoderImpl::~H264DecoderImpl() {
   Release();
@@ -228,10 +270,20 @@ int32_t H264DecoderImpl::InitDecode(const VideoCodec* codec_settings,
   av_context_->extradata = nullptr;
   av_context_->extradata_size = 0;
 
-  // If this is ever increased, look at |av_context_->thread_safe_callbacks| and
-  // make it possible to disable the thread checker in the frame buffer pool.
-  av_context_->thread_count = 1;
-  av_context_->thread_type = FF_THREAD_SLICE;
+  int thread_count;
+  int thread_type;
+  GetThreadingSettings(number_of_cores, &thread_count, &thread_type);
+  av_context_->thread_count = thread_count;
+  av_context_->thread_type = thread_type;
+  // With frame threading |get_buffer2| is called from FFmpeg's worker
+  // threads. |AVGetBuffer2| only uses the thread-safe |pool_|, so it is safe
+  // to let FFmpeg call it concurrently.
+  if (thread_count > 1) {
+    av_context_->thread_safe_callbacks = 1;
+    LOG(LS_INFO) << "H.264 decoder using " << thread_count << " "
+                 << (thread_type == FF_THREAD_FRAME ? "frame" : "slice")
+                 << " threads.";
+  }
 
   // Function used by FFmpeg to get buffers to store decoded frames in.
   av_context_->get_buffer2 = AVGetBuffer2;
@@ -319,7 +371,10 @@ int32_t H264DecoderImpl::Decode(const EncodedImage& input_image,
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
   packet.size = static_cast<int>(input_image._length);
-  av_context_->reordered_opaque = input_image.ntp_time_ms_ * 1000;  // ms -> μs
+  // With frame threading the decoded frame returned for this packet may
+  // belong to an earlier packet. FFmpeg passes |reordered_opaque| through to
+  // the frame it belongs to, so use it to carry the RTP timestamp.
+  av_context_->reordered_opaque = input_image._timeStamp;
 
   int frame_decoded = 0;
   int result = avcodec_decode_video2(av_context_.get(),
@@ -340,8 +395,11 @@ int32_t H264DecoderImpl::Decode(const EncodedImage& input_image,
   }
 
   if (!frame_decoded) {
-    LOG(LS_WARNING) << "avcodec_decode_video2 successful but no frame was "
-        "decoded.";
+    // Expected while frame threads are filling up.
+    if (av_context_->active_thread_type != FF_THREAD_FRAME) {
+      LOG(LS_WARNING) << "avcodec_decode_video2 successful but no frame was "
+          "decoded.";
+    }
     return WEBRTC_VIDEO_CODEC_OK;
   }
 
@@ -355,7 +413,8 @@ int32_t H264DecoderImpl::Decode(const EncodedImage& input_image,
                video_frame->video_frame_buffer()->DataU());
   RTC_CHECK_EQ(av_frame_->data[kVPlaneIndex],
                video_frame->video_frame_buffer()->DataV());
-  video_frame->set_timestamp(input_image._timeStamp);
+  video_frame->set_timestamp(
+      static_cast<uint32_t>(av_frame_->reordered_opaque));
 
   int32_t ret;
 
@@ -20,7 +20,7 @@ extern "C" {
 #include "third_party/ffmpeg/libavcodec/avcodec.h"
 }  // extern "C"
 
-#include "webrtc/common_video/include/i420_buffer_pool.h"
+#include "webrtc/common_video/include/shared_i420_buffer_pool.h"
 
 namespace webrtc {
 
@@ -69,7 +69,9 @@ class H264DecoderImpl : public H264Decoder {
   void ReportInit();
   void ReportError();
 
-  I420BufferPool pool_;
+  // Shared with other decoders. |AVGetBuffer2| is called concurrently from
+  // FFmpeg's threads when frame threading is enabled.
+  SharedI420BufferPool* const pool_;
   std::unique_ptr<AVCodecContext, AVCodecContextDeleter> av_context_;
   std::unique_ptr<AVFrame, AVFrameDeleter> av_frame_;
 
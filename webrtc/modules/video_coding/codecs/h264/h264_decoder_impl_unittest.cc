@@ -0,0 +1,178 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ *
+ */
+
+#include "webrtc/modules/video_coding/codecs/h264/h264_decoder_impl.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "webrtc/base/timeutils.h"
+#include "webrtc/modules/video_coding/codecs/h264/h264_encoder_impl.h"
+#include "webrtc/test/field_trial.h"
+#include "webrtc/test/frame_generator.h"
+#include "webrtc/test/gtest.h"
+#include "webrtc/test/testsupport/perf_test.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kMaxPayloadSize = 1024;
+const int kNumCores = 4;
+const int kWidth = 1280;
+const int kHeight = 720;
+const int kNumFrames = 60;
+const int kNumSlices = 4;
+const uint32_t kTimestampDelta = 90000 / 30;
+
+// Owns a padded copy of each encoded image, as required by the decoder.
+class EncodedFrameCollector : public EncodedImageCallback {
+ public:
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info,
+                        const RTPFragmentationHeader* fragmentation) override {
+    const size_t size = encoded_image._length +
+                        EncodedImage::GetBufferPaddingBytes(kVideoCodecH264);
+    buffers_.emplace_back(new uint8_t[size]);
+    memcpy(buffers_.back().get(), encoded_image._buffer,
+           encoded_image._length);
+    frames_.push_back(encoded_image);
+    frames_.back()._buffer = buffers_.back().get();
+    frames_.back()._size = size;
+    return Result(Result::OK);
+  }
+
+  const std::vector<EncodedImage>& frames() const { return frames_; }
+
+ private:
+  std::vector<std::unique_ptr<uint8_t[]>> buffers_;
+  std::vector<EncodedImage> frames_;
+};
+
+class DecodedTimestampCollector : public DecodedImageCallback {
+ public:
+  int32_t Decoded(VideoFrame& decoded_image) override {
+    EXPECT_EQ(kWidth, decoded_image.width());
+    EXPECT_EQ(kHeight, decoded_image.height());
+    timestamps_.push_back(decoded_image.timestamp());
+    return 0;
+  }
+
+  const std::vector<uint32_t>& timestamps() const { return timestamps_; }
+
+ private:
+  std::vector<uint32_t> timestamps_;
+};
+
+class H264DecoderImplTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    H264EncoderImpl encoder(cricket::VideoCodec("H264"));
+    VideoCodec codec_settings;
+    codec_settings.codecType = kVideoCodecH264;
+    codec_settings.maxFramerate = 30;
+    codec_settings.width = kWidth;
+    codec_settings.height = kHeight;
+    codec_settings.H264()->frameDroppingOn = false;
+    codec_settings.H264()->numberOfSlices = kNumSlices;
+    codec_settings.startBitrate = 2000;
+    codec_settings.targetBitrate = 2000;
+    codec_settings.maxBitrate = 4000;
+    ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              encoder.InitEncode(&codec_settings, kNumCores, kMaxPayloadSize));
+    encoder.RegisterEncodeCompleteCallback(&encoded_frames_);
+
+    std::unique_ptr<test::FrameGenerator> generator(
+        test::FrameGenerator::CreateChromaGenerator(kWidth, kHeight));
+    for (int i = 0; i < kNumFrames; ++i) {
+      VideoFrame frame(generator->NextFrame()->video_frame_buffer(),
+                       kTimestampDelta * (i + 1), 0, kVideoRotation_0);
+      ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder.Encode(frame, nullptr, nullptr));
+    }
+    encoder.Release();
+    ASSERT_EQ(static_cast<size_t>(kNumFrames), encoded_frames_.frames().size());
+  }
+
+  // Decodes all encoded frames and returns the average time per Decode()
+  // call in microseconds.
+  int64_t DecodeAll(DecodedTimestampCollector* decoded_frames) {
+    H264DecoderImpl decoder;
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, decoder.InitDecode(nullptr, kNumCores));
+    decoder.RegisterDecodeCompleteCallback(decoded_frames);
+    const int64_t start_us = rtc::TimeMicros();
+    for (const EncodedImage& frame : encoded_frames_.frames()) {
+      EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+                decoder.Decode(frame, false, nullptr, nullptr, -1));
+    }
+    return (rtc::TimeMicros() - start_us) / kNumFrames;
+  }
+
+  void ExpectTimestampsInOrder(const std::vector<uint32_t>& timestamps) {
+    for (size_t i = 0; i < timestamps.size(); ++i)
+      EXPECT_EQ(kTimestampDelta * (i + 1), timestamps[i]);
+  }
+
+  EncodedFrameCollector encoded_frames_;
+};
+
+}  // namespace
+
+TEST_F(H264DecoderImplTest, DecodesSingleThreaded) {
+  DecodedTimestampCollector decoded_frames;
+  int64_t decode_time_us = DecodeAll(&decoded_frames);
+  EXPECT_EQ(static_cast<size_t>(kNumFrames),
+            decoded_frames.timestamps().size());
+  ExpectTimestampsInOrder(decoded_frames.timestamps());
+  test::PrintResult("h264_decode_time", "", "single_thread", decode_time_us,
+                    "us", false);
+}
+
+TEST_F(H264DecoderImplTest, DecodesWithSliceThreads) {
+  test::ScopedFieldTrials field_trial(
+      "WebRTC-H264DecoderThreading/Enabled-4-slice/");
+  DecodedTimestampCollector decoded_frames;
+  int64_t decode_time_us = DecodeAll(&decoded_frames);
+  // Slice threading does not delay the output.
+  EXPECT_EQ(static_cast<size_t>(kNumFrames),
+            decoded_frames.timestamps().size());
+  ExpectTimestampsInOrder(decoded_frames.timestamps());
+  test::PrintResult("h264_decode_time", "", "slice_threads", decode_time_us,
+                    "us", false);
+}
+
+TEST_F(H264DecoderImplTest, DecodesWithFrameThreads) {
+  test::ScopedFieldTrials field_trial(
+      "WebRTC-H264DecoderThreading/Enabled-4-frame/");
+  DecodedTimestampCollector decoded_frames;
+  int64_t decode_time_us = DecodeAll(&decoded_frames);
+  // Up to |thread_count| - 1 frames are still in flight when decoding stops,
+  // but all frames that were output must carry their own timestamps.
+  EXPECT_GE(decoded_frames.timestamps().size(),
+            static_cast<size_t>(kNumFrames - 3));
+  EXPECT_LE(decoded_frames.timestamps().size(),
+            static_cast<size_t>(kNumFrames));
+  ExpectTimestampsInOrder(decoded_frames.timestamps());
+  test::PrintResult("h264_decode_time", "", "frame_threads", decode_time_us,
+                    "us", false);
+}
+
+TEST_F(H264DecoderImplTest, IgnoresInvalidThreadingFieldTrial) {
+  test::ScopedFieldTrials field_trial(
+      "WebRTC-H264DecoderThreading/Enabled-4-tile/");
+  DecodedTimestampCollector decoded_frames;
+  DecodeAll(&decoded_frames);
+  EXPECT_EQ(static_cast<size_t>(kNumFrames),
+            decoded_frames.timestamps().size());
+  ExpectTimestampsInOrder(decoded_frames.timestamps());
+}
+
+}  // namespace webrtc
@@ -11,6 +11,7 @@
 
 #include "webrtc/modules/video_coding/codecs/h264/h264_encoder_impl.h"
 
+#include <algorithm>
 #include <limits>
 #include <string>
 
@@ -163,6 +164,8 @@ H264EncoderImpl::H264EncoderImpl(const cricket::VideoCodec& codec)
       frame_dropping_on_(false),
       key_frame_interval_(0),
       packetization_mode_(H264PacketizationMode::SingleNalUnit),
+      num_threads_(1),
+      num_slices_(1),
       max_payload_size_(0),
       number_of_cores_(0),
       encoded_image_callback_(nullptr),
@@ -198,6 +201,11 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* codec_settings,
     ReportError();
     return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
   }
+  if (codec_settings->H264().numberOfThreads < 0 ||
+      codec_settings->H264().numberOfSlices < 0) {
+    ReportError();
+    return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+  }
 
   int32_t release_ret = Release();
   if (release_ret != WEBRTC_VIDEO_CODEC_OK) {
@@ -230,6 +238,13 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* codec_settings,
   mode_ = codec_settings->mode;
   frame_dropping_on_ = codec_settings->H264().frameDroppingOn;
   key_frame_interval_ = codec_settings->H264().keyFrameInterval;
+  num_threads_ = codec_settings->H264().numberOfThreads > 0
+                     ? std::min(codec_settings->H264().numberOfThreads,
+                                static_cast<int>(number_of_cores))
+                     : NumberOfThreads(width_, height_, number_of_cores);
+  num_slices_ = codec_settings->H264().numberOfSlices > 0
+                    ? codec_settings->H264().numberOfSlices
+                    : num_threads_;
   max_payload_size_ = max_payload_size;
 
   // Codec_settings uses kbits/second; encoder uses bits/second.
@@ -431,12 +446,11 @@ SEncParamExt H264EncoderImpl::CreateEncoderParams() const {
   // |keyFrameInterval| - number of frames
   encoder_params.uiIntraPeriod = key_frame_interval_;
   encoder_params.uiMaxNalSize = 0;
-  // Threading model: use auto.
+  // Threading model:
   //  0: auto (dynamic imp. internal encoder)
   //  1: single thread (default value)
   // >1: number of threads
-  encoder_params.iMultipleThreadIdc = NumberOfThreads(
-      encoder_params.iPicWidth, encoder_params.iPicHeight, number_of_cores_);
+  encoder_params.iMultipleThreadIdc = num_threads_;
   // The base spatial layer 0 is the only one we use.
   encoder_params.sSpatialLayers[0].iVideoWidth = encoder_params.iPicWidth;
   encoder_params.sSpatialLayers[0].iVideoHeight = encoder_params.iPicHeight;
@@ -458,10 +472,11 @@ SEncParamExt H264EncoderImpl::CreateEncoderParams() const {
       break;
     case H264PacketizationMode::NonInterleaved:
       // When uiSliceMode = SM_FIXEDSLCNUM_SLICE, uiSliceNum = 0 means auto
-      // design it with cpu core number.
-      // TODO(sprang): Set to 0 when we understand why the rate controller borks
+      // design it with cpu core number. OpenH264 threads work on separate
+      // slices, so by default there is one slice per encoder thread.
+      // TODO(sprang): Use 0 when we understand why the rate controller borks
       //               when uiSliceNum > 1.
-      encoder_params.sSpatialLayers[0].sSliceArgument.uiSliceNum = 1;
+      encoder_params.sSpatialLayers[0].sSliceArgument.uiSliceNum = num_slices_;
       encoder_params.sSpatialLayers[0].sSliceArgument.uiSliceMode =
           SM_FIXEDSLCNUM_SLICE;
       break;
@@ -87,6 +87,8 @@ class H264EncoderImpl : public H264Encoder {
   bool frame_dropping_on_;
   int key_frame_interval_;
   H264PacketizationMode packetization_mode_;
+  int num_threads_;
+  int num_slices_;
 
   size_t max_payload_size_;
   int32_t number_of_cores_;
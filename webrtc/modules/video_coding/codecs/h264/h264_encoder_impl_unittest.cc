@@ -78,6 +78,27 @@ TEST(H264EncoderImplTest, CanInitializeWithRemovedParameter) {
             encoder.PacketizationModeForTesting());
 }
 
+TEST(H264EncoderImplTest, CanInitializeWithMultipleThreadsAndSlices) {
+  H264EncoderImpl encoder(cricket::VideoCodec("H264"));
+  VideoCodec codec_settings;
+  SetDefaultSettings(&codec_settings);
+  codec_settings.width = 1280;
+  codec_settings.height = 720;
+  codec_settings.H264()->numberOfThreads = 4;
+  codec_settings.H264()->numberOfSlices = 4;
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder.InitEncode(&codec_settings, 4, kMaxPayloadSize));
+}
+
+TEST(H264EncoderImplTest, FailsToInitializeWithNegativeThreadCount) {
+  H264EncoderImpl encoder(cricket::VideoCodec("H264"));
+  VideoCodec codec_settings;
+  SetDefaultSettings(&codec_settings);
+  codec_settings.H264()->numberOfThreads = -1;
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_ERR_PARAMETER,
+            encoder.InitEncode(&codec_settings, kNumCores, kMaxPayloadSize));
+}
+
 }  // anonymous namespace
 
 }  // namespace webrtc
@@ -21,6 +21,8 @@ const bool kDenoisingOn = false;
 const bool kFrameDropperOn = true;
 const bool kSpatialResizeOn = false;
 const VideoCodecType kVideoCodecType[] = {kVideoCodecVP8};
+// Number of encoder threads, 0 means single core.
+const int kNumThreads[] = {0, 2, 4};
 
 // Packet loss probability [0.0, 1.0].
 const float kPacketLoss = 0.0f;
@@ -32,12 +34,13 @@ const bool kVerboseLogging = true;
 class PlotVideoProcessorIntegrationTest
     : public VideoProcessorIntegrationTest,
       public ::testing::WithParamInterface<
-          ::testing::tuple<int, int, VideoCodecType>> {
+          ::testing::tuple<int, int, VideoCodecType, int>> {
  protected:
   PlotVideoProcessorIntegrationTest()
       : bitrate_(::testing::get<0>(GetParam())),
         framerate_(::testing::get<1>(GetParam())),
-        codec_type_(::testing::get<2>(GetParam())) {}
+        codec_type_(::testing::get<2>(GetParam())),
+        num_threads_(::testing::get<3>(GetParam())) {}
 
   virtual ~PlotVideoProcessorIntegrationTest() {}
 
@@ -58,6 +61,7 @@ class PlotVideoProcessorIntegrationTest
                        kErrorConcealmentOn, kDenoisingOn, kFrameDropperOn,
                        kSpatialResizeOn, width, height, filename,
                        kVerboseLogging);
+    process_settings.num_threads = num_threads_;
     // Metrics for expected quality (PSNR avg, PSNR min, SSIM avg, SSIM min).
     QualityMetrics quality_metrics;
     SetQualityMetrics(&quality_metrics, 15.0, 10.0, 0.2, 0.1);
@@ -78,6 +82,7 @@ class PlotVideoProcessorIntegrationTest
   const int bitrate_;
   const int framerate_;
   const VideoCodecType codec_type_;
+  const int num_threads_;
 };
 
 INSTANTIATE_TEST_CASE_P(
@@ -85,7 +90,8 @@ INSTANTIATE_TEST_CASE_P(
     PlotVideoProcessorIntegrationTest,
     ::testing::Combine(::testing::ValuesIn(kBitrates),
                        ::testing::ValuesIn(kFps),
-                       ::testing::ValuesIn(kVideoCodecType)));
+                       ::testing::ValuesIn(kVideoCodecType),
+                       ::testing::ValuesIn(kNumThreads)));
 
 TEST_P(PlotVideoProcessorIntegrationTest, ProcessSQCif) {
   RunTest(128, 96, "foreman_128x96");
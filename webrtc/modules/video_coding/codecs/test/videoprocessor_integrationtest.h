@@ -62,6 +62,9 @@ struct CodecConfigPars {
   int height;
   std::string filename;
   bool verbose_logging;
+  // Number of encoder threads. 0 restricts the encoder and decoder to a
+  // single core, for predictability.
+  int num_threads;
 };
 
 // Quality metrics.
@@ -147,8 +150,9 @@ class VideoProcessorIntegrationTest : public testing::Test {
         test::OutputPath(), "videoprocessor_integrationtest");
     config_.frame_length_in_bytes = CalcBufferSize(kI420, width, height);
     config_.verbose = verbose_logging;
-    // Only allow encoder/decoder to use single core, for predictability.
-    config_.use_single_core = true;
+    // Only allow encoder/decoder to use single core, for predictability,
+    // unless the test explicitly asks for multi-threaded encoding.
+    config_.use_single_core = (num_threads_ == 0);
     // Key frame interval and packet loss are set for each test.
     config_.keyframe_interval = key_frame_interval_;
     config_.networking_config.packet_loss_probability = packet_loss_;
@@ -165,6 +169,7 @@ class VideoProcessorIntegrationTest : public testing::Test {
         config_.codec_settings->H264()->frameDroppingOn = frame_dropper_on_;
         config_.codec_settings->H264()->keyFrameInterval =
             kBaseKeyFrameInterval;
+        config_.codec_settings->H264()->numberOfThreads = num_threads_;
         break;
       case kVideoCodecVP8:
         config_.codec_settings->VP8()->errorConcealmentOn =
@@ -175,6 +180,7 @@ class VideoProcessorIntegrationTest : public testing::Test {
         config_.codec_settings->VP8()->frameDroppingOn = frame_dropper_on_;
         config_.codec_settings->VP8()->automaticResizeOn = spatial_resize_on_;
         config_.codec_settings->VP8()->keyFrameInterval = kBaseKeyFrameInterval;
+        config_.codec_settings->VP8()->numberOfThreads = num_threads_;
         break;
       case kVideoCodecVP9:
         config_.codec_settings->VP9()->denoisingOn = denoising_on_;
@@ -397,6 +403,7 @@ class VideoProcessorIntegrationTest : public testing::Test {
     denoising_on_ = process.denoising_on;
     frame_dropper_on_ = process.frame_dropper_on;
     spatial_resize_on_ = process.spatial_resize_on;
+    num_threads_ = process.num_threads;
     SetUpCodecConfig(process.filename, process.width, process.height,
                      process.verbose_logging);
     // Update the layers and the codec with the initial rates.
@@ -524,6 +531,7 @@ class VideoProcessorIntegrationTest : public testing::Test {
     process_settings->height = height;
     process_settings->filename = filename;
     process_settings->verbose_logging = verbose_logging;
+    process_settings->num_threads = 0;
   }
 
   static void SetCodecParameters(CodecConfigPars* process_settings,
@@ -619,6 +627,7 @@ class VideoProcessorIntegrationTest : public testing::Test {
   bool denoising_on_;
   bool frame_dropper_on_;
   bool spatial_resize_on_;
+  int num_threads_;
 };
 
 }  // namespace test
@@ -311,6 +311,10 @@ int VP8EncoderImpl::InitEncode(const VideoCodec* inst,
   if (inst->VP8().automaticResizeOn && inst->numberOfSimulcastStreams > 1) {
     return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
   }
+  if (inst->VP8().numberOfThreads < 0 || inst->VP8().tokenPartitions < 0 ||
+      inst->VP8().tokenPartitions > VP8_EIGHT_TOKENPARTITION) {
+    return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+  }
   int retVal = Release();
   if (retVal < 0) {
     return retVal;
@@ -331,6 +335,7 @@ int VP8EncoderImpl::InitEncode(const VideoCodec* inst,
   SetupTemporalLayers(number_of_streams, num_temporal_layers, *inst);
 
   feedback_mode_ = inst->VP8().feedbackModeOn;
+  token_partitions_ = inst->VP8().tokenPartitions;
 
   number_of_cores_ = number_of_cores;
   timestamp_ = 0;
@@ -471,10 +476,16 @@ int VP8EncoderImpl::InitEncode(const VideoCodec* inst,
   configurations_[0].g_w = inst->width;
   configurations_[0].g_h = inst->height;
 
-  // Determine number of threads based on the image size and #cores.
+  // Determine number of threads based on the image size and #cores, unless
+  // explicitly configured.
   // TODO(fbarchard): Consider number of Simulcast layers.
-  configurations_[0].g_threads = NumberOfThreads(
-      configurations_[0].g_w, configurations_[0].g_h, number_of_cores);
+  if (inst->VP8().numberOfThreads > 0) {
+    configurations_[0].g_threads =
+        std::min(inst->VP8().numberOfThreads, number_of_cores);
+  } else {
+    configurations_[0].g_threads = NumberOfThreads(
+        configurations_[0].g_w, configurations_[0].g_h, number_of_cores);
+  }
 
   // Creating a wrapper to the image - setting image data to NULL.
   // Actual pointer will be set in encode. Setting align to 1, as it
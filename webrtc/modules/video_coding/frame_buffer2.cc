@@ -66,49 +66,7 @@ FrameBuffer::ReturnReason FrameBuffer::NextFrame(
       if (stopped_)
         return kStopped;
 
-      wait_ms = max_wait_time_ms;
-
-      // Need to hold |crit_| in order to use |frames_|, therefore we
-      // set it here in the loop instead of outside the loop in order to not
-      // acquire the lock unnecesserily.
-      next_frame_it_ = frames_.end();
-
-      // |frame_it| points to the first frame after the
-      // |last_decoded_frame_it_|.
-      auto frame_it = frames_.end();
-      if (last_decoded_frame_it_ == frames_.end()) {
-        frame_it = frames_.begin();
-      } else {
-        frame_it = last_decoded_frame_it_;
-        ++frame_it;
-      }
-
-      // |continuous_end_it| points to the first frame after the
-      // |last_continuous_frame_it_|.
-      auto continuous_end_it = last_continuous_frame_it_;
-      if (continuous_end_it != frames_.end())
-        ++continuous_end_it;
-
-      for (; frame_it != continuous_end_it; ++frame_it) {
-        if (!frame_it->second.continuous ||
-            frame_it->second.num_missing_decodable > 0) {
-          continue;
-        }
-
-        FrameObject* frame = frame_it->second.frame.get();
-        next_frame_it_ = frame_it;
-        if (frame->RenderTime() == -1)
-          frame->SetRenderTime(timing_->RenderTimeMs(frame->timestamp, now_ms));
-        wait_ms = timing_->MaxWaitingTime(frame->RenderTime(), now_ms);
-
-        // This will cause the frame buffer to prefer high framerate rather
-        // than high resolution in the case of the decoder not decoding fast
-        // enough and the stream has multiple spatial and temporal layers.
-        if (wait_ms == 0)
-          continue;
-
-        break;
-      }
+      wait_ms = FindNextFrame(now_ms, max_wait_time_ms);
     }  // rtc::Critscope lock(&crit_);
 
     wait_ms = std::min<int64_t>(wait_ms, latest_return_time_ms - now_ms);
@@ -118,28 +76,7 @@ FrameBuffer::ReturnReason FrameBuffer::NextFrame(
   rtc::CritScope lock(&crit_);
   int64_t now_ms = clock_->TimeInMilliseconds();
   if (next_frame_it_ != frames_.end()) {
-    std::unique_ptr<FrameObject> frame =
-        std::move(next_frame_it_->second.frame);
-
-    if (!frame->delayed_by_retransmission()) {
-      int64_t frame_delay;
-
-      if (inter_frame_delay_.CalculateDelay(frame->timestamp, &frame_delay,
-                                            frame->ReceivedTime())) {
-        jitter_estimator_->UpdateEstimate(frame_delay, frame->size());
-      }
-
-      float rtt_mult = protection_mode_ == kProtectionNackFEC ? 0.0 : 1.0;
-      timing_->SetJitterDelay(jitter_estimator_->GetJitterEstimate(rtt_mult));
-      timing_->UpdateCurrentDelay(frame->RenderTime(), now_ms);
-    }
-
-    UpdateJitterDelay();
-
-    PropagateDecodability(next_frame_it_->second);
-    AdvanceLastDecodedFrame(next_frame_it_);
-    last_decoded_frame_timestamp_ = frame->timestamp;
-    *frame_out = std::move(frame);
+    *frame_out = GetNextFrame(now_ms);
     return kFrameFound;
   } else if (latest_return_time_ms - now_ms > 0) {
     // If |next_frame_it_ == frames_.end()| and there is still time left, it
@@ -152,6 +89,97 @@ FrameBuffer::ReturnReason FrameBuffer::NextFrame(
   }
 }
 
+FrameBuffer::ReturnReason FrameBuffer::PollNextFrame(
+    std::unique_ptr<FrameObject>* frame_out,
+    int64_t* wait_ms_out) {
+  rtc::CritScope lock(&crit_);
+  if (stopped_)
+    return kStopped;
+
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  int64_t wait_ms = FindNextFrame(now_ms, -1);
+  if (next_frame_it_ != frames_.end() && wait_ms == 0) {
+    *frame_out = GetNextFrame(now_ms);
+    return kFrameFound;
+  }
+
+  *wait_ms_out = next_frame_it_ != frames_.end() ? wait_ms : -1;
+  return kTimeout;
+}
+
+int64_t FrameBuffer::FindNextFrame(int64_t now_ms, int64_t max_wait_time_ms) {
+  int64_t wait_ms = max_wait_time_ms;
+
+  // Need to hold |crit_| in order to use |frames_|, therefore we
+  // set it here instead of in the caller in order to not acquire the lock
+  // unnecesserily.
+  next_frame_it_ = frames_.end();
+
+  // |frame_it| points to the first frame after the
+  // |last_decoded_frame_it_|.
+  auto frame_it = frames_.end();
+  if (last_decoded_frame_it_ == frames_.end()) {
+    frame_it = frames_.begin();
+  } else {
+    frame_it = last_decoded_frame_it_;
+    ++frame_it;
+  }
+
+  // |continuous_end_it| points to the first frame after the
+  // |last_continuous_frame_it_|.
+  auto continuous_end_it = last_continuous_frame_it_;
+  if (continuous_end_it != frames_.end())
+    ++continuous_end_it;
+
+  for (; frame_it != continuous_end_it; ++frame_it) {
+    if (!frame_it->second.continuous ||
+        frame_it->second.num_missing_decodable > 0) {
+      continue;
+    }
+
+    FrameObject* frame = frame_it->second.frame.get();
+    next_frame_it_ = frame_it;
+    if (frame->RenderTime() == -1)
+      frame->SetRenderTime(timing_->RenderTimeMs(frame->timestamp, now_ms));
+    wait_ms = timing_->MaxWaitingTime(frame->RenderTime(), now_ms);
+
+    // This will cause the frame buffer to prefer high framerate rather
+    // than high resolution in the case of the decoder not decoding fast
+    // enough and the stream has multiple spatial and temporal layers.
+    if (wait_ms == 0)
+      continue;
+
+    break;
+  }
+
+  return wait_ms;
+}
+
+std::unique_ptr<FrameObject> FrameBuffer::GetNextFrame(int64_t now_ms) {
+  RTC_DCHECK(next_frame_it_ != frames_.end());
+  std::unique_ptr<FrameObject> frame = std::move(next_frame_it_->second.frame);
+
+  if (!frame->delayed_by_retransmission()) {
+    int64_t frame_delay;
+
+    if (inter_frame_delay_.CalculateDelay(frame->timestamp, &frame_delay,
+                                          frame->ReceivedTime())) {
+      jitter_estimator_->UpdateEstimate(frame_delay, frame->size());
+    }
+
+    float rtt_mult = protection_mode_ == kProtectionNackFEC ? 0.0 : 1.0;
+    timing_->SetJitterDelay(jitter_estimator_->GetJitterEstimate(rtt_mult));
+    timing_->UpdateCurrentDelay(frame->RenderTime(), now_ms);
+  }
+
+  UpdateJitterDelay();
+
+  PropagateDecodability(next_frame_it_->second);
+  AdvanceLastDecodedFrame(next_frame_it_);
+  last_decoded_frame_timestamp_ = frame->timestamp;
+  return frame;
+}
+
 void FrameBuffer::SetProtectionMode(VCMVideoProtection mode) {
   rtc::CritScope lock(&crit_);
   protection_mode_ = mode;
@@ -57,6 +57,17 @@ class FrameBuffer {
   ReturnReason NextFrame(int64_t max_wait_time_ms,
                          std::unique_ptr<FrameObject>* frame_out);
 
+  // Non-blocking version of NextFrame(), for callers that multiplex several
+  // frame buffers onto a shared set of decode threads.
+  //  - If a frame should be decoded now it returns kFrameFound and sets
+  //    |frame_out| to the resulting frame.
+  //  - Otherwise it returns kTimeout and sets |wait_ms_out| to the time until
+  //    the next decodable frame is due, or to -1 if there is no decodable
+  //    frame in the buffer.
+  //  - If the FrameBuffer is stopped then it will return kStopped.
+  ReturnReason PollNextFrame(std::unique_ptr<FrameObject>* frame_out,
+                             int64_t* wait_ms_out);
+
   // Tells the FrameBuffer which protection mode that is in use. Affects
   // the frame timing.
   // TODO(philipel): Remove this when new timing calculations has been
@@ -118,6 +129,17 @@ class FrameBuffer {
 
   using FrameMap = std::map<FrameKey, FrameInfo>;
 
+  // Sets |next_frame_it_| to the next frame to be decoded and returns the
+  // time until it should be decoded. Returns |max_wait_time_ms| if there is
+  // no decodable frame.
+  int64_t FindNextFrame(int64_t now_ms, int64_t max_wait_time_ms)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Removes the frame pointed to by |next_frame_it_| from the buffer and
+  // updates timing and decodability state accordingly.
+  std::unique_ptr<FrameObject> GetNextFrame(int64_t now_ms)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   // Update all directly dependent and indirectly dependent frames and mark
   // them as continuous if all their references has been fulfilled.
   void PropagateContinuity(FrameMap::iterator start)
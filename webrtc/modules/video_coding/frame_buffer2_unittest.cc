@@ -295,6 +295,42 @@ TEST_F(TestFrameBuffer2, OneLayerStream) {
   }
 }
 
+TEST_F(TestFrameBuffer2, PollNextFrame) {
+  uint16_t pid = Rand();
+  uint32_t ts = Rand();
+  std::unique_ptr<FrameObject> frame;
+  int64_t wait_ms = 0;
+
+  EXPECT_EQ(FrameBuffer::ReturnReason::kTimeout,
+            buffer_.PollNextFrame(&frame, &wait_ms));
+  EXPECT_EQ(-1, wait_ms);
+
+  InsertFrame(pid, 0, ts, false);
+  InsertFrame(pid + 1, 0, ts + kFps10, false, pid);
+
+  // The first frame is rendered 50 ms from now and takes 25 ms to decode.
+  EXPECT_EQ(FrameBuffer::ReturnReason::kTimeout,
+            buffer_.PollNextFrame(&frame, &wait_ms));
+  EXPECT_EQ(25, wait_ms);
+  EXPECT_FALSE(frame);
+
+  clock_.AdvanceTimeMilliseconds(25);
+  EXPECT_EQ(FrameBuffer::ReturnReason::kFrameFound,
+            buffer_.PollNextFrame(&frame, &wait_ms));
+  ASSERT_TRUE(frame);
+  EXPECT_EQ(pid, frame->picture_id);
+  frame.reset();
+
+  // The second frame is due one frame interval after the first one.
+  EXPECT_EQ(FrameBuffer::ReturnReason::kTimeout,
+            buffer_.PollNextFrame(&frame, &wait_ms));
+  EXPECT_EQ(100, wait_ms);
+
+  buffer_.Stop();
+  EXPECT_EQ(FrameBuffer::ReturnReason::kStopped,
+            buffer_.PollNextFrame(&frame, &wait_ms));
+}
+
 TEST_F(TestFrameBuffer2, DropTemporalLayerSlowDecoder) {
   uint16_t pid = Rand();
   uint32_t ts = Rand();
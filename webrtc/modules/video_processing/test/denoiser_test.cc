@@ -10,16 +10,61 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
+#include "webrtc/base/random.h"
 #include "webrtc/common_video/include/i420_buffer_pool.h"
+#include "webrtc/modules/video_processing/util/denoiser_filter_c.h"
 #include "webrtc/modules/video_processing/video_denoiser.h"
+#include "webrtc/system_wrappers/include/cpu_features_wrapper.h"
 #include "webrtc/test/gtest.h"
 #include "webrtc/test/frame_utils.h"
 #include "webrtc/test/testsupport/fileutils.h"
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "webrtc/modules/video_processing/util/denoiser_filter_avx2.h"
+#include "webrtc/modules/video_processing/util/denoiser_filter_sse2.h"
+#endif
+
 namespace webrtc {
 
+namespace {
+
+// Returns all SIMD filters the CPU supports, to be compared with the C filter.
+std::vector<std::unique_ptr<DenoiserFilter>> CreateSimdFilters() {
+  std::vector<std::unique_ptr<DenoiserFilter>> filters;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2))
+    filters.emplace_back(new DenoiserFilterSSE2());
+  if (WebRtc_GetCPUInfo(kAVX2))
+    filters.emplace_back(new DenoiserFilterAVX2());
+#else
+  filters.push_back(DenoiserFilter::Create(true, nullptr));
+#endif
+  return filters;
+}
+
+void FillRandom(Random* random, uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; ++i)
+    data[i] = random->Rand<uint8_t>();
+}
+
+// Adds noise of at most +-|amplitude| to |src|.
+void AddNoise(Random* random,
+              const uint8_t* src,
+              uint8_t* dst,
+              size_t size,
+              int amplitude) {
+  for (size_t i = 0; i < size; ++i) {
+    int value = src[i] + random->Rand(-amplitude, amplitude);
+    dst[i] = static_cast<uint8_t>(std::min(255, std::max(0, value)));
+  }
+}
+
+}  // namespace
+
 TEST(VideoDenoiserTest, CopyMem) {
   std::unique_ptr<DenoiserFilter> df_c(DenoiserFilter::Create(false, nullptr));
   std::unique_ptr<DenoiserFilter> df_sse_neon(
@@ -125,6 +170,122 @@ TEST(VideoDenoiserTest, MbDenoise) {
   EXPECT_EQ(COPY_BLOCK, decision);
 }
 
+TEST(VideoDenoiserTest, SimdFiltersMatchCOnRandomBlocks) {
+  const int kStride = 32;
+  DenoiserFilterC df_c;
+  Random random(0x1234);
+  for (const auto& df_simd : CreateSimdFilters()) {
+    for (int iteration = 0; iteration < 500; ++iteration) {
+      uint8_t src[kStride * 16];
+      uint8_t running_src[kStride * 16];
+      uint8_t dst_c[kStride * 16] = {0};
+      uint8_t dst_simd[kStride * 16] = {0};
+      FillRandom(&random, running_src, sizeof(running_src));
+      // Mostly small differences, to exercise all filter levels.
+      AddNoise(&random, running_src, src, sizeof(src), 1 + iteration % 20);
+      const uint8_t motion_magnitude = iteration % 2 ? 0 : 30;
+      const int increase_denoising = (iteration / 2) % 2;
+
+      EXPECT_EQ(df_c.Sum8x8(src + 3, kStride),
+                df_simd->Sum8x8(src + 3, kStride));
+
+      uint32_t sse_c = 0;
+      uint32_t sse_simd = 0;
+      EXPECT_EQ(df_c.Variance16x8(src, kStride, running_src, kStride, &sse_c),
+                df_simd->Variance16x8(src, kStride, running_src, kStride,
+                                      &sse_simd));
+      EXPECT_EQ(sse_c, sse_simd);
+
+      EXPECT_EQ(df_c.MbDenoise(running_src, kStride, dst_c, kStride, src,
+                               kStride, motion_magnitude, increase_denoising),
+                df_simd->MbDenoise(running_src, kStride, dst_simd, kStride,
+                                   src, kStride, motion_magnitude,
+                                   increase_denoising));
+      EXPECT_EQ(0, memcmp(dst_c, dst_simd, sizeof(dst_c)));
+
+      df_simd->CopyMem16x16(src, kStride, dst_simd, kStride);
+      for (int i = 0; i < 16; ++i)
+        EXPECT_EQ(0, memcmp(src + i * kStride, dst_simd + i * kStride, 16));
+    }
+  }
+}
+
+TEST(VideoDenoiserTest, SimdFiltersMatchCWithMaximumAdjustments) {
+  DenoiserFilterC df_c;
+  uint8_t sig[16 * 16];
+  uint8_t mc_running_avg[16 * 16];
+  uint8_t dst_c[16 * 16];
+  uint8_t dst_simd[16 * 16];
+  memset(sig, 100, sizeof(sig));
+
+  // Every pixel of the first four columns gets the largest adjustment, so
+  // their sums reach 128 and are clamped to 127. With the small differences of
+  // the fifth column, the sum of the block is exactly the threshold.
+  for (int r = 0; r < 16; ++r) {
+    for (int c = 0; c < 16; ++c) {
+      int diff = 0;
+      if (c < 4)
+        diff = 16;
+      else if (c == 4 && r < 15)
+        diff = -4;
+      mc_running_avg[r * 16 + c] = sig[r * 16 + c] + diff;
+    }
+  }
+  EXPECT_EQ(FILTER_BLOCK,
+            df_c.MbDenoise(mc_running_avg, 16, dst_c, 16, sig, 16, 0, 1));
+  for (const auto& df_simd : CreateSimdFilters()) {
+    EXPECT_EQ(FILTER_BLOCK, df_simd->MbDenoise(mc_running_avg, 16, dst_simd,
+                                               16, sig, 16, 0, 1));
+    EXPECT_EQ(0, memcmp(dst_c, dst_simd, sizeof(dst_c)));
+  }
+
+  // Every pixel gets the largest adjustment.
+  memset(mc_running_avg, 116, sizeof(mc_running_avg));
+  EXPECT_EQ(COPY_BLOCK,
+            df_c.MbDenoise(mc_running_avg, 16, dst_c, 16, sig, 16, 0, 1));
+  for (const auto& df_simd : CreateSimdFilters()) {
+    EXPECT_EQ(COPY_BLOCK, df_simd->MbDenoise(mc_running_avg, 16, dst_simd, 16,
+                                             sig, 16, 0, 1));
+    EXPECT_EQ(0, memcmp(dst_c, dst_simd, sizeof(dst_c)));
+  }
+}
+
+TEST(VideoDenoiserTest, MultiThreadedDenoiserMatchesSingleThreaded) {
+  // Not a multiple of 16, to cover the margins.
+  const int kWidth = 328;
+  const int kHeight = 248;
+  const int kNumFrames = 20;
+  VideoDenoiser denoiser(true);
+  VideoDenoiser denoiser_threaded(true, 3);
+  Random random(0x5678);
+  rtc::scoped_refptr<I420Buffer> background =
+      I420Buffer::Create(kWidth, kHeight);
+  I420Buffer::SetBlack(background.get());
+  // A checkerboard of 8x8 squares.
+  for (int i = 0; i < kHeight; ++i) {
+    for (int j = 0; j < kWidth; ++j)
+      background->MutableDataY()[i * background->StrideY() + j] =
+          static_cast<uint8_t>(64 + ((i / 8 + j / 8) % 2) * 96);
+  }
+
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    rtc::scoped_refptr<I420Buffer> input = I420Buffer::Copy(*background);
+    AddNoise(&random, background->DataY(), input->MutableDataY(),
+             input->StrideY() * kHeight, 6);
+    // A moving square, to trigger moving edge and object detection.
+    for (int i = 0; i < 48; ++i) {
+      memset(input->MutableDataY() + (80 + i) * input->StrideY() + frame * 8,
+             240, 48);
+    }
+    const bool noise_estimation = frame % 2 == 0;
+    rtc::scoped_refptr<VideoFrameBuffer> denoised =
+        denoiser.DenoiseFrame(input, noise_estimation);
+    rtc::scoped_refptr<VideoFrameBuffer> denoised_threaded =
+        denoiser_threaded.DenoiseFrame(input, noise_estimation);
+    ASSERT_TRUE(test::FrameBufsEqual(denoised, denoised_threaded));
+  }
+}
+
 TEST(VideoDenoiserTest, Denoiser) {
   const int kWidth = 352;
   const int kHeight = 288;
@@ -36,6 +36,8 @@ class DenoiserFilter {
                             int src_stride,
                             uint8_t* dst,
                             int dst_stride) = 0;
+  // Returns the sum of the pixels of the 8x8 block at |src|.
+  virtual uint32_t Sum8x8(const uint8_t* src, int src_stride) = 0;
   virtual uint32_t Variance16x8(const uint8_t* a,
                                 int a_stride,
                                 const uint8_t* b,
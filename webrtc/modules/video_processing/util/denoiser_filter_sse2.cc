@@ -97,18 +97,33 @@ static uint32_t AbsSumDiff16x1(__m128i acc_diff) {
   return sum_diff;
 }
 
-// TODO(jackychen): Optimize this function using SSE2.
 void DenoiserFilterSSE2::CopyMem16x16(const uint8_t* src,
                                       int src_stride,
                                       uint8_t* dst,
                                       int dst_stride) {
   for (int i = 0; i < 16; i++) {
-    memcpy(dst, src, 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
     src += src_stride;
     dst += dst_stride;
   }
 }
 
+uint32_t DenoiserFilterSSE2::Sum8x8(const uint8_t* src, int src_stride) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i vsum = _mm_setzero_si128();
+  for (int i = 0; i < 8; i += 2) {
+    const __m128i rows = _mm_unpacklo_epi64(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + src_stride)));
+    // Sum of absolute differences against zero is the sum of each half.
+    vsum = _mm_add_epi64(vsum, _mm_sad_epu8(rows, zero));
+    src += src_stride << 1;
+  }
+  vsum = _mm_add_epi64(vsum, _mm_srli_si128(vsum, 8));
+  return _mm_cvtsi128_si32(vsum);
+}
+
 uint32_t DenoiserFilterSSE2::Variance16x8(const uint8_t* src,
                                           int src_stride,
                                           const uint8_t* ref,
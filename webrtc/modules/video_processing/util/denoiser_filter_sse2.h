@@ -22,6 +22,7 @@ class DenoiserFilterSSE2 : public DenoiserFilter {
                     int src_stride,
                     uint8_t* dst,
                     int dst_stride) override;
+  uint32_t Sum8x8(const uint8_t* src, int src_stride) override;
   uint32_t Variance16x8(const uint8_t* a,
                         int a_stride,
                         const uint8_t* b,
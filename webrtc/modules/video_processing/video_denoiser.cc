@@ -8,6 +8,11 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <vector>
+
+#include "webrtc/base/checks.h"
+#include "webrtc/base/event.h"
+#include "webrtc/base/platform_thread.h"
 #include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
 #include "webrtc/modules/video_processing/video_denoiser.h"
 #include "libyuv/planar_functions.h"
@@ -66,11 +71,95 @@ static void ShowRect(const std::unique_ptr<DenoiserFilter>& filter,
 }
 #endif
 
+// Splits the rows of a frame into contiguous bands and processes them on
+// worker threads and the calling thread.
+class VideoDenoiser::RowWorkers {
+ public:
+  explicit RowWorkers(int num_threads);
+  ~RowWorkers();
+
+  // Calls |func| with row ranges covering [0, num_rows), and returns when all
+  // calls have returned.
+  void Run(int num_rows, const std::function<void(int, int)>& func);
+
+ private:
+  struct Worker {
+    Worker(RowWorkers* parent, const char* name)
+        : parent(parent),
+          start_event(false, false),
+          done_event(false, false),
+          thread(&RowWorkers::WorkerRun, this, name) {}
+    RowWorkers* const parent;
+    rtc::Event start_event;
+    rtc::Event done_event;
+    int row_start = 0;
+    int row_end = 0;
+    rtc::PlatformThread thread;
+  };
+
+  static bool WorkerRun(void* obj);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // Set before the start events are signaled, read by the workers after.
+  const std::function<void(int, int)>* func_ = nullptr;
+  bool stopping_ = false;
+};
+
+VideoDenoiser::RowWorkers::RowWorkers(int num_threads) {
+  RTC_DCHECK_GT(num_threads, 1);
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back(new Worker(this, "DenoiserWorker"));
+    workers_.back()->thread.Start();
+  }
+}
+
+VideoDenoiser::RowWorkers::~RowWorkers() {
+  stopping_ = true;
+  for (auto& worker : workers_) {
+    worker->start_event.Set();
+    worker->thread.Stop();
+  }
+}
+
+bool VideoDenoiser::RowWorkers::WorkerRun(void* obj) {
+  Worker* worker = static_cast<Worker*>(obj);
+  worker->start_event.Wait(rtc::Event::kForever);
+  if (worker->parent->stopping_)
+    return false;
+  (*worker->parent->func_)(worker->row_start, worker->row_end);
+  worker->done_event.Set();
+  return true;
+}
+
+void VideoDenoiser::RowWorkers::Run(
+    int num_rows,
+    const std::function<void(int, int)>& func) {
+  const int num_bands = static_cast<int>(workers_.size()) + 1;
+  func_ = &func;
+  for (int i = 1; i < num_bands; ++i) {
+    Worker* worker = workers_[i - 1].get();
+    worker->row_start = num_rows * i / num_bands;
+    worker->row_end = num_rows * (i + 1) / num_bands;
+    worker->start_event.Set();
+  }
+  // The calling thread takes the first band.
+  func(0, num_rows / num_bands);
+  for (auto& worker : workers_)
+    worker->done_event.Wait(rtc::Event::kForever);
+  func_ = nullptr;
+}
+
 VideoDenoiser::VideoDenoiser(bool runtime_cpu_detection)
+    : VideoDenoiser(runtime_cpu_detection, 1) {}
+
+VideoDenoiser::VideoDenoiser(bool runtime_cpu_detection, int num_threads)
     : width_(0),
       height_(0),
       filter_(DenoiserFilter::Create(runtime_cpu_detection, &cpu_type_)),
-      ne_(new NoiseEstimation()) {}
+      ne_(new NoiseEstimation()),
+      row_workers_(num_threads > 1 ? new RowWorkers(num_threads) : nullptr) {}
+
+VideoDenoiser::~VideoDenoiser() {}
 
 void VideoDenoiser::DenoiserReset(rtc::scoped_refptr<VideoFrameBuffer> frame) {
   width_ = frame->width();
@@ -85,6 +174,16 @@ void VideoDenoiser::DenoiserReset(rtc::scoped_refptr<VideoFrameBuffer> frame) {
   x_density_.reset(new uint8_t[mb_cols_]);
   y_density_.reset(new uint8_t[mb_rows_]);
   moving_object_.reset(new uint8_t[mb_cols_ * mb_rows_]);
+  noise_update_.reset(new NoiseUpdate[mb_cols_ * mb_rows_]);
+  noise_var_.reset(new uint32_t[mb_cols_ * mb_rows_]);
+  luma_.reset(new uint32_t[mb_cols_ * mb_rows_]);
+}
+
+void VideoDenoiser::ForEachRows(const std::function<void(int, int)>& func) {
+  if (row_workers_)
+    row_workers_->Run(mb_rows_, func);
+  else
+    func(0, mb_rows_);
 }
 
 int VideoDenoiser::PositionCheck(int mb_row, int mb_col, int noise_level) {
@@ -163,13 +262,15 @@ bool VideoDenoiser::IsTrailingBlock(const std::unique_ptr<uint8_t[]>& d_status,
   return ret;
 }
 
-void VideoDenoiser::CopySrcOnMOB(const uint8_t* y_src,
+void VideoDenoiser::CopySrcOnMOB(int mb_row_start,
+                                 int mb_row_end,
+                                 const uint8_t* y_src,
                                  int stride_src,
                                  uint8_t* y_dst,
                                  int stride_dst) {
   // Loop over to copy src block if the block is marked as moving object block
   // or if the block may cause trailing artifacts.
-  for (int mb_row = 0; mb_row < mb_rows_; ++mb_row) {
+  for (int mb_row = mb_row_start; mb_row < mb_row_end; ++mb_row) {
     const int mb_index_base = mb_row * mb_cols_;
     const uint8_t* mb_src_base = y_src + (mb_row << 4) * stride_src;
     uint8_t* mb_dst_base = y_dst + (mb_row << 4) * stride_dst;
@@ -211,42 +312,21 @@ void VideoDenoiser::CopyLumaOnMargin(const uint8_t* y_src,
   }
 }
 
-rtc::scoped_refptr<VideoFrameBuffer> VideoDenoiser::DenoiseFrame(
-    rtc::scoped_refptr<VideoFrameBuffer> frame,
-    bool noise_estimation_enabled) {
-  // If previous width and height are different from current frame's, need to
-  // reallocate the buffers and no denoising for the current frame.
-  if (!prev_buffer_ || width_ != frame->width() || height_ != frame->height()) {
-    DenoiserReset(frame);
-    prev_buffer_ = frame;
-    return frame;
-  }
-
-  // Set buffer pointers.
-  const uint8_t* y_src = frame->DataY();
-  int stride_y_src = frame->StrideY();
-  rtc::scoped_refptr<I420Buffer> dst =
-      buffer_pool_.CreateBuffer(width_, height_);
-
-  uint8_t* y_dst = dst->MutableDataY();
-  int stride_y_dst = dst->StrideY();
-
-  const uint8_t* y_dst_prev = prev_buffer_->DataY();
-  int stride_prev = prev_buffer_->StrideY();
-
-  memset(x_density_.get(), 0, mb_cols_);
-  memset(y_density_.get(), 0, mb_rows_);
-  memset(moving_object_.get(), 1, mb_cols_ * mb_rows_);
-
-  uint8_t noise_level = noise_estimation_enabled ? ne_->GetNoiseLevel() : 0;
-  int thr_var_base = 16 * 16 * 2;
-  // Loop over blocks to accumulate/extract noise level and update x/y_density
-  // factors for moving object detection.
-  for (int mb_row = 0; mb_row < mb_rows_; ++mb_row) {
+void VideoDenoiser::DenoiseRows(int mb_row_start,
+                                int mb_row_end,
+                                const uint8_t* y_src,
+                                int stride_src,
+                                const uint8_t* y_prev,
+                                int stride_prev,
+                                uint8_t* y_dst,
+                                int stride_dst,
+                                uint8_t noise_level) {
+  const int thr_var_base = 16 * 16 * 2;
+  for (int mb_row = mb_row_start; mb_row < mb_row_end; ++mb_row) {
     const int mb_index_base = mb_row * mb_cols_;
-    const uint8_t* mb_src_base = y_src + (mb_row << 4) * stride_y_src;
-    uint8_t* mb_dst_base = y_dst + (mb_row << 4) * stride_y_dst;
-    const uint8_t* mb_dst_prev_base = y_dst_prev + (mb_row << 4) * stride_prev;
+    const uint8_t* mb_src_base = y_src + (mb_row << 4) * stride_src;
+    uint8_t* mb_dst_base = y_dst + (mb_row << 4) * stride_dst;
+    const uint8_t* mb_dst_prev_base = y_prev + (mb_row << 4) * stride_prev;
     for (int mb_col = 0; mb_col < mb_cols_; ++mb_col) {
       const int mb_index = mb_index_base + mb_col;
       const bool ne_enable = (mb_index % NOISE_SUBSAMPLE_INTERVAL == 0);
@@ -257,20 +337,15 @@ rtc::scoped_refptr<VideoFrameBuffer> VideoDenoiser::DenoiseFrame(
       uint8_t* mb_dst = mb_dst_base + offset_col;
       const uint8_t* mb_dst_prev = mb_dst_prev_base + offset_col;
 
-      // TODO(jackychen): Need SSE2/NEON opt.
-      int luma = 0;
-      if (ne_enable) {
-        for (int i = 4; i < 12; ++i) {
-          for (int j = 4; j < 12; ++j) {
-            luma += mb_src[i * stride_y_src + j];
-          }
-        }
-      }
+      noise_update_[mb_index] = kNoNoiseUpdate;
+      if (ne_enable)
+        luma_[mb_index] = filter_->Sum8x8(mb_src + 4 * stride_src + 4,
+                                          stride_src);
 
       // Get the filtered block and filter_decision.
       mb_filter_decision_[mb_index] =
-          filter_->MbDenoise(mb_dst_prev, stride_prev, mb_dst, stride_y_dst,
-                             mb_src, stride_y_src, 0, noise_level);
+          filter_->MbDenoise(mb_dst_prev, stride_prev, mb_dst, stride_dst,
+                             mb_src, stride_src, 0, noise_level);
 
       // If filter decision is FILTER_BLOCK, no need to check moving edge.
       // It is unlikely for a moving edge block to be filtered in current
@@ -280,9 +355,9 @@ rtc::scoped_refptr<VideoFrameBuffer> VideoDenoiser::DenoiseFrame(
         if (ne_enable) {
           // The variance used in noise estimation is based on the src block in
           // time t (mb_src) and filtered block in time t-1 (mb_dist_prev).
-          uint32_t noise_var = filter_->Variance16x8(
-              mb_dst_prev, stride_y_dst, mb_src, stride_y_src, &sse_t);
-          ne_->GetNoise(mb_index, noise_var, luma);
+          noise_var_[mb_index] = filter_->Variance16x8(
+              mb_dst_prev, stride_dst, mb_src, stride_src, &sse_t);
+          noise_update_[mb_index] = kGetNoise;
         }
         moving_edge_[mb_index] = 0;  // Not a moving edge block.
       } else {
@@ -290,31 +365,89 @@ rtc::scoped_refptr<VideoFrameBuffer> VideoDenoiser::DenoiseFrame(
         // The variance used in MOD is based on the filtered blocks in time
         // T (mb_dst) and T-1 (mb_dst_prev).
         uint32_t noise_var = filter_->Variance16x8(
-            mb_dst_prev, stride_prev, mb_dst, stride_y_dst, &sse_t);
+            mb_dst_prev, stride_prev, mb_dst, stride_dst, &sse_t);
         if (noise_var > thr_var_adp) {  // Moving edge checking.
-          if (ne_enable) {
-            ne_->ResetConsecLowVar(mb_index);
-          }
+          if (ne_enable)
+            noise_update_[mb_index] = kResetConsecLowVar;
           moving_edge_[mb_index] = 1;  // Mark as moving edge block.
-          x_density_[mb_col] += (pos_factor < 3);
-          y_density_[mb_row] += (pos_factor < 3);
         } else {
           moving_edge_[mb_index] = 0;
           if (ne_enable) {
             // The variance used in noise estimation is based on the src block
             // in time t (mb_src) and filtered block in time t-1 (mb_dist_prev).
-            uint32_t noise_var = filter_->Variance16x8(
-                mb_dst_prev, stride_prev, mb_src, stride_y_src, &sse_t);
-            ne_->GetNoise(mb_index, noise_var, luma);
+            noise_var_[mb_index] = filter_->Variance16x8(
+                mb_dst_prev, stride_prev, mb_src, stride_src, &sse_t);
+            noise_update_[mb_index] = kGetNoise;
           }
         }
       }
-    }  // End of for loop
-  }    // End of for loop
+    }
+  }
+}
+
+rtc::scoped_refptr<VideoFrameBuffer> VideoDenoiser::DenoiseFrame(
+    rtc::scoped_refptr<VideoFrameBuffer> frame,
+    bool noise_estimation_enabled) {
+  // If previous width and height are different from current frame's, need to
+  // reallocate the buffers and no denoising for the current frame.
+  if (!prev_buffer_ || width_ != frame->width() || height_ != frame->height()) {
+    DenoiserReset(frame);
+    prev_buffer_ = frame;
+    return frame;
+  }
+
+  // Set buffer pointers.
+  const uint8_t* y_src = frame->DataY();
+  int stride_y_src = frame->StrideY();
+  rtc::scoped_refptr<I420Buffer> dst =
+      buffer_pool_.CreateBuffer(width_, height_);
+
+  uint8_t* y_dst = dst->MutableDataY();
+  int stride_y_dst = dst->StrideY();
+
+  const uint8_t* y_dst_prev = prev_buffer_->DataY();
+  int stride_prev = prev_buffer_->StrideY();
+
+  memset(x_density_.get(), 0, mb_cols_);
+  memset(y_density_.get(), 0, mb_rows_);
+  memset(moving_object_.get(), 1, mb_cols_ * mb_rows_);
+
+  uint8_t noise_level = noise_estimation_enabled ? ne_->GetNoiseLevel() : 0;
+  // Filter the blocks, and accumulate/extract noise level.
+  ForEachRows([&](int mb_row_start, int mb_row_end) {
+    DenoiseRows(mb_row_start, mb_row_end, y_src, stride_y_src, y_dst_prev,
+                stride_prev, y_dst, stride_y_dst, noise_level);
+  });
+
+  // Feed the noise estimator and update x/y_density factors for moving
+  // object detection, in block order.
+  for (int mb_row = 0; mb_row < mb_rows_; ++mb_row) {
+    for (int mb_col = 0; mb_col < mb_cols_; ++mb_col) {
+      const int mb_index = mb_row * mb_cols_ + mb_col;
+      switch (noise_update_[mb_index]) {
+        case kGetNoise:
+          ne_->GetNoise(mb_index, noise_var_[mb_index], luma_[mb_index]);
+          break;
+        case kResetConsecLowVar:
+          ne_->ResetConsecLowVar(mb_index);
+          break;
+        case kNoNoiseUpdate:
+          break;
+      }
+      if (moving_edge_[mb_index] &&
+          PositionCheck(mb_row, mb_col, noise_level) < 3) {
+        ++x_density_[mb_col];
+        ++y_density_[mb_row];
+      }
+    }
+  }
 
   ReduceFalseDetection(moving_edge_, &moving_object_, noise_level);
 
-  CopySrcOnMOB(y_src, stride_y_src, y_dst, stride_y_dst);
+  ForEachRows([&](int mb_row_start, int mb_row_end) {
+    CopySrcOnMOB(mb_row_start, mb_row_end, y_src, stride_y_src, y_dst,
+                 stride_y_dst);
+  });
 
   // When frame width/height not divisible by 16, copy the margin to
   // denoised_frame.
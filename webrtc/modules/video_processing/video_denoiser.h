@@ -11,6 +11,7 @@
 #ifndef WEBRTC_MODULES_VIDEO_PROCESSING_VIDEO_DENOISER_H_
 #define WEBRTC_MODULES_VIDEO_PROCESSING_VIDEO_DENOISER_H_
 
+#include <functional>
 #include <memory>
 
 #include "webrtc/common_video/include/i420_buffer_pool.h"
@@ -23,14 +24,41 @@ namespace webrtc {
 class VideoDenoiser {
  public:
   explicit VideoDenoiser(bool runtime_cpu_detection);
+  // If |num_threads| > 1, rows of macroblocks are processed in parallel on
+  // |num_threads| - 1 worker threads plus the calling thread. The output is
+  // identical to single-threaded processing.
+  VideoDenoiser(bool runtime_cpu_detection, int num_threads);
+  ~VideoDenoiser();
 
   rtc::scoped_refptr<VideoFrameBuffer> DenoiseFrame(
       rtc::scoped_refptr<VideoFrameBuffer> frame,
       bool noise_estimation_enabled);
 
  private:
+  class RowWorkers;
+
+  // What a block's denoising pass decided to feed into the noise estimator.
+  // The estimator is updated afterwards in block order, so that rows can be
+  // processed in parallel.
+  enum NoiseUpdate : uint8_t { kNoNoiseUpdate, kGetNoise, kResetConsecLowVar };
+
   void DenoiserReset(rtc::scoped_refptr<VideoFrameBuffer> frame);
 
+  // Filters the blocks in rows [mb_row_start, mb_row_end) and classifies them
+  // as moving edge blocks or not.
+  void DenoiseRows(int mb_row_start,
+                   int mb_row_end,
+                   const uint8_t* y_src,
+                   int stride_src,
+                   const uint8_t* y_prev,
+                   int stride_prev,
+                   uint8_t* y_dst,
+                   int stride_dst,
+                   uint8_t noise_level);
+
+  // Runs |func| over all rows of macroblocks, in parallel if enabled.
+  void ForEachRows(const std::function<void(int, int)>& func);
+
   // Check the mb position, return 1: close to the frame center (between 1/8
   // and 7/8 of width/height), 3: close to the border (out of 1/16 and 15/16
   // of width/height), 2: in between.
@@ -47,8 +75,11 @@ class VideoDenoiser {
                        int mb_row,
                        int mb_col);
 
-  // Copy input blocks to dst buffer on moving object blocks (MOB).
-  void CopySrcOnMOB(const uint8_t* y_src,
+  // Copy input blocks to dst buffer on moving object blocks (MOB) in rows
+  // [mb_row_start, mb_row_end).
+  void CopySrcOnMOB(int mb_row_start,
+                    int mb_row_end,
+                    const uint8_t* y_src,
                     int stride_src,
                     uint8_t* y_dst,
                     int stride_dst);
@@ -75,6 +106,11 @@ class VideoDenoiser {
   std::unique_ptr<uint8_t[]> y_density_;
   // Save the return values by MbDenoise for each block.
   std::unique_ptr<DenoiserDecision[]> mb_filter_decision_;
+  // Noise estimator input of each block, see NoiseUpdate.
+  std::unique_ptr<NoiseUpdate[]> noise_update_;
+  std::unique_ptr<uint32_t[]> noise_var_;
+  std::unique_ptr<uint32_t[]> luma_;
+  std::unique_ptr<RowWorkers> row_workers_;
   I420BufferPool buffer_pool_;
   rtc::scoped_refptr<VideoFrameBuffer> prev_buffer_;
 };
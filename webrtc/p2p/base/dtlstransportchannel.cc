@@ -15,10 +15,12 @@
 
 #include "webrtc/p2p/base/common.h"
 #include "webrtc/p2p/base/packettransportinternal.h"
+#include "webrtc/base/bind.h"
 #include "webrtc/base/buffer.h"
 #include "webrtc/base/checks.h"
 #include "webrtc/base/dscp.h"
 #include "webrtc/base/messagequeue.h"
+#include "webrtc/base/sslfingerprint.h"
 #include "webrtc/base/sslstreamadapter.h"
 #include "webrtc/base/stream.h"
 #include "webrtc/base/thread.h"
@@ -58,6 +60,7 @@ static bool IsRtpPacket(const char* data, size_t len) {
 StreamInterfaceChannel::StreamInterfaceChannel(
     IceTransportInternal* ice_transport)
     : ice_transport_(ice_transport),
+      network_thread_(rtc::Thread::Current()),
       state_(rtc::SS_OPEN),
       packets_(kMaxPendingPackets, kMaxDtlsPacketLen) {}
 
@@ -84,9 +87,18 @@ rtc::StreamResult StreamInterfaceChannel::Write(const void* data,
   // Always succeeds, since this is an unreliable transport anyway.
   // TODO(zhihuang): Should this block if ice_transport_'s temporarily
   // unwritable?
-  rtc::PacketOptions packet_options;
-  ice_transport_->SendPacket(static_cast<const char*>(data), data_len,
-                             packet_options);
+  if (!network_thread_->IsCurrent()) {
+    // Written by the DTLS handshake thread.
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&StreamInterfaceChannel::SendPacket, this,
+                  rtc::CopyOnWriteBuffer(static_cast<const char*>(data),
+                                         data_len)));
+  } else {
+    rtc::PacketOptions packet_options;
+    ice_transport_->SendPacket(static_cast<const char*>(data), data_len,
+                               packet_options);
+  }
   if (written) {
     *written = data_len;
   }
@@ -103,6 +115,12 @@ bool StreamInterfaceChannel::OnPacketReceived(const char* data, size_t size) {
   return ret;
 }
 
+void StreamInterfaceChannel::SendPacket(const rtc::CopyOnWriteBuffer& packet) {
+  rtc::PacketOptions packet_options;
+  ice_transport_->SendPacket(packet.data<char>(), packet.size(),
+                             packet_options);
+}
+
 void StreamInterfaceChannel::Close() {
   packets_.Clear();
   state_ = rtc::SS_CLOSED;
@@ -126,7 +144,9 @@ DtlsTransport::DtlsTransport(IceTransportInternal* ice_transport)
       this, &DtlsTransport::OnReceivingState);
 }
 
-DtlsTransport::~DtlsTransport() {}
+DtlsTransport::~DtlsTransport() {
+  ResetDtls();
+}
 
 bool DtlsTransport::SetLocalCertificate(
     const rtc::scoped_refptr<rtc::RTCCertificate>& certificate) {
@@ -167,6 +187,26 @@ bool DtlsTransport::SetSslMaxProtocolVersion(rtc::SSLProtocolVersion version) {
   return true;
 }
 
+bool DtlsTransport::SetHandshakeThread(rtc::Thread* thread) {
+  if (dtls_) {
+    LOG_J(LS_ERROR, this) << "Can't change the DTLS handshake thread after "
+                          << "DTLS is set up.";
+    return false;
+  }
+  handshake_thread_ = thread == network_thread_ ? nullptr : thread;
+  return true;
+}
+
+bool DtlsTransport::SetSslSessionCache(rtc::SSLSessionCache* cache) {
+  if (dtls_) {
+    LOG_J(LS_ERROR, this) << "Can't change the DTLS session cache after DTLS "
+                          << "is set up.";
+    return false;
+  }
+  session_cache_ = cache;
+  return true;
+}
+
 bool DtlsTransport::SetSslRole(rtc::SSLRole role) {
   if (dtls_) {
     if (ssl_role_ != role) {
@@ -232,10 +272,7 @@ bool DtlsTransport::SetRemoteFingerprint(const std::string& digest_alg,
     // received. For instance, if we set up DTLS due to receiving an early
     // ClientHello.
     rtc::SSLPeerCertificateDigestError err;
-    if (!dtls_->SetPeerCertificateDigest(
-            remote_fingerprint_algorithm_,
-            reinterpret_cast<unsigned char*>(remote_fingerprint_value_.data()),
-            remote_fingerprint_value_.size(), &err)) {
+    if (!SetPeerCertificateDigest(&err)) {
       LOG_J(LS_ERROR, this) << "Couldn't set DTLS certificate digest.";
       set_dtls_state(DTLS_TRANSPORT_FAILED);
       // If the error is "verification failed", don't return false, because
@@ -250,7 +287,7 @@ bool DtlsTransport::SetRemoteFingerprint(const std::string& digest_alg,
   // If the fingerprint is changing, we'll tear down the DTLS association and
   // create a new one, resetting our state.
   if (dtls_ && fingerprint_changing) {
-    dtls_.reset(nullptr);
+    ResetDtls();
     set_dtls_state(DTLS_TRANSPORT_NEW);
     set_writable(false);
   }
@@ -265,7 +302,9 @@ bool DtlsTransport::SetRemoteFingerprint(const std::string& digest_alg,
 
 std::unique_ptr<rtc::SSLCertificate> DtlsTransport::GetRemoteSSLCertificate()
     const {
-  if (!dtls_) {
+  // Until the handshake thread hands |dtls_| back, the handshake hasn't
+  // finished as far as the network thread knows.
+  if (!dtls_ || handshake_offloaded_) {
     return nullptr;
   }
 
@@ -291,6 +330,22 @@ bool DtlsTransport::SetupDtls() {
   dtls_->SignalEvent.connect(this, &DtlsTransport::OnDtlsEvent);
   dtls_->SignalSSLHandshakeError.connect(this,
                                          &DtlsTransport::OnDtlsHandshakeError);
+  if (session_cache_) {
+    // Sessions are only resumed between the same two certificates.
+    std::string peer_id;
+    if (remote_fingerprint_value_.size()) {
+      std::unique_ptr<rtc::SSLFingerprint> local_fingerprint(
+          rtc::SSLFingerprint::CreateFromCertificate(local_certificate_));
+      rtc::SSLFingerprint remote_fingerprint(
+          remote_fingerprint_algorithm_, remote_fingerprint_value_.data(),
+          remote_fingerprint_value_.size());
+      if (local_fingerprint) {
+        peer_id = local_fingerprint->ToString() + "|" +
+                  remote_fingerprint.ToString();
+      }
+    }
+    dtls_->SetSessionCache(session_cache_, peer_id);
+  }
   if (remote_fingerprint_value_.size() &&
       !dtls_->SetPeerCertificateDigest(
           remote_fingerprint_algorithm_,
@@ -414,7 +469,11 @@ int DtlsTransport::SendPacket(const char* data,
 }
 
 bool DtlsTransport::IsDtlsConnected() {
-  return dtls_ && dtls_->IsTlsConnected();
+  return dtls_ && !handshake_offloaded_ && dtls_->IsTlsConnected();
+}
+
+bool DtlsTransport::IsSessionResumed() const {
+  return dtls_ && !handshake_offloaded_ && dtls_->IsSessionResumed();
 }
 
 // The state transition logic here is as follows:
@@ -563,8 +622,20 @@ void DtlsTransport::OnReadyToSend(rtc::PacketTransportInternal* transport) {
 }
 
 void DtlsTransport::OnDtlsEvent(rtc::StreamInterface* dtls, int sig, int err) {
-  RTC_DCHECK(rtc::Thread::Current() == network_thread_);
   RTC_DCHECK(dtls == dtls_.get());
+  if (!network_thread_->IsCurrent()) {
+    // Raised on the handshake thread, which delivers it once it is done with
+    // |dtls_|.
+    if (!handshake_events_) {
+      handshake_invoker_.AsyncInvoke<void>(
+          RTC_FROM_HERE, handshake_thread_,
+          rtc::Bind(&DtlsTransport::FinishHandshakeTask, this));
+    }
+    handshake_events_ |= sig;
+    if (sig & rtc::SE_CLOSE)
+      handshake_error_ = err;
+    return;
+  }
   if (sig & rtc::SE_OPEN) {
     // This is the first time.
     LOG_J(LS_INFO, this) << "DTLS handshake complete.";
@@ -611,7 +682,16 @@ void DtlsTransport::MaybeStartDtls() {
   if (dtls_ && ice_transport_->writable()) {
     ConfigureHandshakeTimeout();
 
-    if (dtls_->StartSSL()) {
+    if (handshake_thread_) {
+      // |dtls_| belongs to the handshake thread until the handshake ends.
+      handshake_offloaded_ = true;
+      handshake_events_ = 0;
+      handshake_error_ = 0;
+      handshake_finished_ = false;
+      handshake_invoker_.AsyncInvoke<void>(
+          RTC_FROM_HERE, handshake_thread_,
+          rtc::Bind(&DtlsTransport::StartDtlsOnHandshakeThread, this));
+    } else if (dtls_->StartSSL()) {
       // This should never fail:
       // Because we are operating in a nonblocking mode and all
       // incoming packets come in via OnReadPacket(), which rejects
@@ -663,9 +743,105 @@ bool DtlsTransport::HandleDtlsPacket(const char* data, size_t size) {
 
   // Looks good. Pass to the SIC which ends up being passed to
   // the DTLS stack.
+  if (handshake_offloaded_) {
+    handshake_invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, handshake_thread_,
+        rtc::Bind(&DtlsTransport::HandleDtlsPacketOnHandshakeThread, this,
+                  rtc::CopyOnWriteBuffer(data, size)));
+    return true;
+  }
   return downward_->OnPacketReceived(data, size);
 }
 
+bool DtlsTransport::SetPeerCertificateDigest(
+    rtc::SSLPeerCertificateDigestError* err) {
+  if (handshake_offloaded_) {
+    return handshake_thread_->Invoke<bool>(
+        RTC_FROM_HERE,
+        rtc::Bind(&DtlsTransport::SetPeerCertificateDigestOnHandshakeThread,
+                  this, err));
+  }
+  return dtls_->SetPeerCertificateDigest(
+      remote_fingerprint_algorithm_,
+      reinterpret_cast<unsigned char*>(remote_fingerprint_value_.data()),
+      remote_fingerprint_value_.size(), err);
+}
+
+void DtlsTransport::ResetDtls() {
+  if (handshake_thread_) {
+    // Drop the tasks still queued for the handshake thread, which reference
+    // this object, and destroy |dtls_| there if it is driving it.
+    bool offloaded = handshake_offloaded_;
+    handshake_thread_->Invoke<void>(RTC_FROM_HERE, [this, offloaded] {
+      handshake_thread_->Clear(&handshake_invoker_);
+      if (offloaded)
+        dtls_.reset();
+    });
+    network_thread_->Clear(&invoker_);
+    handshake_offloaded_ = false;
+  }
+  dtls_.reset();
+  downward_ = nullptr;
+}
+
+void DtlsTransport::StartDtlsOnHandshakeThread() {
+  if (dtls_->StartSSL()) {
+    LOG_J(LS_ERROR, this) << "Couldn't start DTLS handshake";
+    OnDtlsEvent(dtls_.get(), rtc::SE_CLOSE, -1);
+  }
+}
+
+void DtlsTransport::HandleDtlsPacketOnHandshakeThread(
+    const rtc::CopyOnWriteBuffer& packet) {
+  if (handshake_finished_) {
+    // The packet was posted before the network thread learned that the
+    // handshake ended, so it has to handle it.
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&DtlsTransport::DeliverDtlsPacket, this, packet));
+    return;
+  }
+  downward_->OnPacketReceived(packet.data<char>(), packet.size());
+  // A handshake waiting for the remote fingerprint raises no event, but it has
+  // no more public key operations to do, so |dtls_| is handed back already.
+  if (!handshake_events_ && dtls_->IsTlsConnected())
+    FinishHandshakeTask();
+}
+
+bool DtlsTransport::SetPeerCertificateDigestOnHandshakeThread(
+    rtc::SSLPeerCertificateDigestError* err) {
+  return dtls_->SetPeerCertificateDigest(
+      remote_fingerprint_algorithm_,
+      reinterpret_cast<unsigned char*>(remote_fingerprint_value_.data()),
+      remote_fingerprint_value_.size(), err);
+}
+
+void DtlsTransport::FinishHandshakeTask() {
+  RTC_DCHECK(handshake_thread_->IsCurrent());
+  invoker_.AsyncInvoke<void>(
+      RTC_FROM_HERE, network_thread_,
+      rtc::Bind(&DtlsTransport::OnHandshakeFinished, this, handshake_events_,
+                handshake_error_));
+  handshake_events_ = 0;
+  handshake_error_ = 0;
+  handshake_finished_ = true;
+}
+
+void DtlsTransport::OnHandshakeFinished(int sig, int err) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  handshake_offloaded_ = false;
+  if (!dtls_)
+    return;
+  // A failure after the handshake completed is reported alone.
+  OnDtlsEvent(dtls_.get(), (sig & rtc::SE_CLOSE) ? rtc::SE_CLOSE : sig, err);
+}
+
+void DtlsTransport::DeliverDtlsPacket(const rtc::CopyOnWriteBuffer& packet) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  if (downward_ && !handshake_offloaded_)
+    downward_->OnPacketReceived(packet.data<char>(), packet.size());
+}
+
 void DtlsTransport::set_receiving(bool receiving) {
   if (receiving_ == receiving) {
     return;
@@ -698,6 +874,12 @@ void DtlsTransport::set_dtls_state(DtlsTransportState state) {
 }
 
 void DtlsTransport::OnDtlsHandshakeError(rtc::SSLHandshakeError error) {
+  if (!network_thread_->IsCurrent()) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&DtlsTransport::OnDtlsHandshakeError, this, error));
+    return;
+  }
   SignalDtlsHandshakeError(error);
 }
 
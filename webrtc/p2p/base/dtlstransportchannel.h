@@ -15,9 +15,11 @@
 #include <string>
 #include <vector>
 
+#include "webrtc/base/asyncinvoker.h"
 #include "webrtc/base/buffer.h"
 #include "webrtc/base/bufferqueue.h"
 #include "webrtc/base/constructormagic.h"
+#include "webrtc/base/copyonwritebuffer.h"
 #include "webrtc/base/sslstreamadapter.h"
 #include "webrtc/base/stream.h"
 #include "webrtc/p2p/base/dtlstransportinternal.h"
@@ -31,6 +33,8 @@ namespace cricket {
 
 // A bridge between a packet-oriented/transport-type interface on
 // the bottom and a StreamInterface on the top.
+// It is created on the network thread, and packets written to it on another
+// thread are sent from the network thread.
 class StreamInterfaceChannel : public rtc::StreamInterface {
  public:
   explicit StreamInterfaceChannel(IceTransportInternal* ice_transport);
@@ -51,9 +55,14 @@ class StreamInterfaceChannel : public rtc::StreamInterface {
                           int* error) override;
 
  private:
+  void SendPacket(const rtc::CopyOnWriteBuffer& packet);
+
   IceTransportInternal* ice_transport_;  // owned by DtlsTransport
+  rtc::Thread* network_thread_;
   rtc::StreamState state_;
   rtc::BufferQueue packets_;
+  // Passes packets written on another thread to the network thread.
+  rtc::AsyncInvoker invoker_;
 
   RTC_DISALLOW_COPY_AND_ASSIGN(StreamInterfaceChannel);
 };
@@ -84,6 +93,13 @@ class StreamInterfaceChannel : public rtc::StreamInterface {
 //
 //   - The SSLStreamAdapter writes to downward_->Write() which translates it
 //     into packet writes on ice_transport_.
+//
+//   - If a handshake thread is set, dtls_ is driven by that thread from the
+//     start of the handshake until it completes, fails or only waits for the
+//     remote fingerprint: StartSSL() and the DTLS packets are posted to it,
+//     and its events are posted back. Until then, the network thread reports
+//     neither a remote certificate nor a DTLS connection. Afterwards, dtls_ is
+//     only used on the network thread again.
 class DtlsTransport : public DtlsTransportInternal {
  public:
   // The parameters here is:
@@ -122,6 +138,18 @@ class DtlsTransport : public DtlsTransportInternal {
 
   virtual bool SetSslMaxProtocolVersion(rtc::SSLProtocolVersion version);
 
+  // Runs the DTLS handshake on |thread| instead of the network thread, so that
+  // the public key operations of many handshakes don't hold up the network
+  // thread. The handshake results are delivered on the network thread.
+  // Can only be set before DTLS is set up.
+  bool SetHandshakeThread(rtc::Thread* thread);
+
+  // Lets the DTLS handshake resume a session previously established with the
+  // same local and remote certificates, which skips the public key
+  // operations. |cache| must outlive this transport. Can only be set before
+  // DTLS is set up.
+  bool SetSslSessionCache(rtc::SSLSessionCache* cache);
+
   // Set up the ciphers to use for DTLS-SRTP. If this method is not called
   // before DTLS starts, or |ciphers| is empty, SRTP keys won't be negotiated.
   // This method should be called before SetupDtls.
@@ -150,11 +178,10 @@ class DtlsTransport : public DtlsTransportInternal {
                             bool use_context,
                             uint8_t* result,
                             size_t result_len) override {
-    return (dtls_.get()) ? dtls_->ExportKeyingMaterial(label, context,
-                                                       context_len,
-                                                       use_context,
-                                                       result, result_len)
-        : false;
+    return (dtls_ && !handshake_offloaded_)
+               ? dtls_->ExportKeyingMaterial(label, context, context_len,
+                                             use_context, result, result_len)
+               : false;
   }
 
   IceTransportInternal* ice_transport() override { return ice_transport_; }
@@ -164,6 +191,9 @@ class DtlsTransport : public DtlsTransportInternal {
   // has not yet been verified.
   bool IsDtlsConnected();
 
+  // Tells if the DTLS handshake resumed a cached session.
+  bool IsSessionResumed() const;
+
   bool receiving() const override { return receiving_; }
 
   bool writable() const override { return writable_; }
@@ -208,6 +238,26 @@ class DtlsTransport : public DtlsTransportInternal {
   bool HandleDtlsPacket(const char* data, size_t size);
   void OnDtlsHandshakeError(rtc::SSLHandshakeError error);
   void ConfigureHandshakeTimeout();
+  bool SetPeerCertificateDigest(rtc::SSLPeerCertificateDigestError* err);
+  // Destroys |dtls_|, on the handshake thread if it is driving it.
+  void ResetDtls();
+
+  // Run on |handshake_thread_| while it drives |dtls_|.
+  void StartDtlsOnHandshakeThread();
+  void HandleDtlsPacketOnHandshakeThread(const rtc::CopyOnWriteBuffer& packet);
+  bool SetPeerCertificateDigestOnHandshakeThread(
+      rtc::SSLPeerCertificateDigestError* err);
+  // Hands |dtls_| back to the network thread, posting it the events raised on
+  // the handshake thread. Posted by the first of these events, so that it runs
+  // once the handshake thread is done with |dtls_|, or run once the handshake
+  // only waits for the remote fingerprint.
+  void FinishHandshakeTask();
+  // Called on the network thread with the events raised by |dtls_| on the
+  // handshake thread.
+  void OnHandshakeFinished(int sig, int err);
+  // Delivers a DTLS packet that reached the handshake thread after the
+  // handshake ended.
+  void DeliverDtlsPacket(const rtc::CopyOnWriteBuffer& packet);
 
   void set_receiving(bool receiving);
   void set_writable(bool writable);
@@ -239,6 +289,23 @@ class DtlsTransport : public DtlsTransportInternal {
   bool receiving_ = false;
   bool writable_ = false;
 
+  rtc::SSLSessionCache* session_cache_ = nullptr;
+
+  // Thread running the handshake, if not the network thread.
+  rtc::Thread* handshake_thread_ = nullptr;
+  // Whether |handshake_thread_| is driving |dtls_|, as seen by the network
+  // thread.
+  bool handshake_offloaded_ = false;
+  // Events raised by |dtls_| on the handshake thread, and whether they ended
+  // the handshake. Only used on the handshake thread.
+  int handshake_events_ = 0;
+  int handshake_error_ = 0;
+  bool handshake_finished_ = false;
+  // Posts tasks to |handshake_thread_|.
+  rtc::AsyncInvoker handshake_invoker_;
+  // Posts the handshake results back to the network thread.
+  rtc::AsyncInvoker invoker_;
+
   RTC_DISALLOW_COPY_AND_ASSIGN(DtlsTransport);
 };
 
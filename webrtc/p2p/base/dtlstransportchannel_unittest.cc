@@ -22,6 +22,9 @@
 #include "webrtc/base/sslidentity.h"
 #include "webrtc/base/sslstreamadapter.h"
 #include "webrtc/base/stringutils.h"
+#include "webrtc/base/thread.h"
+#include "webrtc/base/timeutils.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 #define MAYBE_SKIP_TEST(feature)                              \
   if (!(rtc::SSLStreamAdapter::feature())) {                  \
@@ -74,9 +77,17 @@ class DtlsTestClient : public sigslot::has_slots<> {
         rtc::RTCCertificate::Create(std::unique_ptr<rtc::SSLIdentity>(
             rtc::SSLIdentity::Generate(name_, key_type)));
   }
+  void SetCertificate(
+      const rtc::scoped_refptr<rtc::RTCCertificate>& certificate) {
+    certificate_ = certificate;
+  }
   const rtc::scoped_refptr<rtc::RTCCertificate>& certificate() {
     return certificate_;
   }
+  void SetupHandshakeThread(rtc::Thread* thread) { handshake_thread_ = thread; }
+  void SetupSessionCache(rtc::SSLSessionCache* cache) {
+    session_cache_ = cache;
+  }
   void SetupSrtp() {
     EXPECT_TRUE(certificate_ != nullptr);
     use_dtls_srtp_ = true;
@@ -103,6 +114,8 @@ class DtlsTestClient : public sigslot::has_slots<> {
       dtls->ice_transport()->SetIceTiebreaker(
           (role == cricket::ICEROLE_CONTROLLING) ? 1 : 2);
       dtls->SetSslMaxProtocolVersion(ssl_max_version_);
+      dtls->SetHandshakeThread(handshake_thread_);
+      dtls->SetSslSessionCache(session_cache_);
       dtls->SignalWritableState.connect(
           this, &DtlsTestClient::OnTransportChannelWritableState);
       dtls->SignalReadPacket.connect(
@@ -232,6 +245,18 @@ class DtlsTestClient : public sigslot::has_slots<> {
     return true;
   }
 
+  bool all_dtls_sessions_resumed() const {
+    if (fake_dtls_transports_.empty()) {
+      return false;
+    }
+    for (const auto& dtls : fake_dtls_transports_) {
+      if (!dtls->IsSessionResumed()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   bool all_ice_transports_writable() const {
     if (fake_dtls_transports_.empty()) {
       return false;
@@ -441,6 +466,8 @@ class DtlsTestClient : public sigslot::has_slots<> {
   std::set<int> received_;
   bool use_dtls_srtp_ = false;
   rtc::SSLProtocolVersion ssl_max_version_ = rtc::SSL_PROTOCOL_DTLS_12;
+  rtc::Thread* handshake_thread_ = nullptr;
+  rtc::SSLSessionCache* session_cache_ = nullptr;
   int received_dtls_client_hellos_ = 0;
   int received_dtls_server_hellos_ = 0;
   rtc::SentPacket sent_packet_;
@@ -1167,3 +1194,202 @@ INSTANTIATE_TEST_CASE_P(
                                             CALLER_WRITABLE, HANDSHAKE_FINISHES,
                                             CALLER_RECEIVES_FINGERPRINT}),
         ::testing::Bool()));
+
+// Tests running the DTLS handshakes on handshake threads, and resuming cached
+// sessions. These use the real clock, which the handshake threads run on.
+class DtlsHandshakeThreadTest : public testing::Test {
+ public:
+  DtlsHandshakeThreadTest() {
+    for (int i = 0; i < kNumHandshakeThreads; ++i) {
+      handshake_threads_.emplace_back(new rtc::Thread());
+      handshake_threads_.back()->Start();
+    }
+    certificate1_ = rtc::RTCCertificate::Create(
+        std::unique_ptr<rtc::SSLIdentity>(
+            rtc::SSLIdentity::Generate("P1", rtc::KT_DEFAULT)));
+    certificate2_ = rtc::RTCCertificate::Create(
+        std::unique_ptr<rtc::SSLIdentity>(
+            rtc::SSLIdentity::Generate("P2", rtc::KT_DEFAULT)));
+  }
+
+ protected:
+  static const int kNumHandshakeThreads = 4;
+
+  // Creates a pair of clients using the same certificates as all the other
+  // pairs, and starts connecting them with DTLS-SRTP, |client1| being the
+  // DTLS server. The handshakes run on the handshake threads if
+  // |use_handshake_threads| is true.
+  void StartConnecting(bool use_handshake_threads,
+                       rtc::SSLSessionCache* cache1,
+                       rtc::SSLSessionCache* cache2) {
+    DtlsTestClient* client1 = new DtlsTestClient("P1");
+    DtlsTestClient* client2 = new DtlsTestClient("P2");
+    clients1_.emplace_back(client1);
+    clients2_.emplace_back(client2);
+    client1->SetCertificate(certificate1_);
+    client2->SetCertificate(certificate2_);
+    client1->SetupSrtp();
+    client2->SetupSrtp();
+    if (use_handshake_threads) {
+      client1->SetupHandshakeThread(
+          handshake_threads_[next_thread_++ % kNumHandshakeThreads].get());
+      client2->SetupHandshakeThread(
+          handshake_threads_[next_thread_++ % kNumHandshakeThreads].get());
+    }
+    client1->SetupSessionCache(cache1);
+    client2->SetupSessionCache(cache2);
+    client1->SetupChannels(1, cricket::ICEROLE_CONTROLLING);
+    client2->SetupChannels(1, cricket::ICEROLE_CONTROLLED);
+    client1->Negotiate(client2, cricket::CA_OFFER,
+                       cricket::CONNECTIONROLE_ACTPASS,
+                       cricket::CONNECTIONROLE_ACTIVE, 0);
+    client2->Negotiate(client1, cricket::CA_ANSWER,
+                       cricket::CONNECTIONROLE_ACTIVE,
+                       cricket::CONNECTIONROLE_ACTPASS, 0);
+    client1->Connect(client2, false);
+  }
+
+  bool all_clients_writable() const {
+    for (size_t i = 0; i < clients1_.size(); ++i) {
+      if (!clients1_[i]->all_dtls_transports_writable() ||
+          !clients2_[i]->all_dtls_transports_writable()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void DestroyClients() {
+    clients1_.clear();
+    clients2_.clear();
+  }
+
+  std::vector<std::unique_ptr<rtc::Thread>> handshake_threads_;
+  size_t next_thread_ = 0;
+  rtc::scoped_refptr<rtc::RTCCertificate> certificate1_;
+  rtc::scoped_refptr<rtc::RTCCertificate> certificate2_;
+  std::vector<std::unique_ptr<DtlsTestClient>> clients1_;
+  std::vector<std::unique_ptr<DtlsTestClient>> clients2_;
+};
+
+// Connect with the handshakes on handshake threads, and transfer some data.
+TEST_F(DtlsHandshakeThreadTest, TestTransferDtlsSrtp) {
+  StartConnecting(true, nullptr, nullptr);
+  EXPECT_TRUE_WAIT(all_clients_writable(), kTimeout);
+  DtlsTestClient* client1 = clients1_[0].get();
+  DtlsTestClient* client2 = clients2_[0].get();
+  client1->CheckRole(rtc::SSL_SERVER);
+  client2->CheckRole(rtc::SSL_CLIENT);
+  client1->CheckSrtp(rtc::SRTP_AES128_CM_SHA1_80);
+  client2->CheckSrtp(rtc::SRTP_AES128_CM_SHA1_80);
+  client1->CheckSsl();
+  client2->CheckSsl();
+  EXPECT_TRUE(client1->GetDtlsTransport(0)->GetRemoteSSLCertificate());
+
+  client2->ExpectPackets(0, 1000);
+  client1->SendPackets(0, 1000, 100, false);
+  EXPECT_EQ_WAIT(100u, client2->NumPacketsReceived(), kTimeout);
+  client2->ExpectPackets(0, 1000);
+  client1->SendPackets(0, 1000, 100, true);
+  EXPECT_EQ_WAIT(100u, client2->NumPacketsReceived(), kTimeout);
+}
+
+// Test that a second connection between the same certificates resumes the
+// session of the first one, on the network thread and on handshake threads.
+TEST_F(DtlsHandshakeThreadTest, TestSessionResumption) {
+  std::unique_ptr<rtc::SSLSessionCache> cache1(
+      rtc::SSLSessionCache::Create(10));
+  std::unique_ptr<rtc::SSLSessionCache> cache2(
+      rtc::SSLSessionCache::Create(10));
+  StartConnecting(false, cache1.get(), cache2.get());
+  EXPECT_TRUE_WAIT(all_clients_writable(), kTimeout);
+  EXPECT_FALSE(clients1_[0]->all_dtls_sessions_resumed());
+  EXPECT_FALSE(clients2_[0]->all_dtls_sessions_resumed());
+  DestroyClients();
+
+  for (bool use_handshake_threads : {false, true}) {
+    StartConnecting(use_handshake_threads, cache1.get(), cache2.get());
+    EXPECT_TRUE_WAIT(all_clients_writable(), kTimeout);
+    EXPECT_TRUE(clients1_[0]->all_dtls_sessions_resumed());
+    EXPECT_TRUE(clients2_[0]->all_dtls_sessions_resumed());
+    clients1_[0]->CheckSrtp(rtc::SRTP_AES128_CM_SHA1_80);
+    clients2_[0]->CheckSrtp(rtc::SRTP_AES128_CM_SHA1_80);
+    DestroyClients();
+  }
+}
+
+// Test that a handshake which only waits for the remote fingerprint is handed
+// back to the network thread, which reports it as connected, and that it
+// completes on the network thread once the fingerprint is set.
+TEST_F(DtlsHandshakeThreadTest, LateRemoteFingerprint) {
+  DtlsTestClient client1("P1");
+  DtlsTestClient client2("P2");
+  client1.SetCertificate(certificate1_);
+  client2.SetCertificate(certificate2_);
+  client1.SetupHandshakeThread(handshake_threads_[0].get());
+  client2.SetupHandshakeThread(handshake_threads_[1].get());
+  client1.SetupChannels(1, cricket::ICEROLE_CONTROLLING);
+  client2.SetupChannels(1, cricket::ICEROLE_CONTROLLED);
+  client1.SetLocalTransportDescription(certificate1_, cricket::CA_OFFER,
+                                       cricket::CONNECTIONROLE_ACTPASS, 0);
+  client2.Negotiate(&client1, cricket::CA_ANSWER,
+                    cricket::CONNECTIONROLE_ACTIVE,
+                    cricket::CONNECTIONROLE_ACTPASS, 0);
+  client1.Connect(&client2, false);
+
+  cricket::DtlsTransport* dtls = client1.GetDtlsTransport(0);
+  EXPECT_TRUE_WAIT(dtls->IsDtlsConnected(), kTimeout);
+  EXPECT_TRUE(dtls->GetRemoteSSLCertificate());
+  EXPECT_FALSE(dtls->writable());
+
+  client1.SetRemoteTransportDescription(certificate2_, cricket::CA_ANSWER,
+                                        cricket::CONNECTIONROLE_ACTIVE, 0);
+  EXPECT_TRUE_WAIT(client1.all_dtls_transports_writable() &&
+                       client2.all_dtls_transports_writable(),
+                   kTimeout);
+  EXPECT_EQ(cricket::DTLS_TRANSPORT_CONNECTED, dtls->dtls_state());
+}
+
+// Test destroying the transports while their handshakes run on the handshake
+// threads, at different points of the handshakes.
+TEST_F(DtlsHandshakeThreadTest, DestroyDuringHandshake) {
+  const int kNumConnections = 20;
+  for (int i = 0; i < kNumConnections; ++i) {
+    StartConnecting(true, nullptr, nullptr);
+    rtc::Thread::Current()->ProcessMessages(i);
+    DestroyClients();
+  }
+  // Nothing is left running for the destroyed transports.
+  for (const auto& thread : handshake_threads_)
+    thread->Invoke<void>(RTC_FROM_HERE, [] {});
+  rtc::Thread::Current()->ProcessMessages(0);
+}
+
+// Measures the rate of concurrent DTLS handshakes, full or resumed, run on
+// the network thread or on the handshake threads.
+TEST_F(DtlsHandshakeThreadTest, HandshakeRate) {
+  const int kNumConnections = 50;
+  for (bool resume : {false, true}) {
+    std::unique_ptr<rtc::SSLSessionCache> cache1;
+    std::unique_ptr<rtc::SSLSessionCache> cache2;
+    if (resume) {
+      cache1.reset(rtc::SSLSessionCache::Create(10));
+      cache2.reset(rtc::SSLSessionCache::Create(10));
+      StartConnecting(false, cache1.get(), cache2.get());
+      EXPECT_TRUE_WAIT(all_clients_writable(), kTimeout);
+      DestroyClients();
+    }
+    for (bool use_handshake_threads : {false, true}) {
+      int64_t start_ms = rtc::TimeMillis();
+      for (int i = 0; i < kNumConnections; ++i)
+        StartConnecting(use_handshake_threads, cache1.get(), cache2.get());
+      EXPECT_TRUE_WAIT(all_clients_writable(), 6 * kTimeout);
+      int64_t elapsed_ms = std::max<int64_t>(rtc::TimeMillis() - start_ms, 1);
+      webrtc::test::PrintResult(
+          "dtls_handshake_rate", resume ? "_resumed" : "_full",
+          use_handshake_threads ? "handshake_threads" : "network_thread",
+          kNumConnections * 1000.0 / elapsed_ms, "connections/s", false);
+      DestroyClients();
+    }
+  }
+}
@@ -11,6 +11,7 @@
 #include "webrtc/p2p/base/p2ptransportchannel.h"
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <set>
 
@@ -1249,17 +1250,7 @@ void P2PTransportChannel::SortConnectionsAndUpdateState() {
   // that amongst equal preference, writable connections, this will choose the
   // one whose estimated latency is lowest.  So it is the only one that we
   // need to consider switching to.
-  // TODO(honghaiz): Don't sort;  Just use std::max_element in the right places.
-  std::stable_sort(connections_.begin(), connections_.end(),
-                   [this](const Connection* a, const Connection* b) {
-                     int cmp = CompareConnections(
-                         a, b, rtc::Optional<int64_t>(), nullptr);
-                     if (cmp != 0) {
-                       return cmp > 0;
-                     }
-                     // Otherwise, sort based on latency estimate.
-                     return a->rtt() < b->rtt();
-                   });
+  SortConnections();
 
   LOG(LS_VERBOSE) << "Sorting " << connections_.size()
                   << " available connections:";
@@ -1312,6 +1303,20 @@ void P2PTransportChannel::SortConnectionsAndUpdateState() {
   MaybeStartPinging();
 }
 
+void P2PTransportChannel::SortConnections() {
+  auto is_better = [this](const Connection* a, const Connection* b) {
+    int cmp = CompareConnections(a, b, rtc::Optional<int64_t>(), nullptr);
+    if (cmp != 0) {
+      return cmp > 0;
+    }
+    // Otherwise, sort based on latency estimate.
+    return a->rtt() < b->rtt();
+  };
+  // |connections_| is still sorted from the last time, except for the few
+  // connections whose state changed since, and new ones at the end.
+  StableSortConnections(&connections_, is_better);
+}
+
 std::map<rtc::Network*, Connection*>
 P2PTransportChannel::GetBestConnectionByNetwork() const {
   // |connections_| has been sorted, so the first one in the list on a given
@@ -1674,10 +1679,17 @@ Connection* P2PTransportChannel::FindNextPingableConnection() {
     }
   }
 
+  // The remaining rules only consider pingable connections. Find them once,
+  // in the order of |connections_|.
+  std::vector<Connection*> pingable_connections;
+  std::copy_if(connections_.begin(), connections_.end(),
+               std::back_inserter(pingable_connections),
+               [this, now](Connection* conn) { return IsPingable(conn, now); });
+
   // Rule 3: Triggered checks have priority over non-triggered connections.
   // Rule 3.1: Among triggered checks, oldest takes precedence.
   Connection* oldest_triggered_check =
-      FindOldestConnectionNeedingTriggeredCheck(now);
+      FindOldestConnectionNeedingTriggeredCheck(pingable_connections);
   if (oldest_triggered_check) {
     return oldest_triggered_check;
   }
@@ -1689,20 +1701,25 @@ Connection* P2PTransportChannel::FindNextPingableConnection() {
   // Otherwise, treat everything as unpinged.
   // TODO(honghaiz): Instead of adding two separate vectors, we can add a state
   // "pinged" to filter out unpinged connections.
-  if (std::find_if(unpinged_connections_.begin(), unpinged_connections_.end(),
-                   [this, now](Connection* conn) {
-                     return this->IsPingable(conn, now);
-                   }) == unpinged_connections_.end()) {
+  auto is_pinged = [this](Connection* conn) {
+    return pinged_connections_.count(conn) > 0;
+  };
+  if (std::all_of(pingable_connections.begin(), pingable_connections.end(),
+                  is_pinged)) {
     unpinged_connections_.insert(pinged_connections_.begin(),
                                  pinged_connections_.end());
     pinged_connections_.clear();
+  } else {
+    pingable_connections.erase(
+        std::remove_if(pingable_connections.begin(),
+                       pingable_connections.end(), is_pinged),
+        pingable_connections.end());
   }
 
   // Among un-pinged pingable connections, "more pingable" takes precedence.
-  std::vector<Connection*> pingable_connections;
-  std::copy_if(unpinged_connections_.begin(), unpinged_connections_.end(),
-               std::back_inserter(pingable_connections),
-               [this, now](Connection* conn) { return IsPingable(conn, now); });
+  // Visit them in the order of |unpinged_connections_|, which breaks ties.
+  std::sort(pingable_connections.begin(), pingable_connections.end(),
+            std::less<Connection*>());
   auto iter =
       std::max_element(pingable_connections.begin(), pingable_connections.end(),
                        [this](Connection* conn1, Connection* conn2) {
@@ -1956,12 +1973,9 @@ void P2PTransportChannel::OnReadyToSend(Connection* connection) {
 // (last_ping_received > last_ping_sent).  But we shouldn't do
 // triggered checks if the connection is already writable.
 Connection* P2PTransportChannel::FindOldestConnectionNeedingTriggeredCheck(
-    int64_t now) {
+    const std::vector<Connection*>& pingable_connections) {
   Connection* oldest_needing_triggered_check = nullptr;
-  for (auto conn : connections_) {
-    if (!IsPingable(conn, now)) {
-      continue;
-    }
+  for (auto conn : pingable_connections) {
     bool needs_triggered_check =
         (!conn->writable() &&
          conn->last_ping_received() > conn->last_ping_sent());
@@ -20,6 +20,7 @@
 #ifndef WEBRTC_P2P_BASE_P2PTRANSPORTCHANNEL_H_
 #define WEBRTC_P2P_BASE_P2PTRANSPORTCHANNEL_H_
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
@@ -59,6 +60,22 @@ class RemoteCandidate : public Candidate {
   PortInterface* origin_port_;
 };
 
+// Sorts |connections| best first according to |is_better|, keeping equivalent
+// connections in their current order like std::stable_sort. Connections that
+// are already in order are compared only to the one before them, and the
+// others are moved to a position found by binary search, so this takes about
+// one comparison per connection when only a few of them are out of place.
+template <typename T, typename Compare>
+void StableSortConnections(std::vector<T>* connections, Compare is_better) {
+  for (auto it = connections->begin(); it != connections->end(); ++it) {
+    if (it == connections->begin() || !is_better(*it, *(it - 1))) {
+      continue;
+    }
+    auto pos = std::upper_bound(connections->begin(), it - 1, *it, is_better);
+    std::rotate(pos, it, it + 1);
+  }
+}
+
 // P2PTransportChannel manages the candidates and connection process to keep
 // two P2P clients connected to each other.
 class P2PTransportChannel : public IceTransportInternal,
@@ -216,6 +233,7 @@ class P2PTransportChannel : public IceTransportInternal,
   bool PresumedWritable(const cricket::Connection* conn) const;
 
   void SortConnectionsAndUpdateState();
+  void SortConnections();
   void SwitchSelectedConnection(Connection* conn);
   void UpdateState();
   void HandleAllTimedOut();
@@ -300,7 +318,9 @@ class P2PTransportChannel : public IceTransportInternal,
   void PruneConnections();
   bool IsBackupConnection(const Connection* conn) const;
 
-  Connection* FindOldestConnectionNeedingTriggeredCheck(int64_t now);
+  // Looks for a triggered check among |pingable_connections|.
+  Connection* FindOldestConnectionNeedingTriggeredCheck(
+      const std::vector<Connection*>& pingable_connections);
   // Between |conn1| and |conn2|, this function returns the one which should
   // be pinged first.
   Connection* MorePingable(Connection* conn1, Connection* conn2);
@@ -24,6 +24,7 @@
 #include "webrtc/base/natsocketfactory.h"
 #include "webrtc/base/physicalsocketserver.h"
 #include "webrtc/base/proxyserver.h"
+#include "webrtc/base/random.h"
 #include "webrtc/base/socketaddress.h"
 #include "webrtc/base/ssladapter.h"
 #include "webrtc/base/thread.h"
@@ -3110,6 +3111,50 @@ TEST_F(P2PTransportChannelPingTest, TestTriggeredChecks) {
   EXPECT_EQ(conn1, FindNextPingableConnectionAndPingIt(&ch));
 }
 
+// Verify that StableSortConnections orders connections exactly like
+// std::stable_sort with the same comparator, both from a random order and
+// from a sorted order in which a few connections changed.
+TEST_F(P2PTransportChannelPingTest, TestStableSortConnections) {
+  const int kNumConnections = 24;
+  FakePortAllocator pa(rtc::Thread::Current(), nullptr);
+  P2PTransportChannel ch("stable sort", 1, &pa);
+  PrepareChannel(&ch);
+  ch.MaybeStartGathering();
+  for (int i = 0; i < kNumConnections; ++i) {
+    ch.AddRemoteCandidate(
+        CreateUdpCandidate(LOCAL_PORT_TYPE, "1.1.1.1", 1000 + i, 1));
+  }
+  EXPECT_EQ_WAIT(kNumConnections, static_cast<int>(ch.connections().size()),
+                 kDefaultTimeout);
+  std::vector<Connection*> connections = ch.connections();
+
+  // Few distinct keys, so that there are many equivalent connections.
+  webrtc::Random random(12345);
+  std::map<Connection*, uint32_t> keys;
+  auto is_better = [&keys](Connection* a, Connection* b) {
+    return keys[a] > keys[b];
+  };
+  for (int run = 0; run < 100; ++run) {
+    for (Connection* conn : connections) {
+      keys[conn] = random.Rand(3);
+    }
+    std::random_shuffle(connections.begin(), connections.end());
+    std::vector<Connection*> expected = connections;
+    std::stable_sort(expected.begin(), expected.end(), is_better);
+    StableSortConnections(&connections, is_better);
+    EXPECT_EQ(expected, connections);
+
+    // Change a few keys, as when the state of some connections changes.
+    for (int i = 0; i < 3; ++i) {
+      keys[connections[random.Rand(kNumConnections - 1)]] = random.Rand(3);
+    }
+    expected = connections;
+    std::stable_sort(expected.begin(), expected.end(), is_better);
+    StableSortConnections(&connections, is_better);
+    EXPECT_EQ(expected, connections);
+  }
+}
+
 TEST_F(P2PTransportChannelPingTest, TestAllConnectionsPingedSufficiently) {
   FakePortAllocator pa(rtc::Thread::Current(), nullptr);
   P2PTransportChannel ch("ping sufficiently", 1, &pa);
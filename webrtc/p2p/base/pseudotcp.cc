@@ -14,7 +14,7 @@
 #include <stdlib.h>
 
 #include <algorithm>
-#include <memory>
+#include <cmath>
 #include <set>
 
 #include "webrtc/base/arraysize.h"
@@ -115,6 +115,8 @@ const uint32_t DEF_ACK_DELAY = 100;  // 100 milliseconds
 
 const uint8_t FLAG_CTL = 0x02;
 const uint8_t FLAG_RST = 0x04;
+// The payload of a pure ACK holds SACK blocks rather than data.
+const uint8_t FLAG_SACK = 0x08;
 
 const uint8_t CTL_CONNECT = 0;
 
@@ -123,6 +125,20 @@ const uint8_t TCP_OPT_EOL = 0;        // End of list.
 const uint8_t TCP_OPT_NOOP = 1;       // No-op.
 const uint8_t TCP_OPT_MSS = 2;        // Maximum segment size.
 const uint8_t TCP_OPT_WND_SCALE = 3;  // Window scale factor.
+const uint8_t TCP_OPT_SACK_PERMITTED = 4;  // Selective acks supported.
+
+// Largest window scale factor allowed by RFC 1323, section 2.3.
+const uint8_t MAX_WND_SCALE = 14;
+
+// Each SACK block is a pair of 32-bit left and right edges.
+const uint32_t SACK_BLOCK_SIZE = 8;
+const uint32_t MAX_SACK_BLOCKS = 4;
+const uint32_t MAX_SACK_SIZE = MAX_SACK_BLOCKS * SACK_BLOCK_SIZE;
+
+// CUBIC multiplicative decrease factor and scaling constant, in segments and
+// seconds (RFC 8312, section 5).
+const double CUBIC_BETA = 0.7;
+const double CUBIC_C = 0.4;
 
 const long DEFAULT_TIMEOUT = 4000; // If there are no pending clocks, wake up every 4 seconds
 const long CLOSED_TIMEOUT = 60 * 1000; // If the connection is closed, once per minute
@@ -254,6 +270,14 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
   m_rx_rto = DEF_RTO;
   m_rx_srtt = m_rx_rttvar = 0;
 
+  m_support_sack = true;
+  m_sack_enabled = false;
+  m_sack_high = m_sack_rexmit_nxt = 0;
+
+  m_use_cubic = false;
+  m_cubic_wmax = m_cubic_origin = m_cubic_epoch_start = 0;
+  m_cubic_k = 0;
+
   m_use_nagling = true;
   m_ack_delay = DEF_ACK_DELAY;
   m_support_wnd_scale = true;
@@ -308,9 +332,16 @@ void PseudoTcp::NotifyClock(uint32_t now) {
       }
 
       uint32_t nInFlight = m_snd_nxt - m_snd_una;
-      m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
+      m_ssthresh = lossSlowStartThreshold(nInFlight);
       //LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: " << nInFlight << "  m_mss: " << m_mss;
       m_cwnd = m_mss;
+      // The peer may have discarded the data it sacked, so forget about it
+      // (RFC 2018, section 8).
+      for (SList::iterator it = m_slist.begin(); it != m_slist.end(); ++it) {
+        it->sacked = false;
+      }
+      m_sack_high = m_snd_una;
+      m_sack_rexmit_nxt = m_snd_una;
 
       // Back off retransmit timer.  Note: the limit is lower when connecting.
       uint32_t rto_limit = (m_state < TCP_ESTABLISHED) ? DEF_RTO : MAX_RTO;
@@ -377,6 +408,10 @@ void PseudoTcp::GetOption(Option opt, int* value) {
     *value = m_sbuf_len;
   } else if (opt == OPT_RCVBUF) {
     *value = m_rbuf_len;
+  } else if (opt == OPT_SACK) {
+    *value = m_support_sack ? 1 : 0;
+  } else if (opt == OPT_CUBIC) {
+    *value = m_use_cubic ? 1 : 0;
   } else {
     RTC_NOTREACHED();
   }
@@ -392,6 +427,11 @@ void PseudoTcp::SetOption(Option opt, int value) {
   } else if (opt == OPT_RCVBUF) {
     RTC_DCHECK(m_state == TCP_LISTEN);
     resizeReceiveBuffer(value);
+  } else if (opt == OPT_SACK) {
+    RTC_DCHECK(m_state == TCP_LISTEN);
+    m_support_sack = value != 0;
+  } else if (opt == OPT_CUBIC) {
+    m_use_cubic = value != 0;
   } else {
     RTC_NOTREACHED();
   }
@@ -520,24 +560,35 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
 
   uint32_t now = Now();
 
-  std::unique_ptr<uint8_t[]> buffer(new uint8_t[MAX_PACKET]);
-  long_to_bytes(m_conv, buffer.get());
-  long_to_bytes(seq, buffer.get() + 4);
-  long_to_bytes(m_rcv_nxt, buffer.get() + 8);
+  m_packet_buf.SetSize(HEADER_SIZE + std::max(len, MAX_SACK_SIZE));
+  uint8_t* buffer = m_packet_buf.data();
+
+  // A pure ACK tells the peer about the out-of-order data we have, so it can
+  // retransmit only what is missing.
+  uint32_t sack_len = 0;
+  if (!len && m_sack_enabled && !(flags & FLAG_CTL) && !m_rlist.empty()) {
+    sack_len = writeSackBlocks(buffer + HEADER_SIZE);
+    if (sack_len)
+      flags |= FLAG_SACK;
+  }
+
+  long_to_bytes(m_conv, buffer);
+  long_to_bytes(seq, buffer + 4);
+  long_to_bytes(m_rcv_nxt, buffer + 8);
   buffer[12] = 0;
   buffer[13] = flags;
   short_to_bytes(static_cast<uint16_t>(m_rcv_wnd >> m_rwnd_scale),
-                 buffer.get() + 14);
+                 buffer + 14);
 
   // Timestamp computations
-  long_to_bytes(now, buffer.get() + 16);
-  long_to_bytes(m_ts_recent, buffer.get() + 20);
+  long_to_bytes(now, buffer + 16);
+  long_to_bytes(m_ts_recent, buffer + 20);
   m_ts_lastack = m_rcv_nxt;
 
   if (len) {
     size_t bytes_read = 0;
     rtc::StreamResult result = m_sbuf.ReadOffset(
-        buffer.get() + HEADER_SIZE, len, offset, &bytes_read);
+        buffer + HEADER_SIZE, len, offset, &bytes_read);
     RTC_DCHECK(result == rtc::SR_SUCCESS);
     RTC_DCHECK(static_cast<uint32_t>(bytes_read) == len);
   }
@@ -554,7 +605,7 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
 #endif // _DEBUGMSG
 
   IPseudoTcpNotify::WriteResult wres = m_notify->TcpWritePacket(
-      this, reinterpret_cast<char *>(buffer.get()), len + HEADER_SIZE);
+      this, reinterpret_cast<char*>(buffer), len + sack_len + HEADER_SIZE);
   // Note: When len is 0, this is an ACK packet.  We don't read the return value for those,
   // and thus we won't retry.  So go ahead and treat the packet as a success (basically simulate
   // as if it were dropped), which will prevent our timers from being messed up.
@@ -587,6 +638,19 @@ bool PseudoTcp::parse(const uint8_t* buffer, uint32_t size) {
 
   seg.data = reinterpret_cast<const char *>(buffer) + HEADER_SIZE;
   seg.len = size - HEADER_SIZE;
+  seg.sack = NULL;
+  seg.sack_len = 0;
+
+  if (seg.flags & FLAG_SACK) {
+    if ((seg.len % SACK_BLOCK_SIZE) || (seg.len > MAX_SACK_SIZE)) {
+      LOG_F(LS_WARNING) << "Invalid SACK blocks";
+      return false;
+    }
+    // SACK blocks take the place of data, so this is a pure ACK.
+    seg.sack = seg.data;
+    seg.sack_len = seg.len;
+    seg.len = 0;
+  }
 
 #if _DEBUGMSG >= _DBG_VERBOSE
   LOG(LS_INFO) << "--> <CONV=" << seg.conv
@@ -708,6 +772,10 @@ bool PseudoTcp::process(Segment& seg) {
     m_ts_recent = seg.tsval;
   }
 
+  if (seg.sack_len && m_sack_enabled) {
+    applySackBlocks(seg);
+  }
+
   // Check if this is a valuable ack
   if ((seg.ack > m_snd_una) && (seg.ack <= m_snd_nxt)) {
     // Calculate round-trip time
@@ -773,7 +841,8 @@ bool PseudoTcp::process(Segment& seg) {
 #if _DEBUGMSG >= _DBG_NORMAL
         LOG(LS_INFO) << "recovery retransmit";
 #endif // _DEBUGMSG
-        if (!transmit(m_slist.begin(), now)) {
+        SList::iterator hole = nextRetransmission();
+        if ((hole != m_slist.end()) && !transmit(hole, now)) {
           closedown(ECONNABORTED);
           return false;
         }
@@ -785,7 +854,7 @@ bool PseudoTcp::process(Segment& seg) {
       if (m_cwnd < m_ssthresh) {
         m_cwnd += m_mss;
       } else {
-        m_cwnd += std::max<uint32_t>(1, m_mss * m_mss / m_cwnd);
+        increaseCongestionWindow(now);
       }
     }
   } else if (seg.ack == m_snd_una) {
@@ -802,16 +871,31 @@ bool PseudoTcp::process(Segment& seg) {
         LOG(LS_INFO) << "enter recovery";
         LOG(LS_INFO) << "recovery retransmit";
 #endif // _DEBUGMSG
-        if (!transmit(m_slist.begin(), now)) {
+        m_sack_rexmit_nxt = m_snd_una;
+        SList::iterator hole = nextRetransmission();
+        if (hole == m_slist.end()) {
+          hole = m_slist.begin();
+        }
+        if (!transmit(hole, now)) {
           closedown(ECONNABORTED);
           return false;
         }
         m_recover = m_snd_nxt;
         uint32_t nInFlight = m_snd_nxt - m_snd_una;
-        m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
+        m_ssthresh = lossSlowStartThreshold(nInFlight);
         //LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: " << nInFlight << "  m_mss: " << m_mss;
         m_cwnd = m_ssthresh + 3 * m_mss;
       } else if (m_dup_acks > 3) {
+        // Each further dup ack means another segment left the network. With
+        // SACK, use it to fill the next hole rather than waiting for a
+        // partial ack to reveal it.
+        if (m_sack_enabled) {
+          SList::iterator hole = nextRetransmission();
+          if ((hole != m_slist.end()) && !transmit(hole, now)) {
+            closedown(ECONNABORTED);
+            return false;
+          }
+        }
         m_cwnd += m_mss;
       }
     } else {
@@ -1041,6 +1125,7 @@ void PseudoTcp::attemptSend(SendFlags sflags) {
 
   if (rtc::TimeDiff32(now, m_lastsend) > static_cast<long>(m_rx_rto)) {
     m_cwnd = m_mss;
+    m_cubic_epoch_start = 0;
   }
 
 #if _DEBUGMSG
@@ -1181,6 +1266,10 @@ PseudoTcp::queueConnectMessage() {
     buf.WriteUInt8(1);
     buf.WriteUInt8(m_rwnd_scale);
   }
+  if (m_support_sack) {
+    buf.WriteUInt8(TCP_OPT_SACK_PERMITTED);
+    buf.WriteUInt8(0);
+  }
   m_snd_wnd = static_cast<uint32_t>(buf.Length());
   queue(buf.Data(), static_cast<uint32_t>(buf.Length()), true);
 }
@@ -1229,6 +1318,11 @@ void PseudoTcp::parseOptions(const char* data, uint32_t len) {
       m_swnd_scale = 0;
     }
   }
+
+  // SACK blocks are only sent and used if both sides support them.
+  m_sack_enabled = m_support_sack &&
+                   (options_specified.find(TCP_OPT_SACK_PERMITTED) !=
+                    options_specified.end());
 }
 
 void PseudoTcp::applyOption(char kind, const char* data, uint32_t len) {
@@ -1243,13 +1337,128 @@ void PseudoTcp::applyOption(char kind, const char* data, uint32_t len) {
       return;
     }
     applyWindowScaleOption(data[0]);
+  } else if (kind == TCP_OPT_SACK_PERMITTED) {
+    // http://www.ietf.org/rfc/rfc2018.txt
+    if (len != 0) {
+      LOG_F(WARNING) << "Invalid SACK permitted option received.";
+    }
   }
 }
 
 void PseudoTcp::applyWindowScaleOption(uint8_t scale_factor) {
+  if (scale_factor > MAX_WND_SCALE) {
+    LOG_F(WARNING) << "Window scale factor " << static_cast<int>(scale_factor)
+                   << " exceeds the maximum; using " << MAX_WND_SCALE;
+    scale_factor = MAX_WND_SCALE;
+  }
   m_swnd_scale = scale_factor;
 }
 
+uint32_t PseudoTcp::writeSackBlocks(uint8_t* buffer) {
+  // |m_rlist| is sorted by sequence number, but its segments can overlap or
+  // be adjacent, so merge them into contiguous blocks.
+  uint32_t size = 0;
+  RList::const_iterator it = m_rlist.begin();
+  while ((it != m_rlist.end()) && (size < MAX_SACK_SIZE)) {
+    uint32_t left = it->seq;
+    uint32_t right = it->seq + it->len;
+    for (++it; (it != m_rlist.end()) && (it->seq <= right); ++it) {
+      right = std::max(right, it->seq + it->len);
+    }
+    if (right <= m_rcv_nxt) {
+      continue;
+    }
+    long_to_bytes(std::max(left, m_rcv_nxt), buffer + size);
+    long_to_bytes(right, buffer + size + 4);
+    size += SACK_BLOCK_SIZE;
+  }
+  return size;
+}
+
+void PseudoTcp::applySackBlocks(const Segment& seg) {
+  for (uint32_t i = 0; i < seg.sack_len; i += SACK_BLOCK_SIZE) {
+    uint32_t left = bytes_to_long(seg.sack + i);
+    uint32_t right = bytes_to_long(seg.sack + i + 4);
+    if ((left >= right) || (left < m_snd_una) || (right > m_snd_nxt)) {
+      continue;
+    }
+    for (SList::iterator it = m_slist.begin();
+         (it != m_slist.end()) && (it->xmit > 0) && (it->seq < right); ++it) {
+      if ((it->seq >= left) && (it->seq + it->len <= right)) {
+        it->sacked = true;
+      }
+    }
+    m_sack_high = std::max(m_sack_high, right);
+  }
+}
+
+PseudoTcp::SList::iterator PseudoTcp::nextRetransmission() {
+  if (!m_sack_enabled) {
+    return m_slist.begin();
+  }
+  for (SList::iterator it = m_slist.begin();
+       (it != m_slist.end()) && (it->xmit > 0); ++it) {
+    if (it->sacked || (it->seq < m_sack_rexmit_nxt)) {
+      continue;
+    }
+    // The first unacknowledged segment is known to be missing. Later ones
+    // are only known to be missing if the peer sacked data above them.
+    if ((it != m_slist.begin()) && (it->seq >= m_sack_high)) {
+      break;
+    }
+    m_sack_rexmit_nxt = it->seq + it->len;
+    return it;
+  }
+  return m_slist.end();
+}
+
+uint32_t PseudoTcp::lossSlowStartThreshold(uint32_t in_flight) {
+  if (!m_use_cubic) {
+    return std::max(in_flight / 2, 2 * m_mss);
+  }
+  // Fast convergence: release bandwidth to newer flows if the window keeps
+  // shrinking.
+  if (in_flight < m_cubic_wmax) {
+    m_cubic_wmax = static_cast<uint32_t>(in_flight * (1 + CUBIC_BETA) / 2);
+  } else {
+    m_cubic_wmax = in_flight;
+  }
+  m_cubic_epoch_start = 0;
+  return std::max(static_cast<uint32_t>(in_flight * CUBIC_BETA), 2 * m_mss);
+}
+
+void PseudoTcp::increaseCongestionWindow(uint32_t now) {
+  uint32_t reno_increase = std::max<uint32_t>(1, m_mss * m_mss / m_cwnd);
+  if (!m_use_cubic) {
+    m_cwnd += reno_increase;
+    return;
+  }
+
+  if (m_cubic_epoch_start == 0) {
+    m_cubic_epoch_start = now;
+    if (m_cwnd < m_cubic_wmax) {
+      // Time for the cubic function to grow back to the window at the loss.
+      m_cubic_k = std::cbrt((m_cubic_wmax - m_cwnd) / (CUBIC_C * m_mss));
+      m_cubic_origin = m_cubic_wmax;
+    } else {
+      m_cubic_k = 0;
+      m_cubic_origin = m_cwnd;
+    }
+  }
+
+  // Target the window the cubic function reaches an RTT from now, growing by
+  // at most half a segment per ACK (RFC 8312, section 4.1). The Reno
+  // increase is a floor, so CUBIC is never slower than NewReno.
+  double t = (rtc::TimeDiff32(now, m_cubic_epoch_start) + m_rx_srtt) / 1000.0;
+  double target = m_cubic_origin + CUBIC_C * std::pow(t - m_cubic_k, 3) * m_mss;
+  uint32_t cubic_increase = 0;
+  if (target > m_cwnd) {
+    cubic_increase = static_cast<uint32_t>(
+        std::min<double>(m_mss / 2, (target - m_cwnd) * m_mss / m_cwnd));
+  }
+  m_cwnd += std::max(reno_increase, cubic_increase);
+}
+
 void PseudoTcp::resizeSendBuffer(uint32_t new_size) {
   m_sbuf_len = new_size;
   m_sbuf.SetCapacity(new_size);
@@ -1260,6 +1469,7 @@ void PseudoTcp::resizeReceiveBuffer(uint32_t new_size) {
 
   // Determine the scale factor such that the scaled window size can fit
   // in a 16-bit unsigned integer.
+  new_size = std::min<uint32_t>(new_size, 0xFFFF << MAX_WND_SCALE);
   while (new_size > 0xFFFF) {
     ++scale_factor;
     new_size >>= 1;
@@ -14,6 +14,7 @@
 #include <list>
 
 #include "webrtc/base/basictypes.h"
+#include "webrtc/base/buffer.h"
 #include "webrtc/base/stream.h"
 
 namespace cricket {
@@ -82,13 +83,15 @@ class PseudoTcp {
   // instance's behaviour for the kind of data it will carry.
   // If an unrecognized option is set or got, an assertion will fire.
   //
-  // Setting options for OPT_RCVBUF or OPT_SNDBUF after Connect() is called
-  // will result in an assertion.
+  // Setting options for OPT_RCVBUF, OPT_SNDBUF or OPT_SACK after Connect() is
+  // called will result in an assertion.
   enum Option {
     OPT_NODELAY,      // Whether to enable Nagle's algorithm (0 == off)
     OPT_ACKDELAY,     // The Delayed ACK timeout (0 == off).
     OPT_RCVBUF,       // Set the receive buffer size, in bytes.
     OPT_SNDBUF,       // Set the send buffer size, in bytes.
+    OPT_SACK,         // Whether to negotiate selective acks (0 == off).
+    OPT_CUBIC,        // Whether to use CUBIC instead of NewReno (0 == off).
   };
   void GetOption(Option opt, int* value);
   void SetOption(Option opt, int value);
@@ -117,15 +120,20 @@ class PseudoTcp {
     const char * data;
     uint32_t len;
     uint32_t tsval, tsecr;
+    // SACK blocks carried by a pure ACK, as pairs of left and right edges.
+    const char* sack;
+    uint32_t sack_len;
   };
 
   struct SSegment {
     SSegment(uint32_t s, uint32_t l, bool c)
-        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c) {}
+        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c), sacked(false) {}
     uint32_t seq, len;
     // uint32_t tstamp;
     uint8_t xmit;
     bool bCtrl;
+    // Whether the peer has selectively acknowledged this segment.
+    bool sacked;
   };
   typedef std::list<SSegment> SList;
 
@@ -181,6 +189,26 @@ class PseudoTcp {
   // Apply window scale option.
   void applyWindowScaleOption(uint8_t scale_factor);
 
+  // Writes SACK blocks describing the out-of-order data in |m_rlist| to
+  // |buffer|. Returns the number of bytes written.
+  uint32_t writeSackBlocks(uint8_t* buffer);
+
+  // Marks the segments covered by the SACK blocks of |seg| as sacked.
+  void applySackBlocks(const Segment& seg);
+
+  // Returns the next segment to retransmit during fast recovery, or
+  // m_slist.end() if there is none. Without SACK, this is always the first
+  // unacknowledged segment. With SACK, this is the next hole below the highest
+  // sacked sequence number that hasn't been retransmitted yet.
+  SList::iterator nextRetransmission();
+
+  // Returns the slow start threshold to use after a loss, with |in_flight|
+  // bytes outstanding.
+  uint32_t lossSlowStartThreshold(uint32_t in_flight);
+
+  // Grows |m_cwnd| for an ACK received in congestion avoidance.
+  void increaseCongestionWindow(uint32_t now);
+
   // Resize the send buffer with |new_size| in bytes.
   void resizeSendBuffer(uint32_t new_size);
 
@@ -228,6 +256,18 @@ class PseudoTcp {
   uint32_t m_recover;
   uint32_t m_t_ack;
 
+  // Selective acknowledgements (RFC 2018). |m_sack_high| is the highest
+  // sequence number sacked by the peer, and |m_sack_rexmit_nxt| is where the
+  // search for holes to retransmit resumes during fast recovery.
+  bool m_support_sack, m_sack_enabled;
+  uint32_t m_sack_high, m_sack_rexmit_nxt;
+
+  // CUBIC congestion control (RFC 8312) state. |m_cubic_epoch_start| is 0
+  // until the first ACK in congestion avoidance after a loss.
+  bool m_use_cubic;
+  uint32_t m_cubic_wmax, m_cubic_origin, m_cubic_epoch_start;
+  double m_cubic_k;
+
   // Configuration options
   bool m_use_nagling;
   uint32_t m_ack_delay;
@@ -235,6 +275,9 @@ class PseudoTcp {
   // This is used by unit tests to test backward compatibility of
   // PseudoTcp implementations that don't support window scaling.
   bool m_support_wnd_scale;
+
+  // Reused to build outgoing packets, so sending doesn't allocate.
+  rtc::Buffer m_packet_buf;
 };
 
 }  // namespace cricket
@@ -9,15 +9,20 @@
  */
 
 #include <algorithm>
+#include <set>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #include "webrtc/p2p/base/pseudotcp.h"
+#include "webrtc/base/byteorder.h"
 #include "webrtc/base/gunit.h"
 #include "webrtc/base/helpers.h"
 #include "webrtc/base/messagehandler.h"
 #include "webrtc/base/stream.h"
 #include "webrtc/base/thread.h"
 #include "webrtc/base/timeutils.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 using cricket::PseudoTcp;
 
@@ -97,6 +102,17 @@ class PseudoTcpTestBase : public testing::Test,
   void DisableLocalWindowScale() {
     local_.disableWindowScale();
   }
+  void SetOptSack(bool enable_sack) {
+    local_.SetOption(PseudoTcp::OPT_SACK, enable_sack);
+    remote_.SetOption(PseudoTcp::OPT_SACK, enable_sack);
+  }
+  void DisableRemoteSack() {
+    remote_.SetOption(PseudoTcp::OPT_SACK, 0);
+  }
+  void SetOptCubic(bool enable_cubic) {
+    local_.SetOption(PseudoTcp::OPT_CUBIC, enable_cubic);
+    remote_.SetOption(PseudoTcp::OPT_CUBIC, enable_cubic);
+  }
 
  protected:
   int Connect() {
@@ -207,7 +223,8 @@ class PseudoTcpTestBase : public testing::Test,
 
 class PseudoTcpTest : public PseudoTcpTestBase {
  public:
-  void TestTransfer(int size) {
+  // Returns the throughput of the transfer, in Kbps.
+  int TestTransfer(int size) {
     uint32_t start;
     int32_t elapsed;
     size_t received;
@@ -227,7 +244,7 @@ class PseudoTcpTest : public PseudoTcpTestBase {
     // Sending will start from OnTcpWriteable and complete when all data has
     // been received.
     EXPECT_TRUE_WAIT(have_disconnected_, kTransferTimeoutMs);
-    elapsed = rtc::Time32() - start;
+    elapsed = std::max(rtc::Time32() - start, 1u);
     recv_stream_.GetSize(&received);
     // Ensure we closed down OK and we got the right data.
     // TODO: Ensure the errors are cleared properly.
@@ -238,6 +255,7 @@ class PseudoTcpTest : public PseudoTcpTestBase {
                         recv_stream_.GetBuffer(), size));
     LOG(LS_INFO) << "Transferred " << received << " bytes in " << elapsed
                  << " ms (" << size * 8 / elapsed << " Kbps)";
+    return size * 8 / elapsed;
   }
 
  private:
@@ -313,6 +331,47 @@ class PseudoTcpTest : public PseudoTcpTestBase {
   rtc::MemoryStream recv_stream_;
 };
 
+// Drops chosen data segments the first time they are sent, and records the
+// selective acks sent by the receiver and the segments the sender resends.
+class PseudoTcpTestSack : public PseudoTcpTest {
+ protected:
+  PseudoTcpTestSack() : new_segments_(0), sack_packets_(0) {}
+
+  // Drops the |index|th new data segment sent by the local side.
+  void DropSegment(int index) { drop_indices_.insert(index); }
+
+  WriteResult TcpWritePacket(PseudoTcp* tcp,
+                             const char* buffer,
+                             size_t len) override {
+    // See the packet layout in pseudotcp.cc.
+    const size_t kHeaderSize = 24;
+    const uint8_t kFlagCtl = 0x02;
+    const uint8_t kFlagSack = 0x08;
+    RTC_CHECK_GE(len, kHeaderSize);
+    const uint8_t flags = static_cast<uint8_t>(buffer[13]);
+    if (tcp == &remote_) {
+      if (flags & kFlagSack) {
+        ++sack_packets_;
+      }
+    } else if ((len > kHeaderSize) && !(flags & kFlagCtl)) {
+      const uint32_t seq = rtc::GetBE32(buffer + 4);
+      if (!sent_.insert(seq).second) {
+        retransmitted_.insert(seq);
+      } else if (drop_indices_.count(new_segments_++)) {
+        dropped_.insert(seq);
+        return WR_SUCCESS;
+      }
+    }
+    return PseudoTcpTest::TcpWritePacket(tcp, buffer, len);
+  }
+
+  std::set<int> drop_indices_;
+  int new_segments_;
+  std::set<uint32_t> sent_;
+  std::set<uint32_t> dropped_;
+  std::set<uint32_t> retransmitted_;
+  int sack_packets_;
+};
 
 class PseudoTcpTestPingPong : public PseudoTcpTestBase {
  public:
@@ -725,6 +784,90 @@ TEST_F(PseudoTcpTest, TestSendVerySmallReceiveBuffer) {
   TestTransfer(100000);
 }
 
+// Test that with selective acks, only the lost segments are retransmitted.
+TEST_F(PseudoTcpTestSack, TestRetransmitsOnlyLostSegments) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetOptSack(true);
+  DropSegment(10);
+  DropSegment(14);
+  DropSegment(15);
+  TestTransfer(100000);
+  EXPECT_GT(sack_packets_, 0);
+  EXPECT_EQ(3u, dropped_.size());
+  EXPECT_EQ(dropped_, retransmitted_);
+}
+
+// Test sending data with packet loss to a receiver that doesn't support
+// selective acks, as older implementations don't.
+TEST_F(PseudoTcpTest, TestSendWithLossRemoteNoSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetDelay(50);
+  SetLoss(10);
+  DisableRemoteSack();
+  TestTransfer(100000);
+}
+
+// Test sending data with packet loss using CUBIC congestion control.
+TEST_F(PseudoTcpTest, TestSendWithDelayAndLossAndCubic) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetDelay(50);
+  SetLoss(10);
+  SetOptCubic(true);
+  TestTransfer(100000);
+}
+
+// Test using CUBIC with large windows and no loss.
+TEST_F(PseudoTcpTest, TestSendBothUseLargeWindowScaleAndCubic) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetRemoteOptRcvBuf(1000000);
+  SetLocalOptRcvBuf(1000000);
+  SetOptCubic(true);
+  TestTransfer(10000000);
+}
+
+// Throughput benchmark over a matrix of packet loss, delay and loss recovery
+// configurations. Disabled since it takes a while, run it with
+// --gtest_also_run_disabled_tests.
+enum LossRecovery { NEWRENO, SACK, SACK_CUBIC };
+
+class PseudoTcpThroughputTest
+    : public PseudoTcpTest,
+      public ::testing::WithParamInterface<std::tuple<int, int, LossRecovery>> {
+};
+
+TEST_P(PseudoTcpThroughputTest, DISABLED_TestTransferThroughput) {
+  const int loss = std::get<0>(GetParam());
+  const int delay = std::get<1>(GetParam());
+  const LossRecovery recovery = std::get<2>(GetParam());
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetRemoteOptRcvBuf(200000);
+  SetLocalOptRcvBuf(200000);
+  SetOptSndBuf(300000);
+  SetLoss(loss);
+  SetDelay(delay);
+  SetOptSack(recovery != NEWRENO);
+  SetOptCubic(recovery == SACK_CUBIC);
+  int kbps = TestTransfer(200000);
+
+  const char* const kRecoveryNames[] = {"newreno", "sack", "sack_cubic"};
+  webrtc::test::PrintResult(
+      "pseudotcp_throughput",
+      "_loss" + std::to_string(loss) + "_delay" + std::to_string(delay),
+      kRecoveryNames[recovery], kbps, "Kbps", false);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    PseudoTcpThroughput,
+    PseudoTcpThroughputTest,
+    ::testing::Combine(::testing::Values(0, 1, 5),
+                       ::testing::Values(0, 50),
+                       ::testing::Values(NEWRENO, SACK, SACK_CUBIC)));
+
 // Ping-pong (request/response) tests
 
 // Test sending <= 1x MTU of data in each ping/pong.  Should take <10ms.
@@ -0,0 +1,271 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/p2p/base/shardedturnserver.h"
+
+#include "webrtc/base/buffer.h"
+#include "webrtc/base/checks.h"
+#include "webrtc/base/thread.h"
+#include "webrtc/p2p/base/basicpacketsocketfactory.h"
+
+namespace cricket {
+
+namespace {
+
+// IDs used for posted messages for ShardedTurnServer.
+enum {
+  MSG_SEND_PACKET,
+};
+
+// A packet received on an internal socket, on its way to a shard.
+struct IncomingPacket : public rtc::MessageData {
+  IncomingPacket(const char* data,
+                 size_t size,
+                 const rtc::SocketAddress& addr,
+                 const rtc::PacketTime& packet_time)
+      : data(data, size), addr(addr), packet_time(packet_time) {}
+
+  rtc::Buffer data;
+  rtc::SocketAddress addr;
+  rtc::PacketTime packet_time;
+};
+
+// A packet sent by a shard, on its way to an internal socket.
+struct OutgoingPacket : public rtc::MessageData {
+  OutgoingPacket(rtc::AsyncPacketSocket* socket,
+                 const void* data,
+                 size_t size,
+                 const rtc::SocketAddress& addr,
+                 const rtc::PacketOptions& options)
+      : socket(socket),
+        data(static_cast<const uint8_t*>(data), size),
+        addr(addr),
+        options(options) {}
+
+  rtc::AsyncPacketSocket* socket;
+  rtc::Buffer data;
+  rtc::SocketAddress addr;
+  rtc::PacketOptions options;
+};
+
+// Scrambles the bits of |h|, so that the low bits used to pick a shard depend
+// on all bits of the 5-tuple hash (the MurmurHash3 finalizer).
+uint32_t MixHash(uint32_t h) {
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return h;
+}
+
+}  // namespace
+
+struct ShardedTurnServer::Shard {
+  std::unique_ptr<rtc::Thread> thread;
+  // Used and destroyed on |thread|.
+  std::unique_ptr<TurnServer> server;
+};
+
+// Stands in for an internal socket on a shard's thread. Packets received on the
+// real socket are posted to it and signaled to the shard's TurnServer, and
+// packets sent on it are posted back to the network thread.
+class ShardedTurnServer::ShardSocket : public rtc::AsyncPacketSocket,
+                                      public rtc::MessageHandler {
+ public:
+  ShardSocket(ShardedTurnServer* server,
+              rtc::Thread* thread,
+              rtc::AsyncPacketSocket* socket,
+              const rtc::SocketAddress& local_address)
+      : server_(server),
+        thread_(thread),
+        socket_(socket),
+        local_address_(local_address) {}
+  ~ShardSocket() override { thread_->Clear(this); }
+
+  rtc::SocketAddress GetLocalAddress() const override {
+    return local_address_;
+  }
+  rtc::SocketAddress GetRemoteAddress() const override {
+    return rtc::SocketAddress();
+  }
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override {
+    // The internal sockets are not connected.
+    RTC_NOTREACHED();
+    return -1;
+  }
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override {
+    RTC_DCHECK(thread_->IsCurrent());
+    // Like any UDP send, this may still be dropped on the way.
+    server_->PostSendPacket(socket_, pv, cb, addr, options);
+    return static_cast<int>(cb);
+  }
+  int Close() override { return 0; }
+  State GetState() const override { return STATE_BOUND; }
+  int GetOption(rtc::Socket::Option opt, int* value) override { return -1; }
+  int SetOption(rtc::Socket::Option opt, int value) override { return -1; }
+  int GetError() const override { return 0; }
+  void SetError(int error) override {}
+
+  void OnMessage(rtc::Message* msg) override {
+    RTC_DCHECK(thread_->IsCurrent());
+    std::unique_ptr<IncomingPacket> packet(
+        static_cast<IncomingPacket*>(msg->pdata));
+    SignalReadPacket(this, packet->data.data<char>(), packet->data.size(),
+                     packet->addr, packet->packet_time);
+  }
+
+ private:
+  ShardedTurnServer* const server_;
+  rtc::Thread* const thread_;
+  rtc::AsyncPacketSocket* const socket_;
+  const rtc::SocketAddress local_address_;
+};
+
+ShardedTurnServer::ShardedTurnServer(rtc::Thread* network_thread,
+                                     int num_shards)
+    : network_thread_(network_thread) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  RTC_DCHECK_GT(num_shards, 0);
+  for (int i = 0; i < num_shards; ++i) {
+    std::unique_ptr<Shard> shard(new Shard());
+    shard->thread = rtc::Thread::CreateWithSocketServer();
+    shard->thread->SetName("TurnServerShard", shard.get());
+    shard->thread->Start();
+    shard->server.reset(new TurnServer(shard->thread.get()));
+    shards_.push_back(std::move(shard));
+  }
+}
+
+ShardedTurnServer::~ShardedTurnServer() {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  // Stop dispatching packets before the shards go away.
+  for (const auto& kv : internal_sockets_)
+    delete kv.first;
+  for (const auto& shard : shards_) {
+    Shard* s = shard.get();
+    s->thread->Invoke<void>(RTC_FROM_HERE, [s] { s->server.reset(); });
+    s->thread->Stop();
+  }
+  // Drop packets the shards sent that have not gone out yet; their sockets
+  // are gone.
+  network_thread_->Clear(this);
+}
+
+void ShardedTurnServer::set_realm(const std::string& realm) {
+  InvokeOnShards([&realm](Shard* shard) { shard->server->set_realm(realm); });
+}
+
+void ShardedTurnServer::set_software(const std::string& software) {
+  InvokeOnShards(
+      [&software](Shard* shard) { shard->server->set_software(software); });
+}
+
+void ShardedTurnServer::set_auth_hook(TurnAuthInterface* auth_hook) {
+  InvokeOnShards(
+      [auth_hook](Shard* shard) { shard->server->set_auth_hook(auth_hook); });
+}
+
+void ShardedTurnServer::set_enable_permission_checks(bool enable) {
+  InvokeOnShards([enable](Shard* shard) {
+    shard->server->set_enable_permission_checks(enable);
+  });
+}
+
+void ShardedTurnServer::set_reject_private_addresses(bool filter) {
+  InvokeOnShards([filter](Shard* shard) {
+    shard->server->set_reject_private_addresses(filter);
+  });
+}
+
+void ShardedTurnServer::AddInternalSocket(rtc::AsyncPacketSocket* socket) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  RTC_DCHECK(internal_sockets_.find(socket) == internal_sockets_.end());
+  const rtc::SocketAddress local_address = socket->GetLocalAddress();
+  InternalSocket& internal_socket = internal_sockets_[socket];
+  internal_socket.local_hash = local_address.Hash();
+  InvokeOnShards([this, socket, &local_address,
+                  &internal_socket](Shard* shard) {
+    ShardSocket* shard_socket =
+        new ShardSocket(this, shard->thread.get(), socket, local_address);
+    shard->server->AddInternalSocket(shard_socket, PROTO_UDP);
+    internal_socket.shard_sockets.push_back(shard_socket);
+  });
+  socket->SignalReadPacket.connect(this, &ShardedTurnServer::OnInternalPacket);
+}
+
+void ShardedTurnServer::SetExternalAddress(const rtc::SocketAddress& address) {
+  InvokeOnShards([&address](Shard* shard) {
+    shard->server->SetExternalSocketFactory(
+        new rtc::BasicPacketSocketFactory(shard->thread.get()), address);
+  });
+}
+
+std::vector<size_t> ShardedTurnServer::GetAllocationCounts() {
+  std::vector<size_t> counts;
+  InvokeOnShards([&counts](Shard* shard) {
+    counts.push_back(shard->server->allocations().size());
+  });
+  return counts;
+}
+
+void ShardedTurnServer::InvokeOnShards(
+    const std::function<void(Shard*)>& functor) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  for (const auto& shard : shards_) {
+    Shard* s = shard.get();
+    s->thread->Invoke<void>(RTC_FROM_HERE, [&functor, s] { functor(s); });
+  }
+}
+
+size_t ShardedTurnServer::GetShardIndex(const InternalSocket& socket,
+                                        const rtc::SocketAddress& src) const {
+  // All internal sockets are UDP, so the protocol does not change the hash.
+  uint32_t hash = static_cast<uint32_t>(src.Hash() ^ (socket.local_hash * 31));
+  return MixHash(hash) % shards_.size();
+}
+
+void ShardedTurnServer::OnInternalPacket(rtc::AsyncPacketSocket* socket,
+                                         const char* data,
+                                         size_t size,
+                                         const rtc::SocketAddress& addr,
+                                         const rtc::PacketTime& packet_time) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  auto it = internal_sockets_.find(socket);
+  RTC_DCHECK(it != internal_sockets_.end());
+  size_t index = GetShardIndex(it->second, addr);
+  shards_[index]->thread->Post(RTC_FROM_HERE,
+                               it->second.shard_sockets[index], 0,
+                               new IncomingPacket(data, size, addr,
+                                                  packet_time));
+}
+
+void ShardedTurnServer::PostSendPacket(rtc::AsyncPacketSocket* socket,
+                                       const void* data,
+                                       size_t size,
+                                       const rtc::SocketAddress& addr,
+                                       const rtc::PacketOptions& options) {
+  network_thread_->Post(RTC_FROM_HERE, this, MSG_SEND_PACKET,
+                        new OutgoingPacket(socket, data, size, addr, options));
+}
+
+void ShardedTurnServer::OnMessage(rtc::Message* msg) {
+  RTC_DCHECK(msg->message_id == MSG_SEND_PACKET);
+  std::unique_ptr<OutgoingPacket> packet(static_cast<OutgoingPacket*>(msg->pdata));
+  packet->socket->SendTo(packet->data.data(), packet->data.size(),
+                         packet->addr, packet->options);
+}
+
+}  // namespace cricket
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_P2P_BASE_SHARDEDTURNSERVER_H_
+#define WEBRTC_P2P_BASE_SHARDEDTURNSERVER_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "webrtc/base/asyncpacketsocket.h"
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/messagehandler.h"
+#include "webrtc/base/sigslot.h"
+#include "webrtc/base/socketaddress.h"
+#include "webrtc/p2p/base/turnserver.h"
+
+namespace rtc {
+class Thread;
+}
+
+namespace cricket {
+
+// Spreads the allocations of a TURN server across a number of shards, each a
+// TurnServer running on its own network thread. Packets received on the
+// internal sockets are dispatched to a shard by a hash of their 5-tuple, so
+// all packets of an allocation are handled by the same shard, which owns the
+// allocation with its permissions, channels and external socket.
+//
+// The internal sockets stay on |network_thread|, which only reads packets from
+// them and sends the packets that the shards send to clients. Parsing,
+// authentication, allocation lookups and all I/O on the external sockets run
+// on the shards.
+//
+// Only UDP internal sockets are supported.
+class ShardedTurnServer : public rtc::MessageHandler,
+                          public sigslot::has_slots<> {
+ public:
+  // Must be created, used and destroyed on |network_thread|.
+  ShardedTurnServer(rtc::Thread* network_thread, int num_shards);
+  ~ShardedTurnServer() override;
+
+  int num_shards() const { return static_cast<int>(shards_.size()); }
+
+  // Same as the TurnServer settings, applied to all shards.
+  void set_realm(const std::string& realm);
+  void set_software(const std::string& software);
+  // The hook is called on the shard threads, so it must be thread-safe.
+  void set_auth_hook(TurnAuthInterface* auth_hook);
+  void set_enable_permission_checks(bool enable);
+  void set_reject_private_addresses(bool filter);
+
+  // Starts listening for packets from internal clients on a UDP socket
+  // created on |network_thread|. Takes ownership of |socket|.
+  void AddInternalSocket(rtc::AsyncPacketSocket* socket);
+  // Sets the address the external sockets are bound to. Each shard creates
+  // its external sockets on its own thread.
+  void SetExternalAddress(const rtc::SocketAddress& address);
+
+  // Returns the number of allocations on each shard.
+  std::vector<size_t> GetAllocationCounts();
+
+ private:
+  class ShardSocket;
+  struct Shard;
+
+  struct InternalSocket {
+    // Hash of the local address, the half of the 5-tuple that is the same for
+    // all packets received on the socket.
+    size_t local_hash;
+    // Stand-ins for the socket on each shard, owned by the shard's TurnServer.
+    std::vector<ShardSocket*> shard_sockets;
+  };
+
+  void InvokeOnShards(const std::function<void(Shard*)>& functor);
+  size_t GetShardIndex(const InternalSocket& socket,
+                       const rtc::SocketAddress& src) const;
+
+  void OnInternalPacket(rtc::AsyncPacketSocket* socket,
+                        const char* data,
+                        size_t size,
+                        const rtc::SocketAddress& addr,
+                        const rtc::PacketTime& packet_time);
+  // Called on a shard thread when the shard sends a packet to a client.
+  void PostSendPacket(rtc::AsyncPacketSocket* socket,
+                      const void* data,
+                      size_t size,
+                      const rtc::SocketAddress& addr,
+                      const rtc::PacketOptions& options);
+  void OnMessage(rtc::Message* msg) override;
+
+  rtc::Thread* const network_thread_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::map<rtc::AsyncPacketSocket*, InternalSocket> internal_sockets_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(ShardedTurnServer);
+};
+
+}  // namespace cricket
+
+#endif  // WEBRTC_P2P_BASE_SHARDEDTURNSERVER_H_
@@ -0,0 +1,291 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "webrtc/base/asyncudpsocket.h"
+#include "webrtc/base/bytebuffer.h"
+#include "webrtc/base/gunit.h"
+#include "webrtc/base/helpers.h"
+#include "webrtc/base/physicalsocketserver.h"
+#include "webrtc/base/testclient.h"
+#include "webrtc/base/thread.h"
+#include "webrtc/base/timeutils.h"
+#include "webrtc/p2p/base/shardedturnserver.h"
+#include "webrtc/p2p/base/stun.h"
+#include "webrtc/test/testsupport/perf_test.h"
+
+namespace cricket {
+
+namespace {
+
+const char kRealm[] = "example.org";
+const int kTimeoutMs = 5000;
+const int kChannelId = 0x4000;
+const char kLocalIp[] = "127.0.0.1";
+
+// Succeeds if the password is the same as the username. Thread-safe.
+class TestAuth : public TurnAuthInterface {
+ public:
+  bool GetKey(const std::string& username,
+              const std::string& realm,
+              std::string* key) override {
+    return ComputeStunCredentialHash(username, realm, username, key);
+  }
+};
+
+// Minimal TURN client that allocates, binds a channel and sends channel data.
+class TestTurnClient {
+ public:
+  TestTurnClient(rtc::SocketServer* ss, const rtc::SocketAddress& server_addr)
+      : client_(
+            rtc::AsyncUDPSocket::Create(ss, rtc::SocketAddress(kLocalIp, 0))),
+        server_addr_(server_addr),
+        username_(rtc::CreateRandomString(8)) {}
+
+  bool Allocate() {
+    TurnMessage request;
+    request.SetType(STUN_ALLOCATE_REQUEST);
+    request.AddAttribute(new StunUInt32Attribute(
+        STUN_ATTR_REQUESTED_TRANSPORT, IPPROTO_UDP << 24));
+    // The first attempt is rejected with the realm and a nonce.
+    std::unique_ptr<TurnMessage> response(SendRequest(&request, false));
+    if (!response || response->type() != STUN_ALLOCATE_ERROR_RESPONSE)
+      return false;
+    nonce_ = response->GetByteString(STUN_ATTR_NONCE)->GetString();
+    ComputeStunCredentialHash(username_, kRealm, username_, &key_);
+
+    response.reset(SendRequest(&request, true));
+    if (!response || response->type() != STUN_ALLOCATE_RESPONSE)
+      return false;
+    relayed_addr_ =
+        response->GetAddress(STUN_ATTR_XOR_RELAYED_ADDRESS)->GetAddress();
+    return true;
+  }
+
+  bool BindChannel(const rtc::SocketAddress& peer) {
+    TurnMessage request;
+    request.SetType(TURN_CHANNEL_BIND_REQUEST);
+    request.AddAttribute(new StunUInt32Attribute(STUN_ATTR_CHANNEL_NUMBER,
+                                                 kChannelId << 16));
+    request.AddAttribute(
+        new StunXorAddressAttribute(STUN_ATTR_XOR_PEER_ADDRESS, peer));
+    std::unique_ptr<TurnMessage> response(SendRequest(&request, true));
+    return response && response->type() == TURN_CHANNEL_BIND_RESPONSE;
+  }
+
+  void SendChannelData(const char* data, size_t size) {
+    rtc::ByteBufferWriter buf;
+    buf.WriteUInt16(kChannelId);
+    buf.WriteUInt16(static_cast<uint16_t>(size));
+    buf.WriteBytes(data, size);
+    client_.SendTo(buf.Data(), buf.Length(), server_addr_);
+  }
+
+  rtc::TestClient* client() { return &client_; }
+  const rtc::SocketAddress& relayed_addr() const { return relayed_addr_; }
+
+ private:
+  TurnMessage* SendRequest(TurnMessage* request, bool authenticate) {
+    request->SetTransactionID(
+        rtc::CreateRandomString(kStunTransactionIdLength));
+    if (authenticate) {
+      request->AddAttribute(
+          new StunByteStringAttribute(STUN_ATTR_USERNAME, username_));
+      request->AddAttribute(
+          new StunByteStringAttribute(STUN_ATTR_REALM, kRealm));
+      request->AddAttribute(
+          new StunByteStringAttribute(STUN_ATTR_NONCE, nonce_));
+      request->AddMessageIntegrity(key_);
+    }
+    rtc::ByteBufferWriter buf;
+    request->Write(&buf);
+    client_.SendTo(buf.Data(), buf.Length(), server_addr_);
+
+    std::unique_ptr<rtc::TestClient::Packet> packet(
+        client_.NextPacket(kTimeoutMs));
+    if (!packet)
+      return nullptr;
+    std::unique_ptr<TurnMessage> response(new TurnMessage());
+    rtc::ByteBufferReader reader(packet->buf, packet->size);
+    if (!response->Read(&reader))
+      return nullptr;
+    return response.release();
+  }
+
+  rtc::TestClient client_;
+  const rtc::SocketAddress server_addr_;
+  const std::string username_;
+  std::string nonce_;
+  std::string key_;
+  rtc::SocketAddress relayed_addr_;
+};
+
+// Counts the packets received on a set of sockets.
+class PacketCounter : public sigslot::has_slots<> {
+ public:
+  void Watch(rtc::AsyncPacketSocket* socket) {
+    socket->SignalReadPacket.connect(this, &PacketCounter::OnPacket);
+  }
+  int count() const { return count_; }
+  int64_t last_packet_ms() const { return last_packet_ms_; }
+
+ private:
+  void OnPacket(rtc::AsyncPacketSocket* socket,
+                const char* data,
+                size_t size,
+                const rtc::SocketAddress& addr,
+                const rtc::PacketTime& packet_time) {
+    ++count_;
+    last_packet_ms_ = rtc::TimeMillis();
+  }
+
+  int count_ = 0;
+  int64_t last_packet_ms_ = 0;
+};
+
+}  // namespace
+
+class ShardedTurnServerTest : public testing::Test {
+ public:
+  ShardedTurnServerTest()
+      : ss_scope_(&pss_),
+        network_thread_(rtc::Thread::CreateWithSocketServer()) {
+    network_thread_->Start();
+  }
+
+  ~ShardedTurnServerTest() {
+    network_thread_->Invoke<void>(RTC_FROM_HERE, [this] { server_.reset(); });
+  }
+
+  void CreateServer(int num_shards) {
+    network_thread_->Invoke<void>(RTC_FROM_HERE, [this, num_shards] {
+      server_.reset(new ShardedTurnServer(network_thread_.get(), num_shards));
+      server_->set_realm(kRealm);
+      server_->set_auth_hook(&auth_);
+      rtc::AsyncPacketSocket* socket = rtc::AsyncUDPSocket::Create(
+          network_thread_->socketserver(), rtc::SocketAddress(kLocalIp, 0));
+      server_addr_ = socket->GetLocalAddress();
+      server_->AddInternalSocket(socket);
+      server_->SetExternalAddress(rtc::SocketAddress(kLocalIp, 0));
+    });
+  }
+
+  std::vector<size_t> GetAllocationCounts() {
+    return network_thread_->Invoke<std::vector<size_t>>(
+        RTC_FROM_HERE, [this] { return server_->GetAllocationCounts(); });
+  }
+
+ protected:
+  rtc::PhysicalSocketServer pss_;
+  rtc::SocketServerScope ss_scope_;
+  std::unique_ptr<rtc::Thread> network_thread_;
+  TestAuth auth_;
+  std::unique_ptr<ShardedTurnServer> server_;
+  rtc::SocketAddress server_addr_;
+};
+
+TEST_F(ShardedTurnServerTest, RelaysChannelDataInBothDirections) {
+  CreateServer(2);
+  TestTurnClient turn_client(&pss_, server_addr_);
+  rtc::TestClient peer(
+      rtc::AsyncUDPSocket::Create(&pss_, rtc::SocketAddress(kLocalIp, 0)));
+  ASSERT_TRUE(turn_client.Allocate());
+  ASSERT_TRUE(turn_client.BindChannel(peer.address()));
+
+  const char kToPeer[] = "to peer";
+  turn_client.SendChannelData(kToPeer, sizeof(kToPeer));
+  rtc::SocketAddress from;
+  EXPECT_TRUE(peer.CheckNextPacket(kToPeer, sizeof(kToPeer), &from));
+  EXPECT_EQ(turn_client.relayed_addr(), from);
+
+  const char kToClient[] = "to client";
+  peer.SendTo(kToClient, sizeof(kToClient), turn_client.relayed_addr());
+  std::unique_ptr<rtc::TestClient::Packet> packet(
+      turn_client.client()->NextPacket(kTimeoutMs));
+  ASSERT_TRUE(packet);
+  ASSERT_EQ(4 + sizeof(kToClient), packet->size);
+  EXPECT_EQ(kChannelId, rtc::GetBE16(packet->buf));
+  EXPECT_EQ(0, memcmp(kToClient, packet->buf + 4, sizeof(kToClient)));
+}
+
+TEST_F(ShardedTurnServerTest, SpreadsAllocationsAcrossShards) {
+  const int kNumShards = 4;
+  const int kNumClients = 16;
+  CreateServer(kNumShards);
+  std::vector<std::unique_ptr<TestTurnClient>> clients;
+  for (int i = 0; i < kNumClients; ++i) {
+    clients.emplace_back(new TestTurnClient(&pss_, server_addr_));
+    ASSERT_TRUE(clients.back()->Allocate());
+  }
+
+  std::vector<size_t> counts = GetAllocationCounts();
+  ASSERT_EQ(static_cast<size_t>(kNumShards), counts.size());
+  size_t total = 0;
+  int used_shards = 0;
+  for (size_t count : counts) {
+    total += count;
+    if (count > 0)
+      ++used_shards;
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumClients), total);
+  EXPECT_GT(used_shards, 1);
+}
+
+// Measures the packet rate relayed from clients to peers.
+TEST_F(ShardedTurnServerTest, RelayThroughput) {
+  const int kNumClients = 8;
+  const int kPacketsPerClient = 2000;
+  const int kBurstSize = 8;
+  const size_t kPacketSize = 1000;
+  const char kPayload[kPacketSize] = {0};
+
+  for (int num_shards : {1, 4}) {
+    CreateServer(num_shards);
+    std::vector<std::unique_ptr<TestTurnClient>> clients;
+    std::vector<std::unique_ptr<rtc::AsyncPacketSocket>> peers;
+    PacketCounter received;
+    for (int i = 0; i < kNumClients; ++i) {
+      clients.emplace_back(new TestTurnClient(&pss_, server_addr_));
+      peers.emplace_back(
+          rtc::AsyncUDPSocket::Create(&pss_, rtc::SocketAddress(kLocalIp, 0)));
+      received.Watch(peers.back().get());
+      ASSERT_TRUE(clients.back()->Allocate());
+      ASSERT_TRUE(clients.back()->BindChannel(peers.back()->GetLocalAddress()));
+    }
+
+    const int64_t start_ms = rtc::TimeMillis();
+    for (int sent = 0; sent < kPacketsPerClient; sent += kBurstSize) {
+      for (const auto& client : clients) {
+        for (int i = 0; i < kBurstSize; ++i)
+          client->SendChannelData(kPayload, kPacketSize);
+      }
+      rtc::Thread::Current()->ProcessMessages(0);
+    }
+    // Loopback may drop packets under load, so wait until no more arrive.
+    int last_count = -1;
+    while (received.count() != last_count &&
+           received.count() < kNumClients * kPacketsPerClient) {
+      last_count = received.count();
+      rtc::Thread::Current()->ProcessMessages(100);
+    }
+    ASSERT_GT(received.count(), 0);
+    const int64_t elapsed_ms =
+        std::max<int64_t>(1, received.last_packet_ms() - start_ms);
+    webrtc::test::PrintResult(
+        "turn_relay_throughput", "", "shards_" + std::to_string(num_shards),
+        received.count() * 1000 / elapsed_ms, "packets/s", false);
+  }
+}
+
+}  // namespace cricket
@@ -0,0 +1,221 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/p2p/base/sharedudpsocket.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "webrtc/base/byteorder.h"
+#include "webrtc/base/checks.h"
+#include "webrtc/base/logging.h"
+#include "webrtc/base/timeutils.h"
+#include "webrtc/p2p/base/stun.h"
+
+namespace cricket {
+
+// Stands in for the shared socket for one ICE endpoint.
+class SharedUdpSocket::Endpoint : public rtc::AsyncPacketSocket {
+ public:
+  Endpoint(SharedUdpSocket* owner,
+           const std::string& ufrag,
+           const std::string& password)
+      : owner_(owner), ufrag_(ufrag), password_(password) {}
+  ~Endpoint() override { owner_->RemoveEndpoint(this); }
+
+  const std::string& ufrag() const { return ufrag_; }
+  const std::string& password() const { return password_; }
+  void set_credentials(const std::string& ufrag, const std::string& password) {
+    ufrag_ = ufrag;
+    password_ = password;
+  }
+  // Addresses that are bound to this endpoint.
+  const std::vector<rtc::SocketAddress>& addresses() const {
+    return addresses_;
+  }
+  void AddAddress(const rtc::SocketAddress& addr) {
+    addresses_.push_back(addr);
+  }
+  void RemoveAddress(const rtc::SocketAddress& addr) {
+    auto it = std::find(addresses_.begin(), addresses_.end(), addr);
+    RTC_DCHECK(it != addresses_.end());
+    *it = addresses_.back();
+    addresses_.pop_back();
+  }
+
+  rtc::SocketAddress GetLocalAddress() const override {
+    return owner_->GetLocalAddress();
+  }
+  rtc::SocketAddress GetRemoteAddress() const override {
+    return rtc::SocketAddress();
+  }
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override {
+    // The shared socket is not connected.
+    RTC_NOTREACHED();
+    return -1;
+  }
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override {
+    rtc::SentPacket sent_packet(options.packet_id, rtc::TimeMillis());
+    int ret = owner_->SendTo(this, pv, cb, addr, options);
+    SignalSentPacket(this, sent_packet);
+    return ret;
+  }
+  int Close() override { return 0; }
+  State GetState() const override { return owner_->socket_->GetState(); }
+  // Options apply to the shared socket, so they affect all endpoints.
+  int GetOption(rtc::Socket::Option opt, int* value) override {
+    return owner_->socket_->GetOption(opt, value);
+  }
+  int SetOption(rtc::Socket::Option opt, int value) override {
+    return owner_->socket_->SetOption(opt, value);
+  }
+  int GetError() const override { return owner_->socket_->GetError(); }
+  void SetError(int error) override {}
+
+ private:
+  SharedUdpSocket* const owner_;
+  std::string ufrag_;
+  std::string password_;
+  std::vector<rtc::SocketAddress> addresses_;
+};
+
+SharedUdpSocket::SharedUdpSocket(rtc::AsyncPacketSocket* socket)
+    : socket_(socket) {
+  RTC_DCHECK(socket_->GetState() == rtc::AsyncPacketSocket::STATE_BOUND);
+  socket_->SignalReadPacket.connect(this, &SharedUdpSocket::OnReadPacket);
+  socket_->SignalReadyToSend.connect(this, &SharedUdpSocket::OnReadyToSend);
+}
+
+SharedUdpSocket::~SharedUdpSocket() {
+  RTC_DCHECK(endpoints_by_ufrag_.empty());
+}
+
+rtc::AsyncPacketSocket* SharedUdpSocket::CreateEndpoint(
+    const std::string& ufrag,
+    const std::string& password) {
+  if (endpoints_by_ufrag_.find(ufrag) != endpoints_by_ufrag_.end()) {
+    LOG(LS_WARNING) << "ICE ufrag " << ufrag << " is already in use on "
+                    << GetLocalAddress().ToSensitiveString();
+    return nullptr;
+  }
+  Endpoint* endpoint = new Endpoint(this, ufrag, password);
+  endpoints_by_ufrag_[ufrag] = endpoint;
+  return endpoint;
+}
+
+bool SharedUdpSocket::SetEndpointCredentials(rtc::AsyncPacketSocket* socket,
+                                             const std::string& ufrag,
+                                             const std::string& password) {
+  Endpoint* endpoint = static_cast<Endpoint*>(socket);
+  auto it = endpoints_by_ufrag_.find(endpoint->ufrag());
+  RTC_DCHECK(it != endpoints_by_ufrag_.end() && it->second == endpoint);
+  if (ufrag != endpoint->ufrag()) {
+    if (endpoints_by_ufrag_.find(ufrag) != endpoints_by_ufrag_.end())
+      return false;
+    endpoints_by_ufrag_.erase(it);
+    endpoints_by_ufrag_[ufrag] = endpoint;
+  }
+  endpoint->set_credentials(ufrag, password);
+  return true;
+}
+
+SharedUdpSocket::Endpoint* SharedUdpSocket::FindEndpointForBindingRequest(
+    const char* data,
+    size_t size) const {
+  StunMessageView msg;
+  if (!msg.Parse(data, size) || msg.type() != STUN_BINDING_REQUEST)
+    return nullptr;
+  const char* username;
+  size_t username_length;
+  if (!msg.GetAttribute(STUN_ATTR_USERNAME, &username, &username_length))
+    return nullptr;
+  // The USERNAME of a check is "<receiver's ufrag>:<sender's ufrag>".
+  const char* colon =
+      static_cast<const char*>(memchr(username, ':', username_length));
+  if (!colon)
+    return nullptr;
+  auto it = endpoints_by_ufrag_.find(std::string(username, colon));
+  if (it == endpoints_by_ufrag_.end() ||
+      !msg.ValidateMessageIntegrity(it->second->password())) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void SharedUdpSocket::BindAddress(const rtc::SocketAddress& addr,
+                                  Endpoint* endpoint) {
+  Endpoint*& bound_endpoint = endpoints_by_address_[addr];
+  if (bound_endpoint == endpoint)
+    return;
+  // Each address is listed by the endpoint it is bound to only, so that
+  // addresses moving between endpoints don't pile up.
+  if (bound_endpoint)
+    bound_endpoint->RemoveAddress(addr);
+  bound_endpoint = endpoint;
+  endpoint->AddAddress(addr);
+}
+
+void SharedUdpSocket::RemoveEndpoint(Endpoint* endpoint) {
+  endpoints_by_ufrag_.erase(endpoint->ufrag());
+  for (const rtc::SocketAddress& addr : endpoint->addresses()) {
+    auto it = endpoints_by_address_.find(addr);
+    RTC_DCHECK(it != endpoints_by_address_.end() && it->second == endpoint);
+    endpoints_by_address_.erase(it);
+  }
+}
+
+int SharedUdpSocket::SendTo(Endpoint* endpoint,
+                            const void* data,
+                            size_t size,
+                            const rtc::SocketAddress& addr,
+                            const rtc::PacketOptions& options) {
+  if (endpoints_by_address_.find(addr) == endpoints_by_address_.end())
+    BindAddress(addr, endpoint);
+  return socket_->SendTo(data, size, addr, options);
+}
+
+void SharedUdpSocket::OnReadPacket(rtc::AsyncPacketSocket* socket,
+                                   const char* data,
+                                   size_t size,
+                                   const rtc::SocketAddress& remote_addr,
+                                   const rtc::PacketTime& packet_time) {
+  RTC_DCHECK(socket == socket_.get());
+  Endpoint* endpoint = nullptr;
+  if (size >= kStunHeaderSize && rtc::GetBE16(data) == STUN_BINDING_REQUEST) {
+    // Checks rebind their source address, e.g. after an ICE restart.
+    endpoint = FindEndpointForBindingRequest(data, size);
+    if (endpoint)
+      BindAddress(remote_addr, endpoint);
+  }
+  if (!endpoint) {
+    auto it = endpoints_by_address_.find(remote_addr);
+    if (it != endpoints_by_address_.end())
+      endpoint = it->second;
+  }
+  if (!endpoint) {
+    ++dropped_packets_;
+    return;
+  }
+  endpoint->SignalReadPacket(endpoint, data, size, remote_addr, packet_time);
+}
+
+void SharedUdpSocket::OnReadyToSend(rtc::AsyncPacketSocket* socket) {
+  for (const auto& kv : endpoints_by_ufrag_)
+    kv.second->SignalReadyToSend(kv.second);
+}
+
+}  // namespace cricket
@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_P2P_BASE_SHAREDUDPSOCKET_H_
+#define WEBRTC_P2P_BASE_SHAREDUDPSOCKET_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "webrtc/base/asyncpacketsocket.h"
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/sigslot.h"
+#include "webrtc/base/socketaddress.h"
+
+namespace cricket {
+
+// Lets many ICE endpoints, typically one per peer of a server, share a single
+// UDP socket. Each endpoint is an AsyncPacketSocket that a UDPPort can be
+// created on, identified by the local ICE ufrag and password of its port.
+//
+// Incoming packets are demultiplexed to endpoints as follows:
+// - A STUN binding request goes to the endpoint whose ufrag is the local part
+//   of its USERNAME, if its MESSAGE-INTEGRITY is valid for the endpoint's
+//   password. Its source address is then bound to that endpoint.
+// - Any other packet goes to the endpoint its source address is bound to.
+//   Until then, an address is also bound to the first endpoint that sends to
+//   it, so that responses to the endpoint's own checks come back to it.
+// Packets that match no endpoint are dropped.
+//
+// So a remote address can only be used by one endpoint at a time, which holds
+// as long as clients don't share a socket between transports.
+//
+// Must be used on the thread of the underlying socket.
+class SharedUdpSocket : public sigslot::has_slots<> {
+ public:
+  // Takes ownership of |socket|, which must be bound.
+  explicit SharedUdpSocket(rtc::AsyncPacketSocket* socket);
+  ~SharedUdpSocket() override;
+
+  rtc::SocketAddress GetLocalAddress() const {
+    return socket_->GetLocalAddress();
+  }
+
+  // Creates an endpoint for packets sent to |ufrag|. Returns null if the
+  // ufrag is in use. The endpoint must be deleted before this object.
+  rtc::AsyncPacketSocket* CreateEndpoint(const std::string& ufrag,
+                                         const std::string& password);
+  // Changes the ICE credentials of an endpoint created by CreateEndpoint, as
+  // on an ICE restart. Returns false if |ufrag| is in use by another one.
+  bool SetEndpointCredentials(rtc::AsyncPacketSocket* endpoint,
+                              const std::string& ufrag,
+                              const std::string& password);
+
+  size_t num_endpoints() const { return endpoints_by_ufrag_.size(); }
+  size_t num_bound_addresses() const { return endpoints_by_address_.size(); }
+  // Number of received packets that matched no endpoint.
+  int dropped_packets() const { return dropped_packets_; }
+
+ private:
+  class Endpoint;
+  struct SocketAddressHasher {
+    size_t operator()(const rtc::SocketAddress& addr) const {
+      return addr.Hash();
+    }
+  };
+  typedef std::unordered_map<rtc::SocketAddress, Endpoint*, SocketAddressHasher>
+      EndpointAddressMap;
+
+  // Finds the endpoint a STUN binding request is for, or returns null.
+  Endpoint* FindEndpointForBindingRequest(const char* data, size_t size) const;
+  void BindAddress(const rtc::SocketAddress& addr, Endpoint* endpoint);
+  void RemoveEndpoint(Endpoint* endpoint);
+  int SendTo(Endpoint* endpoint,
+             const void* data,
+             size_t size,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options);
+
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const rtc::PacketTime& packet_time);
+  void OnReadyToSend(rtc::AsyncPacketSocket* socket);
+
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  std::unordered_map<std::string, Endpoint*> endpoints_by_ufrag_;
+  EndpointAddressMap endpoints_by_address_;
+  int dropped_packets_ = 0;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(SharedUdpSocket);
+};
+
+}  // namespace cricket
+
+#endif  // WEBRTC_P2P_BASE_SHAREDUDPSOCKET_H_
@@ -0,0 +1,290 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "webrtc/base/asyncudpsocket.h"
+#include "webrtc/base/bytebuffer.h"
+#include "webrtc/base/gunit.h"
+#include "webrtc/base/helpers.h"
+#include "webrtc/base/physicalsocketserver.h"
+#include "webrtc/base/timeutils.h"
+#include "webrtc/base/virtualsocketserver.h"
+#include "webrtc/p2p/base/sharedudpsocket.h"
+#include "webrtc/p2p/base/stun.h"
+#include "webrtc/test/testsupport/perf_test.h"
+
+namespace cricket {
+
+namespace {
+
+const int kTimeoutMs = 1000;
+const rtc::SocketAddress kServerAddr("11.11.11.11", 3478);
+const rtc::SocketAddress kClientAddr1("22.22.22.22", 0);
+const rtc::SocketAddress kClientAddr2("33.33.33.33", 0);
+const char kUfrag1[] = "UF01";
+const char kUfrag2[] = "UF02";
+const char kPwd1[] = "TESTICEPWD00000000000001";
+const char kPwd2[] = "TESTICEPWD00000000000002";
+const char kRemoteUfrag[] = "RMUF";
+
+std::string MakeBindingRequest(const std::string& local_ufrag,
+                               const std::string& password) {
+  StunMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+  msg.AddAttribute(new StunByteStringAttribute(
+      STUN_ATTR_USERNAME, local_ufrag + ":" + kRemoteUfrag));
+  msg.AddMessageIntegrity(password);
+  msg.AddFingerprint();
+  rtc::ByteBufferWriter buf;
+  msg.Write(&buf);
+  return std::string(buf.Data(), buf.Length());
+}
+
+}  // namespace
+
+class SharedUdpSocketTest : public testing::Test,
+                            public sigslot::has_slots<> {
+ public:
+  SharedUdpSocketTest()
+      : pss_(new rtc::PhysicalSocketServer),
+        vss_(new rtc::VirtualSocketServer(pss_.get())),
+        ss_scope_(vss_.get()),
+        server_socket_(rtc::AsyncUDPSocket::Create(vss_.get(), kServerAddr)),
+        shared_(server_socket_),
+        client1_(rtc::AsyncUDPSocket::Create(vss_.get(), kClientAddr1)),
+        client2_(rtc::AsyncUDPSocket::Create(vss_.get(), kClientAddr2)) {
+    client1_->SignalReadPacket.connect(this,
+                                       &SharedUdpSocketTest::OnReadPacket);
+    client2_->SignalReadPacket.connect(this,
+                                       &SharedUdpSocketTest::OnReadPacket);
+  }
+
+ protected:
+  rtc::AsyncPacketSocket* CreateEndpoint(const std::string& ufrag,
+                                         const std::string& password) {
+    rtc::AsyncPacketSocket* endpoint = shared_.CreateEndpoint(ufrag, password);
+    if (endpoint) {
+      endpoint->SignalReadPacket.connect(
+          this, &SharedUdpSocketTest::OnReadPacket);
+    }
+    return endpoint;
+  }
+
+  void SendFromClient(rtc::AsyncPacketSocket* client, const std::string& data) {
+    client->SendTo(data.data(), data.size(), shared_.GetLocalAddress(),
+                   rtc::PacketOptions());
+  }
+
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const rtc::PacketTime& packet_time) {
+    ++num_received_[socket];
+    last_received_[socket].assign(data, size);
+  }
+
+  size_t num_received(rtc::AsyncPacketSocket* socket) {
+    return num_received_[socket];
+  }
+
+  std::unique_ptr<rtc::PhysicalSocketServer> pss_;
+  std::unique_ptr<rtc::VirtualSocketServer> vss_;
+  rtc::SocketServerScope ss_scope_;
+  // Owned by |shared_|.
+  rtc::AsyncPacketSocket* server_socket_;
+  SharedUdpSocket shared_;
+  std::unique_ptr<rtc::AsyncPacketSocket> client1_;
+  std::unique_ptr<rtc::AsyncPacketSocket> client2_;
+  std::map<rtc::AsyncPacketSocket*, size_t> num_received_;
+  std::map<rtc::AsyncPacketSocket*, std::string> last_received_;
+};
+
+// Binding requests are routed by the local ufrag in their USERNAME, and bind
+// their source address for the packets that follow, such as DTLS or SRTP.
+TEST_F(SharedUdpSocketTest, RoutesBindingRequestsByUfrag) {
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint1(
+      CreateEndpoint(kUfrag1, kPwd1));
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint2(
+      CreateEndpoint(kUfrag2, kPwd2));
+  EXPECT_EQ(2u, shared_.num_endpoints());
+  EXPECT_EQ(kServerAddr, endpoint1->GetLocalAddress());
+
+  SendFromClient(client1_.get(), MakeBindingRequest(kUfrag2, kPwd2));
+  EXPECT_EQ_WAIT(1u, num_received(endpoint2.get()), kTimeoutMs);
+  SendFromClient(client2_.get(), MakeBindingRequest(kUfrag1, kPwd1));
+  EXPECT_EQ_WAIT(1u, num_received(endpoint1.get()), kTimeoutMs);
+  EXPECT_EQ(2u, shared_.num_bound_addresses());
+
+  SendFromClient(client1_.get(), "media");
+  EXPECT_EQ_WAIT(2u, num_received(endpoint2.get()), kTimeoutMs);
+  EXPECT_EQ("media", last_received_[endpoint2.get()]);
+  EXPECT_EQ(1u, num_received(endpoint1.get()));
+  EXPECT_EQ(0, shared_.dropped_packets());
+}
+
+TEST_F(SharedUdpSocketTest, DropsPacketsThatMatchNoEndpoint) {
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint1(
+      CreateEndpoint(kUfrag1, kPwd1));
+  // Wrong password, unknown ufrag, and no bound address.
+  SendFromClient(client1_.get(), MakeBindingRequest(kUfrag1, kPwd2));
+  SendFromClient(client1_.get(), MakeBindingRequest(kUfrag2, kPwd2));
+  SendFromClient(client1_.get(), "media");
+  EXPECT_EQ_WAIT(3, shared_.dropped_packets(), kTimeoutMs);
+  EXPECT_EQ(0u, num_received(endpoint1.get()));
+  EXPECT_EQ(0u, shared_.num_bound_addresses());
+}
+
+// Responses to an endpoint's own checks come back to it.
+TEST_F(SharedUdpSocketTest, SendingBindsAddress) {
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint1(
+      CreateEndpoint(kUfrag1, kPwd1));
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint2(
+      CreateEndpoint(kUfrag2, kPwd2));
+  const std::string request = "request";
+  endpoint2->SendTo(request.data(), request.size(),
+                    client1_->GetLocalAddress(), rtc::PacketOptions());
+  EXPECT_EQ_WAIT(1u, num_received(client1_.get()), kTimeoutMs);
+
+  SendFromClient(client1_.get(), "response");
+  EXPECT_EQ_WAIT(1u, num_received(endpoint2.get()), kTimeoutMs);
+  EXPECT_EQ(0u, num_received(endpoint1.get()));
+
+  // A valid check moves the address to another endpoint.
+  SendFromClient(client1_.get(), MakeBindingRequest(kUfrag1, kPwd1));
+  SendFromClient(client1_.get(), "media");
+  EXPECT_EQ_WAIT(2u, num_received(endpoint1.get()), kTimeoutMs);
+  EXPECT_EQ(1u, num_received(endpoint2.get()));
+}
+
+TEST_F(SharedUdpSocketTest, DeletingEndpointUnbindsAddresses) {
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint1(
+      CreateEndpoint(kUfrag1, kPwd1));
+  SendFromClient(client1_.get(), MakeBindingRequest(kUfrag1, kPwd1));
+  EXPECT_EQ_WAIT(1u, num_received(endpoint1.get()), kTimeoutMs);
+  EXPECT_EQ(1u, shared_.num_bound_addresses());
+
+  endpoint1.reset();
+  EXPECT_EQ(0u, shared_.num_endpoints());
+  EXPECT_EQ(0u, shared_.num_bound_addresses());
+  SendFromClient(client1_.get(), "media");
+  EXPECT_EQ_WAIT(1, shared_.dropped_packets(), kTimeoutMs);
+
+  // The ufrag can be used again.
+  endpoint1.reset(CreateEndpoint(kUfrag1, kPwd1));
+  EXPECT_TRUE(endpoint1);
+}
+
+// An address that moves between endpoints stays bound to the last one only.
+TEST_F(SharedUdpSocketTest, AddressMovesBetweenEndpoints) {
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint1(
+      CreateEndpoint(kUfrag1, kPwd1));
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint2(
+      CreateEndpoint(kUfrag2, kPwd2));
+  const std::string request1 = MakeBindingRequest(kUfrag1, kPwd1);
+  const std::string request2 = MakeBindingRequest(kUfrag2, kPwd2);
+  rtc::PacketTime packet_time;
+  for (int i = 0; i < 100; ++i) {
+    server_socket_->SignalReadPacket(server_socket_, request1.data(),
+                                     request1.size(), kClientAddr1,
+                                     packet_time);
+    server_socket_->SignalReadPacket(server_socket_, request2.data(),
+                                     request2.size(), kClientAddr1,
+                                     packet_time);
+  }
+  EXPECT_EQ(1u, shared_.num_bound_addresses());
+
+  // Deleting the endpoint the address was bound to before leaves it bound.
+  endpoint1.reset();
+  EXPECT_EQ(1u, shared_.num_bound_addresses());
+  server_socket_->SignalReadPacket(server_socket_, "media", 5, kClientAddr1,
+                                   packet_time);
+  EXPECT_EQ(101u, num_received(endpoint2.get()));
+
+  endpoint2.reset();
+  EXPECT_EQ(0u, shared_.num_bound_addresses());
+  EXPECT_EQ(0, shared_.dropped_packets());
+}
+
+TEST_F(SharedUdpSocketTest, UfragsAreUnique) {
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint1(
+      CreateEndpoint(kUfrag1, kPwd1));
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint2(
+      CreateEndpoint(kUfrag2, kPwd2));
+  EXPECT_FALSE(CreateEndpoint(kUfrag1, kPwd2));
+  EXPECT_FALSE(shared_.SetEndpointCredentials(endpoint2.get(), kUfrag1, kPwd2));
+}
+
+// After an ICE restart, checks are routed by the new credentials.
+TEST_F(SharedUdpSocketTest, SetEndpointCredentials) {
+  std::unique_ptr<rtc::AsyncPacketSocket> endpoint1(
+      CreateEndpoint(kUfrag1, kPwd1));
+  EXPECT_TRUE(shared_.SetEndpointCredentials(endpoint1.get(), kUfrag2, kPwd2));
+  SendFromClient(client1_.get(), MakeBindingRequest(kUfrag1, kPwd1));
+  EXPECT_EQ_WAIT(1, shared_.dropped_packets(), kTimeoutMs);
+  SendFromClient(client1_.get(), MakeBindingRequest(kUfrag2, kPwd2));
+  EXPECT_EQ_WAIT(1u, num_received(endpoint1.get()), kTimeoutMs);
+}
+
+// Measures the demultiplexing cost with many endpoints, for checks, which are
+// authenticated, and for the packets that follow them. Packets are injected
+// into the underlying socket so that only the demultiplexing is measured.
+TEST_F(SharedUdpSocketTest, DemuxThroughput) {
+  const int kNumEndpoints = 1000;
+  const int kNumPackets = 100000;
+  std::vector<std::unique_ptr<rtc::AsyncPacketSocket>> endpoints;
+  std::vector<std::string> requests;
+  std::vector<rtc::SocketAddress> addrs;
+  for (int i = 0; i < kNumEndpoints; ++i) {
+    std::string ufrag = "UF" + std::to_string(i);
+    endpoints.emplace_back(CreateEndpoint(ufrag, kPwd1));
+    requests.push_back(MakeBindingRequest(ufrag, kPwd1));
+    addrs.push_back(rtc::SocketAddress("22.22.22.22", 1000 + i));
+  }
+  const std::string media(1200, 'm');
+  rtc::PacketTime packet_time;
+
+  int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumPackets; ++i) {
+    const std::string& request = requests[i % kNumEndpoints];
+    server_socket_->SignalReadPacket(server_socket_, request.data(),
+                                     request.size(), addrs[i % kNumEndpoints],
+                                     packet_time);
+  }
+  int64_t checks_us = rtc::TimeMicros() - start_us;
+
+  start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumPackets; ++i) {
+    server_socket_->SignalReadPacket(server_socket_, media.data(),
+                                     media.size(), addrs[i % kNumEndpoints],
+                                     packet_time);
+  }
+  int64_t media_us = rtc::TimeMicros() - start_us;
+
+  EXPECT_EQ(0, shared_.dropped_packets());
+  for (const auto& endpoint : endpoints)
+    EXPECT_EQ(2u * kNumPackets / kNumEndpoints, num_received(endpoint.get()));
+  webrtc::test::PrintResult(
+      "shared_udp_demux", "", "binding_requests",
+      kNumPackets * rtc::kNumMicrosecsPerSec / std::max<int64_t>(checks_us, 1),
+      "packets/s", false);
+  webrtc::test::PrintResult(
+      "shared_udp_demux", "", "bound_addresses",
+      kNumPackets * rtc::kNumMicrosecsPerSec / std::max<int64_t>(media_us, 1),
+      "packets/s", false);
+}
+
+}  // namespace cricket
@@ -19,6 +19,7 @@
 #include "webrtc/base/crc32.h"
 #include "webrtc/base/logging.h"
 #include "webrtc/base/messagedigest.h"
+#include "webrtc/base/sha1digest.h"
 #include "webrtc/base/stringencode.h"
 
 using rtc::ByteBufferReader;
@@ -42,6 +43,83 @@ const char TURN_MAGIC_COOKIE_VALUE[] = { '\x72', '\xC6', '\x4B', '\xC6' };
 const char EMPTY_TRANSACTION_ID[] = "0000000000000000";
 const uint32_t STUN_FINGERPRINT_XOR_VALUE = 0x5354554E;
 
+namespace {
+
+const size_t kHmacSha1BlockSize = 64;
+
+// Computes the MESSAGE-INTEGRITY value of the message in |data|, whose
+// MESSAGE-INTEGRITY attribute starts at |mi_pos|. The HMAC covers the message
+// up to that attribute, with the length in the header adjusted to end right
+// after it (RFC 5389, section 15.4). This is rtc::ComputeHmac on the stack,
+// fed the adjusted header separately so that the message needn't be copied.
+void ComputeStunHmac(const char* key,
+                     size_t key_len,
+                     const char* data,
+                     size_t mi_pos,
+                     char hmac[kStunMessageIntegritySize]) {
+  uint8_t key_block[kHmacSha1BlockSize] = {0};
+  if (key_len > kHmacSha1BlockSize) {
+    rtc::Sha1Digest key_digest;
+    key_digest.Update(key, key_len);
+    key_digest.Finish(key_block, rtc::Sha1Digest::kSize);
+  } else {
+    memcpy(key_block, key, key_len);
+  }
+  uint8_t pad[kHmacSha1BlockSize];
+
+  // The message type, followed by the adjusted length.
+  char header[2 * sizeof(uint16_t)];
+  memcpy(header, data, sizeof(uint16_t));
+  rtc::SetBE16(header + sizeof(uint16_t),
+               static_cast<uint16_t>(mi_pos - kStunHeaderSize +
+                                     kStunAttributeHeaderSize +
+                                     kStunMessageIntegritySize));
+  rtc::Sha1Digest inner;
+  for (size_t i = 0; i < kHmacSha1BlockSize; ++i)
+    pad[i] = key_block[i] ^ 0x36;
+  inner.Update(pad, sizeof(pad));
+  inner.Update(header, sizeof(header));
+  inner.Update(data + sizeof(header), mi_pos - sizeof(header));
+  uint8_t inner_hash[rtc::Sha1Digest::kSize];
+  inner.Finish(inner_hash, sizeof(inner_hash));
+
+  rtc::Sha1Digest outer;
+  for (size_t i = 0; i < kHmacSha1BlockSize; ++i)
+    pad[i] = key_block[i] ^ 0x5c;
+  outer.Update(pad, sizeof(pad));
+  outer.Update(inner_hash, sizeof(inner_hash));
+  outer.Finish(hmac, kStunMessageIntegritySize);
+}
+
+// Decodes the value of an address attribute, as StunAddressAttribute::Read.
+bool ReadStunAddress(const char* value,
+                     size_t length,
+                     rtc::SocketAddress* addr) {
+  if (length < 4)
+    return false;
+  uint8_t stun_family = static_cast<uint8_t>(value[1]);
+  uint16_t port = rtc::GetBE16(value + 2);
+  if (stun_family == STUN_ADDRESS_IPV4) {
+    in_addr v4addr;
+    if (length != 4 + sizeof(v4addr))
+      return false;
+    memcpy(&v4addr, value + 4, sizeof(v4addr));
+    addr->SetIP(rtc::IPAddress(v4addr));
+  } else if (stun_family == STUN_ADDRESS_IPV6) {
+    in6_addr v6addr;
+    if (length != 4 + sizeof(v6addr))
+      return false;
+    memcpy(&v6addr, value + 4, sizeof(v6addr));
+    addr->SetIP(rtc::IPAddress(v6addr));
+  } else {
+    return false;
+  }
+  addr->SetPort(port);
+  return true;
+}
+
+}  // namespace
+
 // StunMessage
 
 StunMessage::StunMessage()
@@ -171,34 +249,8 @@ bool StunMessage::ValidateMessageIntegrity(const char* data, size_t size,
     return false;
   }
 
-  // Getting length of the message to calculate Message Integrity.
-  size_t mi_pos = current_pos;
-  std::unique_ptr<char[]> temp_data(new char[current_pos]);
-  memcpy(temp_data.get(), data, current_pos);
-  if (size > mi_pos + kStunAttributeHeaderSize + kStunMessageIntegritySize) {
-    // Stun message has other attributes after message integrity.
-    // Adjust the length parameter in stun message to calculate HMAC.
-    size_t extra_offset = size -
-        (mi_pos + kStunAttributeHeaderSize + kStunMessageIntegritySize);
-    size_t new_adjusted_len = size - extra_offset - kStunHeaderSize;
-
-    // Writing new length of the STUN message @ Message Length in temp buffer.
-    //      0                   1                   2                   3
-    //      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    //     |0 0|     STUN Message Type     |         Message Length        |
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    rtc::SetBE16(temp_data.get() + 2, static_cast<uint16_t>(new_adjusted_len));
-  }
-
   char hmac[kStunMessageIntegritySize];
-  size_t ret = rtc::ComputeHmac(rtc::DIGEST_SHA_1,
-                                      password.c_str(), password.size(),
-                                      temp_data.get(), mi_pos,
-                                      hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac))
-    return false;
+  ComputeStunHmac(password.c_str(), password.size(), data, current_pos, hmac);
 
   // Comparing the calculated HMAC with the one present in the message.
   return memcmp(data + current_pos + kStunAttributeHeaderSize,
@@ -224,19 +276,10 @@ bool StunMessage::AddMessageIntegrity(const char* key,
   if (!Write(&buf))
     return false;
 
-  int msg_len_for_hmac = static_cast<int>(
-      buf.Length() - kStunAttributeHeaderSize - msg_integrity_attr->length());
+  size_t msg_len_for_hmac =
+      buf.Length() - kStunAttributeHeaderSize - msg_integrity_attr->length();
   char hmac[kStunMessageIntegritySize];
-  size_t ret = rtc::ComputeHmac(rtc::DIGEST_SHA_1,
-                                      key, keylen,
-                                      buf.Data(), msg_len_for_hmac,
-                                      hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac)) {
-    LOG(LS_ERROR) << "HMAC computation failed. Message-Integrity "
-                  << "has dummy value.";
-    return false;
-  }
+  ComputeStunHmac(key, keylen, buf.Data(), msg_len_for_hmac, hmac);
 
   // Insert correct HMAC into the attribute.
   msg_integrity_attr->CopyBytes(hmac, sizeof(hmac));
@@ -414,6 +457,155 @@ bool StunMessage::IsValidTransactionId(const std::string& transaction_id) {
       transaction_id.size() == kStunLegacyTransactionIdLength;
 }
 
+// StunMessageView
+
+StunMessageView::StunMessageView()
+    : data_(nullptr),
+      size_(0),
+      type_(0),
+      integrity_offset_(0),
+      fingerprint_offset_(0) {}
+
+bool StunMessageView::Parse(const char* data, size_t size) {
+  data_ = nullptr;
+  size_ = 0;
+  integrity_offset_ = 0;
+  fingerprint_offset_ = 0;
+  if (size < kStunHeaderSize)
+    return false;
+  uint16_t type = rtc::GetBE16(data);
+  // RTP and RTCP set the MSB of the first byte, see StunMessage::Read.
+  if (type & 0x8000)
+    return false;
+  if (rtc::GetBE16(data + 2) != size - kStunHeaderSize)
+    return false;
+
+  size_t pos = kStunHeaderSize;
+  while (pos < size) {
+    if (size - pos < kStunAttributeHeaderSize)
+      return false;
+    uint16_t attr_type = rtc::GetBE16(data + pos);
+    size_t attr_length = rtc::GetBE16(data + pos + 2);
+    if (size - pos - kStunAttributeHeaderSize < attr_length)
+      return false;
+    if (attr_type == STUN_ATTR_MESSAGE_INTEGRITY && integrity_offset_ == 0)
+      integrity_offset_ = pos;
+    if (attr_type == STUN_ATTR_FINGERPRINT && fingerprint_offset_ == 0)
+      fingerprint_offset_ = pos;
+    // Like StunMessage::Read, accept a last attribute without its padding.
+    pos += kStunAttributeHeaderSize + ((attr_length + 3) & ~3);
+  }
+
+  data_ = data;
+  size_ = size;
+  type_ = type;
+  return true;
+}
+
+bool StunMessageView::IsLegacy() const {
+  RTC_DCHECK(data_);
+  return rtc::GetBE32(data_ + kStunTransactionIdOffset -
+                      kStunMagicCookieLength) != kStunMagicCookie;
+}
+
+const char* StunMessageView::transaction_id() const {
+  return data_ + kStunHeaderSize - transaction_id_length();
+}
+
+size_t StunMessageView::transaction_id_length() const {
+  return IsLegacy() ? kStunLegacyTransactionIdLength
+                    : kStunTransactionIdLength;
+}
+
+bool StunMessageView::GetAttribute(int type,
+                                   const char** value,
+                                   size_t* length) const {
+  RTC_DCHECK(data_);
+  size_t pos = kStunHeaderSize;
+  while (pos < size_) {
+    size_t attr_length = rtc::GetBE16(data_ + pos + 2);
+    if (rtc::GetBE16(data_ + pos) == type) {
+      *value = data_ + pos + kStunAttributeHeaderSize;
+      *length = attr_length;
+      return true;
+    }
+    pos += kStunAttributeHeaderSize + ((attr_length + 3) & ~3);
+  }
+  return false;
+}
+
+bool StunMessageView::GetUInt32(int type, uint32_t* value) const {
+  const char* attr;
+  size_t length;
+  if (!GetAttribute(type, &attr, &length) ||
+      length != StunUInt32Attribute::SIZE) {
+    return false;
+  }
+  *value = rtc::GetBE32(attr);
+  return true;
+}
+
+bool StunMessageView::GetAddress(int type, rtc::SocketAddress* addr) const {
+  const char* value;
+  size_t length;
+  return GetAttribute(type, &value, &length) &&
+         ReadStunAddress(value, length, addr);
+}
+
+bool StunMessageView::GetXorAddress(int type, rtc::SocketAddress* addr) const {
+  if (!GetAddress(type, addr))
+    return false;
+  addr->SetPort(addr->port() ^ (kStunMagicCookie >> 16));
+  const rtc::IPAddress& ip = addr->ipaddr();
+  if (ip.family() == AF_INET) {
+    in_addr v4addr = ip.ipv4_address();
+    v4addr.s_addr ^= rtc::HostToNetwork32(kStunMagicCookie);
+    addr->SetIP(rtc::IPAddress(v4addr));
+    return true;
+  }
+  // IPv6 addresses are also XORed with the transaction ID, which must not be
+  // a legacy one. StunXorAddressAttribute leaves the IP unset in that case.
+  if (IsLegacy())
+    return false;
+  in6_addr v6addr = ip.ipv6_address();
+  uint8_t* bytes = v6addr.s6_addr;
+  const char* cookie =
+      data_ + kStunTransactionIdOffset - kStunMagicCookieLength;
+  for (size_t i = 0; i < kStunMagicCookieLength + kStunTransactionIdLength;
+       ++i) {
+    bytes[i] ^= static_cast<uint8_t>(cookie[i]);
+  }
+  addr->SetIP(rtc::IPAddress(v6addr));
+  return true;
+}
+
+bool StunMessageView::ValidateMessageIntegrity(
+    const std::string& password) const {
+  RTC_DCHECK(data_);
+  // The size check is the same as in the static version.
+  if (integrity_offset_ == 0 || (size_ % 4) != 0 ||
+      rtc::GetBE16(data_ + integrity_offset_ + 2) !=
+          kStunMessageIntegritySize) {
+    return false;
+  }
+  char hmac[kStunMessageIntegritySize];
+  ComputeStunHmac(password.c_str(), password.size(), data_, integrity_offset_,
+                  hmac);
+  return memcmp(data_ + integrity_offset_ + kStunAttributeHeaderSize, hmac,
+                sizeof(hmac)) == 0;
+}
+
+bool StunMessageView::CheckFingerprint() const {
+  RTC_DCHECK(data_);
+  if (fingerprint_offset_ == 0)
+    return true;
+  // The static version only looks at the last attribute.
+  return fingerprint_offset_ + kStunAttributeHeaderSize +
+                 StunUInt32Attribute::SIZE ==
+             size_ &&
+         StunMessage::ValidateFingerprint(data_, size_);
+}
+
 // StunAttribute
 
 StunAttribute::StunAttribute(uint16_t type, uint16_t length)
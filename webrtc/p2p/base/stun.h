@@ -202,6 +202,55 @@ class StunMessage {
   std::vector<StunAttribute*>* attrs_;
 };
 
+// A read-only view of a STUN message in a buffer owned by the caller, which
+// must outlive the view. Unlike StunMessage::Read, Parse allocates nothing: it
+// only checks the framing of the header and attributes, and attribute values
+// are decoded when asked for. Used on the per-packet paths (send and data
+// indications), where a StunMessage would allocate an object per attribute.
+class StunMessageView {
+ public:
+  StunMessageView();
+
+  // Returns false if |data| is not a STUN message, or its attributes don't
+  // add up to its length.
+  bool Parse(const char* data, size_t size);
+
+  int type() const { return type_; }
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Same as StunMessage::IsLegacy.
+  bool IsLegacy() const;
+  // The transaction ID is 16 bytes long for legacy messages, 12 otherwise.
+  const char* transaction_id() const;
+  size_t transaction_id_length() const;
+
+  // Finds the first attribute of |type|, and returns false if there is none
+  // or its value is malformed. The address getters decode the same values as
+  // StunAddressAttribute and StunXorAddressAttribute.
+  bool GetAttribute(int type, const char** value, size_t* length) const;
+  bool GetUInt32(int type, uint32_t* value) const;
+  bool GetAddress(int type, rtc::SocketAddress* addr) const;
+  bool GetXorAddress(int type, rtc::SocketAddress* addr) const;
+
+  // Same as StunMessage::ValidateMessageIntegrity, for the parsed message.
+  bool ValidateMessageIntegrity(const std::string& password) const;
+  // Returns false if the message has a FINGERPRINT attribute which isn't its
+  // last attribute or doesn't match its bytes. Unlike
+  // StunMessage::ValidateFingerprint, a message without one passes, since the
+  // attribute is optional.
+  bool CheckFingerprint() const;
+
+ private:
+  const char* data_;
+  size_t size_;
+  uint16_t type_;
+  // Offsets of the first MESSAGE-INTEGRITY and FINGERPRINT attributes, or 0 if
+  // there are none.
+  size_t integrity_offset_;
+  size_t fingerprint_offset_;
+};
+
 // Base class for all STUN/TURN attributes.
 class StunAttribute {
  public:
@@ -8,7 +8,9 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <algorithm>
 #include <string>
+#include <utility>
 
 #include "webrtc/p2p/base/stun.h"
 #include "webrtc/base/arraysize.h"
@@ -17,6 +19,8 @@
 #include "webrtc/base/logging.h"
 #include "webrtc/base/messagedigest.h"
 #include "webrtc/base/socketaddress.h"
+#include "webrtc/base/timeutils.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 namespace cricket {
 
@@ -1484,4 +1488,232 @@ TEST_F(StunTest, ReadRelayMessage) {
   EXPECT_EQ(0, memcmp(outstring2.c_str(), input, len2));
 }
 
+// Check that StunMessageView reads the same values as StunMessage.
+TEST_F(StunTest, ViewRfc5769ResponseMessage) {
+  for (const auto& testcase :
+       {std::make_pair(kRfc5769SampleResponse,
+                       sizeof(kRfc5769SampleResponse)),
+        std::make_pair(kRfc5769SampleResponseIPv6,
+                       sizeof(kRfc5769SampleResponseIPv6))}) {
+    const char* data = reinterpret_cast<const char*>(testcase.first);
+    StunMessage msg;
+    rtc::ByteBufferReader buf(data, testcase.second);
+    ASSERT_TRUE(msg.Read(&buf));
+
+    StunMessageView view;
+    ASSERT_TRUE(view.Parse(data, testcase.second));
+    EXPECT_EQ(msg.type(), view.type());
+    EXPECT_FALSE(view.IsLegacy());
+    EXPECT_EQ(msg.transaction_id(),
+              std::string(view.transaction_id(),
+                          view.transaction_id_length()));
+
+    const char* software;
+    size_t software_length;
+    ASSERT_TRUE(
+        view.GetAttribute(STUN_ATTR_SOFTWARE, &software, &software_length));
+    EXPECT_EQ(kRfc5769SampleMsgServerSoftware,
+              std::string(software, software_length));
+
+    rtc::SocketAddress mapped_address;
+    ASSERT_TRUE(
+        view.GetXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, &mapped_address));
+    EXPECT_EQ(msg.GetAddress(STUN_ATTR_XOR_MAPPED_ADDRESS)->GetAddress(),
+              mapped_address);
+
+    uint32_t fingerprint;
+    ASSERT_TRUE(view.GetUInt32(STUN_ATTR_FINGERPRINT, &fingerprint));
+    EXPECT_EQ(msg.GetUInt32(STUN_ATTR_FINGERPRINT)->value(), fingerprint);
+    EXPECT_FALSE(view.GetUInt32(STUN_ATTR_USERNAME, &fingerprint));
+
+    EXPECT_TRUE(view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+    EXPECT_FALSE(view.ValidateMessageIntegrity("InvalidPassword"));
+  }
+}
+
+TEST_F(StunTest, ViewLegacyMessage) {
+  unsigned char rfc3489_packet[sizeof(kStunMessageWithIPv4MappedAddress)];
+  memcpy(rfc3489_packet, kStunMessageWithIPv4MappedAddress,
+      sizeof(kStunMessageWithIPv4MappedAddress));
+  memcpy(&rfc3489_packet[4], "ABCD", 4);
+
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(rfc3489_packet),
+                         sizeof(rfc3489_packet)));
+  EXPECT_TRUE(view.IsLegacy());
+  ASSERT_EQ(kStunLegacyTransactionIdLength, view.transaction_id_length());
+  EXPECT_EQ(0, memcmp(&rfc3489_packet[4], view.transaction_id(),
+                      kStunLegacyTransactionIdLength));
+  rtc::SocketAddress addr;
+  ASSERT_TRUE(view.GetAddress(STUN_ATTR_MAPPED_ADDRESS, &addr));
+  EXPECT_EQ(rtc::SocketAddress(rtc::IPAddress(kIPv4TestAddress1),
+                               kTestMessagePort4),
+            addr);
+}
+
+TEST_F(StunTest, ViewSendIndication) {
+  TurnMessage msg;
+  msg.SetType(TURN_SEND_INDICATION);
+  msg.SetTransactionID("0123456789ab");
+  const rtc::SocketAddress peer(rtc::IPAddress(kIPv6TestAddress1),
+                                kTestMessagePort1);
+  msg.AddAttribute(
+      new StunXorAddressAttribute(STUN_ATTR_XOR_PEER_ADDRESS, peer));
+  msg.AddAttribute(new StunByteStringAttribute(STUN_ATTR_DATA, "abcdefg"));
+  rtc::ByteBufferWriter out;
+  ASSERT_TRUE(msg.Write(&out));
+
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(out.Data(), out.Length()));
+  EXPECT_EQ(TURN_SEND_INDICATION, view.type());
+  rtc::SocketAddress addr;
+  ASSERT_TRUE(view.GetXorAddress(STUN_ATTR_XOR_PEER_ADDRESS, &addr));
+  EXPECT_EQ(peer, addr);
+  const char* data;
+  size_t size;
+  ASSERT_TRUE(view.GetAttribute(STUN_ATTR_DATA, &data, &size));
+  EXPECT_EQ("abcdefg", std::string(data, size));
+  EXPECT_FALSE(view.GetAttribute(STUN_ATTR_USERNAME, &data, &size));
+  EXPECT_FALSE(view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+}
+
+TEST_F(StunTest, FailToViewInvalidMessages) {
+  StunMessageView view;
+  EXPECT_FALSE(view.Parse(
+      reinterpret_cast<const char*>(kStunMessageWithZeroLength),
+      sizeof(kStunMessageWithZeroLength)));
+  EXPECT_FALSE(view.Parse(
+      reinterpret_cast<const char*>(kStunMessageWithExcessLength),
+      sizeof(kStunMessageWithExcessLength)));
+  EXPECT_FALSE(view.Parse(
+      reinterpret_cast<const char*>(kStunMessageWithSmallLength),
+      sizeof(kStunMessageWithSmallLength)));
+  EXPECT_FALSE(view.Parse(reinterpret_cast<const char*>(kRtcpPacket),
+                          sizeof(kRtcpPacket)));
+  // An attribute that runs past the end of the message.
+  unsigned char truncated[sizeof(kRfc5769SampleResponse)];
+  memcpy(truncated, kRfc5769SampleResponse, sizeof(truncated));
+  rtc::SetBE16(&truncated[kStunHeaderSize + 2], 0x100);
+  EXPECT_FALSE(view.Parse(reinterpret_cast<const char*>(truncated),
+                          sizeof(truncated)));
+}
+
+TEST_F(StunTest, ViewValidatesLongTermAuthMessageIntegrity) {
+  std::string key;
+  ComputeStunCredentialHash(kRfc5769SampleMsgWithAuthUsername,
+      kRfc5769SampleMsgWithAuthRealm, kRfc5769SampleMsgWithAuthPassword, &key);
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(
+      reinterpret_cast<const char*>(kRfc5769SampleRequestLongTermAuth),
+      sizeof(kRfc5769SampleRequestLongTermAuth)));
+  EXPECT_TRUE(view.ValidateMessageIntegrity(key));
+  EXPECT_FALSE(view.ValidateMessageIntegrity("InvalidPassword"));
+
+  // A password longer than the HMAC block size is hashed first.
+  const std::string long_password(100, 'x');
+  TurnMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID("0123456789ab");
+  msg.AddAttribute(new StunByteStringAttribute(STUN_ATTR_USERNAME, "user"));
+  ASSERT_TRUE(msg.AddMessageIntegrity(long_password));
+  ASSERT_TRUE(msg.AddFingerprint());
+  rtc::ByteBufferWriter out;
+  ASSERT_TRUE(msg.Write(&out));
+  ASSERT_TRUE(view.Parse(out.Data(), out.Length()));
+  EXPECT_TRUE(view.ValidateMessageIntegrity(long_password));
+  EXPECT_TRUE(StunMessage::ValidateMessageIntegrity(out.Data(), out.Length(),
+                                                    long_password));
+  // Check against the generic HMAC as well.
+  char hmac[kStunMessageIntegritySize];
+  const size_t mi_pos = kStunHeaderSize + kStunAttributeHeaderSize + 4;
+  std::string adjusted(out.Data(), mi_pos);
+  rtc::SetBE16(&adjusted[2], static_cast<uint16_t>(
+      mi_pos - kStunHeaderSize + kStunAttributeHeaderSize +
+      kStunMessageIntegritySize));
+  ASSERT_EQ(sizeof(hmac),
+            rtc::ComputeHmac(rtc::DIGEST_SHA_1, long_password.data(),
+                             long_password.size(), adjusted.data(),
+                             adjusted.size(), hmac, sizeof(hmac)));
+  EXPECT_EQ(0, memcmp(out.Data() + mi_pos + kStunAttributeHeaderSize, hmac,
+                      sizeof(hmac)));
+}
+
+TEST_F(StunTest, ViewChecksFingerprint) {
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequest),
+                         sizeof(kRfc5769SampleRequest)));
+  EXPECT_TRUE(view.CheckFingerprint());
+
+  char buf[sizeof(kRfc5769SampleRequest)];
+  memcpy(buf, kRfc5769SampleRequest, sizeof(kRfc5769SampleRequest));
+  buf[kStunHeaderSize + kStunAttributeHeaderSize] ^= 0x01;
+  ASSERT_TRUE(view.Parse(buf, sizeof(buf)));
+  EXPECT_FALSE(view.CheckFingerprint());
+
+  // FINGERPRINT is optional, but must be the last attribute.
+  TurnMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID("0123456789ab");
+  rtc::ByteBufferWriter out;
+  ASSERT_TRUE(msg.Write(&out));
+  ASSERT_TRUE(view.Parse(out.Data(), out.Length()));
+  EXPECT_TRUE(view.CheckFingerprint());
+
+  ASSERT_TRUE(msg.AddFingerprint());
+  msg.AddAttribute(new StunByteStringAttribute(STUN_ATTR_USERNAME, "user"));
+  out.Clear();
+  ASSERT_TRUE(msg.Write(&out));
+  ASSERT_TRUE(view.Parse(out.Data(), out.Length()));
+  EXPECT_FALSE(view.CheckFingerprint());
+}
+
+// Compares the rate at which a send indication can be read and its relayed
+// data found, with StunMessage and with StunMessageView.
+TEST_F(StunTest, ReadSendIndicationThroughput) {
+  const int kIterations = 200000;
+  TurnMessage msg;
+  msg.SetType(TURN_SEND_INDICATION);
+  msg.SetTransactionID("0123456789ab");
+  msg.AddAttribute(new StunXorAddressAttribute(
+      STUN_ATTR_XOR_PEER_ADDRESS,
+      rtc::SocketAddress(rtc::IPAddress(kIPv4TestAddress1),
+                         kTestMessagePort1)));
+  msg.AddAttribute(new StunByteStringAttribute(STUN_ATTR_DATA,
+                                               std::string(1000, 'x')));
+  ASSERT_TRUE(msg.AddFingerprint());
+  rtc::ByteBufferWriter out;
+  ASSERT_TRUE(msg.Write(&out));
+
+  size_t total = 0;
+  int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kIterations; ++i) {
+    TurnMessage read_msg;
+    rtc::ByteBufferReader buf(out.Data(), out.Length());
+    ASSERT_TRUE(read_msg.Read(&buf));
+    total += read_msg.GetByteString(STUN_ATTR_DATA)->length();
+  }
+  int64_t message_us = std::max<int64_t>(1, rtc::TimeMicros() - start_us);
+
+  start_us = rtc::TimeMicros();
+  for (int i = 0; i < kIterations; ++i) {
+    StunMessageView view;
+    const char* data;
+    size_t size;
+    rtc::SocketAddress peer;
+    ASSERT_TRUE(view.Parse(out.Data(), out.Length()));
+    ASSERT_TRUE(view.GetXorAddress(STUN_ATTR_XOR_PEER_ADDRESS, &peer));
+    ASSERT_TRUE(view.GetAttribute(STUN_ATTR_DATA, &data, &size));
+    total += size;
+  }
+  int64_t view_us = std::max<int64_t>(1, rtc::TimeMicros() - start_us);
+  EXPECT_EQ(2u * kIterations * 1000, total);
+
+  webrtc::test::PrintResult("stun_read_send_indication", "", "message",
+                            kIterations * 1000000LL / message_us, "messages/s",
+                            false);
+  webrtc::test::PrintResult("stun_read_send_indication", "", "view",
+                            kIterations * 1000000LL / view_us, "messages/s",
+                            false);
+}
+
 }  // namespace cricket
@@ -97,6 +97,19 @@ bool TransportController::SetSslMaxProtocolVersion(
                                this, version));
 }
 
+void TransportController::SetDtlsHandshakeThreads(
+    const std::vector<rtc::Thread*>& threads) {
+  network_thread_->Invoke<void>(
+      RTC_FROM_HERE, rtc::Bind(&TransportController::SetDtlsHandshakeThreads_n,
+                               this, threads));
+}
+
+void TransportController::SetSslSessionCache(rtc::SSLSessionCache* cache) {
+  network_thread_->Invoke<void>(
+      RTC_FROM_HERE,
+      rtc::Bind(&TransportController::SetSslSessionCache_n, this, cache));
+}
+
 void TransportController::SetIceConfig(const IceConfig& config) {
   network_thread_->Invoke<void>(
       RTC_FROM_HERE,
@@ -109,6 +122,13 @@ void TransportController::SetIceRole(IceRole ice_role) {
       rtc::Bind(&TransportController::SetIceRole_n, this, ice_role));
 }
 
+bool TransportController::Configure(rtc::SSLProtocolVersion ssl_max_version,
+                                    const IceConfig& ice_config) {
+  return network_thread_->Invoke<bool>(
+      RTC_FROM_HERE, rtc::Bind(&TransportController::Configure_n, this,
+                               ssl_max_version, ice_config));
+}
+
 void TransportController::SetNeedsIceRestartFlag() {
   for (auto& kv : transports_) {
     kv.second->SetNeedsIceRestartFlag();
@@ -364,6 +384,13 @@ DtlsTransportInternal* TransportController::CreateDtlsTransportChannel_n(
     IceTransportInternal* ice) {
   DtlsTransport* dtls = new DtlsTransport(ice);
   dtls->SetSslMaxProtocolVersion(ssl_max_version_);
+  dtls->SetSslSessionCache(ssl_session_cache_);
+  if (!dtls_handshake_threads_.empty()) {
+    dtls->SetHandshakeThread(
+        dtls_handshake_threads_[next_dtls_handshake_thread_]);
+    next_dtls_handshake_thread_ =
+        (next_dtls_handshake_thread_ + 1) % dtls_handshake_threads_.size();
+  }
   return dtls;
 }
 
@@ -495,6 +522,18 @@ bool TransportController::SetSslMaxProtocolVersion_n(
   return true;
 }
 
+void TransportController::SetDtlsHandshakeThreads_n(
+    const std::vector<rtc::Thread*>& threads) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  dtls_handshake_threads_ = threads;
+  next_dtls_handshake_thread_ = 0;
+}
+
+void TransportController::SetSslSessionCache_n(rtc::SSLSessionCache* cache) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  ssl_session_cache_ = cache;
+}
+
 void TransportController::SetIceConfig_n(const IceConfig& config) {
   RTC_DCHECK(network_thread_->IsCurrent());
 
@@ -504,6 +543,13 @@ void TransportController::SetIceConfig_n(const IceConfig& config) {
   }
 }
 
+bool TransportController::Configure_n(rtc::SSLProtocolVersion ssl_max_version,
+                                      const IceConfig& ice_config) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  SetIceConfig_n(ice_config);
+  return SetSslMaxProtocolVersion_n(ssl_max_version);
+}
+
 void TransportController::SetIceRole_n(IceRole ice_role) {
   RTC_DCHECK(network_thread_->IsCurrent());
 
@@ -63,8 +63,20 @@ class TransportController : public sigslot::has_slots<>,
   // and WebRtcSession are combined
   bool SetSslMaxProtocolVersion(rtc::SSLProtocolVersion version);
 
+  // Runs the DTLS handshakes of the transports created afterwards on
+  // |threads|, which are assigned in turn. An empty list runs them on the
+  // network thread. See DtlsTransport::SetHandshakeThread.
+  void SetDtlsHandshakeThreads(const std::vector<rtc::Thread*>& threads);
+  // Lets the DTLS handshakes of the transports created afterwards resume the
+  // sessions cached in |cache|, which must outlive them.
+  void SetSslSessionCache(rtc::SSLSessionCache* cache);
+
   void SetIceConfig(const IceConfig& config);
   void SetIceRole(IceRole ice_role);
+  // Does SetSslMaxProtocolVersion() and SetIceConfig() with a single hop to
+  // the network thread, when setting up a new TransportController.
+  bool Configure(rtc::SSLProtocolVersion ssl_max_version,
+                 const IceConfig& ice_config);
 
   // Set the "needs-ice-restart" flag as described in JSEP. After the flag is
   // set, offers should generate new ufrags/passwords until an ICE restart
@@ -202,8 +214,12 @@ class TransportController : public sigslot::has_slots<>,
   void DestroyAllChannels_n();
 
   bool SetSslMaxProtocolVersion_n(rtc::SSLProtocolVersion version);
+  void SetDtlsHandshakeThreads_n(const std::vector<rtc::Thread*>& threads);
+  void SetSslSessionCache_n(rtc::SSLSessionCache* cache);
   void SetIceConfig_n(const IceConfig& config);
   void SetIceRole_n(IceRole ice_role);
+  bool Configure_n(rtc::SSLProtocolVersion ssl_max_version,
+                   const IceConfig& ice_config);
   bool GetSslRole_n(const std::string& transport_name,
                     rtc::SSLRole* role) const;
   bool SetLocalCertificate_n(
@@ -263,6 +279,9 @@ class TransportController : public sigslot::has_slots<>,
   bool redetermine_role_on_ice_restart_;
   uint64_t ice_tiebreaker_ = rtc::CreateRandomId64();
   rtc::SSLProtocolVersion ssl_max_version_ = rtc::SSL_PROTOCOL_DTLS_12;
+  std::vector<rtc::Thread*> dtls_handshake_threads_;
+  size_t next_dtls_handshake_thread_ = 0;
+  rtc::SSLSessionCache* ssl_session_cache_ = nullptr;
   rtc::scoped_refptr<rtc::RTCCertificate> certificate_;
   rtc::AsyncInvoker invoker_;
   // True if QUIC is used instead of DTLS.
@@ -823,25 +823,25 @@ void TurnPort::OnAllocateRequestTimeout() {
 void TurnPort::HandleDataIndication(const char* data, size_t size,
                                     const rtc::PacketTime& packet_time) {
   // Read in the message, and process according to RFC5766, Section 10.4.
-  rtc::ByteBufferReader buf(data, size);
-  TurnMessage msg;
-  if (!msg.Read(&buf)) {
+  // Data indications carry the relayed packets, so the message is only viewed
+  // in place instead of being read into a TurnMessage.
+  StunMessageView msg;
+  if (!msg.Parse(data, size)) {
     LOG_J(LS_WARNING, this) << "Received invalid TURN data indication";
     return;
   }
 
   // Check mandatory attributes.
-  const StunAddressAttribute* addr_attr =
-      msg.GetAddress(STUN_ATTR_XOR_PEER_ADDRESS);
-  if (!addr_attr) {
+  rtc::SocketAddress ext_addr;
+  if (!msg.GetXorAddress(STUN_ATTR_XOR_PEER_ADDRESS, &ext_addr)) {
     LOG_J(LS_WARNING, this) << "Missing STUN_ATTR_XOR_PEER_ADDRESS attribute "
                             << "in data indication.";
     return;
   }
 
-  const StunByteStringAttribute* data_attr =
-      msg.GetByteString(STUN_ATTR_DATA);
-  if (!data_attr) {
+  const char* payload;
+  size_t payload_size;
+  if (!msg.GetAttribute(STUN_ATTR_DATA, &payload, &payload_size)) {
     LOG_J(LS_WARNING, this) << "Missing STUN_ATTR_DATA attribute in "
                             << "data indication.";
     return;
@@ -849,15 +849,13 @@ void TurnPort::HandleDataIndication(const char* data, size_t size,
 
   // Log a warning if the data didn't come from an address that we think we have
   // a permission for.
-  rtc::SocketAddress ext_addr(addr_attr->GetAddress());
   if (!HasPermission(ext_addr.ipaddr())) {
     LOG_J(LS_WARNING, this)
         << "Received TURN data indication with unknown "
         << "peer address, addr=" << ext_addr.ToSensitiveString();
   }
 
-  DispatchPacket(data_attr->bytes(), data_attr->length(), ext_addr,
-                 PROTO_UDP, packet_time);
+  DispatchPacket(payload, payload_size, ext_addr, PROTO_UDP, packet_time);
 }
 
 void TurnPort::HandleChannelData(int channel_id, const char* data,
@@ -144,7 +144,9 @@ TurnServer::~TurnServer() {
 void TurnServer::AddInternalSocket(rtc::AsyncPacketSocket* socket,
                                    ProtocolType proto) {
   RTC_DCHECK(server_sockets_.end() == server_sockets_.find(socket));
-  server_sockets_[socket] = proto;
+  InternalSocket& internal_socket = server_sockets_[socket];
+  internal_socket.proto = proto;
+  internal_socket.remote_address = socket->GetRemoteAddress();
   socket->SignalReadPacket.connect(this, &TurnServer::OnInternalPacket);
 }
 
@@ -199,7 +201,8 @@ void TurnServer::OnInternalPacket(rtc::AsyncPacketSocket* socket,
   }
   InternalSocketMap::iterator iter = server_sockets_.find(socket);
   RTC_DCHECK(iter != server_sockets_.end());
-  TurnServerConnection conn(addr, iter->second, socket);
+  TurnServerConnection conn(addr, iter->second.remote_address,
+                            iter->second.proto, socket);
   uint16_t msg_type = rtc::GetBE16(data);
   if (!IsTurnChannelData(msg_type)) {
     // This is a STUN message.
@@ -215,6 +218,23 @@ void TurnServer::OnInternalPacket(rtc::AsyncPacketSocket* socket,
 
 void TurnServer::HandleStunMessage(TurnServerConnection* conn, const char* data,
                                    size_t size) {
+  // Send indications carry the relayed data, and binding requests are sent for
+  // every ICE connectivity check, so both skip building a TurnMessage. Send
+  // indications need neither authorization nor a response.
+  uint16_t msg_type = rtc::GetBE16(data);
+  if (msg_type == TURN_SEND_INDICATION) {
+    HandleSendIndication(conn, data, size);
+    return;
+  }
+  if (msg_type == STUN_BINDING_REQUEST) {
+    // Legacy requests, without the magic cookie, take the slow path.
+    StunMessageView msg;
+    if (msg.Parse(data, size) && !msg.IsLegacy()) {
+      HandleBindingRequest(conn, msg);
+      return;
+    }
+  }
+
   TurnMessage msg;
   rtc::ByteBufferReader buf(data, size);
   if (!msg.Read(&buf) || (buf.Length() > 0)) {
@@ -276,6 +296,27 @@ void TurnServer::HandleStunMessage(TurnServerConnection* conn, const char* data,
   }
 }
 
+void TurnServer::HandleSendIndication(TurnServerConnection* conn,
+                                      const char* data,
+                                      size_t size) {
+  StunMessageView msg;
+  if (!msg.Parse(data, size)) {
+    LOG(LS_WARNING) << "Received invalid STUN message";
+    return;
+  }
+  if (!msg.CheckFingerprint()) {
+    LOG(LS_WARNING) << "Received STUN message with invalid fingerprint";
+    return;
+  }
+  TurnServerAllocation* allocation = FindAllocation(conn);
+  if (!allocation) {
+    LOG(LS_WARNING) << "Received send indication without allocation, from "
+                    << conn->src().ToSensitiveString();
+    return;
+  }
+  allocation->HandleSendIndication(msg);
+}
+
 bool TurnServer::GetKey(const StunMessage* msg, std::string* key) {
   const StunByteStringAttribute* username_attr =
       msg->GetByteString(STUN_ATTR_USERNAME);
@@ -361,6 +402,60 @@ void TurnServer::HandleBindingRequest(TurnServerConnection* conn,
   SendStun(conn, &response);
 }
 
+void TurnServer::HandleBindingRequest(TurnServerConnection* conn,
+                                      const StunMessageView& req) {
+  if (!req.CheckFingerprint()) {
+    LOG(LS_WARNING) << "Received STUN message with invalid fingerprint";
+    return;
+  }
+
+  // Write the same response as above: the XOR-MAPPED-ADDRESS the request was
+  // received from, and SOFTWARE if one is set.
+  const rtc::IPAddress& ip = conn->src().ipaddr();
+  const size_t ip_size =
+      ip.family() == AF_INET6 ? sizeof(in6_addr) : sizeof(in_addr);
+  const size_t address_size = 4 + ip_size;
+  size_t size = kStunHeaderSize + kStunAttributeHeaderSize + address_size;
+  if (!software_.empty())
+    size += kStunAttributeHeaderSize + ((software_.size() + 3) & ~3);
+  binding_response_.SetSize(size);
+  uint8_t* data = binding_response_.data();
+  rtc::SetBE16(data, STUN_BINDING_RESPONSE);
+  rtc::SetBE16(data + 2, static_cast<uint16_t>(size - kStunHeaderSize));
+  // The magic cookie and the transaction ID.
+  const uint8_t* cookie = reinterpret_cast<const uint8_t*>(req.data()) +
+                          kStunTransactionIdOffset - kStunMagicCookieLength;
+  memcpy(data + 4, cookie, kStunMagicCookieLength + kStunTransactionIdLength);
+
+  uint8_t* attr = data + kStunHeaderSize;
+  rtc::SetBE16(attr, STUN_ATTR_XOR_MAPPED_ADDRESS);
+  rtc::SetBE16(attr + 2, static_cast<uint16_t>(address_size));
+  attr[4] = 0;
+  attr[5] = ip.family() == AF_INET6 ? STUN_ADDRESS_IPV6 : STUN_ADDRESS_IPV4;
+  rtc::SetBE16(attr + 6, conn->src().port() ^ (kStunMagicCookie >> 16));
+  // The IP is XORed with the magic cookie, followed for IPv6 by the
+  // transaction ID, which are in |cookie| in that order.
+  if (ip.family() == AF_INET6) {
+    in6_addr v6addr = ip.ipv6_address();
+    memcpy(attr + 8, &v6addr, ip_size);
+  } else {
+    in_addr v4addr = ip.ipv4_address();
+    memcpy(attr + 8, &v4addr, ip_size);
+  }
+  for (size_t i = 0; i < ip_size; ++i)
+    attr[8 + i] ^= cookie[i];
+
+  if (!software_.empty()) {
+    attr += kStunAttributeHeaderSize + address_size;
+    rtc::SetBE16(attr, STUN_ATTR_SOFTWARE);
+    rtc::SetBE16(attr + 2, static_cast<uint16_t>(software_.size()));
+    memcpy(attr + kStunAttributeHeaderSize, software_.data(), software_.size());
+    uint8_t* padding = attr + kStunAttributeHeaderSize + software_.size();
+    memset(padding, 0, data + size - padding);
+  }
+  Send(conn, binding_response_.data(), binding_response_.size());
+}
+
 void TurnServer::HandleAllocateRequest(TurnServerConnection* conn,
                                        const TurnMessage* msg,
                                        const std::string& key) {
@@ -501,8 +596,14 @@ void TurnServer::SendStun(TurnServerConnection* conn, StunMessage* msg) {
 
 void TurnServer::Send(TurnServerConnection* conn,
                       const rtc::ByteBufferWriter& buf) {
+  Send(conn, buf.Data(), buf.Length());
+}
+
+void TurnServer::Send(TurnServerConnection* conn,
+                      const void* data,
+                      size_t size) {
   rtc::PacketOptions options;
-  conn->socket()->SendTo(buf.Data(), buf.Length(), conn->src(), options);
+  conn->socket()->SendTo(data, size, conn->src(), options);
 }
 
 void TurnServer::OnAllocationDestroyed(TurnServerAllocation* allocation) {
@@ -513,7 +614,8 @@ void TurnServer::OnAllocationDestroyed(TurnServerAllocation* allocation) {
   // by all allocations.
   // Note: We may not find a socket if it's a TCP socket that was closed, and
   // the allocation is only now timing out.
-  if (iter != server_sockets_.end() && iter->second != cricket::PROTO_UDP) {
+  if (iter != server_sockets_.end() &&
+      iter->second.proto != cricket::PROTO_UDP) {
     DestroyInternalSocket(socket);
   }
 
@@ -552,6 +654,12 @@ TurnServerConnection::TurnServerConnection(const rtc::SocketAddress& src,
       socket_(socket) {
 }
 
+TurnServerConnection::TurnServerConnection(const rtc::SocketAddress& src,
+                                           const rtc::SocketAddress& dst,
+                                           ProtocolType proto,
+                                           rtc::AsyncPacketSocket* socket)
+    : src_(src), dst_(dst), proto_(proto), socket_(socket) {}
+
 bool TurnServerConnection::operator==(const TurnServerConnection& c) const {
   return src_ == c.src_ && dst_ == c.dst_ && proto_ == c.proto_;
 }
@@ -569,6 +677,12 @@ std::string TurnServerConnection::ToString() const {
   return ost.str();
 }
 
+size_t TurnServerConnection::Hash() const {
+  // Most allocations share |dst_| and |proto_|, so |src_| carries nearly all
+  // of the entropy.
+  return src_.Hash() ^ (dst_.Hash() * 31) ^ proto_;
+}
+
 TurnServerAllocation::TurnServerAllocation(TurnServer* server,
                                            rtc::Thread* thread,
                                            const TurnServerConnection& conn,
@@ -584,13 +698,12 @@ TurnServerAllocation::TurnServerAllocation(TurnServer* server,
 }
 
 TurnServerAllocation::~TurnServerAllocation() {
-  for (ChannelList::iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    delete *it;
+  for (ChannelIdMap::iterator it = channels_by_id_.begin();
+       it != channels_by_id_.end(); ++it) {
+    delete it->second;
   }
-  for (PermissionList::iterator it = perms_.begin();
-       it != perms_.end(); ++it) {
-    delete *it;
+  for (PermissionMap::iterator it = perms_.begin(); it != perms_.end(); ++it) {
+    delete it->second;
   }
   thread_->Clear(this, MSG_ALLOCATION_TIMEOUT);
   LOG_J(LS_INFO, this) << "Allocation destroyed";
@@ -611,9 +724,6 @@ void TurnServerAllocation::HandleTurnMessage(const TurnMessage* msg) {
     case TURN_REFRESH_REQUEST:
       HandleRefreshRequest(msg);
       break;
-    case TURN_SEND_INDICATION:
-      HandleSendIndication(msg);
-      break;
     case TURN_CREATE_PERMISSION_REQUEST:
       HandleCreatePermissionRequest(msg);
       break;
@@ -687,23 +797,23 @@ void TurnServerAllocation::HandleRefreshRequest(const TurnMessage* msg) {
   SendResponse(&response);
 }
 
-void TurnServerAllocation::HandleSendIndication(const TurnMessage* msg) {
+void TurnServerAllocation::HandleSendIndication(const StunMessageView& msg) {
   // Check mandatory attributes.
-  const StunByteStringAttribute* data_attr = msg->GetByteString(STUN_ATTR_DATA);
-  const StunAddressAttribute* peer_attr =
-      msg->GetAddress(STUN_ATTR_XOR_PEER_ADDRESS);
-  if (!data_attr || !peer_attr) {
+  const char* data;
+  size_t size;
+  rtc::SocketAddress peer;
+  if (!msg.GetAttribute(STUN_ATTR_DATA, &data, &size) ||
+      !msg.GetXorAddress(STUN_ATTR_XOR_PEER_ADDRESS, &peer)) {
     LOG_J(LS_WARNING, this) << "Received invalid send indication";
     return;
   }
 
   // If a permission exists, send the data on to the peer.
-  if (HasPermission(peer_attr->GetAddress().ipaddr())) {
-    SendExternal(data_attr->bytes(), data_attr->length(),
-                 peer_attr->GetAddress());
+  if (HasPermission(peer.ipaddr())) {
+    SendExternal(data, size, peer);
   } else {
     LOG_J(LS_WARNING, this) << "Received send indication without permission"
-                            << "peer=" << peer_attr->GetAddress();
+                            << "peer=" << peer;
   }
 }
 
@@ -767,7 +877,8 @@ void TurnServerAllocation::HandleChannelBindRequest(const TurnMessage* msg) {
     channel1 = new Channel(thread_, channel_id, peer_attr->GetAddress());
     channel1->SignalDestroyed.connect(this,
         &TurnServerAllocation::OnChannelDestroyed);
-    channels_.push_back(channel1);
+    channels_by_id_[channel_id] = channel1;
+    channels_by_peer_[channel1->peer()] = channel1;
   } else {
     channel1->Refresh();
   }
@@ -806,12 +917,13 @@ void TurnServerAllocation::OnExternalPacket(
   RTC_DCHECK(external_socket_.get() == socket);
   Channel* channel = FindChannel(addr);
   if (channel) {
-    // There is a channel bound to this address. Send as a channel message.
-    rtc::ByteBufferWriter buf;
-    buf.WriteUInt16(channel->id());
-    buf.WriteUInt16(static_cast<uint16_t>(size));
-    buf.WriteBytes(data, size);
-    server_->Send(&conn_, buf);
+    // There is a channel bound to this address. Send as a channel message,
+    // built in a buffer that is reused for every packet.
+    channel_data_.SetSize(TURN_CHANNEL_HEADER_SIZE + size);
+    rtc::SetBE16(channel_data_.data(), static_cast<uint16_t>(channel->id()));
+    rtc::SetBE16(channel_data_.data() + 2, static_cast<uint16_t>(size));
+    memcpy(channel_data_.data() + TURN_CHANNEL_HEADER_SIZE, data, size);
+    server_->Send(&conn_, channel_data_.data(), channel_data_.size());
   } else if (!server_->enable_permission_checks_ ||
              HasPermission(addr.ipaddr())) {
     // No channel, but a permission exists. Send as a data indication.
@@ -850,7 +962,7 @@ void TurnServerAllocation::AddPermission(const rtc::IPAddress& addr) {
     perm = new Permission(thread_, addr);
     perm->SignalDestroyed.connect(
         this, &TurnServerAllocation::OnPermissionDestroyed);
-    perms_.push_back(perm);
+    perms_[addr] = perm;
   } else {
     perm->Refresh();
   }
@@ -858,32 +970,20 @@ void TurnServerAllocation::AddPermission(const rtc::IPAddress& addr) {
 
 TurnServerAllocation::Permission* TurnServerAllocation::FindPermission(
     const rtc::IPAddress& addr) const {
-  for (PermissionList::const_iterator it = perms_.begin();
-       it != perms_.end(); ++it) {
-    if ((*it)->peer() == addr)
-      return *it;
-  }
-  return NULL;
+  PermissionMap::const_iterator it = perms_.find(addr);
+  return (it != perms_.end()) ? it->second : NULL;
 }
 
 TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
     int channel_id) const {
-  for (ChannelList::const_iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    if ((*it)->id() == channel_id)
-      return *it;
-  }
-  return NULL;
+  ChannelIdMap::const_iterator it = channels_by_id_.find(channel_id);
+  return (it != channels_by_id_.end()) ? it->second : NULL;
 }
 
 TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
     const rtc::SocketAddress& addr) const {
-  for (ChannelList::const_iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    if ((*it)->peer() == addr)
-      return *it;
-  }
-  return NULL;
+  ChannelAddressMap::const_iterator it = channels_by_peer_.find(addr);
+  return (it != channels_by_peer_.end()) ? it->second : NULL;
 }
 
 void TurnServerAllocation::SendResponse(TurnMessage* msg) {
@@ -914,16 +1014,15 @@ void TurnServerAllocation::OnMessage(rtc::Message* msg) {
 }
 
 void TurnServerAllocation::OnPermissionDestroyed(Permission* perm) {
-  PermissionList::iterator it = std::find(perms_.begin(), perms_.end(), perm);
-  RTC_DCHECK(it != perms_.end());
+  PermissionMap::iterator it = perms_.find(perm->peer());
+  RTC_DCHECK(it != perms_.end() && it->second == perm);
   perms_.erase(it);
 }
 
 void TurnServerAllocation::OnChannelDestroyed(Channel* channel) {
-  ChannelList::iterator it =
-      std::find(channels_.begin(), channels_.end(), channel);
-  RTC_DCHECK(it != channels_.end());
-  channels_.erase(it);
+  size_t erased = channels_by_id_.erase(channel->id());
+  erased += channels_by_peer_.erase(channel->peer());
+  RTC_DCHECK_EQ(2u, erased);
 }
 
 TurnServerAllocation::Permission::Permission(rtc::Thread* thread,
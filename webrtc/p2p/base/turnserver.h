@@ -11,16 +11,17 @@
 #ifndef WEBRTC_P2P_BASE_TURNSERVER_H_
 #define WEBRTC_P2P_BASE_TURNSERVER_H_
 
-#include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "webrtc/p2p/base/portinterface.h"
 #include "webrtc/base/asyncinvoker.h"
 #include "webrtc/base/asyncpacketsocket.h"
+#include "webrtc/base/buffer.h"
 #include "webrtc/base/messagequeue.h"
 #include "webrtc/base/sigslot.h"
 #include "webrtc/base/socketaddress.h"
@@ -34,6 +35,7 @@ class Thread;
 namespace cricket {
 
 class StunMessage;
+class StunMessageView;
 class TurnMessage;
 class TurnServer;
 
@@ -47,11 +49,24 @@ class TurnServerConnection {
   TurnServerConnection(const rtc::SocketAddress& src,
                        ProtocolType proto,
                        rtc::AsyncPacketSocket* socket);
+  // Same as above, with the remote address of |socket| already known.
+  TurnServerConnection(const rtc::SocketAddress& src,
+                       const rtc::SocketAddress& dst,
+                       ProtocolType proto,
+                       rtc::AsyncPacketSocket* socket);
   const rtc::SocketAddress& src() const { return src_; }
   rtc::AsyncPacketSocket* socket() { return socket_; }
   bool operator==(const TurnServerConnection& t) const;
   bool operator<(const TurnServerConnection& t) const;
   std::string ToString() const;
+  // Hashes the 5-tuple; consistent with operator==.
+  size_t Hash() const;
+
+  struct Hasher {
+    size_t operator()(const TurnServerConnection& conn) const {
+      return conn.Hash();
+    }
+  };
 
  private:
   rtc::SocketAddress src_;
@@ -86,6 +101,7 @@ class TurnServerAllocation : public rtc::MessageHandler,
   std::string ToString() const;
 
   void HandleTurnMessage(const TurnMessage* msg);
+  void HandleSendIndication(const StunMessageView& msg);
   void HandleChannelData(const char* data, size_t size);
 
   sigslot::signal1<TurnServerAllocation*> SignalDestroyed;
@@ -93,12 +109,26 @@ class TurnServerAllocation : public rtc::MessageHandler,
  private:
   class Channel;
   class Permission;
-  typedef std::list<Permission*> PermissionList;
-  typedef std::list<Channel*> ChannelList;
+  struct IPAddressHasher {
+    size_t operator()(const rtc::IPAddress& addr) const {
+      return rtc::HashIP(addr);
+    }
+  };
+  struct SocketAddressHasher {
+    size_t operator()(const rtc::SocketAddress& addr) const {
+      return addr.Hash();
+    }
+  };
+  typedef std::unordered_map<rtc::IPAddress, Permission*, IPAddressHasher>
+      PermissionMap;
+  // Channels are looked up by id for data from the client, and by peer
+  // address for data from the peer.
+  typedef std::unordered_map<int, Channel*> ChannelIdMap;
+  typedef std::unordered_map<rtc::SocketAddress, Channel*, SocketAddressHasher>
+      ChannelAddressMap;
 
   void HandleAllocateRequest(const TurnMessage* msg);
   void HandleRefreshRequest(const TurnMessage* msg);
-  void HandleSendIndication(const TurnMessage* msg);
   void HandleCreatePermissionRequest(const TurnMessage* msg);
   void HandleChannelBindRequest(const TurnMessage* msg);
 
@@ -134,8 +164,10 @@ class TurnServerAllocation : public rtc::MessageHandler,
   std::string username_;
   std::string origin_;
   std::string last_nonce_;
-  PermissionList perms_;
-  ChannelList channels_;
+  PermissionMap perms_;
+  ChannelIdMap channels_by_id_;
+  ChannelAddressMap channels_by_peer_;
+  rtc::Buffer channel_data_;
 };
 
 // An interface through which the MD5 credential hash can be retrieved.
@@ -163,7 +195,9 @@ class TurnRedirectInterface {
 // Not yet wired up: TCP support.
 class TurnServer : public sigslot::has_slots<> {
  public:
-  typedef std::map<TurnServerConnection, std::unique_ptr<TurnServerAllocation>>
+  typedef std::unordered_map<TurnServerConnection,
+                             std::unique_ptr<TurnServerAllocation>,
+                             TurnServerConnection::Hasher>
       AllocationMap;
 
   explicit TurnServer(rtc::Thread* thread);
@@ -228,7 +262,11 @@ class TurnServer : public sigslot::has_slots<> {
 
   void HandleStunMessage(
       TurnServerConnection* conn, const char* data, size_t size);
+  void HandleSendIndication(
+      TurnServerConnection* conn, const char* data, size_t size);
   void HandleBindingRequest(TurnServerConnection* conn, const StunMessage* msg);
+  void HandleBindingRequest(TurnServerConnection* conn,
+                            const StunMessageView& msg);
   void HandleAllocateRequest(TurnServerConnection* conn, const TurnMessage* msg,
                              const std::string& key);
 
@@ -256,6 +294,7 @@ class TurnServer : public sigslot::has_slots<> {
 
   void SendStun(TurnServerConnection* conn, StunMessage* msg);
   void Send(TurnServerConnection* conn, const rtc::ByteBufferWriter& buf);
+  void Send(TurnServerConnection* conn, const void* data, size_t size);
 
   void OnAllocationDestroyed(TurnServerAllocation* allocation);
   void DestroyInternalSocket(rtc::AsyncPacketSocket* socket);
@@ -263,8 +302,13 @@ class TurnServer : public sigslot::has_slots<> {
   // Just clears |sockets_to_delete_|; called asynchronously.
   void FreeSockets();
 
+  struct InternalSocket {
+    ProtocolType proto;
+    // Cached, since asking the socket costs a system call per packet.
+    rtc::SocketAddress remote_address;
+  };
   typedef std::map<rtc::AsyncPacketSocket*,
-                   ProtocolType> InternalSocketMap;
+                   InternalSocket> InternalSocketMap;
   typedef std::map<rtc::AsyncSocket*,
                    ProtocolType> ServerSocketMap;
 
@@ -281,6 +325,9 @@ class TurnServer : public sigslot::has_slots<> {
   // Check for permission when receiving an external packet.
   bool enable_permission_checks_ = true;
 
+  // Binding responses are built in a buffer that is reused for every request.
+  rtc::Buffer binding_response_;
+
   InternalSocketMap server_sockets_;
   ServerSocketMap server_listen_sockets_;
   // Used when we need to delete a socket asynchronously.
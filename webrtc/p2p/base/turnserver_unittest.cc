@@ -8,10 +8,15 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string>
+#include <vector>
+
+#include "webrtc/base/bytebuffer.h"
 #include "webrtc/base/gunit.h"
 #include "webrtc/base/physicalsocketserver.h"
 #include "webrtc/base/virtualsocketserver.h"
 #include "webrtc/p2p/base/basicpacketsocketfactory.h"
+#include "webrtc/p2p/base/stun.h"
 #include "webrtc/p2p/base/turnserver.h"
 
 // NOTE: This is a work in progress. Currently this file only has tests for
@@ -65,4 +70,95 @@ TEST_F(TurnServerConnectionTest, ComparisonOperators) {
   ExpectNotEqual(connection1, connection4);
 }
 
+class TurnServerTest : public testing::Test, public sigslot::has_slots<> {
+ public:
+  TurnServerTest()
+      : vss_(&pss_), ss_scope_(&vss_), server_(rtc::Thread::Current()) {}
+
+  void OnPacket(rtc::AsyncPacketSocket* socket,
+                const char* data,
+                size_t size,
+                const rtc::SocketAddress& addr,
+                const rtc::PacketTime& packet_time) {
+    responses_.push_back(std::string(data, size));
+  }
+
+  // Sends |request| to a server socket on |server_ip| from a client socket on
+  // |client_ip|, whose address is returned in |client_address|.
+  void SendRequest(const std::string& server_ip,
+                   const std::string& client_ip,
+                   const rtc::ByteBufferWriter& request,
+                   rtc::SocketAddress* client_address) {
+    rtc::AsyncPacketSocket* server_socket = socket_factory_.CreateUdpSocket(
+        rtc::SocketAddress(server_ip, 0), 0, 0);
+    server_.AddInternalSocket(server_socket, PROTO_UDP);
+    std::unique_ptr<rtc::AsyncPacketSocket> client_socket(
+        socket_factory_.CreateUdpSocket(rtc::SocketAddress(client_ip, 0), 0,
+                                        0));
+    client_socket->SignalReadPacket.connect(this, &TurnServerTest::OnPacket);
+    *client_address = client_socket->GetLocalAddress();
+    client_socket->SendTo(request.Data(), request.Length(),
+                          server_socket->GetLocalAddress(),
+                          rtc::PacketOptions());
+    vss_.ProcessMessagesUntilIdle();
+  }
+
+ protected:
+  rtc::PhysicalSocketServer pss_;
+  rtc::VirtualSocketServer vss_;
+  rtc::SocketServerScope ss_scope_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  TurnServer server_;
+  std::vector<std::string> responses_;
+};
+
+// Binding requests are answered without parsing them into a StunMessage, so
+// check that the response is the one StunMessage would write.
+TEST_F(TurnServerTest, RespondsToBindingRequests) {
+  const std::string kTransactionId = "0123456789ab";
+  const std::string kSoftware = "TurnServerTest";
+  server_.set_software(kSoftware);
+  StunMessage request;
+  request.SetType(STUN_BINDING_REQUEST);
+  request.SetTransactionID(kTransactionId);
+  ASSERT_TRUE(request.AddFingerprint());
+  rtc::ByteBufferWriter request_buf;
+  ASSERT_TRUE(request.Write(&request_buf));
+
+  for (const char* ip : {"1.1.1.1", "2001:db8::1"}) {
+    responses_.clear();
+    rtc::SocketAddress client_address;
+    SendRequest(ip, ip, request_buf, &client_address);
+    ASSERT_EQ(1u, responses_.size());
+
+    StunMessage expected;
+    expected.SetType(STUN_BINDING_RESPONSE);
+    expected.SetTransactionID(kTransactionId);
+    expected.AddAttribute(new StunXorAddressAttribute(
+        STUN_ATTR_XOR_MAPPED_ADDRESS, client_address));
+    expected.AddAttribute(
+        new StunByteStringAttribute(STUN_ATTR_SOFTWARE, kSoftware));
+    rtc::ByteBufferWriter expected_buf;
+    ASSERT_TRUE(expected.Write(&expected_buf));
+    EXPECT_EQ(std::string(expected_buf.Data(), expected_buf.Length()),
+              responses_[0]);
+  }
+}
+
+TEST_F(TurnServerTest, DropsBindingRequestWithInvalidFingerprint) {
+  StunMessage request;
+  request.SetType(STUN_BINDING_REQUEST);
+  request.SetTransactionID("0123456789ab");
+  ASSERT_TRUE(request.AddFingerprint());
+  rtc::ByteBufferWriter request_buf;
+  ASSERT_TRUE(request.Write(&request_buf));
+  std::string corrupted(request_buf.Data(), request_buf.Length());
+  corrupted[kStunHeaderSize - 1] ^= 0x01;
+  rtc::ByteBufferWriter corrupted_buf(corrupted.data(), corrupted.size());
+
+  rtc::SocketAddress client_address;
+  SendRequest("1.1.1.1", "1.1.1.1", corrupted_buf, &client_address);
+  EXPECT_TRUE(responses_.empty());
+}
+
 }  // namespace cricket
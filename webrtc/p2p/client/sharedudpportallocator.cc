@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/p2p/client/sharedudpportallocator.h"
+
+#include "webrtc/base/checks.h"
+#include "webrtc/base/logging.h"
+#include "webrtc/base/thread.h"
+#include "webrtc/p2p/base/stunport.h"
+
+namespace cricket {
+
+namespace {
+
+int PrefixLength(const rtc::SocketAddress& addr) {
+  return addr.ipaddr().family() == AF_INET6 ? 64 : 32;
+}
+
+}  // namespace
+
+SharedUdpPortAllocator::SharedUdpPortAllocator(rtc::Thread* network_thread,
+                                               rtc::AsyncPacketSocket* socket)
+    : network_thread_(network_thread),
+      socket_factory_(network_thread),
+      network_("shared",
+               "shared udp socket",
+               rtc::TruncateIP(socket->GetLocalAddress().ipaddr(),
+                               PrefixLength(socket->GetLocalAddress())),
+               PrefixLength(socket->GetLocalAddress())),
+      shared_socket_(socket) {
+  // Host candidates carry the socket's address, so it can't be a wildcard.
+  RTC_DCHECK(!socket->GetLocalAddress().IsAnyIP());
+  network_.AddIP(socket->GetLocalAddress().ipaddr());
+}
+
+SharedUdpPortAllocator::~SharedUdpPortAllocator() {}
+
+PortAllocatorSession* SharedUdpPortAllocator::CreateSessionInternal(
+    const std::string& content_name,
+    int component,
+    const std::string& ice_ufrag,
+    const std::string& ice_pwd) {
+  return new SharedUdpPortAllocatorSession(
+      this, network_thread_, &socket_factory_, &network_, &shared_socket_,
+      content_name, component, ice_ufrag, ice_pwd);
+}
+
+SharedUdpPortAllocatorSession::SharedUdpPortAllocatorSession(
+    PortAllocator* allocator,
+    rtc::Thread* network_thread,
+    rtc::PacketSocketFactory* socket_factory,
+    rtc::Network* network,
+    SharedUdpSocket* shared_socket,
+    const std::string& content_name,
+    int component,
+    const std::string& ice_ufrag,
+    const std::string& ice_pwd)
+    : PortAllocatorSession(content_name,
+                           component,
+                           ice_ufrag,
+                           ice_pwd,
+                           allocator->flags()),
+      network_thread_(network_thread),
+      socket_factory_(socket_factory),
+      network_(network),
+      shared_socket_(shared_socket) {}
+
+SharedUdpPortAllocatorSession::~SharedUdpPortAllocatorSession() {
+  // Destroy the port while the endpoint socket it sends on and the members
+  // OnPortDestroyed touches are still alive.
+  port_.reset();
+}
+
+void SharedUdpPortAllocatorSession::StartGettingPorts() {
+  running_ = true;
+  // A pooled session has no ICE credentials yet, and incoming checks are
+  // routed by ufrag, so its port is created once it is taken from the pool.
+  if (!port_ && !pooled())
+    CreatePort();
+}
+
+std::vector<PortInterface*> SharedUdpPortAllocatorSession::ReadyPorts() const {
+  return ready_ports_;
+}
+
+std::vector<Candidate> SharedUdpPortAllocatorSession::ReadyCandidates() const {
+  return candidates_;
+}
+
+void SharedUdpPortAllocatorSession::PruneAllPorts() {
+  if (port_)
+    port_->Prune();
+}
+
+void SharedUdpPortAllocatorSession::UpdateIceParametersInternal() {
+  if (!port_) {
+    if (running_)
+      CreatePort();
+    return;
+  }
+  if (!shared_socket_->SetEndpointCredentials(socket_.get(), ice_ufrag(),
+                                              ice_pwd())) {
+    LOG(LS_WARNING) << "Failed to update the ICE credentials of the port on "
+                    << shared_socket_->GetLocalAddress().ToSensitiveString();
+  }
+  port_->SetIceParameters(component(), ice_ufrag(), ice_pwd());
+}
+
+void SharedUdpPortAllocatorSession::CreatePort() {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  socket_.reset(shared_socket_->CreateEndpoint(ice_ufrag(), ice_pwd()));
+  if (!socket_) {
+    allocation_done_ = true;
+    SignalCandidatesAllocationDone(this);
+    return;
+  }
+  socket_->SignalReadPacket.connect(
+      this, &SharedUdpPortAllocatorSession::OnReadPacket);
+  port_.reset(UDPPort::Create(network_thread_, socket_factory_, network_,
+                              socket_.get(), username(), password(),
+                              std::string(), false));
+  RTC_DCHECK(port_);
+  port_->SignalDestroyed.connect(
+      this, &SharedUdpPortAllocatorSession::OnPortDestroyed);
+  port_->set_component(component());
+  port_->set_generation(generation());
+  port_->SignalPortComplete.connect(
+      this, &SharedUdpPortAllocatorSession::OnPortComplete);
+  port_->PrepareAddress();
+  ready_ports_.push_back(port_.get());
+  SignalPortReady(this, port_.get());
+  port_->KeepAliveUntilPruned();
+}
+
+void SharedUdpPortAllocatorSession::OnReadPacket(
+    rtc::AsyncPacketSocket* socket,
+    const char* data,
+    size_t size,
+    const rtc::SocketAddress& remote_addr,
+    const rtc::PacketTime& packet_time) {
+  if (port_)
+    port_->HandleIncomingPacket(socket, data, size, remote_addr, packet_time);
+}
+
+void SharedUdpPortAllocatorSession::OnPortComplete(Port* port) {
+  const std::vector<Candidate>& candidates = port->Candidates();
+  candidates_.insert(candidates_.end(), candidates.begin(), candidates.end());
+  SignalCandidatesReady(this, candidates);
+
+  allocation_done_ = true;
+  SignalCandidatesAllocationDone(this);
+}
+
+void SharedUdpPortAllocatorSession::OnPortDestroyed(PortInterface* port) {
+  // The port deletes itself once it is pruned and has no connections left.
+  port_.release();
+  ready_ports_.clear();
+}
+
+}  // namespace cricket
@@ -0,0 +1,118 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_P2P_CLIENT_SHAREDUDPPORTALLOCATOR_H_
+#define WEBRTC_P2P_CLIENT_SHAREDUDPPORTALLOCATOR_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "webrtc/base/network.h"
+#include "webrtc/p2p/base/basicpacketsocketfactory.h"
+#include "webrtc/p2p/base/portallocator.h"
+#include "webrtc/p2p/base/sharedudpsocket.h"
+
+namespace rtc {
+class Thread;
+}
+
+namespace cricket {
+
+class UDPPort;
+
+// A port allocator for servers that host many peers, such as an SFU. Instead
+// of gathering on every network, each session gets a single UDPPort with a
+// host candidate on a UDP socket that is shared by all sessions (see
+// SharedUdpSocket). So thousands of P2PTransportChannels use one file
+// descriptor, while each keeps its own STUN binding handling, connections,
+// DTLS and SRTP.
+//
+// The remote side must be the one that finds the paths: the server usually
+// learns the addresses of its peers as peer reflexive candidates from their
+// checks, like an ICE lite agent.
+class SharedUdpPortAllocator : public PortAllocator {
+ public:
+  // Takes ownership of |socket|, a UDP socket created on |network_thread| and
+  // bound to the address that is advertised in the host candidates.
+  SharedUdpPortAllocator(rtc::Thread* network_thread,
+                         rtc::AsyncPacketSocket* socket);
+  ~SharedUdpPortAllocator() override;
+
+  void SetNetworkIgnoreMask(int network_ignore_mask) override {}
+
+  SharedUdpSocket* shared_socket() { return &shared_socket_; }
+
+ protected:
+  PortAllocatorSession* CreateSessionInternal(
+      const std::string& content_name,
+      int component,
+      const std::string& ice_ufrag,
+      const std::string& ice_pwd) override;
+
+ private:
+  rtc::Thread* const network_thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  rtc::Network network_;
+  SharedUdpSocket shared_socket_;
+};
+
+class SharedUdpPortAllocatorSession : public PortAllocatorSession {
+ public:
+  SharedUdpPortAllocatorSession(PortAllocator* allocator,
+                                rtc::Thread* network_thread,
+                                rtc::PacketSocketFactory* socket_factory,
+                                rtc::Network* network,
+                                SharedUdpSocket* shared_socket,
+                                const std::string& content_name,
+                                int component,
+                                const std::string& ice_ufrag,
+                                const std::string& ice_pwd);
+  ~SharedUdpPortAllocatorSession() override;
+
+  void SetCandidateFilter(uint32_t filter) override {}
+  void StartGettingPorts() override;
+  void StopGettingPorts() override { running_ = false; }
+  bool IsGettingPorts() override { return running_; }
+  void ClearGettingPorts() override { running_ = false; }
+  std::vector<PortInterface*> ReadyPorts() const override;
+  std::vector<Candidate> ReadyCandidates() const override;
+  bool CandidatesAllocationDone() const override { return allocation_done_; }
+  void PruneAllPorts() override;
+
+ protected:
+  void UpdateIceParametersInternal() override;
+
+ private:
+  void CreatePort();
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const rtc::PacketTime& packet_time);
+  void OnPortComplete(Port* port);
+  void OnPortDestroyed(PortInterface* port);
+
+  rtc::Thread* const network_thread_;
+  rtc::PacketSocketFactory* const socket_factory_;
+  rtc::Network* const network_;
+  SharedUdpSocket* const shared_socket_;
+  // Declared before |port_|, which sends on it until it is destroyed.
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  std::unique_ptr<UDPPort> port_;
+  std::vector<PortInterface*> ready_ports_;
+  std::vector<Candidate> candidates_;
+  bool running_ = false;
+  bool allocation_done_ = false;
+};
+
+}  // namespace cricket
+
+#endif  // WEBRTC_P2P_CLIENT_SHAREDUDPPORTALLOCATOR_H_
@@ -0,0 +1,188 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "webrtc/base/asyncudpsocket.h"
+#include "webrtc/base/gunit.h"
+#include "webrtc/base/physicalsocketserver.h"
+#include "webrtc/base/thread.h"
+#include "webrtc/base/virtualsocketserver.h"
+#include "webrtc/p2p/base/fakeportallocator.h"
+#include "webrtc/p2p/base/p2ptransportchannel.h"
+#include "webrtc/p2p/client/sharedudpportallocator.h"
+
+namespace cricket {
+
+namespace {
+
+const int kTimeoutMs = 5000;
+const rtc::SocketAddress kServerAddr("11.11.11.11", 3478);
+const char kContentName[] = "data";
+
+IceParameters MakeIceParameters(const std::string& prefix, int i) {
+  std::string suffix = std::to_string(i);
+  return IceParameters(prefix + suffix, "TESTICEPWD0000000000000" + suffix,
+                       false);
+}
+
+}  // namespace
+
+class SharedUdpPortAllocatorTest : public testing::Test,
+                                   public sigslot::has_slots<> {
+ public:
+  SharedUdpPortAllocatorTest()
+      : pss_(new rtc::PhysicalSocketServer),
+        vss_(new rtc::VirtualSocketServer(pss_.get())),
+        ss_scope_(vss_.get()),
+        allocator_(rtc::Thread::Current(),
+                   rtc::AsyncUDPSocket::Create(vss_.get(), kServerAddr)),
+        client_allocator_(rtc::Thread::Current(), nullptr) {
+    allocator_.Initialize();
+    client_allocator_.Initialize();
+  }
+
+ protected:
+  std::unique_ptr<PortAllocatorSession> CreateSession(
+      const IceParameters& ice) {
+    std::unique_ptr<PortAllocatorSession> session = allocator_.CreateSession(
+        kContentName, ICE_CANDIDATE_COMPONENT_RTP, ice.ufrag, ice.pwd);
+    session->StartGettingPorts();
+    return session;
+  }
+
+  // Creates a server channel on the shared socket and a client that only
+  // learns the server's candidates, like a client of an ICE lite server.
+  void CreateChannelPair(int i) {
+    IceParameters server_ice = MakeIceParameters("SRV", i);
+    IceParameters client_ice = MakeIceParameters("CLI", i);
+    P2PTransportChannel* server = new P2PTransportChannel(
+        kContentName, ICE_CANDIDATE_COMPONENT_RTP, &allocator_);
+    P2PTransportChannel* client = new P2PTransportChannel(
+        kContentName, ICE_CANDIDATE_COMPONENT_RTP, &client_allocator_);
+    servers_.emplace_back(server);
+    clients_.emplace_back(client);
+    clients_by_server_[server] = client;
+
+    server->SetIceRole(ICEROLE_CONTROLLED);
+    server->SetIceParameters(server_ice);
+    server->SetRemoteIceParameters(client_ice);
+    client->SetIceRole(ICEROLE_CONTROLLING);
+    client->SetIceParameters(client_ice);
+    client->SetRemoteIceParameters(server_ice);
+    server->SignalCandidateGathered.connect(
+        this, &SharedUdpPortAllocatorTest::OnServerCandidateGathered);
+    server->SignalReadPacket.connect(
+        this, &SharedUdpPortAllocatorTest::OnReadPacket);
+    client->SignalReadPacket.connect(
+        this, &SharedUdpPortAllocatorTest::OnReadPacket);
+    server->MaybeStartGathering();
+    client->MaybeStartGathering();
+  }
+
+  void OnServerCandidateGathered(IceTransportInternal* transport,
+                                 const Candidate& candidate) {
+    clients_by_server_[transport]->AddRemoteCandidate(candidate);
+  }
+
+  void OnReadPacket(rtc::PacketTransportInternal* transport,
+                    const char* data,
+                    size_t len,
+                    const rtc::PacketTime& packet_time,
+                    int flags) {
+    last_received_[transport].assign(data, len);
+  }
+
+  std::string last_received(rtc::PacketTransportInternal* transport) {
+    return last_received_[transport];
+  }
+
+  std::unique_ptr<rtc::PhysicalSocketServer> pss_;
+  std::unique_ptr<rtc::VirtualSocketServer> vss_;
+  rtc::SocketServerScope ss_scope_;
+  SharedUdpPortAllocator allocator_;
+  FakePortAllocator client_allocator_;
+  std::vector<std::unique_ptr<P2PTransportChannel>> servers_;
+  std::vector<std::unique_ptr<P2PTransportChannel>> clients_;
+  std::map<IceTransportInternal*, P2PTransportChannel*> clients_by_server_;
+  std::map<rtc::PacketTransportInternal*, std::string> last_received_;
+};
+
+TEST_F(SharedUdpPortAllocatorTest, SessionsShareOneSocket) {
+  const int kNumSessions = 100;
+  std::vector<std::unique_ptr<PortAllocatorSession>> sessions;
+  for (int i = 0; i < kNumSessions; ++i) {
+    sessions.push_back(CreateSession(MakeIceParameters("SRV", i)));
+    ASSERT_TRUE(sessions.back()->CandidatesAllocationDone());
+    ASSERT_EQ(1u, sessions.back()->ReadyPorts().size());
+    std::vector<Candidate> candidates = sessions.back()->ReadyCandidates();
+    ASSERT_EQ(1u, candidates.size());
+    EXPECT_EQ(LOCAL_PORT_TYPE, candidates[0].type());
+    EXPECT_EQ(kServerAddr, candidates[0].address());
+    EXPECT_EQ("SRV" + std::to_string(i), candidates[0].username());
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumSessions),
+            allocator_.shared_socket()->num_endpoints());
+
+  // The ufrag of a session can't be used by another one while it lives.
+  std::unique_ptr<PortAllocatorSession> duplicate =
+      CreateSession(MakeIceParameters("SRV", 0));
+  EXPECT_TRUE(duplicate->CandidatesAllocationDone());
+  EXPECT_TRUE(duplicate->ReadyPorts().empty());
+
+  sessions.clear();
+  EXPECT_EQ(0u, allocator_.shared_socket()->num_endpoints());
+}
+
+// A pooled session gets its port once it is taken from the pool, since
+// incoming checks are routed by its ICE ufrag.
+TEST_F(SharedUdpPortAllocatorTest, PooledSessionGetsPortWhenTaken) {
+  allocator_.SetConfiguration(ServerAddresses(),
+                              std::vector<RelayServerConfig>(), 1, false);
+  EXPECT_EQ(0u, allocator_.shared_socket()->num_endpoints());
+  IceParameters ice = MakeIceParameters("SRV", 0);
+  std::unique_ptr<PortAllocatorSession> session = allocator_.TakePooledSession(
+      kContentName, ICE_CANDIDATE_COMPONENT_RTP, ice.ufrag, ice.pwd);
+  ASSERT_TRUE(session);
+  ASSERT_EQ(1u, session->ReadyPorts().size());
+  EXPECT_EQ(ice.ufrag, session->ReadyCandidates()[0].username());
+  EXPECT_EQ(1u, allocator_.shared_socket()->num_endpoints());
+}
+
+// Clients connect to their own server channel, through one server socket.
+TEST_F(SharedUdpPortAllocatorTest, ConnectsClientsThroughSharedSocket) {
+  const int kNumClients = 3;
+  for (int i = 0; i < kNumClients; ++i)
+    CreateChannelPair(i);
+  for (int i = 0; i < kNumClients; ++i) {
+    EXPECT_TRUE_WAIT(clients_[i]->writable() && servers_[i]->writable(),
+                     kTimeoutMs);
+    ASSERT_TRUE(servers_[i]->selected_connection());
+    EXPECT_EQ(PRFLX_PORT_TYPE,
+              servers_[i]->selected_connection()->remote_candidate().type());
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumClients),
+            allocator_.shared_socket()->num_endpoints());
+
+  for (int i = 0; i < kNumClients; ++i) {
+    std::string data = "from client " + std::to_string(i);
+    clients_[i]->SendPacket(data.data(), data.size(), rtc::PacketOptions(), 0);
+    EXPECT_EQ_WAIT(data, last_received(servers_[i].get()), kTimeoutMs);
+    data = "from server " + std::to_string(i);
+    servers_[i]->SendPacket(data.data(), data.size(), rtc::PacketOptions(), 0);
+    EXPECT_EQ_WAIT(data, last_received(clients_[i].get()), kTimeoutMs);
+  }
+  EXPECT_EQ(0, allocator_.shared_socket()->dropped_packets());
+}
+
+}  // namespace cricket
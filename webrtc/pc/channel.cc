@@ -38,6 +38,9 @@ bool SetRawAudioSink_w(VoiceMediaChannel* channel,
   return true;
 }
 
+// SRTP_MAX_TRAILER_LEN in libsrtp: the largest auth tag plus MKI.
+const size_t kMaxSrtpTrailerLen = 16 + 128;
+
 struct SendPacketMessageData : public rtc::MessageData {
   rtc::CopyOnWriteBuffer packet;
   rtc::PacketOptions options;
@@ -585,6 +588,57 @@ bool BaseChannel::SetCryptoOptions(const rtc::CryptoOptions& crypto_options) {
   return true;
 }
 
+void BaseChannel::SetRtpForwarding(BaseChannel* target,
+                                   const RtpHeaderRewrite& rewrite) {
+  network_thread_->Invoke<void>(
+      RTC_FROM_HERE,
+      Bind(&BaseChannel::SetRtpForwarding_n, this, target, rewrite));
+}
+
+void BaseChannel::SetRtpForwarding_n(BaseChannel* target,
+                                     const RtpHeaderRewrite& rewrite) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  RTC_DCHECK(!target || target->network_thread_ == network_thread_);
+  rtp_forwarding_target_ = target;
+  rtp_forwarding_rewrite_ = rewrite;
+  if (target) {
+    // Leaves room for the largest SRTP trailer the target may append, so
+    // forwarding never reallocates.
+    forwarding_buffer_.EnsureCapacity(kMaxRtpPacketLen + kMaxSrtpTrailerLen);
+  }
+}
+
+bool BaseChannel::SendForwardedRtp_n(SrtpFilter* source,
+                                     const RtpHeaderRewrite& rewrite,
+                                     rtc::Buffer* packet) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  TRACE_EVENT0("webrtc", "BaseChannel::SendForwardedRtp_n");
+#if defined(ENABLE_EXTERNAL_AUTH)
+  // The auth tag would have to be written by the socket layer, which
+  // forwarded packets bypass.
+  LOG(LS_WARNING) << "Forwarding RTP is not supported with external auth.";
+  return false;
+#else
+  if (!rtp_packet_transport_ || !rtp_packet_transport_->writable() ||
+      !srtp_filter_.IsActive()) {
+    return false;
+  }
+  int len = 0;
+  if (!srtp_filter_.ForwardRtp(source, rewrite, packet->data(),
+                               static_cast<int>(packet->size()),
+                               static_cast<int>(packet->capacity()), &len)) {
+    LOG(LS_ERROR) << "Failed to forward " << content_name_
+                  << " RTP packet: size=" << packet->size();
+    return false;
+  }
+  packet->SetSize(len);
+  int flags = (secure() && secure_dtls()) ? PF_SRTP_BYPASS : PF_NORMAL;
+  int ret = rtp_packet_transport_->SendPacket(
+      packet->data<char>(), packet->size(), rtc::PacketOptions(), flags);
+  return ret == static_cast<int>(packet->size());
+#endif
+}
+
 void BaseChannel::OnWritableState(rtc::PacketTransportInternal* transport) {
   RTC_DCHECK(transport == rtp_packet_transport_ ||
              transport == rtcp_packet_transport_);
@@ -604,6 +658,17 @@ void BaseChannel::OnPacketRead(rtc::PacketTransportInternal* transport,
   // When using RTCP multiplexing we might get RTCP packets on the RTP
   // transport. We feed RTP traffic into the demuxer to determine if it is RTCP.
   bool rtcp = PacketIsRtcp(transport, data, len);
+  if (!rtcp && rtp_forwarding_target_ && srtp_filter_.IsActive()) {
+    // Forwarded packets don't reach the media channel, and are only
+    // unprotected in |forwarding_buffer_| on their way to the target.
+    if (len < kMinRtpPacketLen || len > kMaxRtpPacketLen) {
+      return;
+    }
+    forwarding_buffer_.SetData(data, len);
+    rtp_forwarding_target_->SendForwardedRtp_n(
+        &srtp_filter_, rtp_forwarding_rewrite_, &forwarding_buffer_);
+    return;
+  }
   rtc::CopyOnWriteBuffer packet(data, len);
   HandlePacket(rtcp, &packet, packet_time);
 }
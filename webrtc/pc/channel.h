@@ -21,6 +21,7 @@
 #include "webrtc/api/call/audio_sink.h"
 #include "webrtc/base/asyncinvoker.h"
 #include "webrtc/base/asyncudpsocket.h"
+#include "webrtc/base/buffer.h"
 #include "webrtc/base/criticalsection.h"
 #include "webrtc/base/network.h"
 #include "webrtc/base/sigslot.h"
@@ -203,6 +204,13 @@ class BaseChannel
 
   bool SetCryptoOptions(const rtc::CryptoOptions& crypto_options);
 
+  // Forwards the RTP packets received by this channel to |target| with
+  // SrtpFilter::ForwardRtp, instead of passing them to the media channel, for
+  // relaying media between peers. Both channels must use the same network
+  // thread, and forwarding must be stopped, by passing a null |target|,
+  // before |target| is destroyed. RTCP is still handled by this channel.
+  void SetRtpForwarding(BaseChannel* target, const RtpHeaderRewrite& rewrite);
+
   // This function returns true if we require SRTP for call setup.
   bool srtp_required_for_testing() const { return srtp_required_; }
 
@@ -284,6 +292,13 @@ class BaseChannel
   void OnPacketReceived(bool rtcp,
                         const rtc::CopyOnWriteBuffer& packet,
                         const rtc::PacketTime& packet_time);
+  void SetRtpForwarding_n(BaseChannel* target,
+                          const RtpHeaderRewrite& rewrite);
+  // Re-protects an SRTP packet received by |source| and sends it on this
+  // channel's RTP transport.
+  bool SendForwardedRtp_n(SrtpFilter* source,
+                          const RtpHeaderRewrite& rewrite,
+                          rtc::Buffer* packet);
 
   void EnableMedia_w();
   void DisableMedia_w();
@@ -423,6 +438,10 @@ class BaseChannel
   const bool srtp_required_ = true;
   rtc::CryptoOptions crypto_options_;
   int rtp_abs_sendtime_extn_id_ = -1;
+  BaseChannel* rtp_forwarding_target_ = nullptr;
+  RtpHeaderRewrite rtp_forwarding_rewrite_;
+  // Reused for every forwarded packet, so forwarding doesn't allocate.
+  rtc::Buffer forwarding_buffer_;
 
   // MediaChannel related members that should be accessed from the worker
   // thread.
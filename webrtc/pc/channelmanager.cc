@@ -114,16 +114,28 @@ bool ChannelManager::SetCryptoOptions_w(
 
 void ChannelManager::GetSupportedAudioSendCodecs(
     std::vector<AudioCodec>* codecs) const {
+  if (supported_codecs_) {
+    *codecs = supported_codecs_->audio_send_codecs;
+    return;
+  }
   *codecs = media_engine_->audio_send_codecs();
 }
 
 void ChannelManager::GetSupportedAudioReceiveCodecs(
     std::vector<AudioCodec>* codecs) const {
+  if (supported_codecs_) {
+    *codecs = supported_codecs_->audio_recv_codecs;
+    return;
+  }
   *codecs = media_engine_->audio_recv_codecs();
 }
 
 void ChannelManager::GetSupportedAudioRtpHeaderExtensions(
     RtpHeaderExtensions* ext) const {
+  if (supported_codecs_) {
+    *ext = supported_codecs_->audio_rtp_header_extensions;
+    return;
+  }
   *ext = media_engine_->GetAudioCapabilities().header_extensions;
 }
 
@@ -131,7 +143,8 @@ void ChannelManager::GetSupportedVideoCodecs(
     std::vector<VideoCodec>* codecs) const {
   codecs->clear();
 
-  std::vector<VideoCodec> video_codecs = media_engine_->video_codecs();
+  std::vector<VideoCodec> video_codecs = supported_codecs_ ?
+      supported_codecs_->video_codecs : media_engine_->video_codecs();
   for (const auto& video_codec : video_codecs) {
     if (!enable_rtx_ &&
         _stricmp(kRtxCodecName, video_codec.name.c_str()) == 0) {
@@ -143,14 +156,38 @@ void ChannelManager::GetSupportedVideoCodecs(
 
 void ChannelManager::GetSupportedVideoRtpHeaderExtensions(
     RtpHeaderExtensions* ext) const {
+  if (supported_codecs_) {
+    *ext = supported_codecs_->video_rtp_header_extensions;
+    return;
+  }
   *ext = media_engine_->GetVideoCapabilities().header_extensions;
 }
 
 void ChannelManager::GetSupportedDataCodecs(
     std::vector<DataCodec>* codecs) const {
+  if (supported_codecs_) {
+    *codecs = supported_codecs_->data_codecs;
+    return;
+  }
   *codecs = data_media_engine_->data_codecs();
 }
 
+void ChannelManager::CacheSupportedCodecs() {
+  RTC_DCHECK(main_thread_->IsCurrent());
+  if (supported_codecs_)
+    return;
+  std::unique_ptr<SupportedCodecs> supported_codecs(new SupportedCodecs());
+  supported_codecs->audio_send_codecs = media_engine_->audio_send_codecs();
+  supported_codecs->audio_recv_codecs = media_engine_->audio_recv_codecs();
+  supported_codecs->audio_rtp_header_extensions =
+      media_engine_->GetAudioCapabilities().header_extensions;
+  supported_codecs->video_codecs = media_engine_->video_codecs();
+  supported_codecs->video_rtp_header_extensions =
+      media_engine_->GetVideoCapabilities().header_extensions;
+  supported_codecs->data_codecs = data_media_engine_->data_codecs();
+  supported_codecs_ = std::move(supported_codecs);
+}
+
 bool ChannelManager::Init() {
   RTC_DCHECK(!initialized_);
   if (initialized_) {
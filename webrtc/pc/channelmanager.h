@@ -77,6 +77,11 @@ class ChannelManager {
   void GetSupportedVideoCodecs(std::vector<VideoCodec>* codecs) const;
   void GetSupportedVideoRtpHeaderExtensions(RtpHeaderExtensions* ext) const;
   void GetSupportedDataCodecs(std::vector<DataCodec>* codecs) const;
+  // Copies the codecs and RTP header extensions of the media engine, which
+  // may only be asked for them on its signaling thread. From then on the
+  // methods above return the copies and can be called on any thread, e.g. on
+  // the signaling threads of factory shards. Idempotent.
+  void CacheSupportedCodecs();
 
   // Indicates whether the media engine is started.
   bool initialized() const { return initialized_; }
@@ -185,8 +190,19 @@ class ChannelManager {
       bool srtp_required);
   void DestroyRtpDataChannel_w(RtpDataChannel* data_channel);
 
+  struct SupportedCodecs {
+    std::vector<AudioCodec> audio_send_codecs;
+    std::vector<AudioCodec> audio_recv_codecs;
+    RtpHeaderExtensions audio_rtp_header_extensions;
+    std::vector<VideoCodec> video_codecs;
+    RtpHeaderExtensions video_rtp_header_extensions;
+    std::vector<DataCodec> data_codecs;
+  };
+
   std::unique_ptr<MediaEngineInterface> media_engine_;
   std::unique_ptr<DataEngineInterface> data_media_engine_;
+  // Set once by CacheSupportedCodecs() and never changed afterwards.
+  std::unique_ptr<const SupportedCodecs> supported_codecs_;
   bool initialized_;
   rtc::Thread* main_thread_;
   rtc::Thread* worker_thread_;
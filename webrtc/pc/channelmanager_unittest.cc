@@ -182,4 +182,29 @@ TEST_F(ChannelManagerTest, SetVideoRtxEnabled) {
   EXPECT_TRUE(ContainsMatchingCodec(codecs, rtx_codec));
 }
 
+TEST_F(ChannelManagerTest, CacheSupportedCodecs) {
+  EXPECT_TRUE(cm_->SetVideoRtxEnabled(true));
+  cm_->CacheSupportedCodecs();
+  // The media engine isn't asked again.
+  fme_->SetAudioCodecs(std::vector<AudioCodec>());
+  fme_->SetVideoCodecs(std::vector<VideoCodec>());
+
+  // The copies can be read on another thread.
+  worker_.Start();
+  std::vector<AudioCodec> audio_codecs;
+  std::vector<VideoCodec> video_codecs;
+  worker_.Invoke<void>(RTC_FROM_HERE, [&] {
+    cm_->GetSupportedAudioSendCodecs(&audio_codecs);
+    cm_->GetSupportedVideoCodecs(&video_codecs);
+  });
+  EXPECT_EQ(MAKE_VECTOR(kAudioCodecs), audio_codecs);
+  EXPECT_EQ(MAKE_VECTOR(kVideoCodecs), video_codecs);
+
+  // RTX is still filtered when it is read.
+  EXPECT_TRUE(cm_->SetVideoRtxEnabled(false));
+  cm_->GetSupportedVideoCodecs(&video_codecs);
+  EXPECT_FALSE(ContainsMatchingCodec(video_codecs, VideoCodec(96, "rtx")));
+  EXPECT_EQ(2u, video_codecs.size());
+}
+
 }  // namespace cricket
@@ -748,8 +748,9 @@ bool PeerConnection::Initialize(
   // The port allocator lives on the network thread and should be initialized
   // there.
   if (!network_thread()->Invoke<bool>(
-          RTC_FROM_HERE, rtc::Bind(&PeerConnection::InitializePortAllocator_n,
-                                   this, configuration))) {
+          RTC_FROM_HERE,
+          rtc::Bind(&PeerConnection::InitializePortAllocator_n, this,
+                    configuration, factory_->options().network_ignore_mask))) {
     return false;
   }
 
@@ -2509,7 +2510,8 @@ DataChannel* PeerConnection::FindDataChannelBySid(int sid) const {
 }
 
 bool PeerConnection::InitializePortAllocator_n(
-    const RTCConfiguration& configuration) {
+    const RTCConfiguration& configuration,
+    int network_ignore_mask) {
   cricket::ServerAddresses stun_servers;
   std::vector<cricket::RelayServerConfig> turn_servers;
   if (ParseIceServers(configuration.servers, &stun_servers, &turn_servers) !=
@@ -2517,6 +2519,7 @@ bool PeerConnection::InitializePortAllocator_n(
     return false;
   }
 
+  port_allocator_->SetNetworkIgnoreMask(network_ignore_mask);
   port_allocator_->Initialize();
 
   // To handle both internal and externally created port allocator, we will
@@ -379,7 +379,8 @@ class PeerConnection : public PeerConnectionInterface,
   DataChannel* FindDataChannelBySid(int sid) const;
 
   // Called when first configuring the port allocator.
-  bool InitializePortAllocator_n(const RTCConfiguration& configuration);
+  bool InitializePortAllocator_n(const RTCConfiguration& configuration,
+                                 int network_ignore_mask);
   // Called when SetConfiguration is called to apply the supported subset
   // of the configuration on the network thread.
   bool ReconfigurePortAllocator_n(
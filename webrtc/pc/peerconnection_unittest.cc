@@ -2025,6 +2025,26 @@ TEST_F(P2PTestConductor, GetDtls12Recv) {
                                           kDefaultSrtpCryptoSuite));
 }
 
+// Test that a call works when both ends run the DTLS handshakes on handshake
+// threads and cache the DTLS sessions.
+TEST_F(P2PTestConductor, LocalP2PTestDtlsHandshakeThreads) {
+  PeerConnectionFactory::Options init_options;
+  init_options.dtls_handshake_threads = 2;
+  init_options.enable_dtls_session_resumption = true;
+  PeerConnectionFactory::Options recv_options = init_options;
+  ASSERT_TRUE(CreateTestClients(nullptr, &init_options, nullptr, nullptr,
+                                &recv_options, nullptr));
+  LocalP2PTest();
+
+  EXPECT_TRUE_WAIT(
+      rtc::SSLStreamAdapter::IsAcceptableCipher(
+          initializing_client()->GetDtlsCipherStats(), rtc::KT_DEFAULT),
+      kMaxWaitForStatsMs);
+  EXPECT_EQ_WAIT(rtc::SrtpCryptoSuiteToName(kDefaultSrtpCryptoSuite),
+                 initializing_client()->GetSrtpCipherStats(),
+                 kMaxWaitForStatsMs);
+}
+
 // Test that a non-GCM cipher is used if both sides only support non-GCM.
 TEST_F(P2PTestConductor, GetGcmNone) {
   TestGcmNegotiation(false, false, kDefaultSrtpCryptoSuite);
@@ -10,6 +10,7 @@
 
 #include "webrtc/pc/peerconnectionfactory.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "webrtc/api/audio_codecs/builtin_audio_decoder_factory.h"
@@ -21,6 +22,7 @@
 #include "webrtc/api/videosourceproxy.h"
 #include "webrtc/base/bind.h"
 #include "webrtc/base/checks.h"
+#include "webrtc/base/sslstreamadapter.h"
 #include "webrtc/media/engine/webrtcmediaengine.h"
 #include "webrtc/media/engine/webrtcvideodecoderfactory.h"
 #include "webrtc/media/engine/webrtcvideoencoderfactory.h"
@@ -36,6 +38,14 @@
 
 namespace webrtc {
 
+namespace {
+
+// Number of peers whose DTLS sessions are cached if
+// |Options::enable_dtls_session_resumption| is set.
+const size_t kMaxDtlsSessions = 1000;
+
+}  // namespace
+
 rtc::scoped_refptr<PeerConnectionFactoryInterface> CreatePeerConnectionFactory(
     rtc::scoped_refptr<AudioEncoderFactory> audio_encoder_factory,
     rtc::scoped_refptr<AudioDecoderFactory> audio_decoder_factory) {
@@ -177,6 +187,22 @@ PeerConnectionFactory::PeerConnectionFactory(
   // RTC_DCHECK(default_adm != NULL);
 }
 
+PeerConnectionFactory::PeerConnectionFactory(ShardTag,
+                                             PeerConnectionFactory* parent,
+                                             rtc::Thread* signaling_thread)
+    : owns_ptrs_(false),
+      wraps_current_thread_(false),
+      network_thread_(parent->network_thread_),
+      worker_thread_(parent->worker_thread_),
+      signaling_thread_(signaling_thread),
+      options_(parent->options_),
+      certificate_pool_(parent->certificate_pool_),
+      dtls_handshake_threads_(parent->dtls_handshake_threads_),
+      dtls_session_cache_(parent->dtls_session_cache_),
+      parent_(parent->root()) {
+  RTC_DCHECK(signaling_thread);
+}
+
 PeerConnectionFactory::~PeerConnectionFactory() {
   RTC_DCHECK(signaling_thread_->IsCurrent());
   channel_manager_.reset(nullptr);
@@ -186,6 +212,16 @@ PeerConnectionFactory::~PeerConnectionFactory() {
   default_socket_factory_ = nullptr;
   default_network_manager_ = nullptr;
 
+  // Pending certificate generations reference the pool and are discarded when
+  // the thread is stopped.
+  certificate_pool_ = nullptr;
+  certificate_thread_.reset();
+
+  if (parent_) {
+    parent_->signaling_thread_->Invoke<void>(RTC_FROM_HERE,
+                                             [this] { parent_ = nullptr; });
+  }
+
   if (owns_ptrs_) {
     if (wraps_current_thread_)
       rtc::ThreadManager::Instance()->UnwrapCurrentThread();
@@ -228,9 +264,40 @@ bool PeerConnectionFactory::Initialize() {
 
 void PeerConnectionFactory::SetOptions(const Options& options) {
   options_ = options;
+  if (parent_) {
+    // The media engine and the certificate pool belong to the parent.
+    return;
+  }
   if (channel_manager_) {
     channel_manager_->SetCryptoOptions(options.crypto_options);
   }
+  if (options.certificate_pool_size > 0 && !certificate_pool_) {
+    certificate_thread_ = rtc::Thread::Create();
+    certificate_thread_->SetName("certificate_thread", nullptr);
+    certificate_thread_->Start();
+    certificate_pool_ = new rtc::RefCountedObject<rtc::RTCCertificatePool>(
+        certificate_thread_.get());
+  }
+  if (certificate_pool_) {
+    certificate_pool_->SetPoolSize(
+        rtc::KeyParams(),
+        static_cast<size_t>(std::max(options.certificate_pool_size, 0)));
+  }
+  // The threads are kept when the option is lowered, since the transports of
+  // existing PeerConnections may use them.
+  while (owned_dtls_handshake_threads_.size() <
+         static_cast<size_t>(std::max(options.dtls_handshake_threads, 0))) {
+    std::unique_ptr<rtc::Thread> thread = rtc::Thread::Create();
+    thread->SetName("dtls_handshake_thread", nullptr);
+    thread->Start();
+    dtls_handshake_threads_.push_back(thread.get());
+    owned_dtls_handshake_threads_.push_back(std::move(thread));
+  }
+  if (options.enable_dtls_session_resumption && !owned_dtls_session_cache_) {
+    owned_dtls_session_cache_.reset(
+        rtc::SSLSessionCache::Create(kMaxDtlsSessions));
+    dtls_session_cache_ = owned_dtls_session_cache_.get();
+  }
 }
 
 rtc::scoped_refptr<AudioSourceInterface>
@@ -276,12 +343,12 @@ PeerConnectionFactory::CreateVideoSource(
 bool PeerConnectionFactory::StartAecDump(rtc::PlatformFile file,
                                          int64_t max_size_bytes) {
   RTC_DCHECK(signaling_thread_->IsCurrent());
-  return channel_manager_->StartAecDump(file, max_size_bytes);
+  return channel_manager()->StartAecDump(file, max_size_bytes);
 }
 
 void PeerConnectionFactory::StopAecDump() {
   RTC_DCHECK(signaling_thread_->IsCurrent());
-  channel_manager_->StopAecDump();
+  channel_manager()->StopAecDump();
 }
 
 rtc::scoped_refptr<PeerConnectionInterface>
@@ -311,17 +378,15 @@ PeerConnectionFactory::CreatePeerConnection(
 
   if (!cert_generator.get()) {
     // No certificate generator specified, use the default one.
-    cert_generator.reset(
-        new rtc::RTCCertificateGenerator(signaling_thread_, network_thread_));
+    cert_generator.reset(new rtc::RTCCertificateGenerator(
+        signaling_thread_, network_thread_, certificate_pool_));
   }
 
   if (!allocator) {
     allocator.reset(new cricket::BasicPortAllocator(
-        default_network_manager_.get(), default_socket_factory_.get()));
+        root()->default_network_manager_.get(),
+        root()->default_socket_factory_.get()));
   }
-  network_thread_->Invoke<void>(
-      RTC_FROM_HERE, rtc::Bind(&cricket::PortAllocator::SetNetworkIgnoreMask,
-                               allocator.get(), options_.network_ignore_mask));
 
   rtc::scoped_refptr<PeerConnection> pc(
       new rtc::RefCountedObject<PeerConnection>(this));
@@ -333,6 +398,20 @@ PeerConnectionFactory::CreatePeerConnection(
   return PeerConnectionProxy::Create(signaling_thread(), pc);
 }
 
+rtc::scoped_refptr<PeerConnectionFactoryInterface>
+PeerConnectionFactory::CreateShard(rtc::Thread* signaling_thread) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  // The shard's sessions ask the shared channel manager for the supported
+  // codecs on the shard's signaling thread, and the media engine may only be
+  // asked on ours.
+  if (!parent_)
+    channel_manager_->CacheSupportedCodecs();
+  rtc::scoped_refptr<PeerConnectionFactory> shard(
+      new rtc::RefCountedObject<PeerConnectionFactory>(ShardTag(), this,
+                                                       signaling_thread));
+  return PeerConnectionFactoryProxy::Create(signaling_thread, shard);
+}
+
 rtc::scoped_refptr<MediaStreamInterface>
 PeerConnectionFactory::CreateLocalMediaStream(const std::string& label) {
   RTC_DCHECK(signaling_thread_->IsCurrent());
@@ -362,16 +441,29 @@ webrtc::MediaControllerInterface* PeerConnectionFactory::CreateMediaController(
     webrtc::RtcEventLog* event_log) const {
   RTC_DCHECK(signaling_thread_->IsCurrent());
   return MediaControllerInterface::Create(config, worker_thread_,
-                                          channel_manager_.get(), event_log);
+                                          channel_manager(), event_log);
 }
 
 cricket::TransportController* PeerConnectionFactory::CreateTransportController(
     cricket::PortAllocator* port_allocator,
     bool redetermine_role_on_ice_restart) {
   RTC_DCHECK(signaling_thread_->IsCurrent());
-  return new cricket::TransportController(signaling_thread_, network_thread_,
-                                          port_allocator,
-                                          redetermine_role_on_ice_restart);
+  cricket::TransportController* transport_controller =
+      new cricket::TransportController(signaling_thread_, network_thread_,
+                                       port_allocator,
+                                       redetermine_role_on_ice_restart);
+  size_t num_handshake_threads = std::min(
+      dtls_handshake_threads_.size(),
+      static_cast<size_t>(std::max(options_.dtls_handshake_threads, 0)));
+  if (num_handshake_threads > 0) {
+    transport_controller->SetDtlsHandshakeThreads(std::vector<rtc::Thread*>(
+        dtls_handshake_threads_.begin(),
+        dtls_handshake_threads_.begin() + num_handshake_threads));
+  }
+  if (options_.enable_dtls_session_resumption && dtls_session_cache_) {
+    transport_controller->SetSslSessionCache(dtls_session_cache_);
+  }
+  return transport_controller;
 }
 
 rtc::Thread* PeerConnectionFactory::signaling_thread() {
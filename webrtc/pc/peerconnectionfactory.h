@@ -13,6 +13,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "webrtc/api/mediastreaminterface.h"
 #include "webrtc/api/peerconnectioninterface.h"
@@ -25,6 +26,7 @@
 namespace rtc {
 class BasicNetworkManager;
 class BasicPacketSocketFactory;
+class SSLSessionCache;
 }
 
 namespace webrtc {
@@ -55,6 +57,9 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
       std::unique_ptr<rtc::RTCCertificateGeneratorInterface> cert_generator,
       PeerConnectionObserver* observer) override;
 
+  rtc::scoped_refptr<PeerConnectionFactoryInterface> CreateShard(
+      rtc::Thread* signaling_thread) override;
+
   bool Initialize();
 
   rtc::scoped_refptr<MediaStreamInterface>
@@ -106,6 +111,11 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
   virtual rtc::Thread* worker_thread();
   virtual rtc::Thread* network_thread();
   const Options& options() const { return options_; }
+  // The pool used by the default certificate generator, or null if
+  // |Options::certificate_pool_size| was never set.
+  rtc::RTCCertificatePool* certificate_pool() const {
+    return certificate_pool_.get();
+  }
 
  protected:
   PeerConnectionFactory(
@@ -121,10 +131,24 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
       cricket::WebRtcVideoEncoderFactory* video_encoder_factory,
       cricket::WebRtcVideoDecoderFactory* video_decoder_factory,
       rtc::scoped_refptr<AudioMixer> audio_mixer);
+
+  // Selects the shard constructor, so that calls meant for the other
+  // constructors can't resolve to it.
+  struct ShardTag {};
+  // Creates a shard of |parent|, see CreateShard().
+  PeerConnectionFactory(ShardTag,
+                        PeerConnectionFactory* parent,
+                        rtc::Thread* signaling_thread);
   virtual ~PeerConnectionFactory();
 
  private:
   std::unique_ptr<cricket::MediaEngineInterface> CreateMediaEngine_w();
+  // The factory which owns the media engine and the default network manager:
+  // the parent of a shard, or this factory.
+  PeerConnectionFactory* root() { return parent_ ? parent_.get() : this; }
+  cricket::ChannelManager* channel_manager() const {
+    return parent_ ? parent_->channel_manager_.get() : channel_manager_.get();
+  }
 
   bool owns_ptrs_;
   bool wraps_current_thread_;
@@ -147,6 +171,22 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
   // External audio mixer. This can be NULL. In that case, internal audio mixer
   // will be created and used.
   rtc::scoped_refptr<AudioMixer> external_audio_mixer_;
+  // Generates the pooled certificates, so that key generation doesn't delay
+  // the network thread.
+  std::unique_ptr<rtc::Thread> certificate_thread_;
+  rtc::scoped_refptr<rtc::RTCCertificatePool> certificate_pool_;
+  // Run the DTLS handshakes and cache the DTLS sessions of the
+  // PeerConnections, see |Options::dtls_handshake_threads| and
+  // |Options::enable_dtls_session_resumption|. Like the certificate pool, they
+  // belong to the parent of a shard, which only points to them. The threads
+  // are stopped before the cache is destroyed.
+  std::unique_ptr<rtc::SSLSessionCache> owned_dtls_session_cache_;
+  std::vector<std::unique_ptr<rtc::Thread>> owned_dtls_handshake_threads_;
+  std::vector<rtc::Thread*> dtls_handshake_threads_;
+  rtc::SSLSessionCache* dtls_session_cache_ = nullptr;
+  // Set if this factory is a shard. The reference is released on the
+  // signaling thread of the parent, since it may be the last one.
+  rtc::scoped_refptr<PeerConnectionFactory> parent_;
 };
 
 }  // namespace webrtc
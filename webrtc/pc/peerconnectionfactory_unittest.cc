@@ -8,13 +8,18 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "webrtc/api/mediastreaminterface.h"
+#include "webrtc/base/asyncinvoker.h"
+#include "webrtc/base/event.h"
 #include "webrtc/base/gunit.h"
 #include "webrtc/base/thread.h"
+#include "webrtc/base/timeutils.h"
 #include "webrtc/media/base/fakevideocapturer.h"
 #include "webrtc/media/engine/webrtccommon.h"
 #include "webrtc/media/engine/webrtcvoe.h"
@@ -25,6 +30,7 @@
 #endif
 #include "webrtc/pc/test/fakertccertificategenerator.h"
 #include "webrtc/pc/test/fakevideotrackrenderer.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 using webrtc::DataChannelInterface;
 using webrtc::FakeVideoTrackRenderer;
@@ -87,6 +93,29 @@ class NullPeerConnectionObserver : public PeerConnectionObserver {
       const webrtc::IceCandidateInterface* candidate) override {}
 };
 
+// Creates |num_peer_connections| PeerConnections with |factory| and adds the
+// time each creation took to |setup_times_us|.
+void CreatePeerConnections(PeerConnectionFactoryInterface* factory,
+                           int num_peer_connections,
+                           rtc::Thread* network_thread,
+                           std::vector<int64_t>* setup_times_us) {
+  NullPeerConnectionObserver observer;
+  webrtc::PeerConnectionInterface::RTCConfiguration config;
+  std::vector<rtc::scoped_refptr<PeerConnectionInterface>> pcs;
+  for (int i = 0; i < num_peer_connections; ++i) {
+    int64_t start_us = rtc::TimeMicros();
+    pcs.push_back(factory->CreatePeerConnection(
+        config,
+        std::unique_ptr<cricket::PortAllocator>(
+            new cricket::FakePortAllocator(network_thread, nullptr)),
+        std::unique_ptr<rtc::RTCCertificateGeneratorInterface>(
+            new FakeRTCCertificateGenerator()),
+        &observer));
+    setup_times_us->push_back(rtc::TimeMicros() - start_us);
+    EXPECT_TRUE(pcs.back());
+  }
+}
+
 }  // namespace
 
 class PeerConnectionFactoryTest : public testing::Test {
@@ -155,6 +184,85 @@ TEST(PeerConnectionFactoryTestInternal, CreatePCUsingInternalModules) {
   EXPECT_TRUE(pc.get() != nullptr);
 }
 
+// Creates PeerConnections from several threads at once, as a server does when
+// many calls start together: first all through one factory, then each thread
+// through its own shard. Prints the percentiles of the setup times.
+TEST(PeerConnectionFactoryTestInternal, JoinStormWithShards) {
+#ifdef WEBRTC_ANDROID
+  webrtc::InitializeAndroidObjects();
+#endif
+  const size_t kNumCallers = 4;
+  const int kPeerConnectionsPerCaller = 25;
+
+  std::unique_ptr<rtc::Thread> network_thread =
+      rtc::Thread::CreateWithSocketServer();
+  std::unique_ptr<rtc::Thread> worker_thread = rtc::Thread::Create();
+  std::unique_ptr<rtc::Thread> signaling_thread = rtc::Thread::Create();
+  network_thread->Start();
+  worker_thread->Start();
+  signaling_thread->Start();
+  rtc::scoped_refptr<PeerConnectionFactoryInterface> factory(
+      webrtc::CreatePeerConnectionFactory(
+          network_thread.get(), worker_thread.get(), signaling_thread.get(),
+          nullptr, nullptr, nullptr));
+  ASSERT_TRUE(factory);
+
+  for (bool sharded : {false, true}) {
+    std::vector<std::unique_ptr<rtc::Thread>> shard_threads;
+    std::vector<rtc::scoped_refptr<PeerConnectionFactoryInterface>> factories;
+    std::vector<std::unique_ptr<rtc::Thread>> callers;
+    std::vector<std::unique_ptr<rtc::Event>> done;
+    std::vector<std::vector<int64_t>> setup_times_us(kNumCallers);
+    for (size_t i = 0; i < kNumCallers; ++i) {
+      if (sharded) {
+        shard_threads.push_back(rtc::Thread::Create());
+        shard_threads.back()->Start();
+        factories.push_back(factory->CreateShard(shard_threads.back().get()));
+        ASSERT_TRUE(factories.back());
+      } else {
+        factories.push_back(factory);
+      }
+      callers.push_back(rtc::Thread::Create());
+      callers.back()->Start();
+      done.emplace_back(new rtc::Event(false, false));
+    }
+
+    rtc::AsyncInvoker invoker;
+    for (size_t i = 0; i < kNumCallers; ++i) {
+      PeerConnectionFactoryInterface* caller_factory = factories[i].get();
+      rtc::Thread* caller_network_thread = network_thread.get();
+      std::vector<int64_t>* caller_setup_times_us = &setup_times_us[i];
+      rtc::Event* caller_done = done[i].get();
+      invoker.AsyncInvoke<void>(RTC_FROM_HERE, callers[i].get(), [=] {
+        CreatePeerConnections(caller_factory, kPeerConnectionsPerCaller,
+                              caller_network_thread, caller_setup_times_us);
+        caller_done->Set();
+      });
+    }
+    for (const auto& caller_done : done) {
+      caller_done->Wait(rtc::Event::kForever);
+    }
+
+    std::vector<int64_t> all_setup_times_us;
+    for (const auto& caller_setup_times_us : setup_times_us) {
+      all_setup_times_us.insert(all_setup_times_us.end(),
+                                caller_setup_times_us.begin(),
+                                caller_setup_times_us.end());
+    }
+    ASSERT_EQ(kNumCallers * kPeerConnectionsPerCaller,
+              all_setup_times_us.size());
+    std::sort(all_setup_times_us.begin(), all_setup_times_us.end());
+    const std::string modifier = sharded ? "_sharded" : "";
+    webrtc::test::PrintResult(
+        "peerconnection_setup_time", modifier, "p50",
+        all_setup_times_us[all_setup_times_us.size() / 2], "us", false);
+    webrtc::test::PrintResult(
+        "peerconnection_setup_time", modifier, "p99",
+        all_setup_times_us[all_setup_times_us.size() * 99 / 100], "us",
+        false);
+  }
+}
+
 // This test verifies creation of PeerConnection with valid STUN and TURN
 // configuration. Also verifies the URL's parsed correctly as expected.
 TEST_F(PeerConnectionFactoryTest, CreatePCUsingIceServers) {
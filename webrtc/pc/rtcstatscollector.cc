@@ -569,6 +569,22 @@ void ProduceMediaStreamAndTrackStats(
 
 }  // namespace
 
+RTCStatsFilter::RTCStatsFilter() {}
+
+RTCStatsFilter::RTCStatsFilter(const RTCStatsFilter& other) = default;
+
+RTCStatsFilter::~RTCStatsFilter() {}
+
+RTCStatsCollector::FilteredRequest::FilteredRequest(
+    rtc::scoped_refptr<RTCStatsCollectorCallback> callback,
+    const RTCStatsFilter& filter)
+    : callback(callback), filter(filter) {}
+
+RTCStatsCollector::FilteredRequest::FilteredRequest(
+    const FilteredRequest& other) = default;
+
+RTCStatsCollector::FilteredRequest::~FilteredRequest() {}
+
 rtc::scoped_refptr<RTCStatsCollector> RTCStatsCollector::Create(
     PeerConnection* pc, int64_t cache_lifetime_us) {
   return rtc::scoped_refptr<RTCStatsCollector>(
@@ -583,6 +599,8 @@ RTCStatsCollector::RTCStatsCollector(PeerConnection* pc,
       network_thread_(pc->session()->network_thread()),
       num_pending_partial_reports_(0),
       partial_report_timestamp_us_(0),
+      gathered_sources_(0),
+      gathering_media_info_(false),
       cache_timestamp_us_(0),
       cache_lifetime_us_(cache_lifetime_us) {
   RTC_DCHECK(pc_);
@@ -592,6 +610,10 @@ RTCStatsCollector::RTCStatsCollector(PeerConnection* pc,
   RTC_DCHECK_GE(cache_lifetime_us_, 0);
   pc_->SignalDataChannelCreated.connect(
       this, &RTCStatsCollector::OnDataChannelCreated);
+  pc_->session()->SignalVoiceChannelDestroyed.connect(
+      this, &RTCStatsCollector::OnMediaChannelDestroyed);
+  pc_->session()->SignalVideoChannelDestroyed.connect(
+      this, &RTCStatsCollector::OnMediaChannelDestroyed);
 }
 
 RTCStatsCollector::~RTCStatsCollector() {
@@ -614,53 +636,27 @@ void RTCStatsCollector::GetStatsReport(
     // Only start gathering stats if we're not already gathering stats. In the
     // case of already gathering stats, |callback_| will be invoked when there
     // are no more pending partial reports.
+    StartGathering(kAllSources, rtc::Optional<uint32_t>());
+  }
+}
 
-    // "Now" using a system clock, relative to the UNIX epoch (Jan 1, 1970,
-    // UTC), in microseconds. The system clock could be modified and is not
-    // necessarily monotonically increasing.
-    int64_t timestamp_us = rtc::TimeUTCMicros();
-
-    num_pending_partial_reports_ = 2;
-    partial_report_timestamp_us_ = cache_now_us;
-
-    // Prepare |channel_name_pairs_| for use in
-    // |ProducePartialResultsOnNetworkThread|.
-    channel_name_pairs_.reset(new ChannelNamePairs());
-    if (pc_->session()->voice_channel()) {
-      channel_name_pairs_->voice = rtc::Optional<ChannelNamePair>(
-          ChannelNamePair(pc_->session()->voice_channel()->content_name(),
-                          pc_->session()->voice_channel()->transport_name()));
-    }
-    if (pc_->session()->video_channel()) {
-      channel_name_pairs_->video = rtc::Optional<ChannelNamePair>(
-          ChannelNamePair(pc_->session()->video_channel()->content_name(),
-                          pc_->session()->video_channel()->transport_name()));
-    }
-    if (pc_->session()->rtp_data_channel()) {
-      channel_name_pairs_->data =
-          rtc::Optional<ChannelNamePair>(ChannelNamePair(
-              pc_->session()->rtp_data_channel()->content_name(),
-              pc_->session()->rtp_data_channel()->transport_name()));
-    }
-    if (pc_->session()->sctp_content_name()) {
-      channel_name_pairs_->data = rtc::Optional<ChannelNamePair>(
-          ChannelNamePair(*pc_->session()->sctp_content_name(),
-                          *pc_->session()->sctp_transport_name()));
-    }
-    // Prepare |track_media_info_map_| for use in
-    // |ProducePartialResultsOnNetworkThread| and
-    // |ProducePartialResultsOnSignalingThread|.
-    track_media_info_map_.reset(PrepareTrackMediaInfoMap_s().release());
-    // Prepare |track_to_id_| for use in |ProducePartialResultsOnNetworkThread|.
-    // This avoids a possible deadlock if |MediaStreamTrackInterface::id| is
-    // implemented to invoke on the signaling thread.
-    track_to_id_ = PrepareTrackToID_s();
+void RTCStatsCollector::GetStatsReport(
+    rtc::scoped_refptr<RTCStatsCollectorCallback> callback,
+    const RTCStatsFilter& filter) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  RTC_DCHECK(callback);
 
-    invoker_.AsyncInvoke<void>(RTC_FROM_HERE, network_thread_,
-        rtc::Bind(&RTCStatsCollector::ProducePartialResultsOnNetworkThread,
-            rtc::scoped_refptr<RTCStatsCollector>(this), timestamp_us));
-    ProducePartialResultsOnSignalingThread(timestamp_us);
+  int64_t cache_now_us = rtc::TimeMicros();
+  if (cached_report_ &&
+      cache_now_us - cache_timestamp_us_ <= cache_lifetime_us_) {
+    callback->OnStatsDelivered(FilterReport(*cached_report_, filter));
+    return;
   }
+  filtered_requests_.push_back(FilteredRequest(callback, filter));
+  // If stats are already being gathered the request is served when they have
+  // been, see |DeliverFilteredReports|.
+  if (!num_pending_partial_reports_)
+    StartGathering(SourcesOfFilter(filter), filter.ssrc);
 }
 
 void RTCStatsCollector::ClearCachedStatsReport() {
@@ -679,15 +675,136 @@ void RTCStatsCollector::WaitForPendingRequest() {
   }
 }
 
+void RTCStatsCollector::StartGathering(int sources,
+                                       const rtc::Optional<uint32_t>& ssrc) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  RTC_DCHECK(!num_pending_partial_reports_);
+  // "Now" using a system clock, relative to the UNIX epoch (Jan 1, 1970,
+  // UTC), in microseconds. The system clock could be modified and is not
+  // necessarily monotonically increasing.
+  int64_t timestamp_us = rtc::TimeUTCMicros();
+
+  num_pending_partial_reports_ = (sources & kNetworkSources) ? 2 : 1;
+  partial_report_timestamp_us_ = rtc::TimeMicros();
+  gathered_sources_ = sources;
+  gathered_ssrc_ = ssrc;
+
+  // Prepare |channel_name_pairs_| for use in
+  // |ProducePartialResultsOnNetworkThread|.
+  channel_name_pairs_.reset(new ChannelNamePairs());
+  if (pc_->session()->voice_channel()) {
+    channel_name_pairs_->voice = rtc::Optional<ChannelNamePair>(
+        ChannelNamePair(pc_->session()->voice_channel()->content_name(),
+                        pc_->session()->voice_channel()->transport_name()));
+  }
+  if (pc_->session()->video_channel()) {
+    channel_name_pairs_->video = rtc::Optional<ChannelNamePair>(
+        ChannelNamePair(pc_->session()->video_channel()->content_name(),
+                        pc_->session()->video_channel()->transport_name()));
+  }
+  if (pc_->session()->rtp_data_channel()) {
+    channel_name_pairs_->data =
+        rtc::Optional<ChannelNamePair>(ChannelNamePair(
+            pc_->session()->rtp_data_channel()->content_name(),
+            pc_->session()->rtp_data_channel()->transport_name()));
+  }
+  if (pc_->session()->sctp_content_name()) {
+    channel_name_pairs_->data = rtc::Optional<ChannelNamePair>(
+        ChannelNamePair(*pc_->session()->sctp_content_name(),
+                        *pc_->session()->sctp_transport_name()));
+  }
+  if (sources & kMediaSources) {
+    // Prepare |track_to_id_| for use in
+    // |ProducePartialResultsOnNetworkThread|. This avoids a possible deadlock
+    // if |MediaStreamTrackInterface::id| is implemented to invoke on the
+    // signaling thread.
+    track_to_id_ = PrepareTrackToID_s();
+    cricket::VoiceChannel* voice_channel = pc_->session()->voice_channel();
+    cricket::VideoChannel* video_channel = pc_->session()->video_channel();
+    if (voice_channel || video_channel) {
+      gathering_media_info_ = true;
+      invoker_.AsyncInvoke<void>(RTC_FROM_HERE, worker_thread_,
+          rtc::Bind(&RTCStatsCollector::GatherMediaInfo_w,
+              rtc::scoped_refptr<RTCStatsCollector>(this), voice_channel,
+              video_channel, timestamp_us));
+      return;
+    }
+    // Prepare |track_media_info_map_| for use in
+    // |ProducePartialResultsOnNetworkThread| and
+    // |ProducePartialResultsOnSignalingThread|.
+    track_media_info_map_ = PrepareTrackMediaInfoMap_s(nullptr, nullptr);
+  }
+  ProducePartialResults_s(timestamp_us);
+}
+
+void RTCStatsCollector::GatherMediaInfo_w(
+    cricket::VoiceChannel* voice_channel,
+    cricket::VideoChannel* video_channel,
+    int64_t timestamp_us) {
+  RTC_DCHECK(worker_thread_->IsCurrent());
+  // The channels' |GetStats| run directly on the worker thread.
+  if (voice_channel) {
+    voice_media_info_.reset(new cricket::VoiceMediaInfo());
+    if (!voice_channel->GetStats(voice_media_info_.get()))
+      voice_media_info_.reset();
+  }
+  if (video_channel) {
+    video_media_info_.reset(new cricket::VideoMediaInfo());
+    if (!video_channel->GetStats(video_media_info_.get()))
+      video_media_info_.reset();
+  }
+  invoker_.AsyncInvoke<void>(RTC_FROM_HERE, signaling_thread_,
+      rtc::Bind(&RTCStatsCollector::OnMediaInfoGathered_s,
+          rtc::scoped_refptr<RTCStatsCollector>(this), timestamp_us));
+}
+
+void RTCStatsCollector::OnMediaInfoGathered_s(int64_t timestamp_us) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  RTC_DCHECK(gathering_media_info_);
+  gathering_media_info_ = false;
+  track_media_info_map_ = PrepareTrackMediaInfoMap_s(
+      std::move(voice_media_info_), std::move(video_media_info_));
+  ProducePartialResults_s(timestamp_us);
+}
+
+void RTCStatsCollector::ProducePartialResults_s(int64_t timestamp_us) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  if (gathered_sources_ & kNetworkSources) {
+    invoker_.AsyncInvoke<void>(RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&RTCStatsCollector::ProducePartialResultsOnNetworkThread,
+            rtc::scoped_refptr<RTCStatsCollector>(this), timestamp_us));
+  }
+  ProducePartialResultsOnSignalingThread(timestamp_us);
+}
+
 void RTCStatsCollector::ProducePartialResultsOnSignalingThread(
     int64_t timestamp_us) {
   RTC_DCHECK(signaling_thread_->IsCurrent());
   rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(
       timestamp_us);
 
-  ProduceDataChannelStats_s(timestamp_us, report.get());
-  ProduceMediaStreamAndTrackStats_s(timestamp_us, report.get());
-  ProducePeerConnectionStats_s(timestamp_us, report.get());
+  if (gathered_sources_ & kSignalingSources) {
+    ProduceDataChannelStats_s(timestamp_us, report.get());
+    ProducePeerConnectionStats_s(timestamp_us, report.get());
+  }
+  if (gathered_sources_ & kMediaSources) {
+    ProduceMediaStreamAndTrackStats_s(timestamp_us, report.get());
+    if (!(gathered_sources_ & kNetworkSources)) {
+      // The session stats are not gathered, so the transports of the media
+      // channels are looked up by name like |WebRtcSession::GetStats| does.
+      std::map<std::string, std::string> proxy_to_transport;
+      for (const rtc::Optional<ChannelNamePair>* channel_name_pair :
+           {&channel_name_pairs_->voice, &channel_name_pairs_->video}) {
+        if (*channel_name_pair) {
+          proxy_to_transport[(*channel_name_pair)->content_name] =
+              (*channel_name_pair)->transport_name;
+        }
+      }
+      ProduceCodecStats(timestamp_us, *track_media_info_map_, report.get());
+      ProduceRTPStreamStats(timestamp_us, proxy_to_transport,
+                            *track_media_info_map_, report.get());
+    }
+  }
 
   AddPartialResults(report);
 }
@@ -701,20 +818,25 @@ void RTCStatsCollector::ProducePartialResultsOnNetworkThread(
   std::unique_ptr<SessionStats> session_stats =
       pc_->session()->GetStats(*channel_name_pairs_);
   if (session_stats) {
-    std::map<std::string, CertificateStatsPair> transport_cert_stats =
+    const std::map<std::string, CertificateStatsPair>& transport_cert_stats =
         PrepareTransportCertificateStats_n(*session_stats);
 
     ProduceCertificateStats_n(
         timestamp_us, transport_cert_stats, report.get());
-    ProduceCodecStats_n(
-        timestamp_us, *track_media_info_map_, report.get());
     ProduceIceCandidateAndPairStats_n(
-        timestamp_us, *session_stats, track_media_info_map_->video_media_info(),
+        timestamp_us, *session_stats,
+        track_media_info_map_ ? track_media_info_map_->video_media_info()
+                              : nullptr,
         report.get());
-    ProduceRTPStreamStats_n(
-        timestamp_us, *session_stats, *track_media_info_map_, report.get());
     ProduceTransportStats_n(
         timestamp_us, *session_stats, transport_cert_stats, report.get());
+    if (gathered_sources_ & kMediaSources) {
+      ProduceCodecStats(
+          timestamp_us, *track_media_info_map_, report.get());
+      ProduceRTPStreamStats(
+          timestamp_us, session_stats->proxy_to_transport,
+          *track_media_info_map_, report.get());
+    }
   }
 
   AddPartialResults(report);
@@ -742,13 +864,18 @@ void RTCStatsCollector::AddPartialResults_s(
     partial_report_->TakeMembersFrom(partial_report);
   --num_pending_partial_reports_;
   if (!num_pending_partial_reports_) {
-    cache_timestamp_us_ = partial_report_timestamp_us_;
-    cached_report_ = partial_report_;
+    rtc::scoped_refptr<const RTCStatsReport> report = partial_report_;
     partial_report_ = nullptr;
     channel_name_pairs_.reset();
     track_media_info_map_.reset();
     track_to_id_.clear();
-    DeliverCachedReport();
+    if (gathered_sources_ == kAllSources && !gathered_ssrc_) {
+      cache_timestamp_us_ = partial_report_timestamp_us_;
+      cached_report_ = report;
+      if (!callbacks_.empty())
+        DeliverCachedReport();
+    }
+    DeliverFilteredReports(report, gathered_sources_, gathered_ssrc_);
   }
 }
 
@@ -763,6 +890,85 @@ void RTCStatsCollector::DeliverCachedReport() {
   callbacks_.clear();
 }
 
+void RTCStatsCollector::DeliverFilteredReports(
+    const rtc::scoped_refptr<const RTCStatsReport>& report,
+    int sources,
+    const rtc::Optional<uint32_t>& ssrc) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  std::vector<FilteredRequest> requests;
+  requests.swap(filtered_requests_);
+  for (const FilteredRequest& request : requests) {
+    // Requests made while stats of fewer components or streams were being
+    // gathered wait for the next report.
+    if ((SourcesOfFilter(request.filter) & ~sources) ||
+        (ssrc && request.filter.ssrc != ssrc)) {
+      filtered_requests_.push_back(request);
+      continue;
+    }
+    request.callback->OnStatsDelivered(FilterReport(*report, request.filter));
+  }
+  // A callback may have made a request which started gathering stats.
+  if (num_pending_partial_reports_)
+    return;
+  if (!callbacks_.empty()) {
+    StartGathering(kAllSources, rtc::Optional<uint32_t>());
+  } else if (!filtered_requests_.empty()) {
+    const RTCStatsFilter& filter = filtered_requests_.front().filter;
+    StartGathering(SourcesOfFilter(filter), filter.ssrc);
+  }
+}
+
+int RTCStatsCollector::SourcesOfFilter(const RTCStatsFilter& filter) {
+  if (filter.types.empty())
+    return kAllSources;
+  int sources = 0;
+  for (const std::string& type : filter.types) {
+    if (type == RTCDataChannelStats::kType ||
+        type == RTCPeerConnectionStats::kType) {
+      sources |= kSignalingSources;
+    } else if (type == RTCMediaStreamStats::kType ||
+               type == RTCMediaStreamTrackStats::kType ||
+               type == RTCCodecStats::kType ||
+               type == RTCInboundRTPStreamStats::kType ||
+               type == RTCOutboundRTPStreamStats::kType) {
+      sources |= kMediaSources;
+    } else if (type == RTCIceCandidatePairStats::kType) {
+      // The bandwidth estimations of the selected candidate pair are part of
+      // the stats of the video channel.
+      sources |= kNetworkSources | kMediaSources;
+    } else if (type == RTCTransportStats::kType ||
+               type == RTCLocalIceCandidateStats::kType ||
+               type == RTCRemoteIceCandidateStats::kType ||
+               type == RTCCertificateStats::kType) {
+      sources |= kNetworkSources;
+    }
+  }
+  return sources;
+}
+
+rtc::scoped_refptr<const RTCStatsReport> RTCStatsCollector::FilterReport(
+    const RTCStatsReport& report, const RTCStatsFilter& filter) {
+  rtc::scoped_refptr<RTCStatsReport> filtered_report =
+      RTCStatsReport::Create(report.timestamp_us());
+  for (const RTCStats& stats : report) {
+    if (!filter.types.empty() &&
+        filter.types.find(stats.type()) == filter.types.end()) {
+      continue;
+    }
+    if (filter.ssrc && (stats.type() == RTCInboundRTPStreamStats::kType ||
+                        stats.type() == RTCOutboundRTPStreamStats::kType)) {
+      const RTCRTPStreamStats& rtp_stream_stats =
+          static_cast<const RTCRTPStreamStats&>(stats);
+      if (!rtp_stream_stats.ssrc.is_defined() ||
+          *rtp_stream_stats.ssrc != *filter.ssrc) {
+        continue;
+      }
+    }
+    filtered_report->AddStats(stats.copy());
+  }
+  return filtered_report;
+}
+
 void RTCStatsCollector::ProduceCertificateStats_n(
     int64_t timestamp_us,
     const std::map<std::string, CertificateStatsPair>& transport_cert_stats,
@@ -780,10 +986,9 @@ void RTCStatsCollector::ProduceCertificateStats_n(
   }
 }
 
-void RTCStatsCollector::ProduceCodecStats_n(
+void RTCStatsCollector::ProduceCodecStats(
     int64_t timestamp_us, const TrackMediaInfoMap& track_media_info_map,
     RTCStatsReport* report) const {
-  RTC_DCHECK(network_thread_->IsCurrent());
   // Audio
   if (track_media_info_map.voice_media_info()) {
     // Inbound
@@ -945,16 +1150,16 @@ void RTCStatsCollector::ProducePeerConnectionStats_s(
   report->AddStats(std::move(stats));
 }
 
-void RTCStatsCollector::ProduceRTPStreamStats_n(
-    int64_t timestamp_us, const SessionStats& session_stats,
+void RTCStatsCollector::ProduceRTPStreamStats(
+    int64_t timestamp_us,
+    const std::map<std::string, std::string>& proxy_to_transport,
     const TrackMediaInfoMap& track_media_info_map,
     RTCStatsReport* report) const {
-  RTC_DCHECK(network_thread_->IsCurrent());
 
   // Audio
   if (track_media_info_map.voice_media_info()) {
     std::string transport_id = RTCTransportStatsIDFromBaseChannel(
-        session_stats.proxy_to_transport, *pc_->session()->voice_channel());
+        proxy_to_transport, *pc_->session()->voice_channel());
     RTC_DCHECK(!transport_id.empty());
     // Inbound
     for (const cricket::VoiceReceiverInfo& voice_receiver_info :
@@ -963,6 +1168,8 @@ void RTCStatsCollector::ProduceRTPStreamStats_n(
       // is fixed.
       if (voice_receiver_info.ssrc() == 0)
         continue;
+      if (gathered_ssrc_ && voice_receiver_info.ssrc() != *gathered_ssrc_)
+        continue;
       std::unique_ptr<RTCInboundRTPStreamStats> inbound_audio(
           new RTCInboundRTPStreamStats(
               RTCInboundRTPStreamStatsIDFromSSRC(
@@ -991,6 +1198,8 @@ void RTCStatsCollector::ProduceRTPStreamStats_n(
       // is fixed.
       if (voice_sender_info.ssrc() == 0)
         continue;
+      if (gathered_ssrc_ && voice_sender_info.ssrc() != *gathered_ssrc_)
+        continue;
       std::unique_ptr<RTCOutboundRTPStreamStats> outbound_audio(
           new RTCOutboundRTPStreamStats(
               RTCOutboundRTPStreamStatsIDFromSSRC(
@@ -1016,7 +1225,7 @@ void RTCStatsCollector::ProduceRTPStreamStats_n(
   // Video
   if (track_media_info_map.video_media_info()) {
     std::string transport_id = RTCTransportStatsIDFromBaseChannel(
-        session_stats.proxy_to_transport, *pc_->session()->video_channel());
+        proxy_to_transport, *pc_->session()->video_channel());
     RTC_DCHECK(!transport_id.empty());
     // Inbound
     for (const cricket::VideoReceiverInfo& video_receiver_info :
@@ -1025,6 +1234,8 @@ void RTCStatsCollector::ProduceRTPStreamStats_n(
       // is fixed.
       if (video_receiver_info.ssrc() == 0)
         continue;
+      if (gathered_ssrc_ && video_receiver_info.ssrc() != *gathered_ssrc_)
+        continue;
       std::unique_ptr<RTCInboundRTPStreamStats> inbound_video(
           new RTCInboundRTPStreamStats(
               RTCInboundRTPStreamStatsIDFromSSRC(
@@ -1053,6 +1264,8 @@ void RTCStatsCollector::ProduceRTPStreamStats_n(
       // is fixed.
       if (video_sender_info.ssrc() == 0)
         continue;
+      if (gathered_ssrc_ && video_sender_info.ssrc() != *gathered_ssrc_)
+        continue;
       std::unique_ptr<RTCOutboundRTPStreamStats> outbound_video(
           new RTCOutboundRTPStreamStats(
               RTCOutboundRTPStreamStatsIDFromSSRC(
@@ -1143,49 +1356,54 @@ void RTCStatsCollector::ProduceTransportStats_n(
   }
 }
 
-std::map<std::string, RTCStatsCollector::CertificateStatsPair>
+const std::map<std::string, RTCStatsCollector::CertificateStatsPair>&
 RTCStatsCollector::PrepareTransportCertificateStats_n(
-    const SessionStats& session_stats) const {
+    const SessionStats& session_stats) {
   RTC_DCHECK(network_thread_->IsCurrent());
   std::map<std::string, CertificateStatsPair> transport_cert_stats;
   for (const auto& transport_stats : session_stats.transport_stats) {
+    const std::string& transport_name = transport_stats.second.transport_name;
+    auto previous_it = transport_cert_stats_.find(transport_name);
+    CertificateStatsPair* previous =
+        previous_it != transport_cert_stats_.end() ? &previous_it->second
+                                                   : nullptr;
     CertificateStatsPair certificate_stats_pair;
-    rtc::scoped_refptr<rtc::RTCCertificate> local_certificate;
     if (pc_->session()->GetLocalCertificate(
-        transport_stats.second.transport_name, &local_certificate)) {
-      certificate_stats_pair.local =
-          local_certificate->ssl_certificate().GetStats();
+        transport_name, &certificate_stats_pair.local_certificate)) {
+      if (previous && previous->local &&
+          previous->local_certificate ==
+              certificate_stats_pair.local_certificate) {
+        certificate_stats_pair.local = std::move(previous->local);
+      } else {
+        certificate_stats_pair.local = certificate_stats_pair
+            .local_certificate->ssl_certificate().GetStats();
+      }
     }
     std::unique_ptr<rtc::SSLCertificate> remote_certificate =
-        pc_->session()->GetRemoteSSLCertificate(
-            transport_stats.second.transport_name);
+        pc_->session()->GetRemoteSSLCertificate(transport_name);
     if (remote_certificate) {
-      certificate_stats_pair.remote = remote_certificate->GetStats();
+      remote_certificate->ToDER(&certificate_stats_pair.remote_certificate_der);
+      if (previous && previous->remote &&
+          previous->remote_certificate_der ==
+              certificate_stats_pair.remote_certificate_der) {
+        certificate_stats_pair.remote = std::move(previous->remote);
+      } else {
+        certificate_stats_pair.remote = remote_certificate->GetStats();
+      }
     }
     transport_cert_stats.insert(
-        std::make_pair(transport_stats.second.transport_name,
-                       std::move(certificate_stats_pair)));
+        std::make_pair(transport_name, std::move(certificate_stats_pair)));
   }
-  return transport_cert_stats;
+  // Transports which are gone are dropped.
+  transport_cert_stats_ = std::move(transport_cert_stats);
+  return transport_cert_stats_;
 }
 
 std::unique_ptr<TrackMediaInfoMap>
-RTCStatsCollector::PrepareTrackMediaInfoMap_s() const {
+RTCStatsCollector::PrepareTrackMediaInfoMap_s(
+    std::unique_ptr<cricket::VoiceMediaInfo> voice_media_info,
+    std::unique_ptr<cricket::VideoMediaInfo> video_media_info) const {
   RTC_DCHECK(signaling_thread_->IsCurrent());
-  std::unique_ptr<cricket::VoiceMediaInfo> voice_media_info;
-  if (pc_->session()->voice_channel()) {
-    voice_media_info.reset(new cricket::VoiceMediaInfo());
-    if (!pc_->session()->voice_channel()->GetStats(voice_media_info.get())) {
-      voice_media_info.reset();
-    }
-  }
-  std::unique_ptr<cricket::VideoMediaInfo> video_media_info;
-  if (pc_->session()->video_channel()) {
-    video_media_info.reset(new cricket::VideoMediaInfo());
-    if (!pc_->session()->video_channel()->GetStats(video_media_info.get())) {
-      video_media_info.reset();
-    }
-  }
   std::unique_ptr<TrackMediaInfoMap> track_media_info_map(
       new TrackMediaInfoMap(std::move(voice_media_info),
                             std::move(video_media_info),
@@ -1223,6 +1441,14 @@ void RTCStatsCollector::OnDataChannelCreated(DataChannel* channel) {
   channel->SignalClosed.connect(this, &RTCStatsCollector::OnDataChannelClosed);
 }
 
+void RTCStatsCollector::OnMediaChannelDestroyed() {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  // The channel is destroyed with a blocking invoke on the worker thread,
+  // which would run before a pending |GatherMediaInfo_w|, so that is run first.
+  if (gathering_media_info_)
+    invoker_.Flush(worker_thread_);
+}
+
 void RTCStatsCollector::OnDataChannelOpened(DataChannel* channel) {
   RTC_DCHECK(signaling_thread_->IsCurrent());
   bool result = internal_record_.opened_data_channels.insert(
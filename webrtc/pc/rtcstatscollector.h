@@ -14,14 +14,17 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include "webrtc/api/stats/rtcstats_objects.h"
 #include "webrtc/api/stats/rtcstatscollectorcallback.h"
 #include "webrtc/api/stats/rtcstatsreport.h"
 #include "webrtc/base/asyncinvoker.h"
+#include "webrtc/base/buffer.h"
 #include "webrtc/base/optional.h"
 #include "webrtc/base/refcount.h"
+#include "webrtc/base/rtccertificate.h"
 #include "webrtc/base/scoped_ref_ptr.h"
 #include "webrtc/base/sigslot.h"
 #include "webrtc/base/sslidentity.h"
@@ -32,6 +35,8 @@
 
 namespace cricket {
 class Candidate;
+class VideoChannel;
+class VoiceChannel;
 }  // namespace cricket
 
 namespace rtc {
@@ -44,6 +49,21 @@ class PeerConnection;
 struct SessionStats;
 struct ChannelNamePairs;
 
+// Selects the stats of a partial stats report, see
+// |RTCStatsCollector::GetStatsReport|.
+struct RTCStatsFilter {
+  RTCStatsFilter();
+  RTCStatsFilter(const RTCStatsFilter& other);
+  ~RTCStatsFilter();
+
+  // The |RTCStats::type|s of the stats to include. All types are included if
+  // this is empty.
+  std::set<std::string> types;
+  // If set, "inbound-rtp" and "outbound-rtp" stats are only included for
+  // this SSRC. Other types of stats are not affected.
+  rtc::Optional<uint32_t> ssrc;
+};
+
 // All public methods of the collector are to be called on the signaling thread.
 // Stats are gathered on the signaling, worker and network threads
 // asynchronously. The callback is invoked on the signaling thread. Resulting
@@ -60,6 +80,14 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   // considered fresh for |cache_lifetime_| ms. const RTCStatsReports are safe
   // to use across multiple threads and may be destructed on any thread.
   void GetStatsReport(rtc::scoped_refptr<RTCStatsCollectorCallback> callback);
+  // Gets a report with only the stats selected by |filter|. Only the threads
+  // and components the selected stats are produced from are visited, e.g. a
+  // report of "inbound-rtp" stats doesn't get the stats of the transports, so
+  // polling a few stats this way is much cheaper than getting a full report.
+  // A fresh cached full report is filtered if there is one. Partial reports
+  // are not cached.
+  void GetStatsReport(rtc::scoped_refptr<RTCStatsCollectorCallback> callback,
+                      const RTCStatsFilter& filter);
   // Clears the cache's reference to the most recent stats report. Subsequently
   // calling |GetStatsReport| guarantees fresh stats.
   void ClearCachedStatsReport();
@@ -85,10 +113,68 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   struct CertificateStatsPair {
     std::unique_ptr<rtc::SSLCertificateStats> local;
     std::unique_ptr<rtc::SSLCertificateStats> remote;
+    // The certificates |local| and |remote| were produced from. Producing the
+    // stats of a certificate involves hashing and base64 encoding it, so they
+    // are reused for as long as the certificates of the transport are the
+    // same.
+    rtc::scoped_refptr<rtc::RTCCertificate> local_certificate;
+    rtc::Buffer remote_certificate_der;
   };
 
+  // The components a report is produced from. Collecting the stats of a
+  // component may involve invoking on other threads, which only happens if
+  // stats produced from it are requested.
+  enum StatsSources {
+    // "data-channel" and "peer-connection" stats, produced on the signaling
+    // thread.
+    kSignalingSources = 1 << 0,
+    // "stream", "track", "codec", "inbound-rtp" and "outbound-rtp" stats,
+    // produced from the stats of the media channels, which are gotten from
+    // the worker thread.
+    kMediaSources = 1 << 1,
+    // "transport", "candidate-pair", "local-candidate", "remote-candidate" and
+    // "certificate" stats, produced on the network thread.
+    kNetworkSources = 1 << 2,
+    kAllSources = kSignalingSources | kMediaSources | kNetworkSources,
+  };
+
+  // A |GetStatsReport| request for a partial report.
+  struct FilteredRequest {
+    FilteredRequest(rtc::scoped_refptr<RTCStatsCollectorCallback> callback,
+                    const RTCStatsFilter& filter);
+    FilteredRequest(const FilteredRequest& other);
+    ~FilteredRequest();
+
+    rtc::scoped_refptr<RTCStatsCollectorCallback> callback;
+    RTCStatsFilter filter;
+  };
+
+  static int SourcesOfFilter(const RTCStatsFilter& filter);
+  // Returns the stats of |report| selected by |filter|.
+  static rtc::scoped_refptr<const RTCStatsReport> FilterReport(
+      const RTCStatsReport& report, const RTCStatsFilter& filter);
+
+  // Starts gathering the stats produced from |sources|. Stats of other RTP
+  // streams than |ssrc|, if set, are not produced.
+  void StartGathering(int sources, const rtc::Optional<uint32_t>& ssrc);
+  // Gets the stats of the media channels for |track_media_info_map_|. This is
+  // posted to the worker thread rather than invoked on it, so that the
+  // signaling thread isn't blocked while the media engine collects its stats,
+  // and continues with |OnMediaInfoGathered_s|.
+  void GatherMediaInfo_w(cricket::VoiceChannel* voice_channel,
+                         cricket::VideoChannel* video_channel,
+                         int64_t timestamp_us);
+  void OnMediaInfoGathered_s(int64_t timestamp_us);
+  // Starts producing the partial reports on the network and signaling threads.
+  void ProducePartialResults_s(int64_t timestamp_us);
   void AddPartialResults_s(rtc::scoped_refptr<RTCStatsReport> partial_report);
   void DeliverCachedReport();
+  // Delivers |report|, produced from |sources|, to the filtered requests it
+  // has the stats of. Gathering is restarted for the requests left, if any.
+  void DeliverFilteredReports(
+      const rtc::scoped_refptr<const RTCStatsReport>& report,
+      int sources,
+      const rtc::Optional<uint32_t>& ssrc);
 
   // Produces |RTCCertificateStats|.
   void ProduceCertificateStats_n(
@@ -96,7 +182,7 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
       const std::map<std::string, CertificateStatsPair>& transport_cert_stats,
       RTCStatsReport* report) const;
   // Produces |RTCCodecStats|.
-  void ProduceCodecStats_n(
+  void ProduceCodecStats(
       int64_t timestamp_us, const TrackMediaInfoMap& track_media_info_map,
       RTCStatsReport* report) const;
   // Produces |RTCDataChannelStats|.
@@ -113,9 +199,12 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   // Produces |RTCPeerConnectionStats|.
   void ProducePeerConnectionStats_s(
       int64_t timestamp_us, RTCStatsReport* report) const;
-  // Produces |RTCInboundRTPStreamStats| and |RTCOutboundRTPStreamStats|.
-  void ProduceRTPStreamStats_n(
-      int64_t timestamp_us, const SessionStats& session_stats,
+  // Produces |RTCInboundRTPStreamStats| and |RTCOutboundRTPStreamStats|. This
+  // is done on the network thread when transport stats are gathered too and
+  // on the signaling thread otherwise.
+  void ProduceRTPStreamStats(
+      int64_t timestamp_us,
+      const std::map<std::string, std::string>& proxy_to_transport,
       const TrackMediaInfoMap& track_media_info_map,
       RTCStatsReport* report) const;
   // Produces |RTCTransportStats|.
@@ -125,13 +214,17 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
       RTCStatsReport* report) const;
 
   // Helper function to stats-producing functions.
-  std::map<std::string, CertificateStatsPair>
-  PrepareTransportCertificateStats_n(const SessionStats& session_stats) const;
-  std::unique_ptr<TrackMediaInfoMap> PrepareTrackMediaInfoMap_s() const;
+  const std::map<std::string, CertificateStatsPair>&
+  PrepareTransportCertificateStats_n(const SessionStats& session_stats);
+  std::unique_ptr<TrackMediaInfoMap> PrepareTrackMediaInfoMap_s(
+      std::unique_ptr<cricket::VoiceMediaInfo> voice_media_info,
+      std::unique_ptr<cricket::VideoMediaInfo> video_media_info) const;
   std::map<MediaStreamTrackInterface*, std::string> PrepareTrackToID_s() const;
 
   // Slots for signals (sigslot) that are wired up to |pc_|.
   void OnDataChannelCreated(DataChannel* channel);
+  // Slots for signals (sigslot) that are wired up to |pc_->session()|.
+  void OnMediaChannelDestroyed();
   // Slots for signals (sigslot) that are wired up to |channel|.
   void OnDataChannelOpened(DataChannel* channel);
   void OnDataChannelClosed(DataChannel* channel);
@@ -146,6 +239,14 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   int64_t partial_report_timestamp_us_;
   rtc::scoped_refptr<RTCStatsReport> partial_report_;
   std::vector<rtc::scoped_refptr<RTCStatsCollectorCallback>> callbacks_;
+  std::vector<FilteredRequest> filtered_requests_;
+
+  // The |StatsSources| being gathered, and the SSRC of the RTP streams whose
+  // stats are gathered if only one stream's are. Set in |StartGathering| and
+  // read in |ProducePartialResultsOnNetworkThread| and
+  // |ProducePartialResultsOnSignalingThread|, like the members below.
+  int gathered_sources_;
+  rtc::Optional<uint32_t> gathered_ssrc_;
 
   // Set in |GetStatsReport|, read in |ProducePartialResultsOnNetworkThread| and
   // |ProducePartialResultsOnSignalingThread|, reset after work is complete. Not
@@ -154,6 +255,12 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   std::unique_ptr<ChannelNamePairs> channel_name_pairs_;
   std::unique_ptr<TrackMediaInfoMap> track_media_info_map_;
   std::map<MediaStreamTrackInterface*, std::string> track_to_id_;
+  // Whether |GatherMediaInfo_w| is in flight; a media channel must then not
+  // be destroyed before it has run. The media info is set on the worker
+  // thread and moved to |track_media_info_map_| on the signaling thread.
+  bool gathering_media_info_;
+  std::unique_ptr<cricket::VoiceMediaInfo> voice_media_info_;
+  std::unique_ptr<cricket::VideoMediaInfo> video_media_info_;
 
   // A timestamp, in microseconds, that is based on a timer that is
   // monotonically increasing. That is, even if the system clock is modified the
@@ -163,6 +270,10 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   int64_t cache_lifetime_us_;
   rtc::scoped_refptr<const RTCStatsReport> cached_report_;
 
+  // The certificate stats of each transport, by transport name, as of the last
+  // report. Only accessed on the network thread.
+  std::map<std::string, CertificateStatsPair> transport_cert_stats_;
+
   // Data recorded and maintained by the stats collector during its lifetime.
   // Some stats are produced from this record instead of other components.
   struct InternalRecord {
@@ -13,6 +13,7 @@
 #include <initializer_list>
 #include <memory>
 #include <ostream>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -22,12 +23,14 @@
 #include "webrtc/api/stats/rtcstatsreport.h"
 #include "webrtc/api/test/mock_rtpreceiver.h"
 #include "webrtc/api/test/mock_rtpsender.h"
+#include "webrtc/base/base64.h"
 #include "webrtc/base/checks.h"
 #include "webrtc/base/fakeclock.h"
 #include "webrtc/base/fakesslidentity.h"
 #include "webrtc/base/gunit.h"
 #include "webrtc/base/logging.h"
 #include "webrtc/base/socketaddress.h"
+#include "webrtc/base/stringencode.h"
 #include "webrtc/base/thread_checker.h"
 #include "webrtc/base/timedelta.h"
 #include "webrtc/base/timeutils.h"
@@ -42,6 +45,7 @@
 #include "webrtc/pc/test/mock_peerconnection.h"
 #include "webrtc/pc/test/mock_webrtcsession.h"
 #include "webrtc/pc/test/rtcstatsobtainer.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 using testing::_;
 using testing::Invoke;
@@ -171,6 +175,65 @@ std::unique_ptr<cricket::Candidate> CreateFakeCandidate(
   return candidate;
 }
 
+// A certificate which counts the digests computed of it, i.e. how many times
+// its stats were produced.
+class DigestCountingSSLCertificate : public rtc::FakeSSLCertificate {
+ public:
+  DigestCountingSSLCertificate(const std::string& der, int* num_digests)
+      : rtc::FakeSSLCertificate(rtc::SSLIdentity::DerToPem(
+            "CERTIFICATE",
+            reinterpret_cast<const unsigned char*>(der.c_str()),
+            der.length())),
+        num_digests_(num_digests) {}
+
+  DigestCountingSSLCertificate* GetReference() const override {
+    return new DigestCountingSSLCertificate(*this);
+  }
+  bool ComputeDigest(const std::string& algorithm,
+                     unsigned char* digest,
+                     size_t size,
+                     size_t* length) const override {
+    ++*num_digests_;
+    return rtc::FakeSSLCertificate::ComputeDigest(algorithm, digest, size,
+                                                  length);
+  }
+
+ private:
+  int* num_digests_;
+};
+
+class DigestCountingSSLIdentity : public rtc::SSLIdentity {
+ public:
+  explicit DigestCountingSSLIdentity(const DigestCountingSSLCertificate& cert)
+      : cert_(cert) {}
+
+  DigestCountingSSLIdentity* GetReference() const override {
+    return new DigestCountingSSLIdentity(*this);
+  }
+  const rtc::SSLCertificate& certificate() const override { return cert_; }
+  std::string PrivateKeyToPEMString() const override {
+    RTC_NOTREACHED();  // Not implemented.
+    return "";
+  }
+  std::string PublicKeyToPEMString() const override {
+    RTC_NOTREACHED();  // Not implemented.
+    return "";
+  }
+
+ private:
+  DigestCountingSSLCertificate cert_;
+};
+
+// Returns the base64 encoded DERs of the certificates in |report|.
+std::set<std::string> GetBase64Certificates(const RTCStatsReport& report) {
+  std::set<std::string> certificates;
+  for (const RTCCertificateStats* stats :
+       report.GetStatsOfType<RTCCertificateStats>()) {
+    certificates.insert(*stats->base64_certificate);
+  }
+  return certificates;
+}
+
 class FakeAudioTrackForStats
     : public MediaStreamTrack<AudioTrackInterface> {
  public:
@@ -632,6 +695,14 @@ class RTCStatsCollectorTest : public testing::Test {
     return callback->report();
   }
 
+  rtc::scoped_refptr<const RTCStatsReport> GetStatsReport(
+      const RTCStatsFilter& filter) {
+    rtc::scoped_refptr<RTCStatsObtainer> callback = RTCStatsObtainer::Create();
+    collector_->GetStatsReport(callback, filter);
+    EXPECT_TRUE_WAIT(callback->report(), kGetStatsReportTimeoutMs);
+    return callback->report();
+  }
+
   void ExpectReportContainsCertificateInfo(
       const rtc::scoped_refptr<const RTCStatsReport>& report,
       const CertificateInfo& certinfo) {
@@ -980,6 +1051,113 @@ TEST_F(RTCStatsCollectorTest, CollectRTCCertificateStatsChain) {
   ExpectReportContainsCertificateInfo(report, *remote_certinfo);
 }
 
+TEST_F(RTCStatsCollectorTest, CertificateStatsReusedWhileCertificatesAreSame) {
+  int num_digests = 0;
+  auto create_local_certificate = [&num_digests](const std::string& der) {
+    return rtc::RTCCertificate::Create(std::unique_ptr<rtc::SSLIdentity>(
+        new DigestCountingSSLIdentity(
+            DigestCountingSSLCertificate(der, &num_digests))));
+  };
+  rtc::scoped_refptr<rtc::RTCCertificate> local_certificate =
+      create_local_certificate("(local) certificate");
+  std::unique_ptr<rtc::SSLCertificate> remote_certificate(
+      new DigestCountingSSLCertificate("(remote) certificate", &num_digests));
+
+  EXPECT_CALL(test_->session(), GetStats(_)).WillRepeatedly(Invoke(
+      [](const ChannelNamePairs&) {
+        std::unique_ptr<SessionStats> stats(new SessionStats());
+        stats->transport_stats["transport"].transport_name = "transport";
+        return stats;
+      }));
+  EXPECT_CALL(test_->session(), GetLocalCertificate("transport", _))
+      .WillRepeatedly(Invoke(
+          [&local_certificate](const std::string&,
+                               rtc::scoped_refptr<rtc::RTCCertificate>*
+                                   certificate) {
+            *certificate = local_certificate;
+            return true;
+          }));
+  EXPECT_CALL(test_->session(),
+              GetRemoteSSLCertificate_ReturnsRawPointer("transport"))
+      .WillRepeatedly(Invoke([&remote_certificate](const std::string&) {
+        return remote_certificate->GetReference();
+      }));
+
+  rtc::scoped_refptr<const RTCStatsReport> report = GetStatsReport();
+  EXPECT_EQ(2, num_digests);
+  EXPECT_EQ(std::set<std::string>({rtc::Base64::Encode("(local) certificate"),
+                                   rtc::Base64::Encode("(remote) certificate")}),
+            GetBase64Certificates(*report));
+
+  // The stats of the same certificates are not produced again, even if the
+  // remote certificate is a new object with the same DER.
+  remote_certificate.reset(
+      new DigestCountingSSLCertificate("(remote) certificate", &num_digests));
+  collector_->ClearCachedStatsReport();
+  report = GetStatsReport();
+  EXPECT_EQ(2, num_digests);
+  EXPECT_EQ(std::set<std::string>({rtc::Base64::Encode("(local) certificate"),
+                                   rtc::Base64::Encode("(remote) certificate")}),
+            GetBase64Certificates(*report));
+}
+
+TEST_F(RTCStatsCollectorTest, CertificateStatsUpdatedWhenCertificatesChange) {
+  int num_digests = 0;
+  auto create_local_certificate = [&num_digests](const std::string& der) {
+    return rtc::RTCCertificate::Create(std::unique_ptr<rtc::SSLIdentity>(
+        new DigestCountingSSLIdentity(
+            DigestCountingSSLCertificate(der, &num_digests))));
+  };
+  rtc::scoped_refptr<rtc::RTCCertificate> local_certificate =
+      create_local_certificate("(local) certificate");
+  std::unique_ptr<rtc::SSLCertificate> remote_certificate(
+      new DigestCountingSSLCertificate("(remote) certificate", &num_digests));
+
+  EXPECT_CALL(test_->session(), GetStats(_)).WillRepeatedly(Invoke(
+      [](const ChannelNamePairs&) {
+        std::unique_ptr<SessionStats> stats(new SessionStats());
+        stats->transport_stats["transport"].transport_name = "transport";
+        return stats;
+      }));
+  EXPECT_CALL(test_->session(), GetLocalCertificate("transport", _))
+      .WillRepeatedly(Invoke(
+          [&local_certificate](const std::string&,
+                               rtc::scoped_refptr<rtc::RTCCertificate>*
+                                   certificate) {
+            *certificate = local_certificate;
+            return true;
+          }));
+  EXPECT_CALL(test_->session(),
+              GetRemoteSSLCertificate_ReturnsRawPointer("transport"))
+      .WillRepeatedly(Invoke([&remote_certificate](const std::string&) {
+        return remote_certificate->GetReference();
+      }));
+
+  rtc::scoped_refptr<const RTCStatsReport> report = GetStatsReport();
+  EXPECT_EQ(2, num_digests);
+
+  // A new local certificate.
+  local_certificate = create_local_certificate("(local) new certificate");
+  collector_->ClearCachedStatsReport();
+  report = GetStatsReport();
+  EXPECT_EQ(3, num_digests);
+  EXPECT_EQ(
+      std::set<std::string>({rtc::Base64::Encode("(local) new certificate"),
+                             rtc::Base64::Encode("(remote) certificate")}),
+      GetBase64Certificates(*report));
+
+  // A remote certificate with a different DER.
+  remote_certificate.reset(new DigestCountingSSLCertificate(
+      "(remote) new certificate", &num_digests));
+  collector_->ClearCachedStatsReport();
+  report = GetStatsReport();
+  EXPECT_EQ(4, num_digests);
+  EXPECT_EQ(
+      std::set<std::string>({rtc::Base64::Encode("(local) new certificate"),
+                             rtc::Base64::Encode("(remote) new certificate")}),
+      GetBase64Certificates(*report));
+}
+
 TEST_F(RTCStatsCollectorTest, CollectRTCDataChannelStats) {
   test_->data_channels().push_back(
       new MockDataChannel(
@@ -2249,6 +2427,274 @@ TEST_F(RTCStatsCollectorTest, CollectRTCTransportStats) {
       report->Get(expected_rtcp_transport.id())->cast_to<RTCTransportStats>());
 }
 
+TEST_F(RTCStatsCollectorTest, CollectFilteredSignalingStats) {
+  MockVoiceMediaChannel* voice_media_channel = new MockVoiceMediaChannel();
+  cricket::VoiceChannel voice_channel(
+      test_->worker_thread(), test_->network_thread(),
+      test_->signaling_thread(), test_->media_engine(), voice_media_channel,
+      "VoiceContentName", kDefaultRtcpMuxRequired, kDefaultSrtpRequired);
+  EXPECT_CALL(test_->session(), voice_channel())
+      .WillRepeatedly(Return(&voice_channel));
+
+  // Neither the media channels nor the transports are asked for stats.
+  EXPECT_CALL(*voice_media_channel, GetStats(_)).Times(0);
+  EXPECT_CALL(test_->session(), GetStats(_)).Times(0);
+
+  RTCStatsFilter filter;
+  filter.types.insert(RTCPeerConnectionStats::kType);
+  rtc::scoped_refptr<const RTCStatsReport> report = GetStatsReport(filter);
+  EXPECT_EQ(1u, report->size());
+  EXPECT_TRUE(report->Get("RTCPeerConnection"));
+}
+
+TEST_F(RTCStatsCollectorTest, CollectFilteredRTCInboundRTPStreamStats) {
+  MockVoiceMediaChannel* voice_media_channel = new MockVoiceMediaChannel();
+  cricket::VoiceChannel voice_channel(
+      test_->worker_thread(), test_->network_thread(),
+      test_->signaling_thread(), test_->media_engine(), voice_media_channel,
+      "VoiceContentName", kDefaultRtcpMuxRequired, kDefaultSrtpRequired);
+  EXPECT_CALL(test_->session(), voice_channel())
+      .WillRepeatedly(Return(&voice_channel));
+
+  cricket::VoiceMediaInfo voice_media_info;
+  for (uint32_t ssrc : {1, 2}) {
+    voice_media_info.receivers.push_back(cricket::VoiceReceiverInfo());
+    voice_media_info.receivers.back().local_stats.push_back(
+        cricket::SsrcReceiverInfo());
+    voice_media_info.receivers.back().local_stats[0].ssrc = ssrc;
+    voice_media_info.receivers.back().packets_rcvd = 10 * ssrc;
+  }
+  EXPECT_CALL(*voice_media_channel, GetStats(_))
+      .WillRepeatedly(DoAll(SetArgPointee<0>(voice_media_info), Return(true)));
+  // The transports are not asked for stats.
+  EXPECT_CALL(test_->session(), GetStats(_)).Times(0);
+
+  RTCStatsFilter filter;
+  filter.types.insert(RTCInboundRTPStreamStats::kType);
+  filter.ssrc = rtc::Optional<uint32_t>(2);
+  rtc::scoped_refptr<const RTCStatsReport> report = GetStatsReport(filter);
+  ASSERT_EQ(1u, report->size());
+  const RTCStats* stats = report->Get("RTCInboundRTPAudioStream_2");
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(20u, *stats->cast_to<RTCInboundRTPStreamStats>().packets_received);
+  EXPECT_TRUE(stats->cast_to<RTCInboundRTPStreamStats>().transport_id
+                  .is_defined());
+}
+
+TEST_F(RTCStatsCollectorTest, FilteredStatsReportFromCachedReport) {
+  rtc::scoped_refptr<const RTCStatsReport> report = GetStatsReport();
+
+  // The cached report is fresh, so nothing is gathered.
+  EXPECT_CALL(test_->session(), GetStats(_)).Times(0);
+  RTCStatsFilter filter;
+  filter.types.insert(RTCPeerConnectionStats::kType);
+  rtc::scoped_refptr<const RTCStatsReport> filtered_report =
+      GetStatsReport(filter);
+  EXPECT_EQ(report->timestamp_us(), filtered_report->timestamp_us());
+  ASSERT_EQ(1u, filtered_report->size());
+  ASSERT_TRUE(report->Get("RTCPeerConnection"));
+  EXPECT_EQ(*report->Get("RTCPeerConnection"),
+            *filtered_report->Get("RTCPeerConnection"));
+}
+
+TEST_F(RTCStatsCollectorTest, FilteredRequestWaitsForWiderGathering) {
+  MockVoiceMediaChannel* voice_media_channel = new MockVoiceMediaChannel();
+  cricket::VoiceChannel voice_channel(
+      test_->worker_thread(), test_->network_thread(),
+      test_->signaling_thread(), test_->media_engine(), voice_media_channel,
+      "VoiceContentName", kDefaultRtcpMuxRequired, kDefaultSrtpRequired);
+  EXPECT_CALL(test_->session(), voice_channel())
+      .WillRepeatedly(Return(&voice_channel));
+  EXPECT_CALL(*voice_media_channel, GetStats(_)).WillRepeatedly(Return(true));
+
+  SessionStats session_stats;
+  session_stats.transport_stats["transport"].transport_name = "transport";
+  cricket::TransportChannelStats channel_stats;
+  channel_stats.component = cricket::ICE_CANDIDATE_COMPONENT_RTP;
+  session_stats.transport_stats["transport"].channel_stats.push_back(
+      channel_stats);
+  // Only the second request needs the transports.
+  EXPECT_CALL(test_->session(), GetStats(_)).WillOnce(Invoke(
+      [&session_stats](const ChannelNamePairs&) {
+        return std::unique_ptr<SessionStats>(new SessionStats(session_stats));
+      }));
+
+  // The media info is gathered on the worker thread, which is the current
+  // thread, so the first request is still being served when the second one
+  // is made.
+  RTCStatsFilter codec_filter;
+  codec_filter.types.insert(RTCCodecStats::kType);
+  rtc::scoped_refptr<const RTCStatsReport> codec_report;
+  collector_->GetStatsReport(RTCStatsObtainer::Create(&codec_report),
+                             codec_filter);
+  RTCStatsFilter transport_filter;
+  transport_filter.types.insert(RTCTransportStats::kType);
+  rtc::scoped_refptr<const RTCStatsReport> transport_report;
+  collector_->GetStatsReport(RTCStatsObtainer::Create(&transport_report),
+                             transport_filter);
+  EXPECT_FALSE(codec_report);
+  EXPECT_FALSE(transport_report);
+
+  // The stats gathered for the first request don't have the transports', so
+  // they are gathered again for the second.
+  EXPECT_TRUE_WAIT(codec_report, kGetStatsReportTimeoutMs);
+  EXPECT_TRUE_WAIT(transport_report, kGetStatsReportTimeoutMs);
+  EXPECT_TRUE(codec_report->GetStatsOfType<RTCTransportStats>().empty());
+  EXPECT_EQ(1u, transport_report->size());
+  EXPECT_TRUE(transport_report->Get(
+      "RTCTransport_transport_" +
+      rtc::ToString<>(cricket::ICE_CANDIDATE_COMPONENT_RTP)));
+}
+
+TEST_F(RTCStatsCollectorTest, MediaChannelsDestroyedWhileGatheringStats) {
+  MockVoiceMediaChannel* voice_media_channel = new MockVoiceMediaChannel();
+  std::unique_ptr<cricket::VoiceChannel> voice_channel(
+      new cricket::VoiceChannel(
+          test_->worker_thread(), test_->network_thread(),
+          test_->signaling_thread(), test_->media_engine(),
+          voice_media_channel, "VoiceContentName", kDefaultRtcpMuxRequired,
+          kDefaultSrtpRequired));
+  EXPECT_CALL(test_->session(), voice_channel())
+      .WillRepeatedly(Return(voice_channel.get()));
+  EXPECT_CALL(*voice_media_channel, GetStats(_)).WillOnce(Return(true));
+
+  MockVideoMediaChannel* video_media_channel = new MockVideoMediaChannel();
+  std::unique_ptr<cricket::VideoChannel> video_channel(
+      new cricket::VideoChannel(
+          test_->worker_thread(), test_->network_thread(),
+          test_->signaling_thread(), video_media_channel, "VideoContentName",
+          kDefaultRtcpMuxRequired, kDefaultSrtpRequired));
+  EXPECT_CALL(test_->session(), video_channel())
+      .WillRepeatedly(Return(video_channel.get()));
+  EXPECT_CALL(*video_media_channel, GetStats(_)).WillOnce(Return(true));
+
+  rtc::scoped_refptr<const RTCStatsReport> report;
+  collector_->GetStatsReport(RTCStatsObtainer::Create(&report));
+  // The worker thread is the current thread, so the media info has not been
+  // gathered yet.
+  EXPECT_FALSE(report);
+
+  // Destroy the channels the way |WebRtcSession| does, signaling first.
+  EXPECT_CALL(test_->session(), voice_channel()).WillRepeatedly(ReturnNull());
+  test_->session().SignalVoiceChannelDestroyed();
+  voice_channel.reset();
+  EXPECT_CALL(test_->session(), video_channel()).WillRepeatedly(ReturnNull());
+  test_->session().SignalVideoChannelDestroyed();
+  video_channel.reset();
+
+  EXPECT_TRUE_WAIT(report, kGetStatsReportTimeoutMs);
+  EXPECT_TRUE(report->Get("RTCPeerConnection"));
+}
+
+// Measures the time it takes to get a full report and a report of the
+// "inbound-rtp" stats of one stream, with |num_tracks| local and remote audio
+// tracks.
+TEST_F(RTCStatsCollectorTest, GetStatsReportPerformance) {
+  const int kNumReports = 100;
+  for (int num_tracks : {1, 10, 100}) {
+    MockVoiceMediaChannel* voice_media_channel = new MockVoiceMediaChannel();
+    cricket::VoiceChannel voice_channel(
+        test_->worker_thread(), test_->network_thread(),
+        test_->signaling_thread(), test_->media_engine(), voice_media_channel,
+        "VoiceContentName", kDefaultRtcpMuxRequired, kDefaultSrtpRequired);
+
+    rtc::scoped_refptr<StreamCollection> local_streams =
+        StreamCollection::Create();
+    rtc::scoped_refptr<MediaStream> local_stream =
+        MediaStream::Create("LocalStreamLabel");
+    local_streams->AddStream(local_stream);
+    rtc::scoped_refptr<StreamCollection> remote_streams =
+        StreamCollection::Create();
+    rtc::scoped_refptr<MediaStream> remote_stream =
+        MediaStream::Create("RemoteStreamLabel");
+    remote_streams->AddStream(remote_stream);
+    std::vector<rtc::scoped_refptr<RtpSenderInterface>> senders;
+    std::vector<rtc::scoped_refptr<RtpReceiverInterface>> receivers;
+    cricket::VoiceMediaInfo voice_media_info;
+    for (int i = 0; i < num_tracks; ++i) {
+      const uint32_t local_ssrc = 2 * i + 1;
+      rtc::scoped_refptr<MediaStreamTrackInterface> local_track =
+          CreateFakeTrack(cricket::MEDIA_TYPE_AUDIO,
+                          "LocalAudioTrackID" + rtc::ToString<>(i),
+                          MediaStreamTrackInterface::kLive);
+      local_stream->AddTrack(
+          static_cast<AudioTrackInterface*>(local_track.get()));
+      senders.push_back(CreateMockSender(local_track, local_ssrc));
+      voice_media_info.senders.push_back(cricket::VoiceSenderInfo());
+      voice_media_info.senders.back().local_stats.push_back(
+          cricket::SsrcSenderInfo());
+      voice_media_info.senders.back().local_stats[0].ssrc = local_ssrc;
+
+      const uint32_t remote_ssrc = 2 * i + 2;
+      rtc::scoped_refptr<MediaStreamTrackInterface> remote_track =
+          CreateFakeTrack(cricket::MEDIA_TYPE_AUDIO,
+                          "RemoteAudioTrackID" + rtc::ToString<>(i),
+                          MediaStreamTrackInterface::kLive);
+      remote_stream->AddTrack(
+          static_cast<AudioTrackInterface*>(remote_track.get()));
+      receivers.push_back(CreateMockReceiver(remote_track, remote_ssrc));
+      voice_media_info.receivers.push_back(cricket::VoiceReceiverInfo());
+      voice_media_info.receivers.back().local_stats.push_back(
+          cricket::SsrcReceiverInfo());
+      voice_media_info.receivers.back().local_stats[0].ssrc = remote_ssrc;
+    }
+    EXPECT_CALL(test_->pc(), local_streams())
+        .WillRepeatedly(Return(local_streams));
+    EXPECT_CALL(test_->pc(), remote_streams())
+        .WillRepeatedly(Return(remote_streams));
+    EXPECT_CALL(test_->pc(), GetSenders()).WillRepeatedly(Return(senders));
+    EXPECT_CALL(test_->pc(), GetReceivers()).WillRepeatedly(Return(receivers));
+    EXPECT_CALL(*voice_media_channel, GetStats(_)).WillRepeatedly(
+        DoAll(SetArgPointee<0>(voice_media_info), Return(true)));
+    EXPECT_CALL(test_->session(), voice_channel())
+        .WillRepeatedly(Return(&voice_channel));
+
+    SessionStats session_stats;
+    session_stats.proxy_to_transport["VoiceContentName"] = "TransportName";
+    session_stats.transport_stats["TransportName"].transport_name =
+        "TransportName";
+    cricket::TransportChannelStats channel_stats;
+    channel_stats.component = cricket::ICE_CANDIDATE_COMPONENT_RTP;
+    session_stats.transport_stats["TransportName"].channel_stats.push_back(
+        channel_stats);
+    EXPECT_CALL(test_->session(), GetStats(_)).WillRepeatedly(Invoke(
+        [&session_stats](const ChannelNamePairs&) {
+          return std::unique_ptr<SessionStats>(new SessionStats(session_stats));
+        }));
+
+    int64_t start_ns = rtc::SystemTimeNanos();
+    for (int i = 0; i < kNumReports; ++i) {
+      collector_->ClearCachedStatsReport();
+      rtc::scoped_refptr<const RTCStatsReport> report = GetStatsReport();
+      ASSERT_TRUE(report->Get("RTCInboundRTPAudioStream_2"));
+    }
+    int64_t full_report_ns =
+        (rtc::SystemTimeNanos() - start_ns) / kNumReports;
+
+    RTCStatsFilter filter;
+    filter.types.insert(RTCInboundRTPStreamStats::kType);
+    filter.ssrc = rtc::Optional<uint32_t>(2);
+    start_ns = rtc::SystemTimeNanos();
+    for (int i = 0; i < kNumReports; ++i) {
+      collector_->ClearCachedStatsReport();
+      rtc::scoped_refptr<const RTCStatsReport> report = GetStatsReport(filter);
+      ASSERT_EQ(1u, report->size());
+    }
+    int64_t filtered_report_ns =
+        (rtc::SystemTimeNanos() - start_ns) / kNumReports;
+
+    std::string tracks = rtc::ToString<>(num_tracks) + "_tracks";
+    webrtc::test::PrintResult(
+        "rtc_stats_collector", "_full_report", tracks,
+        static_cast<double>(full_report_ns) / rtc::kNumNanosecsPerMicrosec,
+        "us", false);
+    webrtc::test::PrintResult(
+        "rtc_stats_collector", "_inbound_rtp_report", tracks,
+        static_cast<double>(filtered_report_ns) / rtc::kNumNanosecsPerMicrosec,
+        "us", false);
+  }
+}
+
 class RTCStatsCollectorTestWithFakeCollector : public testing::Test {
  public:
   RTCStatsCollectorTestWithFakeCollector()
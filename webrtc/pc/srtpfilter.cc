@@ -13,6 +13,7 @@
 #include <string.h>
 
 #include <algorithm>
+#include <utility>
 
 #include "third_party/libsrtp/include/srtp.h"
 #include "third_party/libsrtp/include/srtp_priv.h"
@@ -169,6 +170,16 @@ bool SrtpFilter::ProtectRtp(void* p,
   return send_session_->ProtectRtp(p, in_len, max_len, out_len, index);
 }
 
+bool SrtpFilter::ProtectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets) {
+  if (!IsActive()) {
+    LOG(LS_WARNING) << "Failed to ProtectRtp: SRTP not active";
+    packets->clear();
+    return false;
+  }
+  RTC_CHECK(send_session_);
+  return send_session_->ProtectRtp(packets);
+}
+
 bool SrtpFilter::ProtectRtcp(void* p, int in_len, int max_len, int* out_len) {
   if (!IsActive()) {
     LOG(LS_WARNING) << "Failed to ProtectRtcp: SRTP not active";
@@ -191,6 +202,16 @@ bool SrtpFilter::UnprotectRtp(void* p, int in_len, int* out_len) {
   return recv_session_->UnprotectRtp(p, in_len, out_len);
 }
 
+bool SrtpFilter::UnprotectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets) {
+  if (!IsActive()) {
+    LOG(LS_WARNING) << "Failed to UnprotectRtp: SRTP not active";
+    packets->clear();
+    return false;
+  }
+  RTC_CHECK(recv_session_);
+  return recv_session_->UnprotectRtp(packets);
+}
+
 bool SrtpFilter::UnprotectRtcp(void* p, int in_len, int* out_len) {
   if (!IsActive()) {
     LOG(LS_WARNING) << "Failed to UnprotectRtcp: SRTP not active";
@@ -204,6 +225,32 @@ bool SrtpFilter::UnprotectRtcp(void* p, int in_len, int* out_len) {
   }
 }
 
+bool SrtpFilter::ForwardRtp(SrtpFilter* source,
+                            const RtpHeaderRewrite& rewrite,
+                            void* p,
+                            int in_len,
+                            int max_len,
+                            int* out_len) {
+  if (!IsActive() || !source->IsActive()) {
+    LOG(LS_WARNING) << "Failed to ForwardRtp: SRTP not active";
+    return false;
+  }
+  int len;
+  if (!source->UnprotectRtp(p, in_len, &len)) {
+    return false;
+  }
+  if (len < static_cast<int>(kMinRtpPacketLen)) {
+    return false;
+  }
+  uint8_t* header = static_cast<uint8_t*>(p);
+  uint16_t seq_num = rtc::GetBE16(header + 2) + rewrite.sequence_number_offset;
+  rtc::SetBE16(header + 2, seq_num);
+  rtc::SetBE32(header + 4, rtc::GetBE32(header + 4) + rewrite.timestamp_offset);
+  rtc::SetBE32(header + 8, rewrite.ssrc);
+  RTC_CHECK(send_session_);
+  return send_session_->ProtectRtp(p, len, max_len, out_len);
+}
+
 bool SrtpFilter::GetRtpAuthParams(uint8_t** key, int* key_len, int* tag_len) {
   if (!IsActive()) {
     LOG(LS_WARNING) << "Failed to GetRtpAuthParams: SRTP not active";
@@ -529,6 +576,43 @@ bool SrtpSession::ProtectRtp(void* p,
   return (index) ? GetSendStreamPacketIndex(p, in_len, index) : true;
 }
 
+bool SrtpSession::ProtectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets) {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  if (!session_) {
+    LOG(LS_WARNING) << "Failed to protect SRTP packets: no SRTP Session";
+    packets->clear();
+    return false;
+  }
+
+  auto failed = packets->begin();
+  int seq_num = last_send_seq_num_;
+  for (auto it = packets->begin(); it != packets->end(); ++it) {
+    int len = static_cast<int>(it->size());
+    // Also makes the buffer writable if it is shared.
+    it->EnsureCapacity(len + rtp_auth_tag_len_);
+    uint8_t* data = it->data();
+    int err = srtp_protect(session_, data, &len);
+    if (err != srtp_err_status_ok) {
+      uint32_t ssrc;
+      if (GetRtpSsrc(data, it->size(), &ssrc)) {
+        srtp_stat_->AddProtectRtpResult(ssrc, err);
+      }
+      LOG(LS_WARNING) << "Failed to protect SRTP packet, err=" << err;
+      continue;
+    }
+    GetRtpSeqNum(data, len, &seq_num);
+    it->SetSize(len);
+    if (failed != it) {
+      *failed = std::move(*it);
+    }
+    ++failed;
+  }
+  last_send_seq_num_ = seq_num;
+  bool ok = failed == packets->end();
+  packets->erase(failed, packets->end());
+  return ok;
+}
+
 bool SrtpSession::ProtectRtcp(void* p, int in_len, int max_len, int* out_len) {
   RTC_DCHECK(thread_checker_.CalledOnValidThread());
   if (!session_) {
@@ -573,6 +657,38 @@ bool SrtpSession::UnprotectRtp(void* p, int in_len, int* out_len) {
   return true;
 }
 
+bool SrtpSession::UnprotectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets) {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  if (!session_) {
+    LOG(LS_WARNING) << "Failed to unprotect SRTP packets: no SRTP Session";
+    packets->clear();
+    return false;
+  }
+
+  auto failed = packets->begin();
+  for (auto it = packets->begin(); it != packets->end(); ++it) {
+    int len = static_cast<int>(it->size());
+    uint8_t* data = it->data();
+    int err = srtp_unprotect(session_, data, &len);
+    if (err != srtp_err_status_ok) {
+      uint32_t ssrc;
+      if (GetRtpSsrc(data, it->size(), &ssrc)) {
+        srtp_stat_->AddUnprotectRtpResult(ssrc, err);
+      }
+      LOG(LS_WARNING) << "Failed to unprotect SRTP packet, err=" << err;
+      continue;
+    }
+    it->SetSize(len);
+    if (failed != it) {
+      *failed = std::move(*it);
+    }
+    ++failed;
+  }
+  bool ok = failed == packets->end();
+  packets->erase(failed, packets->end());
+  return ok;
+}
+
 bool SrtpSession::UnprotectRtcp(void* p, int in_len, int* out_len) {
   RTC_DCHECK(thread_checker_.CalledOnValidThread());
   if (!session_) {
@@ -834,6 +950,16 @@ bool SrtpSession::UnprotectRtcp(void* data, int in_len, int* out_len) {
   return SrtpNotAvailable(__FUNCTION__);
 }
 
+bool SrtpSession::ProtectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets) {
+  packets->clear();
+  return SrtpNotAvailable(__FUNCTION__);
+}
+
+bool SrtpSession::UnprotectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets) {
+  packets->clear();
+  return SrtpNotAvailable(__FUNCTION__);
+}
+
 void SrtpSession::set_signal_silent_time(uint32_t signal_silent_time) {
   // Do nothing.
 }
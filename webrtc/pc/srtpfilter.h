@@ -19,6 +19,7 @@
 
 #include "webrtc/base/basictypes.h"
 #include "webrtc/base/constructormagic.h"
+#include "webrtc/base/copyonwritebuffer.h"
 #include "webrtc/base/criticalsection.h"
 #include "webrtc/base/sigslotrepeater.h"
 #include "webrtc/base/sslstreamadapter.h"
@@ -37,6 +38,17 @@ class SrtpStat;
 
 void ShutdownSrtp();
 
+// The RTP header fields that are rewritten when forwarding a packet with
+// SrtpFilter::ForwardRtp.
+struct RtpHeaderRewrite {
+  // SSRC of the forwarded packets.
+  uint32_t ssrc = 0;
+  // Added to the sequence number and timestamp of each packet, with wrap
+  // around.
+  uint16_t sequence_number_offset = 0;
+  uint32_t timestamp_offset = 0;
+};
+
 // Class to transform SRTP to/from RTP.
 // Initialize by calling SetSend with the local security params, then call
 // SetRecv once the remote security params are received. At that point
@@ -108,6 +120,25 @@ class SrtpFilter {
   bool UnprotectRtp(void* data, int in_len, int* out_len);
   bool UnprotectRtcp(void* data, int in_len, int* out_len);
 
+  // Batch versions of ProtectRtp and UnprotectRtp, for callers that handle
+  // many packets at once, such as a forwarding server. Each packet is
+  // processed in place and resized, and packets that fail are removed from
+  // |packets|. Returns false if any packet failed.
+  bool ProtectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets);
+  bool UnprotectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets);
+
+  // Forwards an SRTP packet received by |source| in place, for relaying
+  // media between peers: the packet is unprotected with the receive keys of
+  // |source|, the SSRC, sequence number and timestamp are rewritten, and it
+  // is protected with the send keys of this filter. Nothing else is parsed,
+  // and no memory is allocated.
+  bool ForwardRtp(SrtpFilter* source,
+                  const RtpHeaderRewrite& rewrite,
+                  void* data,
+                  int in_len,
+                  int max_len,
+                  int* out_len);
+
   // Returns rtp auth params from srtp context.
   bool GetRtpAuthParams(uint8_t** key, int* key_len, int* tag_len);
 
@@ -201,6 +232,13 @@ class SrtpSession {
   bool UnprotectRtp(void* data, int in_len, int* out_len);
   bool UnprotectRtcp(void* data, int in_len, int* out_len);
 
+  // Protects or unprotects a batch of RTP packets in place, growing their
+  // buffers for the authentication tag as needed. This saves the per-call
+  // checks and bookkeeping of the single packet versions. Packets that fail
+  // are removed from |packets|. Returns false if any packet failed.
+  bool ProtectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets);
+  bool UnprotectRtp(std::vector<rtc::CopyOnWriteBuffer>* packets);
+
   // Helper method to get authentication params.
   bool GetRtpAuthParams(uint8_t** key, int* key_len, int* tag_len);
 
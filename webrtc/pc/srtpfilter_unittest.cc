@@ -10,14 +10,21 @@
 
 #include "webrtc/pc/srtpfilter.h"
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "third_party/libsrtp/include/srtp.h"
 #include "webrtc/base/byteorder.h"
 #include "webrtc/base/constructormagic.h"
 #include "webrtc/base/gunit.h"
 #include "webrtc/base/thread.h"
+#include "webrtc/base/timeutils.h"
 #include "webrtc/media/base/cryptoparams.h"
 #include "webrtc/media/base/fakertp.h"
+#include "webrtc/media/base/rtputils.h"
 #include "webrtc/p2p/base/sessiondescription.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 using rtc::CS_AES_CM_128_HMAC_SHA1_80;
 using rtc::CS_AES_CM_128_HMAC_SHA1_32;
@@ -771,6 +778,291 @@ TEST_F(SrtpSessionTest, TestReplay) {
                              &out_len));
 }
 
+// Makes |count| copies of kPcmuFrame with consecutive sequence numbers, and
+// |payload_size| bytes of payload if that is not zero.
+static std::vector<rtc::CopyOnWriteBuffer> MakeRtpPackets(
+    size_t count,
+    size_t payload_size) {
+  std::vector<rtc::CopyOnWriteBuffer> packets;
+  for (size_t i = 0; i < count; ++i) {
+    rtc::CopyOnWriteBuffer packet(kPcmuFrame, cricket::kMinRtpPacketLen);
+    if (payload_size == 0) {
+      packet.AppendData(kPcmuFrame + cricket::kMinRtpPacketLen,
+                        sizeof(kPcmuFrame) - cricket::kMinRtpPacketLen);
+    } else {
+      packet.SetSize(cricket::kMinRtpPacketLen + payload_size);
+      memset(packet.data() + cricket::kMinRtpPacketLen, 0x55, payload_size);
+    }
+    rtc::SetBE16(packet.data() + 2, static_cast<uint16_t>(i + 1));
+    packets.push_back(std::move(packet));
+  }
+  return packets;
+}
+
+// Sets up the sessions with a key of the right length for |crypto_suite|.
+static void SetKeys(int crypto_suite,
+                    cricket::SrtpSession* send_session,
+                    cricket::SrtpSession* recv_session) {
+  int key_len;
+  int salt_len;
+  ASSERT_TRUE(rtc::GetSrtpKeyAndSaltLengths(crypto_suite, &key_len, &salt_len));
+  ASSERT_LE(key_len + salt_len, kTestKeyLen);
+  ASSERT_TRUE(send_session->SetSend(crypto_suite, kTestKey1,
+                                    key_len + salt_len));
+  ASSERT_TRUE(recv_session->SetRecv(crypto_suite, kTestKey1,
+                                    key_len + salt_len));
+}
+
+// Test that a batch of packets can be protected and unprotected in place,
+// with the buffers growing for the authentication tags.
+TEST_F(SrtpSessionTest, TestProtectUnprotectBatch) {
+  for (int crypto_suite :
+       {rtc::SRTP_AES128_CM_SHA1_80, rtc::SRTP_AEAD_AES_128_GCM}) {
+    cricket::SrtpSession send_session;
+    cricket::SrtpSession recv_session;
+    SetKeys(crypto_suite, &send_session, &recv_session);
+    std::vector<rtc::CopyOnWriteBuffer> packets = MakeRtpPackets(10, 0);
+    const std::vector<rtc::CopyOnWriteBuffer> originals = packets;
+
+    EXPECT_TRUE(send_session.ProtectRtp(&packets));
+    ASSERT_EQ(originals.size(), packets.size());
+    for (size_t i = 0; i < packets.size(); ++i) {
+      EXPECT_EQ(originals[i].size() + send_session.GetSrtpOverhead(),
+                packets[i].size());
+      EXPECT_NE(0, memcmp(originals[i].data(), packets[i].data(),
+                          originals[i].size()));
+    }
+
+    EXPECT_TRUE(recv_session.UnprotectRtp(&packets));
+    EXPECT_EQ(originals, packets);
+  }
+}
+
+// Test that the copies of a shared buffer are left alone by a batch.
+TEST_F(SrtpSessionTest, TestProtectBatchOfSharedBuffers) {
+  EXPECT_TRUE(s1_.SetSend(rtc::SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen));
+  std::vector<rtc::CopyOnWriteBuffer> packets = MakeRtpPackets(1, 0);
+  rtc::CopyOnWriteBuffer shared = packets[0];
+  EXPECT_TRUE(s1_.ProtectRtp(&packets));
+  EXPECT_EQ(0, memcmp(kPcmuFrame, shared.data(), sizeof(kPcmuFrame)));
+  EXPECT_NE(shared, packets[0]);
+}
+
+// Test that the packets of a batch that fail are removed from it.
+TEST_F(SrtpSessionTest, TestUnprotectBatchDropsFailedPackets) {
+  SetKeys(rtc::SRTP_AEAD_AES_128_GCM, &s1_, &s2_);
+  std::vector<rtc::CopyOnWriteBuffer> packets = MakeRtpPackets(5, 0);
+  EXPECT_TRUE(s1_.ProtectRtp(&packets));
+  packets[1].data()[packets[1].size() - 1] ^= 0x01;
+  packets[3].data()[cricket::kMinRtpPacketLen] ^= 0x01;
+
+  EXPECT_FALSE(s2_.UnprotectRtp(&packets));
+  ASSERT_EQ(3u, packets.size());
+  EXPECT_EQ(1, rtc::GetBE16(packets[0].data() + 2));
+  EXPECT_EQ(3, rtc::GetBE16(packets[1].data() + 2));
+  EXPECT_EQ(5, rtc::GetBE16(packets[2].data() + 2));
+
+  // The session has to be set up first.
+  cricket::SrtpSession session;
+  packets = MakeRtpPackets(2, 0);
+  EXPECT_FALSE(session.ProtectRtp(&packets));
+  EXPECT_TRUE(packets.empty());
+}
+
+// Compares the single packet and batch paths, with AES-CM/HMAC-SHA1 and with
+// AES-GCM, for video sized packets.
+TEST_F(SrtpSessionTest, ProtectUnprotectThroughput) {
+  const size_t kNumPackets = 20000;
+  const size_t kBatchSize = 32;
+  const size_t kPayloadSize = 1100;
+  for (int crypto_suite :
+       {rtc::SRTP_AES128_CM_SHA1_80, rtc::SRTP_AEAD_AES_128_GCM}) {
+    const std::string name = rtc::SrtpCryptoSuiteToName(crypto_suite);
+    for (bool batch : {false, true}) {
+      cricket::SrtpSession send_session;
+      cricket::SrtpSession recv_session;
+      SetKeys(crypto_suite, &send_session, &recv_session);
+      std::vector<rtc::CopyOnWriteBuffer> packets =
+          MakeRtpPackets(kNumPackets, kPayloadSize);
+      for (auto& packet : packets)
+        packet.EnsureCapacity(packet.size() + send_session.GetSrtpOverhead());
+
+      int64_t start_us = rtc::TimeMicros();
+      if (batch) {
+        std::vector<rtc::CopyOnWriteBuffer> chunk;
+        for (size_t i = 0; i < kNumPackets; i += kBatchSize) {
+          chunk.assign(std::make_move_iterator(packets.begin() + i),
+                       std::make_move_iterator(packets.begin() + i +
+                                               kBatchSize));
+          ASSERT_TRUE(send_session.ProtectRtp(&chunk));
+          ASSERT_TRUE(recv_session.UnprotectRtp(&chunk));
+          std::move(chunk.begin(), chunk.end(), packets.begin() + i);
+        }
+      } else {
+        for (auto& packet : packets) {
+          int len = static_cast<int>(packet.size());
+          char* data = packet.data<char>();
+          ASSERT_TRUE(send_session.ProtectRtp(
+              data, len, static_cast<int>(packet.capacity()), &len));
+          ASSERT_TRUE(recv_session.UnprotectRtp(data, len, &len));
+          packet.SetSize(len);
+        }
+      }
+      int64_t elapsed_us = std::max<int64_t>(rtc::TimeMicros() - start_us, 1);
+
+      webrtc::test::PrintResult(
+          "srtp_protect_unprotect", batch ? "_batch" : "_single", name,
+          kNumPackets * rtc::kNumMicrosecsPerSec / elapsed_us, "packets/s",
+          false);
+    }
+  }
+}
+
+// Sets up |sender| -> |forwarder_in| with AES-CM/HMAC-SHA1 and
+// |forwarder_out| -> |receiver| with |out_crypto_suite|, like the two legs of
+// a relayed call.
+static void SetUpForwarding(int out_crypto_suite,
+                            cricket::SrtpFilter* sender,
+                            cricket::SrtpFilter* forwarder_in,
+                            cricket::SrtpFilter* forwarder_out,
+                            cricket::SrtpFilter* receiver) {
+  const int in_suite = rtc::SRTP_AES128_CM_SHA1_80;
+  int key_len;
+  int salt_len;
+  ASSERT_TRUE(
+      rtc::GetSrtpKeyAndSaltLengths(out_crypto_suite, &key_len, &salt_len));
+  const int out_key_len = key_len + salt_len;
+  ASSERT_TRUE(sender->SetRtpParams(in_suite, kTestKey1, kTestKeyLen, in_suite,
+                                   kTestKey2, kTestKeyLen));
+  ASSERT_TRUE(forwarder_in->SetRtpParams(in_suite, kTestKey2, kTestKeyLen,
+                                         in_suite, kTestKey1, kTestKeyLen));
+  ASSERT_TRUE(forwarder_out->SetRtpParams(out_crypto_suite, kTestKey2,
+                                          out_key_len, out_crypto_suite,
+                                          kTestKey1, out_key_len));
+  ASSERT_TRUE(receiver->SetRtpParams(out_crypto_suite, kTestKey1, out_key_len,
+                                     out_crypto_suite, kTestKey2,
+                                     out_key_len));
+}
+
+// Test that a forwarded packet is re-keyed and gets the rewritten header
+// fields, with the payload left as it was.
+TEST_F(SrtpFilterTest, TestForwardRtp) {
+  for (int out_crypto_suite :
+       {rtc::SRTP_AES128_CM_SHA1_32, rtc::SRTP_AEAD_AES_128_GCM}) {
+    cricket::SrtpFilter sender, forwarder_in, forwarder_out, receiver;
+    SetUpForwarding(out_crypto_suite, &sender, &forwarder_in, &forwarder_out,
+                    &receiver);
+    cricket::RtpHeaderRewrite rewrite;
+    rewrite.ssrc = 0x11223344;
+    rewrite.sequence_number_offset = 0xFFFF;
+    rewrite.timestamp_offset = 3000;
+
+    char packet[sizeof(kPcmuFrame) + 32];
+    memcpy(packet, kPcmuFrame, sizeof(kPcmuFrame));
+    int len = sizeof(kPcmuFrame);
+    ASSERT_TRUE(sender.ProtectRtp(packet, len, sizeof(packet), &len));
+    EXPECT_TRUE(forwarder_out.ForwardRtp(&forwarder_in, rewrite, packet, len,
+                                         sizeof(packet), &len));
+    ASSERT_TRUE(receiver.UnprotectRtp(packet, len, &len));
+    ASSERT_EQ(static_cast<int>(sizeof(kPcmuFrame)), len);
+
+    const uint8_t* header = reinterpret_cast<const uint8_t*>(packet);
+    // The sequence number 1 wraps around to 0.
+    EXPECT_EQ(0, rtc::GetBE16(header + 2));
+    EXPECT_EQ(3000u, rtc::GetBE32(header + 4));
+    EXPECT_EQ(0x11223344u, rtc::GetBE32(header + 8));
+    EXPECT_EQ(0, memcmp(kPcmuFrame + cricket::kMinRtpPacketLen,
+                        packet + cricket::kMinRtpPacketLen,
+                        sizeof(kPcmuFrame) - cricket::kMinRtpPacketLen));
+  }
+}
+
+// Test that packets that fail authentication are not forwarded.
+TEST_F(SrtpFilterTest, TestForwardRtpRejectsTamperedPacket) {
+  cricket::SrtpFilter sender, forwarder_in, forwarder_out, receiver;
+  SetUpForwarding(rtc::SRTP_AES128_CM_SHA1_80, &sender, &forwarder_in,
+                  &forwarder_out, &receiver);
+  char packet[sizeof(kPcmuFrame) + 32];
+  memcpy(packet, kPcmuFrame, sizeof(kPcmuFrame));
+  int len = sizeof(kPcmuFrame);
+  ASSERT_TRUE(sender.ProtectRtp(packet, len, sizeof(packet), &len));
+  packet[len - 1] ^= 0x01;
+  EXPECT_FALSE(forwarder_out.ForwardRtp(&forwarder_in,
+                                        cricket::RtpHeaderRewrite(), packet,
+                                        len, sizeof(packet), &len));
+
+  // Both filters have to be active.
+  cricket::SrtpFilter inactive;
+  EXPECT_FALSE(inactive.ForwardRtp(&forwarder_in, cricket::RtpHeaderRewrite(),
+                                   packet, len, sizeof(packet), &len));
+}
+
+// Compares forwarding in place with what relaying through the receive and
+// send paths costs: unprotect, copy into a new buffer, parse the header,
+// rewrite it and protect again. Runs on one thread, so the rates are per
+// core.
+TEST_F(SrtpFilterTest, ForwardRtpThroughput) {
+  const size_t kNumPackets = 20000;
+  const size_t kPayloadSize = 1100;
+  cricket::RtpHeaderRewrite rewrite;
+  rewrite.ssrc = 0x11223344;
+  rewrite.sequence_number_offset = 100;
+  rewrite.timestamp_offset = 3000;
+  for (bool in_place : {false, true}) {
+    cricket::SrtpFilter sender, forwarder_in, forwarder_out, receiver;
+    SetUpForwarding(rtc::SRTP_AEAD_AES_128_GCM, &sender, &forwarder_in,
+                    &forwarder_out, &receiver);
+    std::vector<rtc::CopyOnWriteBuffer> packets =
+        MakeRtpPackets(kNumPackets, kPayloadSize);
+    for (auto& packet : packets) {
+      packet.EnsureCapacity(packet.size() + 32);
+      int len = static_cast<int>(packet.size());
+      ASSERT_TRUE(sender.ProtectRtp(packet.data(), len,
+                                    static_cast<int>(packet.capacity()),
+                                    &len));
+      packet.SetSize(len);
+    }
+
+    int64_t start_us = rtc::TimeMicros();
+    for (auto& packet : packets) {
+      int len = static_cast<int>(packet.size());
+      if (in_place) {
+        ASSERT_TRUE(forwarder_out.ForwardRtp(
+            &forwarder_in, rewrite, packet.data(), len,
+            static_cast<int>(packet.capacity()), &len));
+        packet.SetSize(len);
+        continue;
+      }
+      ASSERT_TRUE(forwarder_in.UnprotectRtp(packet.data(), len, &len));
+      rtc::CopyOnWriteBuffer copy(packet.data(), len, len + 32);
+      int seq_num;
+      uint32_t timestamp;
+      ASSERT_TRUE(cricket::GetRtpSeqNum(copy.data(), len, &seq_num));
+      ASSERT_TRUE(cricket::GetRtpTimestamp(copy.data(), len, &timestamp));
+      cricket::SetRtpSsrc(copy.data(), len, rewrite.ssrc);
+      uint16_t new_seq_num =
+          static_cast<uint16_t>(seq_num + rewrite.sequence_number_offset);
+      rtc::SetBE16(copy.data() + 2, new_seq_num);
+      rtc::SetBE32(copy.data() + 4, timestamp + rewrite.timestamp_offset);
+      ASSERT_TRUE(forwarder_out.ProtectRtp(
+          copy.data(), len, static_cast<int>(copy.capacity()), &len));
+      copy.SetSize(len);
+      packet = std::move(copy);
+    }
+    int64_t elapsed_us = std::max<int64_t>(rtc::TimeMicros() - start_us, 1);
+
+    // Check that both paths did the same thing.
+    int len = static_cast<int>(packets.back().size());
+    ASSERT_TRUE(receiver.UnprotectRtp(packets.back().data(), len, &len));
+    EXPECT_EQ(0x11223344u, rtc::GetBE32(packets.back().data() + 8));
+
+    webrtc::test::PrintResult(
+        "srtp_forward_rtp", "", in_place ? "in_place" : "receive_and_send",
+        kNumPackets * rtc::kNumMicrosecsPerSec / elapsed_us, "packets/s",
+        false);
+  }
+}
+
 class SrtpStatTest
     : public testing::Test,
       public sigslot::has_slots<> {
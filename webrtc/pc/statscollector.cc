@@ -506,8 +506,7 @@ StatsCollector::UpdateStats(PeerConnectionInterface::StatsOutputLevel level) {
     // since we'd be creating/updating the stats report objects consistently on
     // the same thread (this class has no locks right now).
     ExtractSessionInfo();
-    ExtractVoiceInfo();
-    ExtractVideoInfo(level);
+    ExtractMediaInfo(level);
     ExtractSenderInfo();
     ExtractDataInfo();
     UpdateTrackReports();
@@ -767,20 +766,40 @@ void StatsCollector::ExtractSessionInfo() {
   }
 }
 
-void StatsCollector::ExtractVoiceInfo() {
+void StatsCollector::ExtractMediaInfo(
+    PeerConnectionInterface::StatsOutputLevel level) {
   RTC_DCHECK(pc_->session()->signaling_thread()->IsCurrent());
 
-  if (!pc_->session()->voice_channel()) {
+  cricket::VoiceChannel* voice_channel = pc_->session()->voice_channel();
+  cricket::VideoChannel* video_channel = pc_->session()->video_channel();
+  if (!voice_channel && !video_channel)
     return;
-  }
   cricket::VoiceMediaInfo voice_info;
-  if (!pc_->session()->voice_channel()->GetStats(&voice_info)) {
-    LOG(LS_ERROR) << "Failed to get voice channel stats.";
-    return;
+  cricket::VideoMediaInfo video_info;
+  bool got_voice_info = false;
+  bool got_video_info = false;
+  pc_->session()->worker_thread()->Invoke<void>(RTC_FROM_HERE, [&] {
+    got_voice_info = voice_channel && voice_channel->GetStats(&voice_info);
+    got_video_info = video_channel && video_channel->GetStats(&video_info);
+  });
+
+  if (voice_channel) {
+    if (got_voice_info)
+      ExtractVoiceInfo(voice_info);
+    else
+      LOG(LS_ERROR) << "Failed to get voice channel stats.";
+  }
+  if (video_channel) {
+    if (got_video_info)
+      ExtractVideoInfo(video_info, level);
+    else
+      LOG(LS_ERROR) << "Failed to get video channel stats.";
   }
+}
 
-  // TODO(tommi): The above code should run on the worker thread and post the
-  // results back to the signaling thread, where we can add data to the reports.
+void StatsCollector::ExtractVoiceInfo(
+    const cricket::VoiceMediaInfo& voice_info) {
+  RTC_DCHECK(pc_->session()->signaling_thread()->IsCurrent());
   rtc::Thread::ScopedDisallowBlockingCalls no_blocking_calls;
 
   StatsReport::Id transport_id(GetTransportIdFromProxy(
@@ -800,20 +819,9 @@ void StatsCollector::ExtractVoiceInfo() {
 }
 
 void StatsCollector::ExtractVideoInfo(
+    const cricket::VideoMediaInfo& video_info,
     PeerConnectionInterface::StatsOutputLevel level) {
   RTC_DCHECK(pc_->session()->signaling_thread()->IsCurrent());
-
-  if (!pc_->session()->video_channel())
-    return;
-
-  cricket::VideoMediaInfo video_info;
-  if (!pc_->session()->video_channel()->GetStats(&video_info)) {
-    LOG(LS_ERROR) << "Failed to get video channel stats.";
-    return;
-  }
-
-  // TODO(tommi): The above code should run on the worker thread and post the
-  // results back to the signaling thread, where we can add data to the reports.
   rtc::Thread::ScopedDisallowBlockingCalls no_blocking_calls;
 
   StatsReport::Id transport_id(GetTransportIdFromProxy(
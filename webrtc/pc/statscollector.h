@@ -110,8 +110,12 @@ class StatsCollector {
 
   void ExtractDataInfo();
   void ExtractSessionInfo();
-  void ExtractVoiceInfo();
-  void ExtractVideoInfo(PeerConnectionInterface::StatsOutputLevel level);
+  // Gets the stats of the voice and video channels in a single hop to the
+  // worker thread and extracts them with the methods below.
+  void ExtractMediaInfo(PeerConnectionInterface::StatsOutputLevel level);
+  void ExtractVoiceInfo(const cricket::VoiceMediaInfo& voice_info);
+  void ExtractVideoInfo(const cricket::VideoMediaInfo& video_info,
+                        PeerConnectionInterface::StatsOutputLevel level);
   void ExtractSenderInfo();
   void BuildSsrcToTransportId();
   webrtc::StatsReport* GetReport(const StatsReport::StatsType& type,
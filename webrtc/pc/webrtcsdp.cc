@@ -13,8 +13,10 @@
 #include <ctype.h>
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -24,6 +26,7 @@
 #include "webrtc/api/jsepsessiondescription.h"
 #include "webrtc/base/arraysize.h"
 #include "webrtc/base/checks.h"
+#include "webrtc/base/constructormagic.h"
 #include "webrtc/base/logging.h"
 #include "webrtc/base/messagedigest.h"
 #include "webrtc/base/stringutils.h"
@@ -438,7 +441,7 @@ static bool GetLine(const std::string& message,
   if (line_end > 0 && (message.at(line_end - 1) == kReturn)) {
     --line_end;
   }
-  *line = message.substr(line_begin, (line_end - line_begin));
+  line->assign(message, line_begin, line_end - line_begin);
   const char* cline = line->c_str();
   // RFC 4566
   // An SDP session description consists of a number of lines of text of
@@ -457,23 +460,90 @@ static bool GetLine(const std::string& message,
   return true;
 }
 
+// Builds the SDP lines, in place of a std::ostringstream whose formatting it
+// matches for the types written to SDP. Its buffer is reused from one line to
+// the next.
+class SdpLineBuilder {
+ public:
+  SdpLineBuilder() {}
+
+  const std::string& str() const { return line_; }
+  void Clear() { line_.clear(); }
+
+  SdpLineBuilder& operator<<(char c) {
+    line_.push_back(c);
+    return *this;
+  }
+  SdpLineBuilder& operator<<(const char* s) {
+    line_.append(s);
+    return *this;
+  }
+  SdpLineBuilder& operator<<(const std::string& s) {
+    line_.append(s);
+    return *this;
+  }
+  SdpLineBuilder& operator<<(int value) { return AppendSigned(value); }
+  SdpLineBuilder& operator<<(long value) { return AppendSigned(value); }
+  SdpLineBuilder& operator<<(long long value) { return AppendSigned(value); }
+  SdpLineBuilder& operator<<(unsigned short value) {
+    return AppendUnsigned(value);
+  }
+  SdpLineBuilder& operator<<(unsigned int value) {
+    return AppendUnsigned(value);
+  }
+  SdpLineBuilder& operator<<(unsigned long value) {
+    return AppendUnsigned(value);
+  }
+  SdpLineBuilder& operator<<(unsigned long long value) {
+    return AppendUnsigned(value);
+  }
+  // Other types, such as floating point numbers, which a stream would format
+  // according to its flags, are not written to SDP.
+  template <typename T>
+  SdpLineBuilder& operator<<(const T& value) = delete;
+
+ private:
+  SdpLineBuilder& AppendSigned(long long value) {
+    if (value < 0) {
+      line_.push_back('-');
+      return AppendUnsigned(0ULL - static_cast<unsigned long long>(value));
+    }
+    return AppendUnsigned(static_cast<unsigned long long>(value));
+  }
+  SdpLineBuilder& AppendUnsigned(unsigned long long value) {
+    char digits[20];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+    do {
+      *--begin = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    line_.append(begin, end);
+    return *this;
+  }
+
+  std::string line_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(SdpLineBuilder);
+};
+
 // Init |os| to "|type|=|value|".
 static void InitLine(const char type,
                      const std::string& value,
-                     std::ostringstream* os) {
-  os->str("");
+                     SdpLineBuilder* os) {
+  os->Clear();
   *os << type << kSdpDelimiterEqual << value;
 }
 
 // Init |os| to "a=|attribute|".
-static void InitAttrLine(const std::string& attribute, std::ostringstream* os) {
+static void InitAttrLine(const std::string& attribute, SdpLineBuilder* os) {
   InitLine(kLineTypeAttributes, attribute, os);
 }
 
 // Writes a SDP attribute line based on |attribute| and |value| to |message|.
 static void AddAttributeLine(const std::string& attribute, int value,
                              std::string* message) {
-  std::ostringstream os;
+  SdpLineBuilder os;
   InitAttrLine(attribute, &os);
   os << kSdpDelimiterColon << value;
   AddLine(os.str(), message);
@@ -507,9 +577,8 @@ static bool GetLineWithType(const std::string& message, size_t* pos,
   return true;
 }
 
-static bool HasAttribute(const std::string& line,
-                         const std::string& attribute) {
-  return (line.compare(kLinePrefixLength, attribute.size(), attribute) == 0);
+static bool HasAttribute(const std::string& line, const char* attribute) {
+  return (line.compare(kLinePrefixLength, strlen(attribute), attribute) == 0);
 }
 
 static bool AddSsrcLine(uint32_t ssrc_id,
@@ -518,7 +587,7 @@ static bool AddSsrcLine(uint32_t ssrc_id,
                         std::string* message) {
   // RFC 5576
   // a=ssrc:<ssrc-id> <attribute>:<value>
-  std::ostringstream os;
+  SdpLineBuilder os;
   InitAttrLine(kAttributeSsrc, &os);
   os << kSdpDelimiterColon << ssrc_id << kSdpDelimiterSpace
      << attribute << kSdpDelimiterColon << value;
@@ -526,21 +595,58 @@ static bool AddSsrcLine(uint32_t ssrc_id,
 }
 
 // Get value only from <attribute>:<value>.
-static bool GetValue(const std::string& message, const std::string& attribute,
+static bool GetValue(const std::string& message, const char* attribute,
                      std::string* value, SdpParseError* error) {
-  std::string leftpart;
-  if (!rtc::tokenize_first(message, kSdpDelimiterColon, &leftpart, value)) {
+  // Same as rtc::tokenize_first(), without copying the left part.
+  const size_t colon = message.find(kSdpDelimiterColon);
+  if (colon == std::string::npos) {
     return ParseFailedGetValue(message, attribute, error);
   }
+  size_t value_begin = colon + 1;
+  while (value_begin < message.length() &&
+         message[value_begin] == kSdpDelimiterColon) {
+    ++value_begin;
+  }
+  value->assign(message, value_begin, std::string::npos);
   // The left part should end with the expected attribute.
-  if (leftpart.length() < attribute.length() ||
-      leftpart.compare(leftpart.length() - attribute.length(),
-                       attribute.length(), attribute) != 0) {
+  const size_t attribute_length = strlen(attribute);
+  if (colon < attribute_length ||
+      message.compare(colon - attribute_length, attribute_length,
+                      attribute) != 0) {
     return ParseFailedGetValue(message, attribute, error);
   }
   return true;
 }
 
+// Splits |line| from |start| on |delimiter| into |fields|, the same way as
+// rtc::split() of the rest of the line, but without copying it first. The
+// strings already in |fields| are reused. Returns the number of fields.
+static size_t SplitLine(const std::string& line,
+                        size_t start,
+                        char delimiter,
+                        std::vector<std::string>* fields) {
+  fields->reserve(
+      std::count(line.begin() + start, line.end(), delimiter) + 1);
+  size_t num_fields = 0;
+  size_t field_begin = start;
+  while (true) {
+    size_t field_end = line.find(delimiter, field_begin);
+    if (field_end == std::string::npos) {
+      field_end = line.length();
+    }
+    if (num_fields == fields->size()) {
+      fields->push_back(std::string());
+    }
+    (*fields)[num_fields++].assign(line, field_begin, field_end - field_begin);
+    if (field_end == line.length()) {
+      break;
+    }
+    field_begin = field_end + 1;
+  }
+  fields->resize(num_fields);
+  return num_fields;
+}
+
 static bool CaseInsensitiveFind(std::string str1, std::string str2) {
   std::transform(str1.begin(), str1.end(), str1.begin(),
                  ::tolower);
@@ -549,12 +655,33 @@ static bool CaseInsensitiveFind(std::string str1, std::string str2) {
   return str1.find(str2) != std::string::npos;
 }
 
+// Parses |s| as an unsigned decimal number, if it's short enough not to
+// overflow a T. Returns false, leaving |t| unchanged, otherwise.
+template <class T>
+static bool GetDecimalFromString(const std::string& s, T* t) {
+  if (!std::numeric_limits<T>::is_integer || s.empty() ||
+      s.length() > static_cast<size_t>(std::numeric_limits<T>::digits10)) {
+    return false;
+  }
+  T value = 0;
+  for (char c : s) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    value = static_cast<T>(value * 10 + (c - '0'));
+  }
+  *t = value;
+  return true;
+}
+
 template <class T>
 static bool GetValueFromString(const std::string& line,
                                const std::string& s,
                                T* t,
                                SdpParseError* error) {
-  if (!rtc::FromString(s, t)) {
+  // Most numbers in SDP are plain decimal numbers, which are parsed without
+  // the stream used by rtc::FromString().
+  if (!GetDecimalFromString(s, t) && !rtc::FromString(s, t)) {
     std::ostringstream description;
     description << "Invalid value: " << s << ".";
     return ParseFailed(line, description.str(), error);
@@ -723,12 +850,11 @@ static void UpdateMediaDefaultDestination(
   // RFC 4566
   // m=<media> <port> <proto> <fmt> ...
   std::vector<std::string> fields;
-  rtc::split(mline, kSdpDelimiterSpace, &fields);
-  if (fields.size() < 3) {
+  if (SplitLine(mline, 0, kSdpDelimiterSpace, &fields) < 3) {
     return;
   }
 
-  std::ostringstream os;
+  SdpLineBuilder os;
   std::string rtp_port, rtp_ip, addr_type;
   GetDefaultDestination(candidates, ICE_CANDIDATE_COMPONENT_RTP,
                         &rtp_port, &rtp_ip, &addr_type);
@@ -767,7 +893,7 @@ static std::string GetRtcpLine(const std::vector<Candidate>& candidates) {
   // RFC 3605
   // rtcp-attribute =  "a=rtcp:" port  [nettype space addrtype space
   // connection-address] CRLF
-  std::ostringstream os;
+  SdpLineBuilder os;
   InitAttrLine(kAttributeRtcp, &os);
   os << kSdpDelimiterColon
      << rtcp_port << " "
@@ -796,6 +922,52 @@ static bool IsValidPort(int port) {
   return port >= 0 && port <= 65535;
 }
 
+// Counts the rtpmap, fmtp and rtcp-fb lines of the codecs of |media_desc|.
+template <class C>
+static size_t CountCodecLines(const MediaContentDescription* media_desc) {
+  size_t num_lines = 0;
+  for (const C& codec :
+       static_cast<const cricket::MediaContentDescriptionImpl<C>*>(media_desc)
+           ->codecs()) {
+    num_lines += 2 + codec.feedback_params.params().size();
+  }
+  return num_lines;
+}
+
+// Estimates the size of the SDP of |jdesc| from the number of its lines, so
+// that the message can be allocated once.
+static size_t EstimateSdpSize(const JsepSessionDescription& jdesc) {
+  // The average size of a line, and the number of lines of the session and
+  // of each media section besides those counted below.
+  const size_t kLineSize = 40;
+  const size_t kNumSessionLines = 8;
+  const size_t kNumMediaSectionLines = 16;
+  // cname, msid, mslabel and label.
+  const size_t kNumLinesPerSsrc = 4;
+
+  const cricket::SessionDescription* desc = jdesc.description();
+  size_t num_lines = kNumSessionLines;
+  for (size_t i = 0; i < desc->contents().size(); ++i) {
+    const MediaContentDescription* media_desc =
+        static_cast<const MediaContentDescription*>(
+            desc->contents()[i].description);
+    num_lines += kNumMediaSectionLines +
+                 media_desc->rtp_header_extensions().size() +
+                 jdesc.candidates(i)->count();
+    for (const StreamParams& track : media_desc->streams()) {
+      num_lines += 1 + kNumLinesPerSsrc * track.ssrcs.size();
+    }
+    if (media_desc->type() == cricket::MEDIA_TYPE_AUDIO) {
+      num_lines += CountCodecLines<cricket::AudioCodec>(media_desc);
+    } else if (media_desc->type() == cricket::MEDIA_TYPE_VIDEO) {
+      num_lines += CountCodecLines<cricket::VideoCodec>(media_desc);
+    } else if (media_desc->type() == cricket::MEDIA_TYPE_DATA) {
+      num_lines += CountCodecLines<cricket::DataCodec>(media_desc);
+    }
+  }
+  return num_lines * kLineSize;
+}
+
 std::string SdpSerialize(const JsepSessionDescription& jdesc,
                          bool unified_plan_sdp) {
   const cricket::SessionDescription* desc = jdesc.description();
@@ -804,6 +976,7 @@ std::string SdpSerialize(const JsepSessionDescription& jdesc,
   }
 
   std::string message;
+  message.reserve(EstimateSdpSize(jdesc));
 
   // Session Description.
   AddLine(kSessionVersion, &message);
@@ -811,7 +984,7 @@ std::string SdpSerialize(const JsepSessionDescription& jdesc,
   // RFC 4566
   // o=<username> <sess-id> <sess-version> <nettype> <addrtype>
   // <unicast-address>
-  std::ostringstream os;
+  SdpLineBuilder os;
   InitLine(kLineTypeOrigin, kSessionOriginUsername, &os);
   const std::string& session_id = jdesc.session_id().empty() ?
       kSessionOriginSessionId : jdesc.session_id();
@@ -1004,7 +1177,7 @@ bool ParseCandidate(const std::string& message, Candidate* candidate,
   }
 
   std::vector<std::string> fields;
-  rtc::split(candidate_value, kSdpDelimiterSpace, &fields);
+  SplitLine(candidate_value, 0, kSdpDelimiterSpace, &fields);
 
   // RFC 5245
   // a=candidate:<foundation> <component-id> <transport> <priority>
@@ -1158,7 +1331,7 @@ bool ParseIceOptions(const std::string& line,
     return false;
   }
   std::vector<std::string> fields;
-  rtc::split(ice_options, kSdpDelimiterSpace, &fields);
+  SplitLine(ice_options, 0, kSdpDelimiterSpace, &fields);
   for (size_t i = 0; i < fields.size(); ++i) {
     transport_options->push_back(fields[i]);
   }
@@ -1172,10 +1345,10 @@ bool ParseSctpPort(const std::string& line,
   // a=sctp-port
   std::vector<std::string> fields;
   const size_t expected_min_fields = 2;
-  rtc::split(line.substr(kLinePrefixLength), kSdpDelimiterColon, &fields);
+  SplitLine(line, kLinePrefixLength, kSdpDelimiterColon, &fields);
   if (fields.size() < expected_min_fields) {
     fields.resize(0);
-    rtc::split(line.substr(kLinePrefixLength), kSdpDelimiterSpace, &fields);
+    SplitLine(line, kLinePrefixLength, kSdpDelimiterSpace, &fields);
   }
   if (fields.size() < expected_min_fields) {
     return ParseFailedExpectMinFieldNum(line, expected_min_fields, error);
@@ -1192,8 +1365,7 @@ bool ParseExtmap(const std::string& line,
   // RFC 5285
   // a=extmap:<value>["/"<direction>] <URI> <extensionattributes>
   std::vector<std::string> fields;
-  rtc::split(line.substr(kLinePrefixLength),
-                   kSdpDelimiterSpace, &fields);
+  SplitLine(line, kLinePrefixLength, kSdpDelimiterSpace, &fields);
   const size_t expected_min_fields = 2;
   if (fields.size() < expected_min_fields) {
     return ParseFailedExpectMinFieldNum(line, expected_min_fields, error);
@@ -1205,7 +1377,7 @@ bool ParseExtmap(const std::string& line,
     return false;
   }
   std::vector<std::string> sub_fields;
-  rtc::split(value_direction, kSdpDelimiterSlash, &sub_fields);
+  SplitLine(value_direction, 0, kSdpDelimiterSlash, &sub_fields);
   int value = 0;
   if (!GetValueFromString(line, sub_fields[0], &value, error)) {
     return false;
@@ -1225,11 +1397,7 @@ void BuildMediaDescription(const ContentInfo* content_info,
   if (content_info == NULL || message == NULL) {
     return;
   }
-  // TODO: Rethink if we should use sprintfn instead of stringstream.
-  // According to the style guide, streams should only be used for logging.
-  // http://google-styleguide.googlecode.com/svn/
-  // trunk/cppguide.xml?showone=Streams#Streams
-  std::ostringstream os;
+  SdpLineBuilder os;
   const MediaContentDescription* media_desc =
       static_cast<const MediaContentDescription*>(
           content_info->description);
@@ -1250,15 +1418,14 @@ void BuildMediaDescription(const ContentInfo* content_info,
   else
     RTC_NOTREACHED();
 
-  std::string fmt;
+  SdpLineBuilder fmt;
   if (media_type == cricket::MEDIA_TYPE_VIDEO) {
     const VideoContentDescription* video_desc =
         static_cast<const VideoContentDescription*>(media_desc);
     for (std::vector<cricket::VideoCodec>::const_iterator it =
              video_desc->codecs().begin();
          it != video_desc->codecs().end(); ++it) {
-      fmt.append(" ");
-      fmt.append(rtc::ToString<int>(it->id));
+      fmt << " " << it->id;
     }
   } else if (media_type == cricket::MEDIA_TYPE_AUDIO) {
     const AudioContentDescription* audio_desc =
@@ -1266,14 +1433,13 @@ void BuildMediaDescription(const ContentInfo* content_info,
     for (std::vector<cricket::AudioCodec>::const_iterator it =
              audio_desc->codecs().begin();
          it != audio_desc->codecs().end(); ++it) {
-      fmt.append(" ");
-      fmt.append(rtc::ToString<int>(it->id));
+      fmt << " " << it->id;
     }
   } else if (media_type == cricket::MEDIA_TYPE_DATA) {
     const DataContentDescription* data_desc =
           static_cast<const DataContentDescription*>(media_desc);
     if (IsDtlsSctp(media_desc->protocol())) {
-      fmt.append(" ");
+      fmt << " ";
 
       for (std::vector<cricket::DataCodec>::const_iterator it =
            data_desc->codecs().begin();
@@ -1284,20 +1450,19 @@ void BuildMediaDescription(const ContentInfo* content_info,
         }
       }
 
-      fmt.append(rtc::ToString<int>(sctp_port));
+      fmt << sctp_port;
     } else {
       for (std::vector<cricket::DataCodec>::const_iterator it =
            data_desc->codecs().begin();
            it != data_desc->codecs().end(); ++it) {
-        fmt.append(" ");
-        fmt.append(rtc::ToString<int>(it->id));
+        fmt << " " << it->id;
       }
     }
   }
   // The fmt must never be empty. If no codecs are found, set the fmt attribute
   // to 0.
-  if (fmt.empty()) {
-    fmt = " 0";
+  if (fmt.str().empty()) {
+    fmt << " 0";
   }
 
   // The port number in the m line will be updated later when associated with
@@ -1319,7 +1484,7 @@ void BuildMediaDescription(const ContentInfo* content_info,
 
   // Add the m and c lines.
   InitLine(kLineTypeMedia, type, &os);
-  os << " " << port << " " << media_desc->protocol() << fmt;
+  os << " " << port << " " << media_desc->protocol() << fmt.str();
   std::string mline = os.str();
   UpdateMediaDefaultDestination(candidates, mline, message);
 
@@ -1419,7 +1584,7 @@ void BuildSctpContentAttributes(std::string* message, int sctp_port) {
   // a=sctpmap:sctpmap-number  protocol  [streams]
   // TODO(lally): switch this over to mmusic-sctp-sdp-12 (or later), with
   // 'a=sctp-port:'
-  std::ostringstream os;
+  SdpLineBuilder os;
   InitAttrLine(kAttributeSctpmap, &os);
   os << kSdpDelimiterColon << sctp_port << kSdpDelimiterSpace
      << kDefaultSctpmapProtocol << kSdpDelimiterSpace
@@ -1432,7 +1597,7 @@ void BuildRtpContentAttributes(const MediaContentDescription* media_desc,
                                const MediaType media_type,
                                bool unified_plan_sdp,
                                std::string* message) {
-  std::ostringstream os;
+  SdpLineBuilder os;
   // RFC 5285
   // a=extmap:<value>["/"<direction>] <URI> <extensionattributes>
   // The definitions MUST be either all session level or all media level. This
@@ -1531,7 +1696,7 @@ void BuildRtpContentAttributes(const MediaContentDescription* media_desc,
       std::vector<uint32_t>::const_iterator ssrc =
           track->ssrc_groups[i].ssrcs.begin();
       for (; ssrc != track->ssrc_groups[i].ssrcs.end(); ++ssrc) {
-        os << kSdpDelimiterSpace << rtc::ToString<uint32_t>(*ssrc);
+        os << kSdpDelimiterSpace << *ssrc;
       }
       AddLine(os.str(), message);
     }
@@ -1566,7 +1731,7 @@ void BuildRtpContentAttributes(const MediaContentDescription* media_desc,
   }
 }
 
-void WriteFmtpHeader(int payload_type, std::ostringstream* os) {
+void WriteFmtpHeader(int payload_type, SdpLineBuilder* os) {
   // fmtp header: a=fmtp:|payload_type| <parameters>
   // Add a=fmtp
   InitAttrLine(kAttributeFmtp, os);
@@ -1574,7 +1739,7 @@ void WriteFmtpHeader(int payload_type, std::ostringstream* os) {
   *os << kSdpDelimiterColon << payload_type;
 }
 
-void WriteRtcpFbHeader(int payload_type, std::ostringstream* os) {
+void WriteRtcpFbHeader(int payload_type, SdpLineBuilder* os) {
   // rtcp-fb header: a=rtcp-fb:|payload_type|
   // <parameters>/<ccm <ccm_parameters>>
   // Add a=rtcp-fb
@@ -1590,13 +1755,13 @@ void WriteRtcpFbHeader(int payload_type, std::ostringstream* os) {
 
 void WriteFmtpParameter(const std::string& parameter_name,
                         const std::string& parameter_value,
-                        std::ostringstream* os) {
+                        SdpLineBuilder* os) {
   // fmtp parameters: |parameter_name|=|parameter_value|
   *os << parameter_name << kSdpDelimiterEqual << parameter_value;
 }
 
 void WriteFmtpParameters(const cricket::CodecParameterMap& parameters,
-                         std::ostringstream* os) {
+                         SdpLineBuilder* os) {
   for (cricket::CodecParameterMap::const_iterator fmtp = parameters.begin();
        fmtp != parameters.end(); ++fmtp) {
     // Parameters are a semicolon-separated list, no spaces.
@@ -1638,7 +1803,7 @@ void AddFmtpLine(const T& codec, std::string* message) {
     // No need to add an fmtp if it will have no (optional) parameters.
     return;
   }
-  std::ostringstream os;
+  SdpLineBuilder os;
   WriteFmtpHeader(codec.id, &os);
   WriteFmtpParameters(fmtp_parameters, &os);
   AddLine(os.str(), message);
@@ -1647,10 +1812,10 @@ void AddFmtpLine(const T& codec, std::string* message) {
 
 template <class T>
 void AddRtcpFbLines(const T& codec, std::string* message) {
+  SdpLineBuilder os;
   for (std::vector<cricket::FeedbackParam>::const_iterator iter =
            codec.feedback_params.params().begin();
        iter != codec.feedback_params.params().end(); ++iter) {
-    std::ostringstream os;
     WriteRtcpFbHeader(codec.id, &os);
     os << " " << iter->id();
     if (!iter->param().empty()) {
@@ -1707,7 +1872,7 @@ void BuildRtpMap(const MediaContentDescription* media_desc,
                  std::string* message) {
   RTC_DCHECK(message != NULL);
   RTC_DCHECK(media_desc != NULL);
-  std::ostringstream os;
+  SdpLineBuilder os;
   if (media_type == cricket::MEDIA_TYPE_VIDEO) {
     const VideoContentDescription* video_desc =
         static_cast<const VideoContentDescription*>(media_desc);
@@ -1796,7 +1961,7 @@ void BuildRtpMap(const MediaContentDescription* media_desc,
 void BuildCandidate(const std::vector<Candidate>& candidates,
                     bool include_ufrag,
                     std::string* message) {
-  std::ostringstream os;
+  SdpLineBuilder os;
 
   for (std::vector<Candidate>::const_iterator it = candidates.begin();
        it != candidates.end(); ++it) {
@@ -1864,7 +2029,7 @@ void BuildCandidate(const std::vector<Candidate>& candidates,
 void BuildIceOptions(const std::vector<std::string>& transport_options,
                      std::string* message) {
   if (!transport_options.empty()) {
-    std::ostringstream os;
+    SdpLineBuilder os;
     InitAttrLine(kAttributeIceOption, &os);
     os << kSdpDelimiterColon << transport_options[0];
     for (size_t i = 1; i < transport_options.size(); ++i) {
@@ -1909,8 +2074,7 @@ bool ParseSessionDescription(const std::string& message, size_t* pos,
                                  std::string(), error);
   }
   std::vector<std::string> fields;
-  rtc::split(line.substr(kLinePrefixLength),
-                   kSdpDelimiterSpace, &fields);
+  SplitLine(line, kLinePrefixLength, kSdpDelimiterSpace, &fields);
   const size_t expected_fields = 6;
   if (fields.size() != expected_fields) {
     return ParseFailedExpectFieldNum(line, expected_fields, error);
@@ -2048,8 +2212,7 @@ bool ParseGroupAttribute(const std::string& line,
   // RFC 5888 and draft-holmberg-mmusic-sdp-bundle-negotiation-00
   // a=group:BUNDLE video voice
   std::vector<std::string> fields;
-  rtc::split(line.substr(kLinePrefixLength),
-                   kSdpDelimiterSpace, &fields);
+  SplitLine(line, kLinePrefixLength, kSdpDelimiterSpace, &fields);
   std::string semantics;
   if (!GetValue(fields[0], kAttributeGroup, &semantics, error)) {
     return false;
@@ -2072,8 +2235,7 @@ static bool ParseFingerprintAttribute(const std::string& line,
   }
 
   std::vector<std::string> fields;
-  rtc::split(line.substr(kLinePrefixLength),
-                   kSdpDelimiterSpace, &fields);
+  SplitLine(line, kLinePrefixLength, kSdpDelimiterSpace, &fields);
   const size_t expected_fields = 2;
   if (fields.size() != expected_fields) {
     return ParseFailedExpectFieldNum(line, expected_fields, error);
@@ -2108,7 +2270,7 @@ static bool ParseDtlsSetup(const std::string& line,
   // setup-attr           =  "a=setup:" role
   // role                 =  "active" / "passive" / "actpass" / "holdconn"
   std::vector<std::string> fields;
-  rtc::split(line.substr(kLinePrefixLength), kSdpDelimiterColon, &fields);
+  SplitLine(line, kLinePrefixLength, kSdpDelimiterColon, &fields);
   const size_t expected_fields = 2;
   if (fields.size() != expected_fields) {
     return ParseFailedExpectFieldNum(line, expected_fields, error);
@@ -2289,8 +2451,7 @@ bool ParseMediaDescription(const std::string& message,
     ++mline_index;
 
     std::vector<std::string> fields;
-    rtc::split(line.substr(kLinePrefixLength),
-                     kSdpDelimiterSpace, &fields);
+    SplitLine(line, kLinePrefixLength, kSdpDelimiterSpace, &fields);
     const size_t expected_min_fields = 4;
     if (fields.size() < expected_min_fields) {
       return ParseFailedExpectMinFieldNum(line, expected_min_fields, error);
@@ -2489,23 +2650,7 @@ T GetCodecWithPayloadType(const std::vector<T>& codecs, int payload_type) {
 // Updates or creates a new codec entry in the audio description.
 template <class T, class U>
 void AddOrReplaceCodec(MediaContentDescription* content_desc, const U& codec) {
-  T* desc = static_cast<T*>(content_desc);
-  std::vector<U> codecs = desc->codecs();
-  bool found = false;
-
-  typename std::vector<U>::iterator iter;
-  for (iter = codecs.begin(); iter != codecs.end(); ++iter) {
-    if (iter->id == codec.id) {
-      *iter = codec;
-      found = true;
-      break;
-    }
-  }
-  if (!found) {
-    desc->AddCodec(codec);
-    return;
-  }
-  desc->set_codecs(codecs);
+  static_cast<T*>(content_desc)->AddOrReplaceCodec(codec);
 }
 
 // Adds or updates existing codec corresponding to |payload_type| according
@@ -2604,6 +2749,7 @@ bool ParseContent(const std::string& message,
   std::string ptime_as_string;
   std::string stream_id;
   std::string track_id;
+  const bool is_rtp = IsRtp(protocol);
 
   // Loop until the next m line
   while (!IsLineType(message, kLineTypeMedia, *pos)) {
@@ -2631,7 +2777,7 @@ bool ParseContent(const std::string& message,
           // data channels. Don't allow SDP to set the bandwidth, because
           // that would give JS the opportunity to "break the Internet".
           // See: https://code.google.com/p/chromium/issues/detail?id=280726
-          if (media_type == cricket::MEDIA_TYPE_DATA && IsRtp(protocol) &&
+          if (media_type == cricket::MEDIA_TYPE_DATA && is_rtp &&
               b > cricket::kDataMaxBandwidth / 1000) {
             std::ostringstream description;
             description << "RTP-based data channels may not send more than "
@@ -2717,7 +2863,7 @@ bool ParseContent(const std::string& message,
                             sctp_port)) {
         return false;
       }
-    } else if (IsRtp(protocol)) {
+    } else if (is_rtp) {
       //
       // RTP specific attrubtes
       //
@@ -2912,7 +3058,7 @@ bool ParseSsrcAttribute(const std::string& line, SsrcInfoVec* ssrc_infos,
     // draft-alvestrand-mmusic-msid-00
     // "msid:" identifier [ " " appdata ]
     std::vector<std::string> fields;
-    rtc::split(value, kSdpDelimiterSpace, &fields);
+    SplitLine(value, 0, kSdpDelimiterSpace, &fields);
     if (fields.size() < 1 || fields.size() > 2) {
       return ParseFailed(line,
                          "Expected format \"msid:<identifier>[ <appdata>]\".",
@@ -2941,8 +3087,7 @@ bool ParseSsrcGroupAttribute(const std::string& line,
   // RFC 5576
   // a=ssrc-group:<semantics> <ssrc-id> ...
   std::vector<std::string> fields;
-  rtc::split(line.substr(kLinePrefixLength),
-                   kSdpDelimiterSpace, &fields);
+  SplitLine(line, kLinePrefixLength, kSdpDelimiterSpace, &fields);
   const size_t expected_min_fields = 2;
   if (fields.size() < expected_min_fields) {
     return ParseFailedExpectMinFieldNum(line, expected_min_fields, error);
@@ -2967,8 +3112,7 @@ bool ParseCryptoAttribute(const std::string& line,
                           MediaContentDescription* media_desc,
                           SdpParseError* error) {
   std::vector<std::string> fields;
-  rtc::split(line.substr(kLinePrefixLength),
-                   kSdpDelimiterSpace, &fields);
+  SplitLine(line, kLinePrefixLength, kSdpDelimiterSpace, &fields);
   // RFC 4568
   // a=crypto:<tag> <crypto-suite> <key-params> [<session-params>]
   const size_t expected_min_fields = 3;
@@ -3034,8 +3178,7 @@ bool ParseRtpmapAttribute(const std::string& line,
                           MediaContentDescription* media_desc,
                           SdpParseError* error) {
   std::vector<std::string> fields;
-  rtc::split(line.substr(kLinePrefixLength),
-                   kSdpDelimiterSpace, &fields);
+  SplitLine(line, kLinePrefixLength, kSdpDelimiterSpace, &fields);
   // RFC 4566
   // a=rtpmap:<payload type> <encoding name>/<clock rate>[/<encodingparameters>]
   const size_t expected_min_fields = 2;
@@ -3060,7 +3203,7 @@ bool ParseRtpmapAttribute(const std::string& line,
   }
   const std::string& encoder = fields[1];
   std::vector<std::string> codec_params;
-  rtc::split(encoder, '/', &codec_params);
+  SplitLine(encoder, 0, '/', &codec_params);
   // <encoding name>/<clock rate>[/<encodingparameters>]
   // 2 mandatory fields
   if (codec_params.size() < 2 || codec_params.size() > 3) {
@@ -3148,7 +3291,7 @@ bool ParseFmtpAttributes(const std::string& line, const MediaType media_type,
 
   // Parse out format specific parameters.
   std::vector<std::string> fields;
-  rtc::split(line_params, kSdpDelimiterSemicolon, &fields);
+  SplitLine(line_params, 0, kSdpDelimiterSemicolon, &fields);
 
   cricket::CodecParameterMap codec_params;
   for (auto& iter : fields) {
@@ -3184,7 +3327,7 @@ bool ParseRtcpFbAttribute(const std::string& line, const MediaType media_type,
     return true;
   }
   std::vector<std::string> rtcp_fb_fields;
-  rtc::split(line.c_str(), kSdpDelimiterSpace, &rtcp_fb_fields);
+  SplitLine(line, 0, kSdpDelimiterSpace, &rtcp_fb_fields);
   if (rtcp_fb_fields.size() < 2) {
     return ParseFailedGetValue(line, kAttributeRtcpFb, error);
   }
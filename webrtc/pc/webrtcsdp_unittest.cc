@@ -21,6 +21,7 @@
 #include "webrtc/base/sslfingerprint.h"
 #include "webrtc/base/stringencode.h"
 #include "webrtc/base/stringutils.h"
+#include "webrtc/base/timeutils.h"
 #include "webrtc/media/base/mediaconstants.h"
 #include "webrtc/media/engine/webrtcvideoengine2.h"
 #include "webrtc/modules/video_coding/codecs/h264/include/h264.h"
@@ -30,6 +31,7 @@
 #include "webrtc/pc/test/androidtestinitializer.h"
 #endif
 #include "webrtc/pc/webrtcsdp.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 using cricket::AudioCodec;
 using cricket::AudioContentDescription;
@@ -3479,3 +3481,158 @@ TEST_F(WebRtcSdpTest, DeserializeMsidAttributeWithMissingStreamId) {
   JsepSessionDescription jdesc_output(kDummyString);
   EXPECT_FALSE(SdpDeserialize(kSdpWithMissingStreamId, &jdesc_output));
 }
+
+// Builds an offer with |num_tracks| audio and |num_tracks| video tracks, with
+// the attributes a browser would put in it. With |unified_plan| each track has
+// its own m= section, otherwise the tracks of each kind share one. The offer
+// is written the way SdpSerialize() writes it, so that serializing the parsed
+// offer gives back the same string.
+static std::string CreateLargeSdp(bool unified_plan, int num_tracks) {
+  std::string sdp =
+      "v=0\r\n"
+      "o=- 18446744069414584320 18446462598732840960 IN IP4 127.0.0.1\r\n"
+      "s=-\r\n"
+      "t=0 0\r\n"
+      "a=msid-semantic: WMS local_stream\r\n";
+  const int num_sections = unified_plan ? 2 * num_tracks : 2;
+  for (int section = 0; section < num_sections; ++section) {
+    const bool audio = unified_plan ? section < num_tracks : section == 0;
+    const std::string mid = rtc::ToString<>(section);
+    if (audio) {
+      sdp +=
+          "m=audio 36768 UDP/TLS/RTP/SAVPF 111 103 104 9 0 8 106 105 13 "
+          "126\r\n";
+    } else {
+      sdp += "m=video 36768 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101 102\r\n";
+    }
+    sdp +=
+        "c=IN IP4 46.2.2.2\r\n"
+        "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+        "a=candidate:1467250027 1 udp 2122260223 192.168.0.196 46243 typ host "
+        "generation 0\r\n"
+        "a=candidate:1853887674 1 udp 1845501695 46.2.2.2 36768 typ srflx "
+        "raddr 192.168.0.196 rport 46243 generation 0\r\n"
+        "a=ice-ufrag:ETEn1v9DoTMB9J4r\r\n"
+        "a=ice-pwd:OtSK0WpNtpUjkY4+86js7ZQl\r\n"
+        "a=ice-options:trickle\r\n"
+        "a=fingerprint:sha-256 "
+        "19:E2:1C:3B:4B:9F:81:E6:B8:5C:F4:A5:A8:D8:73:04:BB:05:2F:70:9F:04:A9:"
+        "0E:05:E9:26:33:E8:70:88:A2\r\n"
+        "a=setup:actpass\r\n"
+        "a=mid:" + mid + "\r\n";
+    if (audio) {
+      sdp +=
+          "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n";
+    } else {
+      sdp +=
+          "a=extmap:2 urn:ietf:params:rtp-hdrext:toffset\r\n"
+          "a=extmap:3 "
+          "http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+          "a=extmap:4 urn:3gpp:video-orientation\r\n";
+    }
+    sdp += "a=sendrecv\r\n";
+    const int first_track = unified_plan ? section % num_tracks : 0;
+    const int end_track = unified_plan ? first_track + 1 : num_tracks;
+    const std::string kind = audio ? "audio" : "video";
+    if (unified_plan) {
+      sdp += "a=msid:local_stream " + kind + "_track_" +
+             rtc::ToString<>(first_track) + "\r\n";
+    }
+    sdp += "a=rtcp-mux\r\n";
+    if (audio) {
+      sdp +=
+          "a=rtpmap:111 opus/48000/2\r\n"
+          "a=rtcp-fb:111 transport-cc\r\n"
+          "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+          "a=rtpmap:103 ISAC/16000\r\n"
+          "a=rtpmap:104 ISAC/32000\r\n"
+          "a=rtpmap:9 G722/8000\r\n"
+          "a=rtpmap:0 PCMU/8000\r\n"
+          "a=rtpmap:8 PCMA/8000\r\n"
+          "a=rtpmap:106 CN/32000\r\n"
+          "a=rtpmap:105 CN/16000\r\n"
+          "a=rtpmap:13 CN/8000\r\n"
+          "a=rtpmap:126 telephone-event/8000\r\n";
+    } else {
+      sdp += "a=rtcp-rsize\r\n";
+      const char* const kCodecs[] = {"VP8", "VP9", "H264"};
+      for (int i = 0; i < 3; ++i) {
+        const std::string pt = rtc::ToString<>(96 + 2 * i);
+        sdp += "a=rtpmap:" + pt + " " + kCodecs[i] + "/90000\r\n" +
+               "a=rtcp-fb:" + pt + " goog-remb\r\n" +
+               "a=rtcp-fb:" + pt + " transport-cc\r\n" +
+               "a=rtcp-fb:" + pt + " ccm fir\r\n" +
+               "a=rtcp-fb:" + pt + " nack\r\n" +
+               "a=rtcp-fb:" + pt + " nack pli\r\n";
+        if (i == 2) {
+          sdp += "a=fmtp:" + pt +
+                 " level-asymmetry-allowed=1;packetization-mode=1;"
+                 "profile-level-id=42e01f\r\n";
+        }
+        const std::string rtx_pt = rtc::ToString<>(97 + 2 * i);
+        sdp += "a=rtpmap:" + rtx_pt + " rtx/90000\r\n" + "a=fmtp:" + rtx_pt +
+               " apt=" + pt + "\r\n";
+      }
+      sdp += "a=rtpmap:102 red/90000\r\n";
+    }
+    for (int track = first_track; track < end_track; ++track) {
+      const std::string track_id = kind + "_track_" + rtc::ToString<>(track);
+      const uint32_t ssrc = 1000 * (audio ? 1 : 2) + 10 * track;
+      std::vector<uint32_t> ssrcs(1, ssrc);
+      if (!audio) {
+        ssrcs.push_back(ssrc + 1);
+        sdp += "a=ssrc-group:FID " + rtc::ToString<>(ssrc) + " " +
+               rtc::ToString<>(ssrc + 1) + "\r\n";
+      }
+      for (uint32_t track_ssrc : ssrcs) {
+        const std::string prefix = "a=ssrc:" + rtc::ToString<>(track_ssrc);
+        sdp += prefix + " cname:L4eeNv5dIh1gavNS\r\n" + prefix +
+               " msid:local_stream " + track_id + "\r\n" + prefix +
+               " mslabel:local_stream\r\n" + prefix + " label:" + track_id +
+               "\r\n";
+      }
+    }
+  }
+  return sdp;
+}
+
+// Measures parsing and serializing of large offers, such as those of
+// conferences.
+TEST_F(WebRtcSdpTest, SerializeAndDeserializeLargeSdpPerformance) {
+  const int kNumTracks = 32;
+  const int kNumRuns = 20;
+  for (bool unified_plan : {false, true}) {
+    const std::string sdp = CreateLargeSdp(unified_plan, kNumTracks);
+    JsepSessionDescription jdesc(kDummyString);
+    SdpParseError error;
+    ASSERT_TRUE(webrtc::SdpDeserialize(sdp, &jdesc, &error))
+        << error.description;
+    EXPECT_EQ(unified_plan ? 2u * kNumTracks : 2u,
+              jdesc.description()->contents().size());
+    // Serializing what was parsed gives back the same message.
+    EXPECT_EQ(sdp, webrtc::SdpSerialize(jdesc, unified_plan));
+
+    int64_t start_ns = rtc::SystemTimeNanos();
+    for (int i = 0; i < kNumRuns; ++i) {
+      JsepSessionDescription parsed_jdesc(kDummyString);
+      ASSERT_TRUE(webrtc::SdpDeserialize(sdp, &parsed_jdesc, &error));
+    }
+    int64_t deserialize_ns = (rtc::SystemTimeNanos() - start_ns) / kNumRuns;
+    start_ns = rtc::SystemTimeNanos();
+    for (int i = 0; i < kNumRuns; ++i) {
+      EXPECT_EQ(sdp.size(), webrtc::SdpSerialize(jdesc, unified_plan).size());
+    }
+    int64_t serialize_ns = (rtc::SystemTimeNanos() - start_ns) / kNumRuns;
+
+    const std::string sdp_type =
+        unified_plan ? "unified_plan_offer" : "plan_b_offer";
+    webrtc::test::PrintResult(
+        "webrtc_sdp", "_deserialize", sdp_type,
+        static_cast<double>(deserialize_ns) / rtc::kNumNanosecsPerMicrosec,
+        "us", false);
+    webrtc::test::PrintResult(
+        "webrtc_sdp", "_serialize", sdp_type,
+        static_cast<double>(serialize_ns) / rtc::kNumNanosecsPerMicrosec, "us",
+        false);
+  }
+}
@@ -510,7 +510,8 @@ bool WebRtcSession::Initialize(
     const PeerConnectionInterface::RTCConfiguration& rtc_configuration) {
   bundle_policy_ = rtc_configuration.bundle_policy;
   rtcp_mux_policy_ = rtc_configuration.rtcp_mux_policy;
-  transport_controller_->SetSslMaxProtocolVersion(options.ssl_max_version);
+  transport_controller_->Configure(options.ssl_max_version,
+                                   ParseIceConfig(rtc_configuration));
 
   // Obtain a certificate from RTCConfiguration if any were provided (optional).
   rtc::scoped_refptr<rtc::RTCCertificate> certificate;
@@ -521,8 +522,6 @@ bool WebRtcSession::Initialize(
     certificate = rtc_configuration.certificates[0];
   }
 
-  SetIceConfig(ParseIceConfig(rtc_configuration));
-
   if (options.disable_encryption) {
     dtls_enabled_ = false;
   } else {
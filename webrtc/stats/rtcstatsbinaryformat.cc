@@ -0,0 +1,549 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/api/stats/rtcstatsbinaryformat.h"
+
+#include <string.h>
+
+#include <utility>
+
+#include "webrtc/base/checks.h"
+
+namespace webrtc {
+
+namespace {
+
+const uint8_t kReportTag = 0x01;
+const uint8_t kSchemaTag = 0x02;
+const uint8_t kStatsTag = 0x03;
+const uint8_t kRemovedTag = 0x04;
+const uint8_t kEndTag = 0x05;
+
+const uint8_t kDeltaFlag = 0x01;
+
+// A 64-bit value takes at most 10 bytes as a varint.
+const int kMaxVarintBytes = 10;
+
+uint64_t ToZigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t FromZigzag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+const RTCStatsMemberInterface& MemberAt(const RTCStats& stats,
+                                        ptrdiff_t offset) {
+  return *reinterpret_cast<const RTCStatsMemberInterface*>(
+      reinterpret_cast<const char*>(&stats) + offset);
+}
+
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size)
+      : data_(data), size_(size), position_(0), error_(false) {}
+
+  size_t position() const { return position_; }
+  bool error() const { return error_; }
+
+  uint8_t ReadByte() {
+    if (position_ == size_) {
+      error_ = true;
+      return 0;
+    }
+    return data_[position_++];
+  }
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int i = 0; i < kMaxVarintBytes; ++i) {
+      uint8_t byte = ReadByte();
+      value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+      if (!(byte & 0x80))
+        return value;
+    }
+    error_ = true;
+    return 0;
+  }
+  int64_t ReadSigned() { return FromZigzag(ReadVarint()); }
+  // Reads the size of a string or sequence, of which every element takes at
+  // least one byte.
+  size_t ReadSize() {
+    uint64_t value = ReadVarint();
+    if (value > size_ - position_) {
+      error_ = true;
+      return 0;
+    }
+    return static_cast<size_t>(value);
+  }
+  double ReadDouble() {
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i)
+      bits |= static_cast<uint64_t>(ReadByte()) << (8 * i);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  std::string ReadString() {
+    size_t length = ReadSize();
+    if (error_)
+      return std::string();
+    std::string value(reinterpret_cast<const char*>(data_ + position_),
+                      length);
+    position_ += length;
+    return value;
+  }
+
+ private:
+  const uint8_t* const data_;
+  const size_t size_;
+  size_t position_;
+  bool error_;
+};
+
+bool ReadValue(Reader* reader, bool* value) {
+  *value = reader->ReadByte() != 0;
+  return !reader->error();
+}
+bool ReadValue(Reader* reader, int32_t* value) {
+  *value = static_cast<int32_t>(reader->ReadSigned());
+  return !reader->error();
+}
+bool ReadValue(Reader* reader, uint32_t* value) {
+  *value = static_cast<uint32_t>(reader->ReadVarint());
+  return !reader->error();
+}
+bool ReadValue(Reader* reader, int64_t* value) {
+  *value = reader->ReadSigned();
+  return !reader->error();
+}
+bool ReadValue(Reader* reader, uint64_t* value) {
+  *value = reader->ReadVarint();
+  return !reader->error();
+}
+bool ReadValue(Reader* reader, double* value) {
+  *value = reader->ReadDouble();
+  return !reader->error();
+}
+bool ReadValue(Reader* reader, std::string* value) {
+  *value = reader->ReadString();
+  return !reader->error();
+}
+template <typename T>
+bool ReadValue(Reader* reader, std::vector<T>* value) {
+  size_t size = reader->ReadSize();
+  value->clear();
+  for (size_t i = 0; i < size && !reader->error(); ++i) {
+    T element;
+    ReadValue(reader, &element);
+    value->push_back(element);
+  }
+  return !reader->error();
+}
+
+// Reads a value of type T and formats it like
+// |RTCStatsMemberInterface::ValueToString|.
+template <typename T>
+bool ReadValueToString(Reader* reader, std::string* value_string) {
+  T value;
+  if (!ReadValue(reader, &value))
+    return false;
+  *value_string = RTCStatsMember<T>("", value).ValueToString();
+  return true;
+}
+
+bool ReadMemberValue(Reader* reader,
+                     RTCStatsMemberInterface::Type type,
+                     std::string* value) {
+  switch (type) {
+    case RTCStatsMemberInterface::kBool:
+      return ReadValueToString<bool>(reader, value);
+    case RTCStatsMemberInterface::kInt32:
+      return ReadValueToString<int32_t>(reader, value);
+    case RTCStatsMemberInterface::kUint32:
+      return ReadValueToString<uint32_t>(reader, value);
+    case RTCStatsMemberInterface::kInt64:
+      return ReadValueToString<int64_t>(reader, value);
+    case RTCStatsMemberInterface::kUint64:
+      return ReadValueToString<uint64_t>(reader, value);
+    case RTCStatsMemberInterface::kDouble:
+      return ReadValueToString<double>(reader, value);
+    case RTCStatsMemberInterface::kString:
+      return ReadValueToString<std::string>(reader, value);
+    case RTCStatsMemberInterface::kSequenceBool:
+      return ReadValueToString<std::vector<bool>>(reader, value);
+    case RTCStatsMemberInterface::kSequenceInt32:
+      return ReadValueToString<std::vector<int32_t>>(reader, value);
+    case RTCStatsMemberInterface::kSequenceUint32:
+      return ReadValueToString<std::vector<uint32_t>>(reader, value);
+    case RTCStatsMemberInterface::kSequenceInt64:
+      return ReadValueToString<std::vector<int64_t>>(reader, value);
+    case RTCStatsMemberInterface::kSequenceUint64:
+      return ReadValueToString<std::vector<uint64_t>>(reader, value);
+    case RTCStatsMemberInterface::kSequenceDouble:
+      return ReadValueToString<std::vector<double>>(reader, value);
+    case RTCStatsMemberInterface::kSequenceString:
+      return ReadValueToString<std::vector<std::string>>(reader, value);
+  }
+  return false;
+}
+
+}  // namespace
+
+// Writes to the caller's buffer. Once the buffer is full, writes are dropped
+// and |overflow| is set, so that the size of the report doesn't have to be
+// checked before writing it.
+class RTCStatsBinaryWriter::Buffer {
+ public:
+  Buffer(uint8_t* data, size_t size)
+      : data_(data), size_(size), position_(0), overflow_(false) {}
+
+  size_t position() const { return position_; }
+  bool overflow() const { return overflow_; }
+
+  void WriteByte(uint8_t byte) {
+    if (position_ == size_) {
+      overflow_ = true;
+      return;
+    }
+    data_[position_++] = byte;
+  }
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      WriteByte(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    WriteByte(static_cast<uint8_t>(value));
+  }
+  void WriteSigned(int64_t value) { WriteVarint(ToZigzag(value)); }
+  void WriteDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i)
+      WriteByte(static_cast<uint8_t>(bits >> (8 * i)));
+  }
+  void WriteString(const char* value, size_t length) {
+    WriteVarint(length);
+    if (length > size_ - position_) {
+      overflow_ = true;
+      position_ = size_;
+      return;
+    }
+    memcpy(data_ + position_, value, length);
+    position_ += length;
+  }
+  void WriteString(const std::string& value) {
+    WriteString(value.data(), value.size());
+  }
+
+  void WriteValue(bool value) { WriteByte(value ? 1 : 0); }
+  void WriteValue(int32_t value) { WriteSigned(value); }
+  void WriteValue(uint32_t value) { WriteVarint(value); }
+  void WriteValue(int64_t value) { WriteSigned(value); }
+  void WriteValue(uint64_t value) { WriteVarint(value); }
+  void WriteValue(double value) { WriteDouble(value); }
+  void WriteValue(const std::string& value) { WriteString(value); }
+  template <typename T>
+  void WriteValue(const std::vector<T>& value) {
+    WriteVarint(value.size());
+    for (const T& element : value)
+      WriteValue(element);
+  }
+  // std::vector<bool> elements are proxies rather than bools.
+  void WriteValue(const std::vector<bool>& value) {
+    WriteVarint(value.size());
+    for (bool element : value)
+      WriteValue(element);
+  }
+
+  template <typename T>
+  void WriteMember(const RTCStatsMemberInterface& member) {
+    WriteValue(*member.cast_to<RTCStatsMember<T>>());
+  }
+  void WriteMemberValue(const RTCStatsMemberInterface& member) {
+    switch (member.type()) {
+      case RTCStatsMemberInterface::kBool:
+        WriteMember<bool>(member);
+        break;
+      case RTCStatsMemberInterface::kInt32:
+        WriteMember<int32_t>(member);
+        break;
+      case RTCStatsMemberInterface::kUint32:
+        WriteMember<uint32_t>(member);
+        break;
+      case RTCStatsMemberInterface::kInt64:
+        WriteMember<int64_t>(member);
+        break;
+      case RTCStatsMemberInterface::kUint64:
+        WriteMember<uint64_t>(member);
+        break;
+      case RTCStatsMemberInterface::kDouble:
+        WriteMember<double>(member);
+        break;
+      case RTCStatsMemberInterface::kString:
+        WriteMember<std::string>(member);
+        break;
+      case RTCStatsMemberInterface::kSequenceBool:
+        WriteMember<std::vector<bool>>(member);
+        break;
+      case RTCStatsMemberInterface::kSequenceInt32:
+        WriteMember<std::vector<int32_t>>(member);
+        break;
+      case RTCStatsMemberInterface::kSequenceUint32:
+        WriteMember<std::vector<uint32_t>>(member);
+        break;
+      case RTCStatsMemberInterface::kSequenceInt64:
+        WriteMember<std::vector<int64_t>>(member);
+        break;
+      case RTCStatsMemberInterface::kSequenceUint64:
+        WriteMember<std::vector<uint64_t>>(member);
+        break;
+      case RTCStatsMemberInterface::kSequenceDouble:
+        WriteMember<std::vector<double>>(member);
+        break;
+      case RTCStatsMemberInterface::kSequenceString:
+        WriteMember<std::vector<std::string>>(member);
+        break;
+    }
+  }
+
+ private:
+  uint8_t* const data_;
+  const size_t size_;
+  size_t position_;
+  bool overflow_;
+};
+
+RTCStatsBinaryWriter::RTCStatsBinaryWriter() {}
+
+RTCStatsBinaryWriter::~RTCStatsBinaryWriter() {}
+
+size_t RTCStatsBinaryWriter::Write(
+    const rtc::scoped_refptr<const RTCStatsReport>& report,
+    Mode mode,
+    uint8_t* buffer,
+    size_t buffer_size) {
+  RTC_DCHECK(report);
+  const RTCStatsReport* previous_report =
+      mode == kDelta ? previous_report_.get() : nullptr;
+  Buffer out(buffer, buffer_size);
+  out.WriteByte(kReportTag);
+  out.WriteByte(previous_report ? kDeltaFlag : 0);
+  out.WriteSigned(report->timestamp_us());
+
+  for (const RTCStats& stats : *report) {
+    Schema* schema = GetSchema(stats);
+    if (!schema->written) {
+      out.WriteByte(kSchemaTag);
+      out.WriteVarint(schema->number);
+      out.WriteString(schema->type, strlen(schema->type));
+      out.WriteVarint(schema->member_offsets.size());
+      for (ptrdiff_t offset : schema->member_offsets) {
+        const RTCStatsMemberInterface& member = MemberAt(stats, offset);
+        out.WriteByte(static_cast<uint8_t>(member.type()));
+        out.WriteString(member.name(), strlen(member.name()));
+      }
+      schema->written = true;
+      written_schemas_.push_back(schema->number);
+    }
+    const RTCStats* previous_stats =
+        previous_report ? previous_report->Get(stats.id()) : nullptr;
+    if (previous_stats && previous_stats->type() != stats.type())
+      previous_stats = nullptr;
+    WriteStats(stats, *schema, previous_stats, report->timestamp_us(),
+               previous_report ? previous_report->timestamp_us() : 0, &out);
+  }
+  if (previous_report) {
+    for (const RTCStats& stats : *previous_report) {
+      if (!report->Get(stats.id())) {
+        out.WriteByte(kRemovedTag);
+        out.WriteString(stats.id());
+      }
+    }
+  }
+  out.WriteByte(kEndTag);
+
+  if (out.overflow()) {
+    // The reader will not see the schemas, write them again next time.
+    for (uint32_t number : written_schemas_)
+      schemas_[number].written = false;
+    written_schemas_.clear();
+    return 0;
+  }
+  written_schemas_.clear();
+  previous_report_ = report;
+  return out.position();
+}
+
+RTCStatsBinaryWriter::Schema* RTCStatsBinaryWriter::GetSchema(
+    const RTCStats& stats) {
+  // There are a dozen stats types, a linear search of the type pointers is
+  // as fast as any lookup.
+  for (Schema& schema : schemas_) {
+    if (schema.type == stats.type())
+      return &schema;
+  }
+  Schema schema;
+  schema.type = stats.type();
+  schema.number = static_cast<uint32_t>(schemas_.size());
+  for (const RTCStatsMemberInterface* member : stats.Members()) {
+    schema.member_offsets.push_back(reinterpret_cast<const char*>(member) -
+                                    reinterpret_cast<const char*>(&stats));
+  }
+  schema.written = false;
+  schemas_.push_back(std::move(schema));
+  return &schemas_.back();
+}
+
+void RTCStatsBinaryWriter::WriteStats(const RTCStats& stats,
+                                      const Schema& schema,
+                                      const RTCStats* previous_stats,
+                                      int64_t timestamp_us,
+                                      int64_t previous_timestamp_us,
+                                      Buffer* out) {
+  const int64_t timestamp_offset_us = stats.timestamp_us() - timestamp_us;
+  // Without previous stats, the defined members are written. Otherwise the
+  // members which changed are, including those which became undefined.
+  size_t num_members = 0;
+  for (ptrdiff_t offset : schema.member_offsets) {
+    const RTCStatsMemberInterface& member = MemberAt(stats, offset);
+    if (previous_stats ? member != MemberAt(*previous_stats, offset)
+                       : member.is_defined()) {
+      ++num_members;
+    }
+  }
+  if (previous_stats && num_members == 0 &&
+      previous_stats->timestamp_us() - previous_timestamp_us ==
+          timestamp_offset_us) {
+    return;
+  }
+
+  out->WriteByte(kStatsTag);
+  out->WriteVarint(schema.number);
+  out->WriteString(stats.id());
+  out->WriteSigned(timestamp_offset_us);
+  out->WriteVarint(num_members);
+  for (size_t i = 0; i < schema.member_offsets.size(); ++i) {
+    const RTCStatsMemberInterface& member =
+        MemberAt(stats, schema.member_offsets[i]);
+    if (previous_stats
+            ? member == MemberAt(*previous_stats, schema.member_offsets[i])
+            : !member.is_defined()) {
+      continue;
+    }
+    out->WriteVarint((i << 1) | (member.is_defined() ? 1 : 0));
+    if (member.is_defined())
+      out->WriteMemberValue(member);
+  }
+}
+
+RTCStatsBinaryReader::Stats::Stats() : timestamp_us(0) {}
+
+RTCStatsBinaryReader::Stats::Stats(const Stats& other) = default;
+
+RTCStatsBinaryReader::Stats::~Stats() {}
+
+RTCStatsBinaryReader::Schema::Schema() {}
+
+RTCStatsBinaryReader::Schema::Schema(const Schema& other) = default;
+
+RTCStatsBinaryReader::Schema::~Schema() {}
+
+RTCStatsBinaryReader::RTCStatsBinaryReader() : timestamp_us_(0) {}
+
+RTCStatsBinaryReader::~RTCStatsBinaryReader() {}
+
+size_t RTCStatsBinaryReader::Read(const uint8_t* data, size_t size) {
+  Reader reader(data, size);
+  if (reader.ReadByte() != kReportTag)
+    return 0;
+  const bool delta = (reader.ReadByte() & kDeltaFlag) != 0;
+  const int64_t timestamp_us = reader.ReadSigned();
+  if (reader.error())
+    return 0;
+  if (delta) {
+    // Stats left out of a delta report are unchanged relative to the report.
+    for (auto& id_and_stats : stats_)
+      id_and_stats.second.timestamp_us += timestamp_us - timestamp_us_;
+  } else {
+    stats_.clear();
+  }
+  timestamp_us_ = timestamp_us;
+
+  while (true) {
+    uint8_t tag = reader.ReadByte();
+    if (reader.error())
+      return 0;
+    switch (tag) {
+      case kSchemaTag: {
+        uint32_t number = static_cast<uint32_t>(reader.ReadVarint());
+        Schema& schema = schemas_[number];
+        schema.type = reader.ReadString();
+        size_t num_members = reader.ReadSize();
+        schema.members.clear();
+        for (size_t i = 0; i < num_members && !reader.error(); ++i) {
+          Member member;
+          uint8_t type = reader.ReadByte();
+          if (type > RTCStatsMemberInterface::kSequenceString)
+            return 0;
+          member.type = static_cast<RTCStatsMemberInterface::Type>(type);
+          member.name = reader.ReadString();
+          member.is_defined = false;
+          schema.members.push_back(member);
+        }
+        break;
+      }
+      case kStatsTag: {
+        auto schema_it = schemas_.find(
+            static_cast<uint32_t>(reader.ReadVarint()));
+        if (schema_it == schemas_.end())
+          return 0;
+        const Schema& schema = schema_it->second;
+        std::string id = reader.ReadString();
+        int64_t stats_timestamp_us = timestamp_us + reader.ReadSigned();
+        if (reader.error())
+          return 0;
+        Stats& stats = stats_[id];
+        if (stats.type != schema.type) {
+          stats.type = schema.type;
+          stats.id = id;
+          stats.members = schema.members;
+        }
+        stats.timestamp_us = stats_timestamp_us;
+        size_t num_members = reader.ReadSize();
+        for (size_t i = 0; i < num_members; ++i) {
+          uint64_t index_and_defined = reader.ReadVarint();
+          uint64_t index = index_and_defined >> 1;
+          if (reader.error() || index >= stats.members.size())
+            return 0;
+          Member& member = stats.members[index];
+          member.is_defined = (index_and_defined & 1) != 0;
+          member.value.clear();
+          if (member.is_defined &&
+              !ReadMemberValue(&reader, member.type, &member.value)) {
+            return 0;
+          }
+        }
+        break;
+      }
+      case kRemovedTag:
+        stats_.erase(reader.ReadString());
+        break;
+      case kEndTag:
+        return reader.error() ? 0 : reader.position();
+      default:
+        return 0;
+    }
+    if (reader.error())
+      return 0;
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,182 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/api/stats/rtcstatsbinaryformat.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "webrtc/base/gunit.h"
+#include "webrtc/stats/test/rtcteststats.h"
+
+namespace webrtc {
+
+namespace {
+
+const size_t kBufferSize = 4096;
+
+std::unique_ptr<RTCTestStats> CreateStats(const std::string& id,
+                                          int64_t timestamp_us,
+                                          int32_t value) {
+  std::unique_ptr<RTCTestStats> stats(new RTCTestStats(id, timestamp_us));
+  stats->m_bool = (value % 2) == 0;
+  stats->m_int32 = -value;
+  stats->m_uint32 = static_cast<uint32_t>(value);
+  stats->m_int64 = -(static_cast<int64_t>(value) << 40);
+  stats->m_uint64 = static_cast<uint64_t>(value) << 40;
+  stats->m_double = value / 3.0;
+  stats->m_string = "value " + std::to_string(value);
+  stats->m_sequence_bool = std::vector<bool>({true, false, value > 0});
+  stats->m_sequence_int32 = std::vector<int32_t>({-value, 0, value});
+  stats->m_sequence_uint32 = std::vector<uint32_t>({0, 1u << 31});
+  stats->m_sequence_int64 = std::vector<int64_t>({-value, INT64_MIN});
+  stats->m_sequence_uint64 = std::vector<uint64_t>({UINT64_MAX, 0});
+  stats->m_sequence_double = std::vector<double>({0.5, -value * 1.5});
+  stats->m_sequence_string = std::vector<std::string>({"", "a", "bc"});
+  return stats;
+}
+
+// Checks that the stats read by |reader| are those of |report|.
+void ExpectReadReport(const RTCStatsBinaryReader& reader,
+                      const RTCStatsReport& report) {
+  EXPECT_EQ(report.timestamp_us(), reader.timestamp_us());
+  ASSERT_EQ(report.size(), reader.stats().size());
+  for (const RTCStats& stats : report) {
+    auto it = reader.stats().find(stats.id());
+    ASSERT_TRUE(it != reader.stats().end()) << stats.id();
+    const RTCStatsBinaryReader::Stats& read_stats = it->second;
+    EXPECT_EQ(stats.type(), read_stats.type);
+    EXPECT_EQ(stats.id(), read_stats.id);
+    EXPECT_EQ(stats.timestamp_us(), read_stats.timestamp_us);
+    std::vector<const RTCStatsMemberInterface*> members = stats.Members();
+    ASSERT_EQ(members.size(), read_stats.members.size());
+    for (size_t i = 0; i < members.size(); ++i) {
+      const RTCStatsBinaryReader::Member& read_member = read_stats.members[i];
+      EXPECT_EQ(members[i]->name(), read_member.name);
+      EXPECT_EQ(members[i]->type(), read_member.type);
+      EXPECT_EQ(members[i]->is_defined(), read_member.is_defined);
+      if (members[i]->is_defined()) {
+        EXPECT_EQ(members[i]->ValueToString(), read_member.value);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(RTCStatsBinaryFormatTest, WritesAndReadsFullReports) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  report->AddStats(CreateStats("a", 1000, 1));
+  report->AddStats(CreateStats("b", 900, -20000));
+  // Undefined members are read as undefined.
+  report->AddStats(
+      std::unique_ptr<RTCStats>(new RTCTestStats("undefined", 1000)));
+
+  RTCStatsBinaryWriter writer;
+  RTCStatsBinaryReader reader;
+  uint8_t buffer[kBufferSize];
+  size_t size = writer.Write(report, RTCStatsBinaryWriter::kFull, buffer,
+                             sizeof(buffer));
+  ASSERT_GT(size, 0u);
+  EXPECT_LT(size, report->ToString().size());
+  EXPECT_EQ(size, reader.Read(buffer, size));
+  ExpectReadReport(reader, *report);
+
+  // The schema is only written once.
+  rtc::scoped_refptr<RTCStatsReport> next_report =
+      RTCStatsReport::Create(2000);
+  next_report->AddStats(CreateStats("a", 2000, 2));
+  next_report->AddStats(CreateStats("b", 1900, -20001));
+  next_report->AddStats(
+      std::unique_ptr<RTCStats>(new RTCTestStats("undefined", 2000)));
+  size_t next_size = writer.Write(next_report, RTCStatsBinaryWriter::kFull,
+                                  buffer, sizeof(buffer));
+  ASSERT_GT(next_size, 0u);
+  EXPECT_LT(next_size, size);
+  EXPECT_EQ(next_size, reader.Read(buffer, next_size));
+  ExpectReadReport(reader, *next_report);
+}
+
+TEST(RTCStatsBinaryFormatTest, WritesOnlyChangesInDeltaReports) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  report->AddStats(CreateStats("unchanged", 1000, 1));
+  report->AddStats(CreateStats("changed", 1000, 2));
+  report->AddStats(CreateStats("removed", 1000, 3));
+
+  RTCStatsBinaryWriter writer;
+  RTCStatsBinaryReader reader;
+  uint8_t buffer[kBufferSize];
+  // Without a previous report, a full report is written.
+  size_t size = writer.Write(report, RTCStatsBinaryWriter::kDelta, buffer,
+                             sizeof(buffer));
+  ASSERT_GT(size, 0u);
+  EXPECT_EQ(size, reader.Read(buffer, size));
+  ExpectReadReport(reader, *report);
+
+  rtc::scoped_refptr<RTCStatsReport> next_report =
+      RTCStatsReport::Create(2000);
+  next_report->AddStats(CreateStats("unchanged", 2000, 1));
+  std::unique_ptr<RTCTestStats> changed = CreateStats("changed", 2000, 2);
+  changed->m_uint64 = 12345;
+  changed->m_sequence_string = std::vector<std::string>({"changed"});
+  next_report->AddStats(std::move(changed));
+  std::unique_ptr<RTCTestStats> added(new RTCTestStats("added", 1500));
+  added->m_int32 = 4;
+  next_report->AddStats(std::move(added));
+  size_t delta_size = writer.Write(next_report, RTCStatsBinaryWriter::kDelta,
+                                   buffer, sizeof(buffer));
+  ASSERT_GT(delta_size, 0u);
+  EXPECT_LT(delta_size, size);
+  EXPECT_EQ(delta_size, reader.Read(buffer, delta_size));
+  ExpectReadReport(reader, *next_report);
+
+  // A member can become undefined.
+  rtc::scoped_refptr<RTCStatsReport> last_report =
+      RTCStatsReport::Create(3000);
+  last_report->AddStats(CreateStats("unchanged", 3000, 1));
+  last_report->AddStats(
+      std::unique_ptr<RTCStats>(new RTCTestStats("changed", 3000)));
+  delta_size = writer.Write(last_report, RTCStatsBinaryWriter::kDelta, buffer,
+                            sizeof(buffer));
+  ASSERT_GT(delta_size, 0u);
+  EXPECT_EQ(delta_size, reader.Read(buffer, delta_size));
+  ExpectReadReport(reader, *last_report);
+}
+
+TEST(RTCStatsBinaryFormatTest, FailsToWriteToSmallBuffer) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  report->AddStats(CreateStats("a", 1000, 1));
+
+  RTCStatsBinaryWriter writer;
+  uint8_t buffer[kBufferSize];
+  size_t size = writer.Write(report, RTCStatsBinaryWriter::kFull, buffer,
+                             sizeof(buffer));
+  ASSERT_GT(size, 0u);
+
+  // A writer which failed to write the report can write it again, including
+  // the schema.
+  RTCStatsBinaryWriter small_writer;
+  for (size_t small_size = 0; small_size < size; small_size += 7) {
+    EXPECT_EQ(0u, small_writer.Write(report, RTCStatsBinaryWriter::kDelta,
+                                     buffer, small_size));
+  }
+  ASSERT_EQ(size, small_writer.Write(report, RTCStatsBinaryWriter::kDelta,
+                                     buffer, sizeof(buffer)));
+  RTCStatsBinaryReader reader;
+  EXPECT_EQ(size, reader.Read(buffer, size));
+  ExpectReadReport(reader, *report);
+
+  // Truncated reports are not read.
+  RTCStatsBinaryReader truncated_reader;
+  EXPECT_EQ(0u, truncated_reader.Read(buffer, size - 1));
+}
+
+}  // namespace webrtc
@@ -0,0 +1,250 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/video/decode_scheduler.h"
+
+#include <string>
+#include <utility>
+
+#include "webrtc/base/checks.h"
+#include "webrtc/system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+class DecodeScheduler::Worker {
+ public:
+  Worker(Clock* clock, const std::string& thread_name);
+  ~Worker();
+
+  size_t num_streams() const;
+
+  void AddStream(Stream* stream);
+  void RemoveStream(Stream* stream);
+  void WakeUp(Stream* stream);
+
+ private:
+  // Streams ordered by the time they should next be polled. Streams with equal
+  // deadlines are kept in insertion order, which gives round-robin service.
+  using DeadlineQueue = std::multimap<int64_t, Stream*>;
+
+  struct StreamState {
+    // Position in |queue_|, or |queue_.end()| if the stream is not queued.
+    DeadlineQueue::iterator queue_it;
+    // Set if WakeUp() was called while the stream was being decoded.
+    bool wake_up_pending = false;
+  };
+
+  static bool Run(void* obj);
+  bool Process();
+
+  void ScheduleLocked(Stream* stream, StreamState* state, int64_t time_ms)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  Clock* const clock_;
+  rtc::Event wake_up_event_;
+  rtc::Event decode_done_event_;
+
+  rtc::CriticalSection crit_;
+  DeadlineQueue queue_ GUARDED_BY(crit_);
+  std::map<Stream*, StreamState> streams_ GUARDED_BY(crit_);
+  Stream* decoding_stream_ GUARDED_BY(crit_);
+  bool stopping_ GUARDED_BY(crit_);
+
+  // Declared last so that it is started after all other members have been
+  // initialized.
+  rtc::PlatformThread thread_;
+};
+
+DecodeScheduler::Worker::Worker(Clock* clock, const std::string& thread_name)
+    : clock_(clock),
+      wake_up_event_(false, false),
+      decode_done_event_(true, false),
+      decoding_stream_(nullptr),
+      stopping_(false),
+      thread_(&Worker::Run, this, thread_name.c_str()) {
+  thread_.Start();
+  thread_.SetPriority(rtc::kHighestPriority);
+}
+
+DecodeScheduler::Worker::~Worker() {
+  {
+    rtc::CritScope lock(&crit_);
+    RTC_DCHECK(streams_.empty());
+    stopping_ = true;
+  }
+  wake_up_event_.Set();
+  thread_.Stop();
+}
+
+size_t DecodeScheduler::Worker::num_streams() const {
+  rtc::CritScope lock(&crit_);
+  return streams_.size();
+}
+
+void DecodeScheduler::Worker::AddStream(Stream* stream) {
+  {
+    rtc::CritScope lock(&crit_);
+    StreamState& state = streams_[stream];
+    state.queue_it = queue_.end();
+    ScheduleLocked(stream, &state, clock_->TimeInMilliseconds());
+  }
+  wake_up_event_.Set();
+}
+
+void DecodeScheduler::Worker::RemoveStream(Stream* stream) {
+  while (true) {
+    {
+      rtc::CritScope lock(&crit_);
+      if (decoding_stream_ != stream) {
+        auto it = streams_.find(stream);
+        RTC_DCHECK(it != streams_.end());
+        if (it->second.queue_it != queue_.end())
+          queue_.erase(it->second.queue_it);
+        streams_.erase(it);
+        return;
+      }
+      // Reset under the lock, so that the worker cannot signal completion of
+      // the ongoing decode before we start waiting for it.
+      decode_done_event_.Reset();
+    }
+    decode_done_event_.Wait(rtc::Event::kForever);
+  }
+}
+
+void DecodeScheduler::Worker::WakeUp(Stream* stream) {
+  {
+    rtc::CritScope lock(&crit_);
+    auto it = streams_.find(stream);
+    if (it == streams_.end())
+      return;
+    if (decoding_stream_ == stream) {
+      it->second.wake_up_pending = true;
+      return;
+    }
+    ScheduleLocked(stream, &it->second, clock_->TimeInMilliseconds());
+  }
+  wake_up_event_.Set();
+}
+
+void DecodeScheduler::Worker::ScheduleLocked(Stream* stream,
+                                             StreamState* state,
+                                             int64_t time_ms) {
+  if (state->queue_it != queue_.end()) {
+    if (state->queue_it->first <= time_ms)
+      return;
+    queue_.erase(state->queue_it);
+  }
+  state->queue_it = queue_.insert(std::make_pair(time_ms, stream));
+}
+
+bool DecodeScheduler::Worker::Run(void* obj) {
+  return static_cast<Worker*>(obj)->Process();
+}
+
+bool DecodeScheduler::Worker::Process() {
+  Stream* stream = nullptr;
+  int wait_ms = rtc::Event::kForever;
+  {
+    rtc::CritScope lock(&crit_);
+    if (stopping_)
+      return false;
+
+    if (!queue_.empty()) {
+      int64_t now_ms = clock_->TimeInMilliseconds();
+      auto next = queue_.begin();
+      if (next->first <= now_ms) {
+        stream = next->second;
+        StreamState& state = streams_[stream];
+        state.queue_it = queue_.end();
+        state.wake_up_pending = false;
+        queue_.erase(next);
+        decoding_stream_ = stream;
+      } else {
+        wait_ms = static_cast<int>(next->first - now_ms);
+      }
+    }
+  }
+
+  if (!stream) {
+    wake_up_event_.Wait(wait_ms);
+    return true;
+  }
+
+  int64_t next_poll_ms = stream->DecodeNextFrame();
+
+  {
+    rtc::CritScope lock(&crit_);
+    decoding_stream_ = nullptr;
+    // RemoveStream() waits for the decode to finish, so |stream| is still
+    // registered here.
+    auto it = streams_.find(stream);
+    RTC_DCHECK(it != streams_.end());
+    int64_t now_ms = clock_->TimeInMilliseconds();
+    if (it->second.wake_up_pending) {
+      ScheduleLocked(stream, &it->second, now_ms);
+    } else if (next_poll_ms >= 0) {
+      ScheduleLocked(stream, &it->second, now_ms + next_poll_ms);
+    }
+  }
+  decode_done_event_.Set();
+  return true;
+}
+
+DecodeScheduler::DecodeScheduler(Clock* clock, size_t num_threads)
+    : clock_(clock) {
+  RTC_DCHECK(clock_);
+  RTC_DCHECK_GT(num_threads, 0u);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(
+        new Worker(clock_, "DecodeWorker" + std::to_string(i)));
+  }
+}
+
+DecodeScheduler::~DecodeScheduler() {
+  RTC_DCHECK(stream_to_worker_.empty());
+}
+
+void DecodeScheduler::RegisterStream(Stream* stream) {
+  rtc::CritScope lock(&crit_);
+  RTC_DCHECK(stream_to_worker_.find(stream) == stream_to_worker_.end());
+  Worker* least_loaded = workers_.front().get();
+  size_t least_load = least_loaded->num_streams();
+  for (const auto& worker : workers_) {
+    size_t load = worker->num_streams();
+    if (load < least_load) {
+      least_loaded = worker.get();
+      least_load = load;
+    }
+  }
+  stream_to_worker_[stream] = least_loaded;
+  least_loaded->AddStream(stream);
+}
+
+void DecodeScheduler::DeregisterStream(Stream* stream) {
+  Worker* worker = nullptr;
+  {
+    rtc::CritScope lock(&crit_);
+    auto it = stream_to_worker_.find(stream);
+    RTC_DCHECK(it != stream_to_worker_.end());
+    worker = it->second;
+    stream_to_worker_.erase(it);
+  }
+  // Don't hold |crit_| while possibly waiting for an ongoing decode.
+  worker->RemoveStream(stream);
+}
+
+void DecodeScheduler::WakeUp(Stream* stream) {
+  rtc::CritScope lock(&crit_);
+  auto it = stream_to_worker_.find(stream);
+  if (it != stream_to_worker_.end())
+    it->second->WakeUp(stream);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_VIDEO_DECODE_SCHEDULER_H_
+#define WEBRTC_VIDEO_DECODE_SCHEDULER_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/criticalsection.h"
+#include "webrtc/base/event.h"
+#include "webrtc/base/platform_thread.h"
+#include "webrtc/base/thread_annotations.h"
+
+namespace webrtc {
+
+class Clock;
+
+// A fixed pool of decode threads shared by many video receive streams, used
+// instead of one dedicated decode thread per stream. Each registered stream is
+// pinned to one worker thread for its whole lifetime, so that decoder state is
+// only ever touched from a single thread. Within a worker, streams are served
+// in order of their next decode deadline, and streams with equal deadlines are
+// served round-robin.
+//
+// The scheduler may be shared between several Call instances, and must
+// outlive all streams registered with it.
+class DecodeScheduler {
+ public:
+  class Stream {
+   public:
+    // Decodes at most one frame. Called on the worker thread the stream was
+    // assigned to at registration. Returns the time in ms until the stream
+    // should be polled again, or -1 if it should not be polled again until
+    // woken up with DecodeScheduler::WakeUp().
+    virtual int64_t DecodeNextFrame() = 0;
+
+   protected:
+    virtual ~Stream() {}
+  };
+
+  DecodeScheduler(Clock* clock, size_t num_threads);
+  ~DecodeScheduler();
+
+  size_t num_threads() const { return workers_.size(); }
+
+  // Assigns |stream| to the least loaded worker and schedules it for
+  // immediate polling.
+  void RegisterStream(Stream* stream);
+
+  // Removes |stream| from the scheduler. If the stream is being decoded on its
+  // worker thread, blocks until DecodeNextFrame() has returned. Must not be
+  // called from a worker thread.
+  void DeregisterStream(Stream* stream);
+
+  // Schedules |stream| to be polled as soon as possible, e.g. because a new
+  // frame has become decodable. Can be called on any thread.
+  void WakeUp(Stream* stream);
+
+ private:
+  class Worker;
+
+  Clock* const clock_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  rtc::CriticalSection crit_;
+  std::map<Stream*, Worker*> stream_to_worker_ GUARDED_BY(crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(DecodeScheduler);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_VIDEO_DECODE_SCHEDULER_H_
@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "webrtc/base/criticalsection.h"
+#include "webrtc/base/event.h"
+#include "webrtc/base/platform_thread.h"
+#include "webrtc/system_wrappers/include/clock.h"
+#include "webrtc/system_wrappers/include/sleep.h"
+#include "webrtc/test/gtest.h"
+#include "webrtc/video/decode_scheduler.h"
+
+namespace webrtc {
+namespace {
+
+const int kTimeoutMs = 5000;
+
+class FakeStream : public DecodeScheduler::Stream {
+ public:
+  explicit FakeStream(int id, std::vector<int>* decode_order = nullptr,
+                      rtc::CriticalSection* order_crit = nullptr)
+      : id_(id),
+        decode_order_(decode_order),
+        order_crit_(order_crit),
+        decode_started_event_(false, false),
+        decoded_event_(false, false) {}
+
+  int64_t DecodeNextFrame() override {
+    rtc::PlatformThreadRef thread = rtc::CurrentThreadRef();
+    {
+      rtc::CritScope lock(&crit_);
+      if (num_decodes_ > 0 && !rtc::IsThreadRefEqual(thread, thread_))
+        decoded_on_multiple_threads_ = true;
+      thread_ = thread;
+      ++num_decodes_;
+    }
+    if (decode_order_) {
+      rtc::CritScope lock(order_crit_);
+      decode_order_->push_back(id_);
+    }
+    decode_started_event_.Set();
+    if (block_event_)
+      block_event_->Wait(rtc::Event::kForever);
+    decoded_event_.Set();
+    rtc::CritScope lock(&crit_);
+    return next_poll_ms_;
+  }
+
+  void set_next_poll_ms(int64_t next_poll_ms) {
+    rtc::CritScope lock(&crit_);
+    next_poll_ms_ = next_poll_ms;
+  }
+  int num_decodes() const {
+    rtc::CritScope lock(&crit_);
+    return num_decodes_;
+  }
+  bool decoded_on_multiple_threads() const {
+    rtc::CritScope lock(&crit_);
+    return decoded_on_multiple_threads_;
+  }
+  void set_block_event(rtc::Event* event) { block_event_ = event; }
+  rtc::Event* decode_started_event() { return &decode_started_event_; }
+  rtc::Event* decoded_event() { return &decoded_event_; }
+
+ private:
+  const int id_;
+  std::vector<int>* const decode_order_;
+  rtc::CriticalSection* const order_crit_;
+  rtc::Event decode_started_event_;
+  rtc::Event decoded_event_;
+  rtc::Event* block_event_ = nullptr;
+
+  rtc::CriticalSection crit_;
+  int64_t next_poll_ms_ GUARDED_BY(crit_) = -1;
+  int num_decodes_ GUARDED_BY(crit_) = 0;
+  bool decoded_on_multiple_threads_ GUARDED_BY(crit_) = false;
+  rtc::PlatformThreadRef thread_ GUARDED_BY(crit_);
+};
+
+bool UnblockAfterDelay(void* event) {
+  SleepMs(50);
+  static_cast<rtc::Event*>(event)->Set();
+  return false;
+}
+
+}  // namespace
+
+TEST(DecodeSchedulerTest, PollsStreamOnRegistration) {
+  DecodeScheduler scheduler(Clock::GetRealTimeClock(), 2);
+  FakeStream stream(0);
+  scheduler.RegisterStream(&stream);
+  EXPECT_TRUE(stream.decoded_event()->Wait(kTimeoutMs));
+  scheduler.DeregisterStream(&stream);
+  EXPECT_EQ(1, stream.num_decodes());
+}
+
+TEST(DecodeSchedulerTest, WakeUpPollsIdleStream) {
+  DecodeScheduler scheduler(Clock::GetRealTimeClock(), 1);
+  FakeStream stream(0);
+  scheduler.RegisterStream(&stream);
+  ASSERT_TRUE(stream.decoded_event()->Wait(kTimeoutMs));
+
+  scheduler.WakeUp(&stream);
+  EXPECT_TRUE(stream.decoded_event()->Wait(kTimeoutMs));
+  scheduler.DeregisterStream(&stream);
+  EXPECT_EQ(2, stream.num_decodes());
+}
+
+TEST(DecodeSchedulerTest, RepollsAfterReturnedDelay) {
+  DecodeScheduler scheduler(Clock::GetRealTimeClock(), 1);
+  FakeStream stream(0);
+  stream.set_next_poll_ms(10);
+  scheduler.RegisterStream(&stream);
+  for (int i = 0; i < 3; ++i)
+    ASSERT_TRUE(stream.decoded_event()->Wait(kTimeoutMs));
+  scheduler.DeregisterStream(&stream);
+  EXPECT_GE(stream.num_decodes(), 3);
+}
+
+TEST(DecodeSchedulerTest, KeepsStreamOnOneThread) {
+  const size_t kNumThreads = 4;
+  const int kNumStreams = 16;
+  DecodeScheduler scheduler(Clock::GetRealTimeClock(), kNumThreads);
+  std::vector<std::unique_ptr<FakeStream>> streams;
+  for (int i = 0; i < kNumStreams; ++i) {
+    streams.emplace_back(new FakeStream(i));
+    streams.back()->set_next_poll_ms(1);
+    scheduler.RegisterStream(streams.back().get());
+  }
+  for (auto& stream : streams) {
+    for (int i = 0; i < 10; ++i)
+      ASSERT_TRUE(stream->decoded_event()->Wait(kTimeoutMs));
+  }
+  for (auto& stream : streams) {
+    scheduler.DeregisterStream(stream.get());
+    EXPECT_FALSE(stream->decoded_on_multiple_threads());
+  }
+}
+
+TEST(DecodeSchedulerTest, ServesDueStreamsRoundRobin) {
+  DecodeScheduler scheduler(Clock::GetRealTimeClock(), 1);
+  rtc::CriticalSection crit;
+  std::vector<int> order;
+  rtc::Event block(false, false);
+
+  // Keep the only worker busy with |first| while the other streams queue up.
+  FakeStream first(0, &order, &crit);
+  first.set_block_event(&block);
+  scheduler.RegisterStream(&first);
+  FakeStream second(1, &order, &crit);
+  FakeStream third(2, &order, &crit);
+  second.set_next_poll_ms(1);
+  third.set_next_poll_ms(1);
+  scheduler.RegisterStream(&second);
+  scheduler.RegisterStream(&third);
+  block.Set();
+
+  ASSERT_TRUE(third.decoded_event()->Wait(kTimeoutMs));
+  ASSERT_TRUE(third.decoded_event()->Wait(kTimeoutMs));
+  std::vector<int> order_snapshot;
+  {
+    rtc::CritScope lock(&crit);
+    order_snapshot = order;
+  }
+  scheduler.DeregisterStream(&second);
+  scheduler.DeregisterStream(&third);
+  scheduler.DeregisterStream(&first);
+
+  ASSERT_GE(order_snapshot.size(), 5u);
+  EXPECT_EQ(0, order_snapshot[0]);
+  for (size_t i = 1; i + 1 < order_snapshot.size(); ++i)
+    EXPECT_NE(order_snapshot[i], order_snapshot[i + 1]);
+}
+
+TEST(DecodeSchedulerTest, DeregisterWaitsForOngoingDecode) {
+  DecodeScheduler scheduler(Clock::GetRealTimeClock(), 1);
+  rtc::Event block(false, false);
+  FakeStream stream(0);
+  stream.set_block_event(&block);
+  scheduler.RegisterStream(&stream);
+  ASSERT_TRUE(stream.decode_started_event()->Wait(kTimeoutMs));
+
+  rtc::PlatformThread unblock_thread(&UnblockAfterDelay, &block, "Unblock");
+  unblock_thread.Start();
+  scheduler.DeregisterStream(&stream);
+  EXPECT_TRUE(stream.decoded_event()->Wait(0));
+  unblock_thread.Stop();
+}
+
+}  // namespace webrtc
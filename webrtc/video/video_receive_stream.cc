@@ -12,6 +12,7 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <utility>
@@ -134,6 +135,9 @@ std::string VideoReceiveStream::Stats::ToString(int64_t time_ms) const {
 }
 
 namespace {
+// Time without a decodable frame after which a keyframe is requested.
+constexpr int kMaxWaitForFrameMs = 3000;
+
 VideoCodec CreateDecoderVideoCodec(const VideoReceiveStream::Decoder& decoder) {
   VideoCodec codec;
   memset(&codec, 0, sizeof(codec));
@@ -179,7 +183,8 @@ VideoReceiveStream::VideoReceiveStream(
     VideoReceiveStream::Config config,
     ProcessThread* process_thread,
     CallStats* call_stats,
-    VieRemb* remb)
+    VieRemb* remb,
+    DecodeScheduler* decode_scheduler)
     : transport_adapter_(config.rtcp_send_transport),
       config_(std::move(config)),
       num_cpu_cores_(num_cpu_cores),
@@ -206,7 +211,11 @@ VideoReceiveStream::VideoReceiveStream(
       rtp_stream_sync_(this),
       jitter_buffer_experiment_(
           field_trial::FindFullName("WebRTC-NewVideoJitterBuffer") ==
-          "Enabled") {
+          "Enabled"),
+      // The legacy jitter buffer only supports blocking decode calls, so the
+      // shared scheduler can only be used with the new jitter buffer.
+      decode_scheduler_(jitter_buffer_experiment_ ? decode_scheduler
+                                                  : nullptr) {
   LOG(LS_INFO) << "VideoReceiveStream: " << config_.ToString();
 
   RTC_DCHECK(process_thread_);
@@ -272,7 +281,7 @@ void VideoReceiveStream::SetSync(Syncable* audio_syncable) {
 
 void VideoReceiveStream::Start() {
   RTC_DCHECK_RUN_ON(&worker_thread_checker_);
-  if (decode_thread_.IsRunning())
+  if (decode_thread_.IsRunning() || decode_scheduler_registered_)
     return;
 
   bool protected_by_fec =
@@ -315,9 +324,15 @@ void VideoReceiveStream::Start() {
       &stats_proxy_, renderer));
   // Register the channel to receive stats updates.
   call_stats_->RegisterStatsObserver(video_stream_decoder_.get());
-  // Start the decode thread
-  decode_thread_.Start();
-  decode_thread_.SetPriority(rtc::kHighestPriority);
+  // Start the decode thread, or hand decoding over to the shared scheduler.
+  if (decode_scheduler_) {
+    last_frame_decoded_ms_ = clock_->TimeInMilliseconds();
+    decode_scheduler_->RegisterStream(this);
+    decode_scheduler_registered_ = true;
+  } else {
+    decode_thread_.Start();
+    decode_thread_.SetPriority(rtc::kHighestPriority);
+  }
   rtp_stream_receiver_.StartReceive();
 }
 
@@ -334,8 +349,13 @@ void VideoReceiveStream::Stop() {
     call_stats_->DeregisterStatsObserver(&rtp_stream_receiver_);
   }
 
-  if (decode_thread_.IsRunning()) {
-    decode_thread_.Stop();
+  if (decode_thread_.IsRunning() || decode_scheduler_registered_) {
+    if (decode_scheduler_registered_) {
+      decode_scheduler_->DeregisterStream(this);
+      decode_scheduler_registered_ = false;
+    } else {
+      decode_thread_.Stop();
+    }
     // Deregister external decoders so they are no longer running during
     // destruction. This effectively stops the VCM since the decoder thread is
     // stopped, the VCM is deregistered and no asynchronous decoder threads are
@@ -432,8 +452,11 @@ void VideoReceiveStream::RequestKeyFrame() {
 void VideoReceiveStream::OnCompleteFrame(
     std::unique_ptr<video_coding::FrameObject> frame) {
   int last_continuous_pid = frame_buffer_->InsertFrame(std::move(frame));
-  if (last_continuous_pid != -1)
+  if (last_continuous_pid != -1) {
     rtp_stream_receiver_.FrameContinuous(last_continuous_pid);
+    if (decode_scheduler_)
+      decode_scheduler_->WakeUp(this);
+  }
 }
 
 int VideoReceiveStream::id() const {
@@ -484,7 +507,6 @@ bool VideoReceiveStream::DecodeThreadFunction(void* ptr) {
 void VideoReceiveStream::Decode() {
   static const int kMaxDecodeWaitTimeMs = 50;
   if (jitter_buffer_experiment_) {
-    static const int kMaxWaitForFrameMs = 3000;
     std::unique_ptr<video_coding::FrameObject> frame;
     video_coding::FrameBuffer::ReturnReason res =
         frame_buffer_->NextFrame(kMaxWaitForFrameMs, &frame);
@@ -504,5 +526,35 @@ void VideoReceiveStream::Decode() {
     video_receiver_.Decode(kMaxDecodeWaitTimeMs);
   }
 }
+
+int64_t VideoReceiveStream::DecodeNextFrame() {
+  RTC_DCHECK(decode_scheduler_);
+  std::unique_ptr<video_coding::FrameObject> frame;
+  int64_t wait_ms = -1;
+  video_coding::FrameBuffer::ReturnReason res =
+      frame_buffer_->PollNextFrame(&frame, &wait_ms);
+  if (res == video_coding::FrameBuffer::ReturnReason::kStopped)
+    return -1;
+
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  if (frame) {
+    if (video_receiver_.Decode(frame.get()) == VCM_OK)
+      rtp_stream_receiver_.FrameDecoded(frame->picture_id);
+    last_frame_decoded_ms_ = now_ms;
+    // More frames may already be decodable; requeue behind other due streams.
+    return 0;
+  }
+
+  if (now_ms - last_frame_decoded_ms_ >= kMaxWaitForFrameMs) {
+    LOG(LS_WARNING) << "No decodable frame in " << kMaxWaitForFrameMs
+                    << " ms, requesting keyframe.";
+    RequestKeyFrame();
+    last_frame_decoded_ms_ = now_ms;
+  }
+  int64_t keyframe_wait_ms = last_frame_decoded_ms_ + kMaxWaitForFrameMs -
+                             now_ms;
+  return wait_ms < 0 ? keyframe_wait_ms
+                     : std::min(wait_ms, keyframe_wait_ms);
+}
 }  // namespace internal
 }  // namespace webrtc
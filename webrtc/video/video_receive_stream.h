@@ -22,6 +22,7 @@
 #include "webrtc/modules/video_coding/frame_buffer2.h"
 #include "webrtc/modules/video_coding/video_coding_impl.h"
 #include "webrtc/system_wrappers/include/clock.h"
+#include "webrtc/video/decode_scheduler.h"
 #include "webrtc/video/receive_statistics_proxy.h"
 #include "webrtc/video/rtp_stream_receiver.h"
 #include "webrtc/video/rtp_streams_synchronizer.h"
@@ -47,15 +48,20 @@ class VideoReceiveStream : public webrtc::VideoReceiveStream,
                            public NackSender,
                            public KeyFrameRequestSender,
                            public video_coding::OnCompleteFrameCallback,
-                           public Syncable {
+                           public Syncable,
+                           public DecodeScheduler::Stream {
  public:
+  // If |decode_scheduler| is non-null, and the new jitter buffer is in use,
+  // frames are decoded on the scheduler's shared threads instead of on a
+  // dedicated decode thread.
   VideoReceiveStream(int num_cpu_cores,
                      bool protected_by_flexfec,
                      PacketRouter* packet_router,
                      VideoReceiveStream::Config config,
                      ProcessThread* process_thread,
                      CallStats* call_stats,
-                     VieRemb* remb);
+                     VieRemb* remb,
+                     DecodeScheduler* decode_scheduler);
   ~VideoReceiveStream() override;
 
   const Config& config() const { return config_; }
@@ -109,6 +115,9 @@ class VideoReceiveStream : public webrtc::VideoReceiveStream,
   uint32_t GetPlayoutTimestamp() const override;
   void SetMinimumPlayoutDelay(int delay_ms) override;
 
+  // Implements DecodeScheduler::Stream.
+  int64_t DecodeNextFrame() override;
+
  private:
   static bool DecodeThreadFunction(void* ptr);
   void Decode();
@@ -142,6 +151,12 @@ class VideoReceiveStream : public webrtc::VideoReceiveStream,
   const bool jitter_buffer_experiment_;
   std::unique_ptr<VCMJitterEstimator> jitter_estimator_;
   std::unique_ptr<video_coding::FrameBuffer> frame_buffer_;
+
+  // Shared decode threads, used instead of |decode_thread_| if set.
+  DecodeScheduler* const decode_scheduler_;
+  bool decode_scheduler_registered_ = false;
+  // Accessed on the scheduler worker thread only.
+  int64_t last_frame_decoded_ms_ = 0;
 };
 }  // namespace internal
 }  // namespace webrtc